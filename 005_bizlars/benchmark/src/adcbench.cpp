@@ -0,0 +1,1342 @@
+// adcbench.cpp : benchmarks for the bizlars library
+//
+// usage: adcbench.x <benchmark> [iterations] [-port <port>] [-json <file>]
+//
+// the end-to-end benchmarks (weight, open, settings, adcupdate) use the public
+// api against the port, default is the simulated adc
+//
+
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <map>
+#include <deque>
+#include <algorithm>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <dirent.h>
+#include "authentication.h"
+#include "rbstelegram.h"
+#include "rbsresponse.h"
+#include "adcserial.h"
+#include "adctrace.h"
+#include "adcrbs.h"
+#include "adcfirmware.h"
+#include "crypto.h"
+#include "bizlars.h"
+using namespace std;
+
+//----------------------------------------------------------------------------
+// VersionInfo Tag
+//
+#define BIN_NAME          "adcbench"
+#define BIN_DESCR         "Bizerba ADC Benchmark Program"
+#define BIN_VERSION       "1.44.0001"
+
+static const char SOH = 0x01;
+static const char STX = 0x02;
+static const char ETX = 0x03;
+static const char ETB = 0x17;
+static const char FS  = 0x1C;
+static const char GS  = 0x1D;
+static const char ESC = 0x1B;
+
+typedef map<string, string> keyValuePair;
+
+/**
+******************************************************************************
+* function pointer
+******************************************************************************
+*/
+typedef void(*BenchCall)(unsigned long iterations);
+
+/**
+******************************************************************************
+* structures
+******************************************************************************
+*/
+typedef struct {
+	const char *name;           // benchmark name
+	const char *descr;          // benchmark description
+	unsigned long iterations;   // default number of iterations
+	BenchCall pBenchFunction;   // function to call
+} BENCHTABLE;
+
+typedef struct {
+	string benchmark;			// benchmark name
+	string name;				// measured value
+	double value;
+	string unit;
+} BENCHRESULT;
+
+/**
+******************************************************************************
+* functions
+******************************************************************************
+*/
+void BenchTelegram(unsigned long iterations);
+void BenchCrc(unsigned long iterations);
+void BenchParse(unsigned long iterations);
+void BenchSerial(unsigned long iterations);
+void BenchTrace(unsigned long iterations);
+void BenchUpdate(unsigned long iterations);
+void BenchWeight(unsigned long iterations);
+void BenchOpen(unsigned long iterations);
+void BenchSettings(unsigned long iterations);
+void BenchAdcUpdate(unsigned long iterations);
+void BenchLogger(unsigned long iterations);
+
+static BENCHTABLE benchTable[] =
+{
+	{ "telegram", "encode rbs telegrams (stringstream vs. RbsTelegram)", 1000000, BenchTelegram },
+	{ "crc", "crc16 bitwise vs. table vs. slicing-by-8", 200000, BenchCrc },
+	{ "parse", "parse RW responses (map vs. RbsResponse)", 1000000, BenchParse },
+	{ "serial", "RW round trips over a pty (byte reads vs. buffered reads)", 2000, BenchSerial },
+	{ "trace", "trace calls with the asynchronous writer", 200000, BenchTrace },
+	{ "update", "firmware download of <iterations> KB to a simulated bootloader (window 1, 4, 8)", 256, BenchUpdate },
+	{ "weight", "AdcReadWeight throughput and latency with 1, 2, 4, 8 threads", 2000, BenchWeight },
+	{ "open", "AdcOpen cold, warm and with device profile", 20, BenchOpen },
+	{ "settings", "AdcSetCountry and AdcSetLoadCapacity", 200, BenchSettings },
+	{ "adcupdate", "AdcUpdateEx of <iterations> KB through the public api", 256, BenchAdcUpdate },
+	{ "logger", "log book download, AdcGetLogger per entry vs. AdcGetLoggerRange (port option logbook=N)", 1000, BenchLogger },
+};
+
+static string				g_port = "AdcSimulator";		// port of AdcOpen for the end-to-end benchmarks
+static const char			*g_benchName = "";				// running benchmark
+static vector<BENCHRESULT>	g_results;						// all results for the json output
+
+
+/**
+******************************************************************************
+* helpers
+******************************************************************************
+*/
+static double Seconds(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+static void AddResult(const string &name, double value, const string &unit)
+{
+	BENCHRESULT result = { g_benchName, name, value, unit };
+
+	g_results.push_back(result);
+}
+
+static void PrintResult(const char *name, unsigned long count, double seconds, const char *unit)
+{
+	cout << "  " << left << setw(32) << name << right << setw(14) << fixed << setprecision(0) << count / seconds << " " << unit << "/s" << endl;
+	AddResult(name, count / seconds, string(unit) + "/s");
+}
+
+// p50 and p99 of the samples in us, the samples get sorted
+static void PrintLatency(const string &name, vector<double> &samples)
+{
+	double p50;
+	double p99;
+
+	if (samples.empty())
+		return;
+
+	sort(samples.begin(), samples.end());
+	p50 = samples[(samples.size() - 1) * 50 / 100];
+	p99 = samples[(samples.size() - 1) * 99 / 100];
+
+	cout << "  " << left << setw(32) << name << right << setw(14) << fixed << setprecision(1) << p50 << " us p50" << setw(12) << p99 << " us p99" << endl;
+	AddResult(name + " p50", p50, "us");
+	AddResult(name + " p99", p99, "us");
+}
+
+static double Microseconds(chrono::steady_clock::time_point start)
+{
+	return chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+}
+
+// json string, the names and units are plain ascii
+static string JsonString(const string &str)
+{
+	string json = "\"";
+
+	for (size_t idx = 0; idx < str.size(); idx++)
+	{
+		if ((str[idx] == '"') || (str[idx] == '\\'))
+			json += '\\';
+		json += str[idx];
+	}
+
+	return json + "\"";
+}
+
+static bool WriteJson(const string &fileName)
+{
+	FILE *file = (fileName == "-") ? stdout : fopen(fileName.c_str(), "w");
+
+	if (file == NULL)
+		return false;
+
+	fprintf(file, "{\n  \"program\": %s,\n  \"version\": %s,\n  \"port\": %s,\n  \"results\": [", JsonString(BIN_NAME).c_str(),
+		JsonString(BIN_VERSION).c_str(), JsonString(g_port).c_str());
+	for (size_t idx = 0; idx < g_results.size(); idx++)
+	{
+		fprintf(file, "%s\n    { \"benchmark\": %s, \"name\": %s, \"value\": %.3f, \"unit\": %s }", idx ? "," : "",
+			JsonString(g_results[idx].benchmark).c_str(), JsonString(g_results[idx].name).c_str(), g_results[idx].value,
+			JsonString(g_results[idx].unit).c_str());
+	}
+	fprintf(file, "\n  ]\n}\n");
+
+	return (file == stdout) ? (fflush(file) == 0) : (fclose(file) == 0);
+}
+
+
+/**
+******************************************************************************
+* CreateTelegramStream - previous telegram encoder based on stringstream,
+*                        kept as reference
+******************************************************************************
+*/
+static string CreateTelegramStream(const string &cmd, const keyValuePair &refDataMap, short orderID, bool crc16)
+{
+	stringstream    output;
+	stringstream    length;
+	bool            bFirst = true;
+	Authentication	crc(RBS_CRC_START, RBS_CRC_POLY, RBS_CRC_MASK);
+	string			str;
+
+	output << ESC << orderID << GS << cmd;
+
+	if (refDataMap.size())
+	{
+		output << STX;
+		for (keyValuePair::const_iterator it = refDataMap.begin(); it != refDataMap.end(); ++it)
+		{
+			if (!bFirst) output << GS;
+			output << (*it).first;
+			if (!(*it).second.empty()) output << FS << (*it).second;
+			bFirst = false;
+		}
+		output << ETX;
+	}
+	else if (crc16)
+	{
+		output << GS;
+	}
+
+	if (crc16)
+	{
+		str = output.str();
+		output << crc.CalcCrc((unsigned char *)str.c_str(), str.length());
+	}
+	output << ETB;
+
+	length << output.str().size();
+	return SOH + length.str() + output.str();
+}
+
+
+/**
+******************************************************************************
+* BenchTelegram - telegrams per second for RW and a settings telegram
+******************************************************************************
+*/
+void BenchTelegram(unsigned long iterations)
+{
+	RbsTelegram		telegram;
+	keyValuePair	rw;
+	keyValuePair	settings;
+	unsigned long	check = 0;
+	chrono::steady_clock::time_point start;
+
+	rw["rr"] = "";
+	for (int idx = 0; idx < 32; idx++)
+	{
+		stringstream key;
+		key << "p" << idx;
+		settings[key.str()] = "1234567890";
+	}
+
+	const keyValuePair *maps[] = { &rw, &settings };
+	const char *cmds[] = { "RW", "SCTR" };
+
+	for (int m = 0; m < 2; m++)
+	{
+		const string cmd = cmds[m];
+		const keyValuePair &refDataMap = *maps[m];
+
+		// both encoders must produce the same telegram
+		telegram.Begin(42, 0, cmd);
+		for (keyValuePair::const_iterator it = refDataMap.begin(); it != refDataMap.end(); ++it)
+			telegram.AddReferenceData((*it).first, (*it).second);
+		telegram.End(true);
+		if (CreateTelegramStream(cmd, refDataMap, 42, true) != telegram.GetData())
+		{
+			cout << "  telegram " << cmd << " differs" << endl;
+			return;
+		}
+
+		start = chrono::steady_clock::now();
+		for (unsigned long idx = 0; idx < iterations; idx++)
+		{
+			check += CreateTelegramStream(cmd, refDataMap, (short)(idx % 99 + 1), true).size();
+		}
+		PrintResult((cmd + " stringstream").c_str(), iterations, Seconds(start), "telegrams");
+
+		start = chrono::steady_clock::now();
+		for (unsigned long idx = 0; idx < iterations; idx++)
+		{
+			telegram.Begin((short)(idx % 99 + 1), 0, cmd);
+			for (keyValuePair::const_iterator it = refDataMap.begin(); it != refDataMap.end(); ++it)
+				telegram.AddReferenceData((*it).first, (*it).second);
+			telegram.End(true);
+			check += telegram.GetSize();
+		}
+		PrintResult((cmd + " RbsTelegram").c_str(), iterations, Seconds(start), "telegrams");
+	}
+
+	if (!check) cout << "  no data" << endl;
+}
+
+
+/**
+******************************************************************************
+* BenchCrc - bytes per second of the crc16 implementations
+******************************************************************************
+*/
+void BenchCrc(unsigned long iterations)
+{
+	typedef void (Authentication::*CrcCall)(unsigned short *crc, const unsigned char *buffer, unsigned long size);
+
+	static const unsigned long sizes[] = { 16, 256, 4096 };	// RW telegram, settings telegram, firmware block
+	const char *names[] = { "bitwise", "table", "slicing-by-8" };
+	CrcCall calls[] = { &Authentication::UpdateCrcBitwise, &Authentication::UpdateCrcTable, &Authentication::UpdateCrcSlicing8 };
+	Authentication crc16(RBS_CRC_START, RBS_CRC_POLY, RBS_CRC_MASK);
+	unsigned char buffer[4096];
+	unsigned short crc[3];
+	chrono::steady_clock::time_point start;
+
+	for (unsigned long idx = 0; idx < sizeof(buffer); idx++)
+		buffer[idx] = (unsigned char)(idx * 7 + 3);
+
+	for (int s = 0; s < 3; s++)
+	{
+		// scale the iterations so every size processes the same amount of data
+		unsigned long loops = iterations * 16 / sizes[s];
+
+		for (int c = 0; c < 3; c++)
+		{
+			stringstream name;
+			unsigned short value = crc16.InitCrc();
+
+			start = chrono::steady_clock::now();
+			for (unsigned long idx = 0; idx < loops; idx++)
+			{
+				(crc16.*calls[c])(&value, buffer, sizes[s]);
+			}
+			name << names[c] << " (" << sizes[s] << " bytes)";
+			PrintResult(name.str().c_str(), loops * sizes[s], Seconds(start), "bytes");
+			crc[c] = value;
+		}
+
+		// results must be bit-identical
+		if ((crc[0] != crc[1]) || (crc[0] != crc[2]))
+			cout << "  crc differs: " << crc[0] << " " << crc[1] << " " << crc[2] << endl;
+	}
+}
+
+
+/**
+******************************************************************************
+* ParseTelegramMap - previous response parser based on maps, kept as reference
+*                    (header, reference data and structure split as before)
+******************************************************************************
+*/
+static bool ParseTelegramMap(const string &telegram, keyValuePair &headerMap, keyValuePair &refDataMap)
+{
+	size_t	pos;
+	size_t	end;
+	size_t	refEnd;
+	int		headerIdx = 0;
+
+	headerMap.clear();
+	refDataMap.clear();
+
+	if (telegram.empty() || (telegram[0] != SOH))
+		return false;
+
+	// header
+	pos = 1;
+	while ((end = telegram.find_first_of(string(1, ESC) + GS, pos)) != string::npos)
+	{
+		headerMap["hdr" + to_string(headerIdx++)] = telegram.substr(pos, end - pos);
+		pos = end + 1;
+		if (telegram[end] == GS) break;
+	}
+
+	// command
+	if ((end = telegram.find_first_of(string(1, STX) + ETB + GS, pos)) == string::npos)
+		return false;
+	headerMap["cmd"] = telegram.substr(pos, end - pos);
+	pos = end + 1;
+
+	// reference data
+	if (telegram[end] == STX)
+	{
+		if ((refEnd = telegram.find(ETX, pos)) == string::npos)
+			return false;
+		while (pos <= refEnd)
+		{
+			size_t fs = telegram.find(FS, pos);
+			end = telegram.find_first_of(string(1, GS) + ETX, pos);
+			if ((fs != string::npos) && (fs < end))
+				refDataMap[telegram.substr(pos, fs - pos)] = telegram.substr(fs + 1, end - fs - 1);
+			else
+				refDataMap[telegram.substr(pos, end - pos)] = "";
+			pos = end + 1;
+		}
+	}
+
+	// checksum
+	if ((end = telegram.find(ETB, pos)) == string::npos)
+		return false;
+	if (end > pos) headerMap["crc16"] = telegram.substr(pos, end - pos);
+
+	return true;
+}
+
+
+static void ParseStructureMap(const string &structStr, keyValuePair &structMap)
+{
+	int		headerIdx = 0;
+	size_t	newPos = 0;
+	size_t	oldPos = 0;
+
+	while ((newPos = structStr.find(ESC, oldPos)) != string::npos)
+	{
+		structMap["pos" + to_string(headerIdx++)] = structStr.substr(oldPos, newPos - oldPos);
+		oldPos = ++newPos;
+	}
+	structMap["pos" + to_string(headerIdx++)] = structStr.substr(oldPos, structStr.size() - oldPos);
+}
+
+
+/**
+******************************************************************************
+* BenchParse - RW responses per second incl. decoding of lcs and wt
+******************************************************************************
+*/
+void BenchParse(unsigned long iterations)
+{
+	RbsTelegram		telegram;
+	RbsResponse		response;
+	keyValuePair	headerMap;
+	keyValuePair	refDataMap;
+	keyValuePair	structMap;
+	string			str;
+	long long		check = 0;
+	long long		mapWeight = 0;
+	long long		spanWeight = 0;
+	chrono::steady_clock::time_point start;
+
+	// typical RW response
+	telegram.Begin(42, 0, "RW");
+	telegram.AddReferenceData("lcs", "1234");
+	telegram.AddReferenceData("stat", "0");
+	telegram.AddReferenceData("tare", string("0") + ESC + "0" + ESC + "3" + ESC + "1");
+	telegram.AddReferenceData("wt", string("-12345") + ESC + "3" + ESC + "1");
+	telegram.End(true);
+	str = telegram.GetData();
+
+	start = chrono::steady_clock::now();
+	for (unsigned long idx = 0; idx < iterations; idx++)
+	{
+		stringstream input;
+
+		if (!ParseTelegramMap(str, headerMap, refDataMap))
+			break;
+		structMap.clear();
+		ParseStructureMap(refDataMap["wt"], structMap);
+		input << structMap["pos0"];
+		input >> mapWeight;
+		check += mapWeight + headerMap.size();
+	}
+	PrintResult("RW map", iterations, Seconds(start), "telegrams");
+
+	start = chrono::steady_clock::now();
+	for (unsigned long idx = 0; idx < iterations; idx++)
+	{
+		const RbsField *value;
+
+		if ((response.Parse(str.c_str(), str.size()) != 0) || ((value = response.Find("wt")) == NULL))
+			break;
+		value->Position(0).GetLongLong(&spanWeight);
+		check += spanWeight + response.GetFieldCount();
+	}
+	PrintResult("RW RbsResponse", iterations, Seconds(start), "telegrams");
+
+	// both parsers must decode the same weight
+	if ((mapWeight != spanWeight) || (refDataMap.size() != (size_t)response.GetFieldCount()))
+		cout << "  parse differs: " << mapWeight << " " << spanWeight << endl;
+	if (!check) cout << "  no data" << endl;
+}
+
+
+/**
+******************************************************************************
+* SerialResponder - scripted adc on the master side of the pty, answers every
+*                   telegram with the same RW response
+******************************************************************************
+*/
+static void SerialResponder(int master, const string *response, atomic<bool> *run)
+{
+	char			buffer[1024];
+	struct pollfd	pfd = { master, POLLIN, 0 };
+	ssize_t			bytesRead;
+
+	while (run->load())
+	{
+		if (poll(&pfd, 1, 100) <= 0)
+			continue;
+		if ((bytesRead = read(master, buffer, sizeof(buffer))) <= 0)
+			continue;
+
+		// one response per received telegram
+		for (ssize_t idx = 0; idx < bytesRead; idx++)
+		{
+			if ((buffer[idx] == ETB) && (write(master, response->c_str(), response->size()) != (ssize_t)response->size()))
+				return;
+		}
+	}
+}
+
+
+/**
+******************************************************************************
+* ReceiveSerial - read one response from the serial interface
+******************************************************************************
+*/
+static unsigned long ReceiveSerial(AdcSerial &serial, bool bytewise)
+{
+	char			buffer[256];
+	unsigned long	size = 0;
+	unsigned long	numRd;
+
+	while (size < sizeof(buffer))
+	{
+		if (bytewise)
+			numRd = serial.Read(&buffer[size], 1);
+		else
+			numRd = serial.ReadAvailable(&buffer[size], sizeof(buffer) - size, 1000);
+		if (numRd == 0)
+			return 0;
+
+		size += numRd;
+		if (buffer[size - 1] == ETB)
+			return size;
+	}
+
+	return 0;
+}
+
+
+/**
+******************************************************************************
+* BenchSerial - RW round trips per second through AdcSerial and a pty pair
+******************************************************************************
+*/
+void BenchSerial(unsigned long iterations)
+{
+	RbsTelegram		telegram;
+	string			request;
+	string			response;
+	atomic<bool>	run(true);
+	int				master;
+	chrono::steady_clock::time_point start;
+
+	if (((master = posix_openpt(O_RDWR | O_NOCTTY)) < 0) || (grantpt(master) != 0) || (unlockpt(master) != 0))
+	{
+		cout << "  can't create pty" << endl;
+		return;
+	}
+
+	AdcSerial serial(ptsname(master));
+	if (!serial.Open())
+	{
+		cout << "  can't open " << ptsname(master) << endl;
+		close(master);
+		return;
+	}
+
+	telegram.Begin(42, 0, "RW");
+	telegram.AddReferenceData("rr", "");
+	telegram.End(true);
+	request = telegram.GetData();
+
+	telegram.Begin(42, 0, "RW");
+	telegram.AddReferenceData("lcs", "1234");
+	telegram.AddReferenceData("stat", "0");
+	telegram.AddReferenceData("tare", string("0") + ESC + "0" + ESC + "3" + ESC + "1");
+	telegram.AddReferenceData("wt", string("-12345") + ESC + "3" + ESC + "1");
+	telegram.End(true);
+	response = telegram.GetData();
+
+	thread responder(SerialResponder, master, &response, &run);
+
+	const char *names[] = { "RW byte reads", "RW buffered reads" };
+	for (int mode = 0; mode < 2; mode++)
+	{
+		unsigned long count = 0;
+
+		start = chrono::steady_clock::now();
+		for (unsigned long idx = 0; idx < iterations; idx++)
+		{
+			if (serial.Write((void *)request.c_str(), request.size()) != request.size())
+				break;
+			if (ReceiveSerial(serial, mode == 0) != response.size())
+				break;
+			count++;
+		}
+		PrintResult(names[mode], count, Seconds(start), "round trips");
+
+		if (count != iterations)
+			cout << "  " << iterations - count << " round trips failed" << endl;
+	}
+
+	run = false;
+	responder.join();
+	serial.Close();
+	close(master);
+}
+
+
+/**
+******************************************************************************
+* BenchTrace - trace calls per second at TRC_INFO with 1 and 4 threads
+******************************************************************************
+*/
+void BenchTrace(unsigned long iterations)
+{
+	RbsTelegram		telegram;
+	string			fileName = "adcbench_trace.log";
+	chrono::steady_clock::time_point start;
+
+	telegram.Begin(42, 0, "RW");
+	telegram.AddReferenceData("lcs", "1234");
+	telegram.AddReferenceData("wt", string("-12345") + ESC + "3" + ESC + "1");
+	telegram.End(true);
+	const char *data = telegram.GetData();
+
+	g_adcTrace.SetConfig(fileName.c_str(), AdcTrace::TRC_INFO);
+
+	for (int threads = 1; threads <= 4; threads *= 4)
+	{
+		stringstream	name;
+		thread			worker[4];
+		atomic<unsigned long> traced(0);
+
+		start = chrono::steady_clock::now();
+		for (int idx = 0; idx < threads; idx++)
+		{
+			worker[idx] = thread([&]()
+			{
+				unsigned long count = 0;
+
+				// a full queue drops the message, Trace returns 0
+				for (unsigned long call = 0; call < iterations; call++)
+				{
+					if (g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tAPPL -> ADC: %s", "ExecuteRequest", data))
+						count++;
+				}
+				traced += count;
+			});
+		}
+		for (int idx = 0; idx < threads; idx++)
+			worker[idx].join();
+		name << "Trace (" << threads << " thread" << (threads > 1 ? "s)" : ")");
+		PrintResult(name.str().c_str(), iterations * threads, Seconds(start), "calls");
+		cout << "  " << traced.load() << " traced, " << iterations * threads - traced.load() << " dropped" << endl;
+
+		g_adcTrace.Flush();
+	}
+
+	// the remaining messages are written before the trace is switched off
+	start = chrono::steady_clock::now();
+	g_adcTrace.SetConfig(NULL, AdcTrace::TRC_OFF);
+	cout << "  flush " << fixed << setprecision(1) << Seconds(start) * 1000 << " ms" << endl;
+
+	remove(fileName.c_str());
+	remove("adcbench_trace.bak");
+}
+
+
+/**
+******************************************************************************
+* BootLoaderSim - adc in bootloader mode behind a link with fixed latency,
+*                 flashes one FRM block after the other
+******************************************************************************
+*/
+class BootLoaderSim : public AdcInterface
+{
+public:
+	BootLoaderSim(unsigned long linkTime, unsigned long flashTime, unsigned long baseAddress, unsigned long size)
+	{
+		m_linkTime = chrono::microseconds(linkTime);
+		m_flashTime = chrono::microseconds(flashTime);
+		m_busyUntil = chrono::steady_clock::now();
+		m_baseAddress = baseAddress;
+		m_flash.assign(size, 0xFF);
+		m_blocks = 0;
+		m_useCRC16 = true;
+	}
+
+	bool Open(string &adcName) { return true; }
+	bool Open() { return true; }
+	bool Close() { return true; }
+	bool Reconnect() { return true; }
+
+	unsigned long Write(void *pData, unsigned long size)
+	{
+		RbsResponse		request;
+		RbsTelegram		telegram;
+		const RbsField	*field;
+		short			orderID = 0;
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+		if ((request.Parse((const char *)pData, size) != 0) || ((field = request.GetHeader(RbsResponse::IDX_ORDERID)) == NULL) || !field->GetShort(&orderID))
+			return size;
+
+		// the device works on one telegram after the other
+		if (m_busyUntil < now + m_linkTime)
+			m_busyUntil = now + m_linkTime;
+		if ((field = request.Find("data")) != NULL)
+		{
+			WriteFlash(*field);
+			m_busyUntil += m_flashTime;
+			m_blocks++;
+		}
+
+		telegram.Begin(orderID, 0, request.GetCmd().ToString());
+		telegram.AddReferenceData("stat", "0");
+		telegram.End(true);
+		m_responses.push_back(make_pair(m_busyUntil + m_linkTime, string(telegram.GetData(), telegram.GetSize())));
+
+		return size;
+	}
+
+	unsigned long Read(void *pData, unsigned long size)
+	{
+		return ReadAvailable(pData, size, 0);
+	}
+
+	unsigned long ReadAvailable(void *pData, unsigned long size, unsigned long timeout)
+	{
+		unsigned long	count;
+
+		if (m_responses.empty() || (m_responses.front().first > chrono::steady_clock::now() + chrono::milliseconds(timeout)))
+		{
+			this_thread::sleep_for(chrono::milliseconds(timeout));
+			return 0;
+		}
+
+		this_thread::sleep_until(m_responses.front().first);
+
+		string &response = m_responses.front().second;
+		count = (response.size() < size) ? response.size() : size;
+		memcpy(pData, response.data(), count);
+		response.erase(0, count);
+		if (response.empty())
+			m_responses.pop_front();
+
+		return count;
+	}
+
+	const vector<unsigned char> &GetFlash() const { return m_flash; }
+	unsigned long GetBlocks() const { return m_blocks; }
+
+private:
+	// data: start address ESC length ESC hex data
+	void WriteFlash(const RbsField &data)
+	{
+		long long		address;
+		long long		len;
+		RbsField		hex = data.Position(2);
+		unsigned int	value;
+
+		if (!data.Position(0).GetLongLong(&address) || !data.Position(1).GetLongLong(&len) || (hex.size != (unsigned long)len * 2))
+			return;
+
+		for (long long idx = 0; idx < len; idx++)
+		{
+			if ((sscanf(&hex.data[idx * 2], "%2x", &value) == 1) && ((unsigned long)address + idx - m_baseAddress < m_flash.size()))
+				m_flash[(unsigned long)address + idx - m_baseAddress] = (unsigned char)value;
+		}
+	}
+
+	chrono::microseconds	m_linkTime;
+	chrono::microseconds	m_flashTime;
+	chrono::steady_clock::time_point m_busyUntil;
+	deque<pair<chrono::steady_clock::time_point, string>> m_responses;
+	unsigned long			m_baseAddress;
+	vector<unsigned char>	m_flash;
+	unsigned long			m_blocks;
+};
+
+
+/**
+******************************************************************************
+* WriteEncryptedFile - write a hex encoded AES-GCM file like the build does
+******************************************************************************
+*/
+static bool WriteEncryptedFile(const string &fileName, const string &plainText)
+{
+	Crypto		crypto;
+	string		cipherText;
+	FILE		*file;
+
+	if ((crypto.EncryptAES_GCM(plainText, cipherText) != Crypto::E_SUCCESS) || ((file = fopen(fileName.c_str(), "w")) == NULL))
+		return false;
+
+	for (size_t idx = 0; idx < cipherText.size(); idx++)
+		fprintf(file, "%02X", (unsigned char)cipherText[idx]);
+
+	return fclose(file) == 0;
+}
+
+
+/**
+******************************************************************************
+* CreateFirmwareFile - write an encrypted s-record file like the build does
+******************************************************************************
+*/
+static bool CreateFirmwareFile(const string &fileName, const string &header, unsigned long baseAddress, const vector<unsigned char> &image)
+{
+	string		plainText;
+	char		line[128];
+	unsigned long	checksum;
+	unsigned long	len;
+
+	// S0 with the zero terminated header
+	len = header.size() + 1 + 3;
+	checksum = len;
+	plainText += "S0" + string(line, snprintf(line, sizeof(line), "%02X0000", (unsigned int)len));
+	for (size_t idx = 0; idx <= header.size(); idx++)
+	{
+		plainText += string(line, snprintf(line, sizeof(line), "%02X", (unsigned char)header.c_str()[idx]));
+		checksum += (unsigned char)header.c_str()[idx];
+	}
+	plainText += string(line, snprintf(line, sizeof(line), "%02X\r\n", (unsigned int)(~checksum & 0xFF)));
+
+	// S3 with 32 data bytes, erased areas are not in the file
+	for (unsigned long pos = 0; pos < image.size(); pos += 32)
+	{
+		unsigned long address = baseAddress + pos;
+
+		len = (image.size() - pos < 32) ? image.size() - pos : 32;
+		if (count(image.begin() + pos, image.begin() + pos + len, 0xFF) == (long)len)
+			continue;
+
+		checksum = (len + 5) + (address >> 24) + ((address >> 16) & 0xFF) + ((address >> 8) & 0xFF) + (address & 0xFF);
+		plainText += string(line, snprintf(line, sizeof(line), "S3%02X%08lX", (unsigned int)(len + 5), address));
+		for (unsigned long idx = 0; idx < len; idx++)
+		{
+			plainText += string(line, snprintf(line, sizeof(line), "%02X", image[pos + idx]));
+			checksum += image[pos + idx];
+		}
+		plainText += string(line, snprintf(line, sizeof(line), "%02X\r\n", (unsigned int)(~checksum & 0xFF)));
+	}
+	plainText += "S70500000000FA\r\n";
+
+	return WriteEncryptedFile(fileName, plainText);
+}
+
+
+/**
+******************************************************************************
+* BenchUpdate - firmware download with 1 ms link latency and 200 us flash
+*               time per block, the image is <iterations> KB
+******************************************************************************
+*/
+void BenchUpdate(unsigned long iterations)
+{
+	const unsigned long		baseAddress = 0x00010000;
+	vector<unsigned char>	image(iterations * 1024);
+	char					directory[] = "/tmp/adcbenchXXXXXX";
+	string					fileName;
+	chrono::steady_clock::time_point start;
+
+	// pseudo random code with an erased gap of 4 KB every 64 KB
+	for (unsigned long pos = 0; pos < image.size(); pos++)
+		image[pos] = ((pos % 0x10000) >= 0xF000) ? 0xFF : (unsigned char)((pos * 2654435761UL) >> 13);
+
+	if (mkdtemp(directory) == NULL)
+	{
+		cout << "  can't create temp directory" << endl;
+		return;
+	}
+	fileName = string(directory) + "/ADC505.baf";
+	if (!CreateFirmwareFile(fileName, "ADC505_1.44.0001_2.10_1.0", baseAddress, image))
+	{
+		cout << "  can't create " << fileName << endl;
+		rmdir(directory);
+		return;
+	}
+
+	for (short window = 1; window <= AdcFirmware::FRM_MAX_WINDOW; window *= (window == 1) ? 4 : 2)
+	{
+		BootLoaderSim	bootLoader(1000, 200, baseAddress, image.size());
+		AdcRbs			protocol(&bootLoader);
+		AdcFirmware		firmware;
+		unsigned long	progressCalls = 0;
+		short			errorCode;
+		double			openTime;
+		double			downloadTime;
+		stringstream	name;
+
+		start = chrono::steady_clock::now();
+		errorCode = firmware.Open(directory, "ADC505");
+		openTime = Seconds(start);
+		if (errorCode != 0)
+		{
+			cout << "  open error " << errorCode << endl;
+			break;
+		}
+
+		start = chrono::steady_clock::now();
+		errorCode = firmware.Download(&protocol, 1, window, 1.10, [&](unsigned long written, unsigned long total) { progressCalls++; });
+		downloadTime = Seconds(start);
+
+		name << "window " << window;
+		cout << "  " << left << setw(32) << name.str() << right << setw(14) << fixed << setprecision(1) << image.size() / 1024.0 / downloadTime << " KB/s"
+			 << "  open " << setprecision(1) << openTime * 1000 << " ms, " << bootLoader.GetBlocks() << " blocks, " << progressCalls << " progress calls" << endl;
+
+		if ((errorCode != 0) || (bootLoader.GetFlash() != image))
+			cout << "  download failed, error " << errorCode << (bootLoader.GetFlash() != image ? ", flash differs" : "") << endl;
+	}
+
+	remove(fileName.c_str());
+	rmdir(directory);
+}
+
+
+/**
+******************************************************************************
+* OpenBenchAdc - open the adc of the end-to-end benchmarks
+******************************************************************************
+*/
+static bool OpenBenchAdc(short *handle)
+{
+	short retCode;
+
+	if ((retCode = AdcOpen("adcbench", "rbs", g_port.c_str(), handle, 0)) != ADC_SUCCESS)
+	{
+		cout << "  can't open " << g_port << ", error " << retCode << endl;
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* BenchWeight - AdcReadWeight calls per second and latency, 1 .. 8 threads
+*               share one adc
+******************************************************************************
+*/
+void BenchWeight(unsigned long iterations)
+{
+	short	handle;
+
+	if (!OpenBenchAdc(&handle))
+		return;
+
+	for (unsigned long threads = 1; threads <= 8; threads *= 2)
+	{
+		vector<vector<double>>	samples(threads);
+		vector<thread>			workers;
+		vector<double>			latency;
+		atomic<unsigned long>	errors(0);
+		stringstream			name;
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		for (unsigned long worker = 0; worker < threads; worker++)
+		{
+			workers.push_back(thread([&, worker]()
+			{
+				AdcState		adcState;
+				AdcWeight		weight;
+				AdcTare			tare;
+
+				samples[worker].reserve(iterations / threads);
+				for (unsigned long idx = 0; idx < iterations / threads; idx++)
+				{
+					chrono::steady_clock::time_point call = chrono::steady_clock::now();
+
+					if (AdcReadWeight(handle, 0, &adcState, &weight, &tare, NULL, NULL) != ADC_SUCCESS)
+						errors++;
+					samples[worker].push_back(Microseconds(call));
+				}
+			}));
+		}
+		for (size_t idx = 0; idx < workers.size(); idx++)
+			workers[idx].join();
+
+		for (size_t idx = 0; idx < samples.size(); idx++)
+			latency.insert(latency.end(), samples[idx].begin(), samples[idx].end());
+
+		name << threads << (threads == 1 ? " thread" : " threads");
+		PrintResult(name.str().c_str(), latency.size(), Seconds(start), "weights");
+		PrintLatency(name.str(), latency);
+		if (errors)
+			cout << "  " << errors << " calls failed" << endl;
+	}
+
+	AdcClose(handle);
+}
+
+
+/**
+******************************************************************************
+* BenchOpen - the first AdcOpen of the process (cold), the following
+*             AdcOpen after AdcClose (warm) and AdcOpen with the device
+*             profile of the first open of a profile directory
+******************************************************************************
+*/
+void BenchOpen(unsigned long iterations)
+{
+	short			handle;
+	vector<double>	cold;
+	vector<double>	warm;
+	vector<double>	profile;
+	char			directory[] = "/tmp/adcbenchXXXXXX";
+	DIR				*dir;
+	struct dirent	*entry;
+	chrono::steady_clock::time_point start;
+
+	for (unsigned long idx = 0; idx <= iterations; idx++)
+	{
+		start = chrono::steady_clock::now();
+		if (!OpenBenchAdc(&handle))
+			return;
+		(idx == 0 ? cold : warm).push_back(Microseconds(start));
+		AdcClose(handle);
+	}
+
+	PrintLatency("AdcOpen cold", cold);
+	PrintLatency("AdcOpen warm", warm);
+
+	if (mkdtemp(directory) == NULL)
+	{
+		cout << "  can't create temp directory" << endl;
+		return;
+	}
+	AdcSetProfilePath(directory);
+
+	// the first open writes the profile
+	for (unsigned long idx = 0; idx <= iterations; idx++)
+	{
+		start = chrono::steady_clock::now();
+		if (!OpenBenchAdc(&handle))
+			break;
+		if (idx)
+			profile.push_back(Microseconds(start));
+		AdcClose(handle);
+	}
+
+	AdcSetProfilePath(NULL);
+	PrintLatency("AdcOpen profile", profile);
+
+	if ((dir = opendir(directory)) != NULL)
+	{
+		while ((entry = readdir(dir)) != NULL)
+		{
+			if (entry->d_name[0] != '.')
+				remove((string(directory) + "/" + entry->d_name).c_str());
+		}
+		closedir(dir);
+	}
+	rmdir(directory);
+}
+
+
+/**
+******************************************************************************
+* CreateSettingsFiles - country settings DE with the load capacity 15kg in the
+*                       values of the simulated adc
+******************************************************************************
+*/
+static bool CreateSettingsFiles(const string &directory)
+{
+	const char *countrySettings[] = { "0", "0", "0", "0", "98100", "DE", "Max {wx}/{w0} {ux}",
+																		   "Min {wm} {um}", "e={t0}/{t1} {ut}", "0" };
+	const char *loadCapacity[] = { "15000", "9", "3", "2", "6000", "15000", "2", "5", "0", "-20", "20",
+																	 "-2", "2", "6000", "6000", "1", "150502", "40", "0", "0", "20", "0",
+																	 "0", "0", "0", "0", "0", "0", "0", "0", "0", "0" };
+	string countryFile = "[country settings DE]\r\n";
+	string loadCapacityFile = "[load capacity 15kg]\r\n";
+
+	for (short idx = 0; (idx < AdcRbs::COUNTRY_SPECIFIC_STRINGS_COUNT) && (idx < (short)(sizeof(countrySettings) / sizeof(countrySettings[0]))); idx++)
+		countryFile += AdcRbs::COUNTRY_SPECIFIC_STRINGS[idx] + "=" + countrySettings[idx] + "\r\n";
+	countryFile += "[load capacities]\r\n15kg=loadcapacity_15kg.txt\r\n";
+
+	for (short idx = 0; (idx < AdcRbs::LOAD_CAPACITY_STRINGS_COUNT) && (idx < (short)(sizeof(loadCapacity) / sizeof(loadCapacity[0]))); idx++)
+		loadCapacityFile += AdcRbs::LOAD_CAPACITY_STRINGS[idx] + "=" + loadCapacity[idx] + "\r\n";
+
+	return WriteEncryptedFile(directory + "/countrysettings_DE.txt", countryFile) &&
+		   WriteEncryptedFile(directory + "/loadcapacity_15kg.txt", loadCapacityFile);
+}
+
+
+/**
+******************************************************************************
+* BenchSettings - push country and load capacity settings, the first call
+*                 reads the files, the others use the file cache
+******************************************************************************
+*/
+void BenchSettings(unsigned long iterations)
+{
+	short			handle;
+	short			retCode;
+	char			directory[] = "/tmp/adcbenchXXXXXX";
+	vector<double>	country[2];
+	vector<double>	loadCapacity[2];
+	unsigned long	errors = 0;
+	chrono::steady_clock::time_point start;
+
+	if ((mkdtemp(directory) == NULL) || !CreateSettingsFiles(directory))
+	{
+		cout << "  can't create the settings files" << endl;
+		return;
+	}
+
+	if (OpenBenchAdc(&handle))
+	{
+		AdcSetCountryFilesPath(handle, directory);
+
+		for (unsigned long idx = 0; idx <= iterations; idx++)
+		{
+			start = chrono::steady_clock::now();
+			if ((retCode = AdcSetCountry(handle, "DE")) != ADC_SUCCESS)
+				errors++;
+			country[idx ? 1 : 0].push_back(Microseconds(start));
+
+			start = chrono::steady_clock::now();
+			if ((retCode = AdcSetLoadCapacity(handle, "15kg")) != ADC_SUCCESS)
+				errors++;
+			loadCapacity[idx ? 1 : 0].push_back(Microseconds(start));
+		}
+
+		PrintLatency("AdcSetCountry first", country[0]);
+		PrintLatency("AdcSetCountry", country[1]);
+		PrintLatency("AdcSetLoadCapacity first", loadCapacity[0]);
+		PrintLatency("AdcSetLoadCapacity", loadCapacity[1]);
+		if (errors)
+			cout << "  " << errors << " calls failed, last error " << retCode << endl;
+
+		AdcClose(handle);
+	}
+
+	remove((string(directory) + "/countrysettings_DE.txt").c_str());
+	remove((string(directory) + "/loadcapacity_15kg.txt").c_str());
+	rmdir(directory);
+}
+
+
+/**
+******************************************************************************
+* BenchAdcUpdate - firmware update through AdcUpdateEx, the image is
+*                  <iterations> KB
+******************************************************************************
+*/
+void BenchAdcUpdate(unsigned long iterations)
+{
+	const unsigned long		baseAddress = 0x00010000;
+	vector<unsigned char>	image(iterations * 1024);
+	char					directory[] = "/tmp/adcbenchXXXXXX";
+	string					fileName;
+	short					handle;
+	short					retCode;
+	chrono::steady_clock::time_point start;
+
+	for (unsigned long pos = 0; pos < image.size(); pos++)
+		image[pos] = ((pos % 0x10000) >= 0xF000) ? 0xFF : (unsigned char)((pos * 2654435761UL) >> 13);
+
+	if (mkdtemp(directory) == NULL)
+	{
+		cout << "  can't create temp directory" << endl;
+		return;
+	}
+	fileName = string(directory) + "/ADC505.baf";
+	if (!CreateFirmwareFile(fileName, "ADC505_1.44.0001_2.10_1.0", baseAddress, image))
+	{
+		cout << "  can't create " << fileName << endl;
+		rmdir(directory);
+		return;
+	}
+
+	if (OpenBenchAdc(&handle))
+	{
+		AdcSetFirmwarePath(handle, directory);
+
+		start = chrono::steady_clock::now();
+		retCode = AdcUpdateEx(handle, 1, 0, NULL, NULL);
+		double seconds = Seconds(start);
+
+		if (retCode == ADC_SUCCESS)
+		{
+			cout << "  " << left << setw(32) << "AdcUpdateEx" << right << setw(14) << fixed << setprecision(1) << image.size() / 1024.0 / seconds
+				 << " KB/s  " << setprecision(0) << seconds * 1000 << " ms" << endl;
+			AddResult("AdcUpdateEx", image.size() / 1024.0 / seconds, "KB/s");
+			AddResult("AdcUpdateEx time", seconds * 1000, "ms");
+		}
+		else
+		{
+			cout << "  update failed, error " << retCode << endl;
+		}
+
+		AdcClose(handle);
+	}
+
+	remove(fileName.c_str());
+	rmdir(directory);
+}
+
+
+/**
+******************************************************************************
+* BenchLogger - read up to <iterations> log book entries with AdcGetLogger
+*               per entry and with AdcGetLoggerRange, with and without export
+******************************************************************************
+*/
+static void CountLoggerEntry(const short handle, const short index, const char *entry, const unsigned long size, void *ctx)
+{
+	(*(unsigned long *)ctx)++;
+}
+
+void BenchLogger(unsigned long iterations)
+{
+	char			entry[512];
+	char			arena[0x4000];
+	char			fileName[] = "/tmp/adcbenchXXXXXX";
+	unsigned long	size;
+	unsigned long	count;
+	short			handle;
+	short			retCode = ADC_SUCCESS;
+	short			entries = (short)min(iterations, 0x7FFFUL);
+	chrono::steady_clock::time_point start;
+	int				fd;
+
+	if (!OpenBenchAdc(&handle))
+		return;
+
+	start = chrono::steady_clock::now();
+	for (count = 0; count < (unsigned long)entries; count++)
+	{
+		size = sizeof(entry);
+		if ((retCode = AdcGetLogger(handle, (short)count, entry, &size)) != ADC_SUCCESS)
+			break;
+	}
+	if ((retCode == ADC_SUCCESS) || (retCode == ADC_E_LOGBOOK_NO_FURTHER_ENTRY))
+		PrintResult("AdcGetLogger", count, Seconds(start), "entries");
+	else
+		cout << "  AdcGetLogger failed, error " << retCode << endl;
+
+	count = 0;
+	start = chrono::steady_clock::now();
+	if ((retCode = AdcGetLoggerRange(handle, 0, entries, arena, sizeof(arena), CountLoggerEntry, &count, NULL)) == ADC_SUCCESS)
+		PrintResult("AdcGetLoggerRange", count, Seconds(start), "entries");
+	else
+		cout << "  AdcGetLoggerRange failed, error " << retCode << endl;
+
+	if ((fd = mkstemp(fileName)) >= 0)
+	{
+		close(fd);
+		count = 0;
+		start = chrono::steady_clock::now();
+		if ((retCode = AdcGetLoggerRange(handle, 0, entries, arena, sizeof(arena), CountLoggerEntry, &count, fileName)) == ADC_SUCCESS)
+			PrintResult("AdcGetLoggerRange export", count, Seconds(start), "entries");
+		else
+			cout << "  AdcGetLoggerRange export failed, error " << retCode << endl;
+		remove(fileName);
+	}
+
+	AdcClose(handle);
+}
+
+
+void Usage()
+{
+	cout << "usage: " << BIN_NAME << ".x <benchmark> [iterations] [-port <port>] [-json <file>]" << endl;
+	for (size_t idx = 0; idx < sizeof(benchTable) / sizeof(benchTable[0]); idx++)
+		cout << "  " << left << setw(12) << benchTable[idx].name << benchTable[idx].descr << endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+	bool			found = false;
+	unsigned long	iterations = 0;
+	string			jsonFile;
+	int				arg;
+
+	if (argc < 2)
+	{
+		cout << BIN_NAME << " - " << BIN_DESCR << " " << BIN_VERSION << endl;
+		Usage();
+		return 1;
+	}
+
+	for (arg = 2; arg < argc; arg++)
+	{
+		if (!strcmp(argv[arg], "-port") && (arg + 1 < argc))
+			g_port = argv[++arg];
+		else if (!strcmp(argv[arg], "-json") && (arg + 1 < argc))
+			jsonFile = argv[++arg];
+		else if (isdigit((unsigned char)argv[arg][0]))
+			iterations = strtoul(argv[arg], NULL, 10);
+		else
+		{
+			Usage();
+			return 1;
+		}
+	}
+
+	// the json output on stdout must not be mixed with the report
+	if (jsonFile == "-")
+		cout.setstate(ios::failbit);
+
+	cout << BIN_NAME << " - " << BIN_DESCR << " " << BIN_VERSION << endl;
+
+	for (size_t idx = 0; idx < sizeof(benchTable) / sizeof(benchTable[0]); idx++)
+	{
+		if (!strcmp(argv[1], benchTable[idx].name) || !strcmp(argv[1], "all"))
+		{
+			cout << benchTable[idx].name << ": " << benchTable[idx].descr << endl;
+			g_benchName = benchTable[idx].name;
+			benchTable[idx].pBenchFunction(iterations ? iterations : benchTable[idx].iterations);
+			found = true;
+		}
+	}
+
+	if (!found)
+	{
+		cout.clear();
+		Usage();
+		return 1;
+	}
+
+	if (!jsonFile.empty() && !WriteJson(jsonFile))
+	{
+		cerr << "can't write " << jsonFile << endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -9,6 +9,12 @@ make
 cd ../main
 make clean
 make
+cd ../benchmark
+make clean
+make
+cd ../frdecode
+make clean
+make
 
 export LD_LIBRARY_PATH=$LD_LIBRARY_PATH:../shared_library
 ./main/main
@@ -0,0 +1,138 @@
+// frdecode.cpp : decoder of the flight recorder dumps of the bizlars library
+//
+// usage: frdecode.x <dump file>
+//
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <time.h>
+#include "adctrace.h"
+#include "adcflightrecorder.h"
+using namespace std;
+
+//----------------------------------------------------------------------------
+// VersionInfo Tag
+//
+#define BIN_NAME          "frdecode"
+#define BIN_DESCR         "Bizerba ADC Flight Recorder Decoder"
+#define BIN_VERSION       "1.44.0001"
+
+
+/**
+******************************************************************************
+* GetDirection - text of the record direction
+******************************************************************************
+*/
+static const char *GetDirection(unsigned char direction)
+{
+	switch (direction)
+	{
+	case AdcFlightRecorder::DIR_REQUEST:	return "APPL -> ADC";
+	case AdcFlightRecorder::DIR_RESPONSE:	return "ADC -> APPL";
+	case AdcFlightRecorder::DIR_ERROR:		return "ERROR      ";
+	default:								return "?          ";
+	}
+}
+
+
+/**
+******************************************************************************
+* GetFrame - frame with readable control characters, like the trace file
+******************************************************************************
+*/
+static string GetFrame(const char *frame, unsigned long size)
+{
+	string	text;
+	char	hex[8];
+
+	for (unsigned long idx = 0; idx < size; idx++)
+	{
+		const char *name = AdcTrace::GetControlChar(frame[idx]);
+
+		if (name)
+		{
+			text.append(name);
+		}
+		else if ((unsigned char)frame[idx] < 0x20)
+		{
+			snprintf(hex, sizeof(hex), "<%02X>", (unsigned char)frame[idx]);
+			text.append(hex);
+		}
+		else
+		{
+			text.push_back(frame[idx]);
+		}
+	}
+
+	return text;
+}
+
+
+int main(int argc, char* argv[])
+{
+	ifstream			file;
+	FlightFileHeader	header;
+	FlightRecord		record;
+	vector<char>		frame;
+	char				timeStr[80];
+	time_t				dumpTime;
+
+	if (argc < 2)
+	{
+		cout << BIN_NAME << " - " << BIN_DESCR << " " << BIN_VERSION << endl;
+		cout << "usage: " << BIN_NAME << ".x <dump file>" << endl;
+		return 1;
+	}
+
+	file.open(argv[1], ios::binary);
+	if (!file.is_open())
+	{
+		cerr << "can't open " << argv[1] << endl;
+		return 1;
+	}
+
+	if (!file.read((char *)&header, sizeof(header)) || (header.magic != AdcFlightRecorder::FLIGHT_MAGIC))
+	{
+		cerr << argv[1] << " is no flight recorder dump" << endl;
+		return 1;
+	}
+	if (header.version != AdcFlightRecorder::FLIGHT_VERSION)
+	{
+		cerr << "unsupported version " << header.version << endl;
+		return 1;
+	}
+
+	dumpTime = (time_t)header.dumpTime;
+	strftime(timeStr, sizeof(timeStr), "%Y-%m-%d %H:%M:%S", localtime(&dumpTime));
+	cout << "dump " << timeStr << ", " << header.recordCount << " records, time in ms before the dump" << endl;
+
+	for (unsigned int idx = 0; idx < header.recordCount; idx++)
+	{
+		if (!file.read((char *)&record, sizeof(record)))
+		{
+			cerr << "dump truncated at record " << idx << endl;
+			return 1;
+		}
+
+		frame.resize(record.size);
+		if (record.size && !file.read(&frame[0], record.size))
+		{
+			cerr << "dump truncated at record " << idx << endl;
+			return 1;
+		}
+
+		cout << setw(12) << fixed << setprecision(3) << -(double)(header.dumpTimestamp - record.timestamp) / 1000000.0 << "   "
+			 << GetDirection(record.direction) << "   id " << setw(5);
+		if (record.orderID >= 0)
+			cout << record.orderID;
+		else
+			cout << "-";
+		cout << "   err " << setw(4) << record.errorCode << "   " << GetFrame(frame.data(), record.size) << endl;
+	}
+
+	return 0;
+}
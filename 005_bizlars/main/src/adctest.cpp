@@ -133,6 +133,9 @@ void DoZeroScale();
 void DoHandleTare();
 void DoResetAdc();
 void DoReadWeight();
+void DoWeightStream();
+void DoFlightRecorder();
+void DoStatistics();
 void DoGetLogger();
 void DoMakeAuthentication();
 void DoGetHighResolution();
@@ -151,7 +154,7 @@ char *GetTareType(AdcTareType tareType);
 char *GetWeightUnit(AdcWeightUnit weightUnit);
 char *GetScaleMode(AdcScaleMode scaleMode);
 char *GetOperatingMode(AdcOperatingMode opMode);
-short Update(const short force = 0);
+short Update(const short force = 0, const short window = 0);
 short SetOperatingMode(AdcOperatingMode mode);
 short GetOperatingMode(AdcOperatingMode *mode);
 void PrintAdcState(AdcState adcState, int mode = 0, bool autoAuthentication = false, string *adcStateOut = NULL);
@@ -211,11 +214,14 @@ MENUTABLE tMenu[] = {
 	{ 'k', (char *)"GetGrossWeight     ", DoGetGrossWeight },
     { 'l', (char *)"SetCountryFilesPath", DoSetCountryFilesPath },
     { 'm', (char *)"MakeAuthentication ", DoMakeAuthentication },
+	{ 'n', (char *)"Statistics         ", DoStatistics },
 	{ 'p', (char *)"Trace              ", DoTraceAdc },
     { 'r', (char *)"Reset              ", DoResetAdc },
     { 's', (char *)"SetScaleValues     ", DoSetScaleValues },
     { 't', (char *)"Tare               ", DoHandleTare },
 	{ 'u', (char *)"Tests              ", DoMakeTests },
+	{ 'v', (char *)"FlightRecorder     ", DoFlightRecorder },
+	{ 'w', (char *)"WeightStream       ", DoWeightStream },
     { 'z', (char *)"ZeroScale          ", DoZeroScale },
 	{ 'x', (char *)"Quit			   ", DoQuitAdc },
 	{ 0, 0, 0 }                         // end of menu entries
@@ -1849,6 +1855,135 @@ void DoReadWeight(void)
 }
 
 
+/**
+******************************************************************************
+* WeightStreamCallback - print the weight if it has changed
+*
+* @param
+* @return
+* @remarks	called by the stream thread of the library
+******************************************************************************
+*/
+static void WeightStreamCallback(const short handle, const short retCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare, void *ctx)
+{
+	AdcWeight	*lastWeight = (AdcWeight *)ctx;
+	string		valueString;
+
+	if (PrintErrorCode(retCode, 0) || (lastWeight->value == weight->value))
+		return;
+
+	*lastWeight = *weight;
+
+	FormatValue(weight->value, weight->decimalPlaces, &valueString);
+	cout << "Weight:  " << valueString << " " << GetWeightUnit(weight->weightUnit);
+
+	if ((tare->type != ADC_TARE_NO) && (tare->value.value != 0))
+	{
+		FormatValue(tare->value.value, tare->value.decimalPlaces, &valueString);
+		cout << "  Tare:  " << valueString << " " << GetWeightUnit(tare->value.weightUnit);
+	}
+
+	cout << "\t";
+	PrintAdcState(*adcState, MODE_READ_WEIGHT);
+	cout << endl;
+}
+
+
+/**
+******************************************************************************
+* DoWeightStream - read weight with the weight stream until a key is pressed
+*
+* @param
+* @return
+* @remarks
+******************************************************************************
+*/
+void DoWeightStream(void)
+{
+	AdcWeight		lastWeight;
+	unsigned long	interval;
+
+	interval = (unsigned long)GetNumeric((char *)"Interval [ms]: ");
+	lastWeight.value = -1;
+
+	if (PrintErrorCode(AdcStartWeightStream(g_adcHandle, interval, WeightStreamCallback, &lastWeight), 0))
+		return;
+
+	while (!_kbhit())
+		Sleep(100);
+	_getch();
+
+	PrintErrorCode(AdcStopWeightStream(g_adcHandle, WeightStreamCallback, &lastWeight), 0);
+}
+
+
+/**
+******************************************************************************
+* DoFlightRecorder - dump the last telegrams or set the automatic dump
+*
+* @param
+* @return
+* @remarks	decode the dump with frdecode.x
+******************************************************************************
+*/
+void DoFlightRecorder(void)
+{
+	char *pStrPointer = NULL;
+	short mode = (short)GetNumeric((char *)"Flight recorder [0: dump   1: dump on protocol errors   2: no automatic dump]: ");
+
+	if (mode != 2)
+		pStrPointer = GetString((char *)"Dump filename + path", 255);
+
+	if (mode == 0)
+		PrintErrorCode(AdcDumpFlightRecorder(g_adcHandle, pStrPointer), 1);
+	else
+		PrintErrorCode(AdcSetFlightRecorderAutoDump(g_adcHandle, pStrPointer), 1);
+}
+
+
+/**
+******************************************************************************
+* DoStatistics - show, reset or write the statistics of the rbs commands
+*
+* @param
+* @return
+* @remarks	latencies in us
+******************************************************************************
+*/
+void DoStatistics(void)
+{
+	AdcCommandStatistics	statistics[64];
+	short					count = 64;
+	char					*pStrPointer;
+	short mode = (short)GetNumeric((char *)"Statistics [0: show   1: reset   2: write Prometheus file]: ");
+
+	if (mode == 1)
+	{
+		PrintErrorCode(AdcResetStatistics(g_adcHandle), 1);
+		return;
+	}
+
+	if (mode == 2)
+	{
+		pStrPointer = GetString((char *)"Filename + path", 255);
+		PrintErrorCode(AdcWriteStatistics(g_adcHandle, pStrPointer), 1);
+		return;
+	}
+
+	if (PrintErrorCode(AdcGetStatistics(g_adcHandle, statistics, &count), 0))
+		return;
+
+	printf("\ncmd   requests retries timeouts crc  protocol failures  round trip p50/p99/max  first byte p50  write p50\n");
+	for (short idx = 0; idx < count; idx++)
+	{
+		printf("%-5s %8lu %7lu %8lu %4lu %8lu %8lu  %8lu/%8lu/%8lu  %14lu  %9lu\n", statistics[idx].cmd,
+			statistics[idx].requests, statistics[idx].retries, statistics[idx].timeouts, statistics[idx].crcErrors,
+			statistics[idx].protocolErrors, statistics[idx].failures, statistics[idx].roundTrip.p50, statistics[idx].roundTrip.p99,
+			statistics[idx].roundTrip.max, statistics[idx].firstByte.p50, statistics[idx].writeTime.p50);
+	}
+}
+
+
 /**
 ******************************************************************************
 * DoGetLogger - get logger
@@ -4040,19 +4175,39 @@ void DoUpdate(void)
 	short	errorCode;
 	string	dir;
 	short	force;
+	short	window;
 
 	dir = GetString((char *)"Enter firmware directory: ", 255);
 
 	force = (short)GetNumeric((char *)"Force [0: no   1: yes]: ");
 
+	window = (short)GetNumeric((char *)"Window [0: one block   1..8]: ");
+
 	errorCode = AdcSetFirmwarePath(g_adcHandle, dir.c_str());
 	if (!PrintErrorCode(errorCode, 0))
 	{
 		// do Update
-		Update(force);
+		Update(force, window);
 	}
 }
 
+
+/**
+******************************************************************************
+* UpdateProgressCallback - print the progress of the firmware download
+*
+* @param
+* @return
+* @remarks	called in the context of AdcUpdateEx
+******************************************************************************
+*/
+static void UpdateProgressCallback(const short handle, const unsigned long written, const unsigned long total, void *ctx)
+{
+	cout << "\rFirmware: " << (total ? (written * 100) / total : 100) << " % (" << written << " / " << total << " bytes)" << flush;
+	if (written == total)
+		cout << endl;
+}
+
 /**
 ******************************************************************************
 * Update - make a firmware update
@@ -4062,7 +4217,7 @@ void DoUpdate(void)
 * @remarks
 ******************************************************************************
 */
-short Update(const short force)
+short Update(const short force, const short window)
 {
 	short	errorCode;
 
@@ -4075,7 +4230,7 @@ short Update(const short force)
 		if (!PrintErrorCode(errorCode, 0))
 		{
 			// update adc
-			errorCode = AdcUpdate(g_adcHandle, force);
+			errorCode = AdcUpdateEx(g_adcHandle, force, window, UpdateProgressCallback, NULL);
 			PrintErrorCode(errorCode, 0);
 		}
 	}
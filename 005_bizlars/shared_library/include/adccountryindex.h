@@ -0,0 +1,76 @@
+/**
+******************************************************************************
+* File       : adccountryindex.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adccountryindex class: index of the country settings files of
+*              a directory with their compatible load capacities
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+using namespace std;
+
+class AdcCountryIndex
+{
+public:
+	typedef map<string, string> LoadCapacities;		// load capacity -> file
+
+	AdcCountryIndex();
+	~AdcCountryIndex();
+
+	void			GetCountries(const string &path, vector<string> &countries);
+	short			GetLoadCapacities(const string &path, const string &country, LoadCapacities &loadCapacities);
+
+	static const string	INDEX_FILE;
+
+private:
+	static const string	FILE_PATTERN;
+	static const string	INDEX_HEADER;
+
+	typedef struct
+	{
+		string			country;			// iso code from the file name
+		long long		modified;			// modification time in ns
+		long long		size;
+		unsigned long long	hash;			// fnv-1a of the encrypted file
+		short			errorCode;			// result of the decryption
+		LoadCapacities	loadCapacities;
+	} Entry;
+
+	typedef struct
+	{
+		map<string, Entry>	files;			// country settings files by name
+		long long		modified;			// modification time of the directory
+		int				watch;				// inotify watch, -1: check with stat
+		bool			rescan;				// directory must be read again
+		set<string>		changed;			// files reported by inotify
+	} Directory;
+
+	Directory		&GetDirectory(const string &path);
+	bool			Validate(const string &path, Directory &directory);
+	bool			UpdateFile(const string &path, const string &fileName, Directory &directory);
+	void			ReadEvents();
+	bool			Load(const string &path, Directory &directory);
+	void			Save(const string &path, Directory &directory);
+
+	static string	GetFilePath(const string &path, const string &fileName);
+	static bool		GetCountry(const string &fileName, string &country);
+	static void		ListFiles(const string &path, vector<string> &fileNames);
+	static bool		GetFileState(const string &fileName, long long *modified, long long *size);
+	static bool		GetHash(const string &fileName, unsigned long long *hash);
+
+	mutex			m_mutex;
+	map<string, Directory>	m_directories;
+	int				m_inotify;				// -1: no inotify
+	map<int, string>		m_watches;		// watch -> path
+};
+
+extern AdcCountryIndex g_adcCountryIndex;
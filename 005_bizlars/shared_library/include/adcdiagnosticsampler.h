@@ -0,0 +1,51 @@
+/**
+******************************************************************************
+* File       : adcdiagnosticsampler.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcdiagnosticsampler class: read the diagnostic data
+*              periodically and keep the latest snapshot
+******************************************************************************
+*/
+#pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "bizlars.h"
+using namespace std;
+
+class Lars;
+
+class AdcDiagnosticSampler
+{
+public:
+	static const unsigned long	MIN_INTERVAL = 100;				// min. sample interval in ms
+
+	AdcDiagnosticSampler(Lars *lars);
+	~AdcDiagnosticSampler();
+
+	short			Start(unsigned long interval);
+	void			Stop();
+	short			GetSample(AdcSensorHealth *sensorHealth, short *count, unsigned long *age);
+
+private:
+	void			SamplerThread();
+
+	Lars					*m_lars;
+	AdcSensorHealth			m_snapshot[DIA_MAX_SENSOR_HEALTH];	// latest successful sample
+	short					m_count;			// records in m_snapshot
+	short					m_errorCode;		// result of the latest sample
+	bool					m_sampled;			// at least one sample since Start
+	chrono::steady_clock::time_point m_sampleTime;	// time of m_snapshot
+	AdcSensorHealth			m_sample[DIA_MAX_SENSOR_HEALTH];	// sample in work, only used by the sampler thread
+	unsigned long			m_interval;
+	chrono::steady_clock::time_point m_next;	// time of the next sample
+	bool					m_run;
+	thread					m_thread;
+	mutex					m_mutex;			// protects all members but m_sample
+	condition_variable		m_cond;
+};
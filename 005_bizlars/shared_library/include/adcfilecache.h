@@ -0,0 +1,66 @@
+/**
+******************************************************************************
+* File       : adcfilecache.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcfilecache class: decrypted and split settings files, shared
+*              by all adc of the process
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+using namespace std;
+
+class AdcFileCache
+{
+public:
+	// one line of a settings file
+	typedef struct
+	{
+		string		key;					// text before '=', whole line without '='
+		string		value;					// text after '='
+		bool		keyValue;				// line contains '='
+	} Row;
+
+	typedef vector<Row> Content;
+
+	// reads fileName and fills content, the default loader decrypts the file
+	typedef function<short(const string &fileName, Content &content)> Loader;
+
+	AdcFileCache();
+	~AdcFileCache();
+
+	short			Read(const string &fileName, shared_ptr<const Content> &content);
+	short			Read(const string &fileName, shared_ptr<const Content> &content, const Loader &loader);
+	void			Clear();
+
+	static short	LoadEncryptedFile(const string &fileName, Content &content);
+
+private:
+	static const size_t	MAX_ENTRIES = 64;
+
+	typedef struct
+	{
+		long long		modified;			// modification time in ns
+		long long		size;
+		unsigned long long	inode;
+		unsigned long	lastUse;
+		shared_ptr<const Content> content;
+	} Entry;
+
+	static bool		GetFileState(const string &fileName, Entry &entry);
+
+	mutex			m_mutex;
+	map<string, Entry>	m_entries;
+	unsigned long	m_useCounter;
+};
+
+extern AdcFileCache g_adcFileCache;
@@ -11,38 +11,64 @@
 */
 #pragma once
 #include <string>
-#include <list>
+#include <functional>
 #include "adcprotocol.h"
 using namespace std;
 
 class AdcFirmware
 {
-	typedef enum
-	{
-		PARSE_ALL = 0,          // parse complete SRecord file
-		PARSE_S0RECORD,			// parse only S0 record
-	}ParseSetting;
-
 public:
+	// written: bytes of the image up to the last sent block, total: size of the image
+	typedef function<void(unsigned long written, unsigned long total)> ProgressCallback;
+
 	AdcFirmware();
     ~AdcFirmware();
 
+	short Open(const string &directory, const string &type);
 	short LoadFile(const string &directory, const string &type);
-	bool  GetData(unsigned long pos, AdcFrmData *frmData);
+	bool  GetData(unsigned long pos, AdcFrmData *frmData) const;
+	short Download(AdcProtocol *protocol, const short force, short window, double bootLoaderVersion, const ProgressCallback &progress) const;
 	short GetVersion(const string &directory, const string &type, string &version);
 	string GetUsbStackVersion();
 	string GetWelmecStructureVersion();
+	unsigned long GetSize() const;
+
+	static const short FRM_BLOCK_SIZE = 256;
+	static const short FRM_MAX_WINDOW = 8;			// max. number of FRM telegrams without response
 
 private:
-	short ParseSRecord(string &content, list<pair<unsigned long, string>> *contentList, ParseSetting parse);
+	typedef function<short(unsigned long address, const unsigned char *data, unsigned long len)> RecordSink;
+	typedef function<short(const AdcFrmData &frmData)> BlockSink;
+
+	// state of the s-record parser between two decrypted chunks
+	typedef struct
+	{
+		string			record;				// current s-record, may be incomplete
+		string			header;				// text of the last S0 record
+		unsigned long	minAddress;			// S3 records since the last S0 record
+		unsigned long	maxAddress;
+		unsigned long	endMinAddress;		// addresses at the end record
+		unsigned long	endMaxAddress;
+		unsigned long	lastEnd;			// end of the previous S3 record
+		unsigned long	dataRecords;
+		bool			ordered;			// S3 records ascending without overlap
+		short			errorCode;
+	} ParseState;
+
+	short Scan(const string &directory, const string &type);
+	short LoadImage();
+	short ForEachBlock(const BlockSink &sink) const;
+	void  InitParse(ParseState &state) const;
+	short ParseChunk(ParseState &state, const char *data, size_t size, const RecordSink &sink) const;
+	short ParseRecord(ParseState &state, const RecordSink &sink) const;
+	bool  IsBootLoaderBugBlock(const AdcFrmData &frmData, double bootLoaderVersion) const;
 	void ParseHeader(string &header);
-	bool CheckSumOK(string content, unsigned long checksum);
-	void ConvertHexAscii2String(string &header);
-		
+
 	unsigned long m_minAddress;
 	unsigned long m_maxAddress;
 
-	unsigned char *m_data;
+	unsigned char *m_data;				// image, NULL: blocks are decrypted from m_cipherText
+	string m_cipherText;				// authenticated content of the firmware file
 
 	string m_adcType;
 	string m_firmwareFileVersion;
@@ -0,0 +1,76 @@
+/**
+******************************************************************************
+* File       : adcflightrecorder.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcflightrecorder class: the last telegrams of an adc in a
+*              ring buffer, dumped to a binary file on demand
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <mutex>
+#include <chrono>
+using namespace std;
+
+// dump file: header, then the records from the oldest to the newest,
+// every record is followed by its frame
+typedef struct
+{
+	unsigned int	magic;				// FLIGHT_MAGIC
+	unsigned int	version;			// FLIGHT_VERSION
+	unsigned int	recordCount;
+	unsigned int	reserved;
+	long long		dumpTimestamp;		// steady clock in ns at the dump
+	long long		dumpTime;			// time_t of the dump
+} FlightFileHeader;
+
+typedef struct
+{
+	long long		timestamp;			// steady clock in ns
+	unsigned int	size;				// bytes of the frame
+	short			orderID;			// -1: unknown
+	short			errorCode;			// LarsErr
+	unsigned char	direction;			// AdcFlightRecorder::DIR_...
+	unsigned char	reserved[7];
+} FlightRecord;
+
+class AdcFlightRecorder
+{
+public:
+	static const unsigned int	FLIGHT_MAGIC = 0x52464C42;		// "BLFR"
+	static const unsigned int	FLIGHT_VERSION = 1;
+
+	static const unsigned char	DIR_REQUEST = 0;		// APPL -> ADC
+	static const unsigned char	DIR_RESPONSE = 1;		// ADC -> APPL
+	static const unsigned char	DIR_ERROR = 2;			// error of the exchange, frame: received bytes
+
+	AdcFlightRecorder();
+	~AdcFlightRecorder();
+
+	void			Record(unsigned char direction, const char *frame, unsigned long size, short orderID, short errorCode);
+	short			Dump(const char *fileName);
+	short			SetAutoDump(const char *fileName);
+
+private:
+	static const unsigned long	FLIGHT_BUFFER_SIZE = 0x40000;		// 256 KByte, some thousand RW telegrams
+	static const unsigned long	FLIGHT_MAX_FRAME = 0x1000;			// longer frames (firmware blocks) are truncated
+	static const long			FLIGHT_AUTO_DUMP_INTERVAL = 10;		// s, min. time between two automatic dumps
+
+	void			Write(const void *data, unsigned long size);
+	void			Read(unsigned long long pos, void *data, unsigned long size);
+	short			WriteFile(const string &fileName);
+
+	char				*m_buffer;
+	unsigned long long	m_head;				// bytes written since start
+	unsigned long long	m_tail;				// start of the oldest record
+	unsigned long		m_count;			// records in the buffer
+	mutex				m_mutex;
+
+	string				m_autoDumpFile;		// empty: no dump on protocol errors
+	chrono::steady_clock::time_point m_lastAutoDump;
+	bool				m_autoDumped;
+};
@@ -28,6 +28,7 @@ class AdcInterface
 public:
     static const short  INTERFACE_USB = 0;
     static const short  INTERFACE_SERIAL = 1;
+    static const short  INTERFACE_SIMULATOR = 2;
     
     AdcInterface();
     virtual                 ~AdcInterface();
@@ -39,10 +40,13 @@ public:
     virtual short           GetInterfaceType();
     virtual unsigned long   Write(void *pData, unsigned long size) = 0;
     virtual unsigned long   Read(void *pData, unsigned long size) = 0;
+	virtual unsigned long   ReadAvailable(void *pData, unsigned long size, unsigned long timeout);
+	virtual void			WaitForData(unsigned long timeout);
 	virtual bool			UseCRC16();
 	virtual bool			ResetInterface();
 	virtual bool			DriverVersion(unsigned short *major, unsigned short  *minor);
 	virtual void			GetPort(string &port);
+	virtual int				GetPollFd();
     
 protected:
     adcHandle   m_hDevice;
@@ -0,0 +1,58 @@
+/**
+******************************************************************************
+* File       : adcprofile.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcprofile class: settings fixed by the firmware read by
+*              Lars::Open, stored per adc and firmware for the next open
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+using namespace std;
+
+class AdcProfile
+{
+public:
+	typedef map<string, string> keyValuePair;
+
+	// response of a settings request
+	typedef struct
+	{
+		string			cmd;
+		keyValuePair	request;
+		keyValuePair	response;
+	} Response;
+
+	typedef vector<Response> Responses;
+
+	AdcProfile();
+	~AdcProfile();
+
+	void			SetPath(const char *path);
+	string			GetFileName(const keyValuePair &version);
+	short			Load(const string &fileName, const keyValuePair &version, Responses &responses);
+	void			Save(const string &fileName, const keyValuePair &version, const Responses &responses);
+	void			Remove(const string &fileName);
+
+private:
+	static const string	FILE_PATTERN;
+	static const string	PROFILE_HEADER;
+
+	static string	Join(const keyValuePair &values);
+	static bool		Split(const string &fields, size_t count, keyValuePair &first, keyValuePair &second);
+	static string	Escape(const string &text, bool key);
+	static bool		Unescape(const string &field, string &text);
+	static unsigned long long GetHash(const string &text);
+
+	mutex			m_mutex;				// protects m_path
+	string			m_path;					// directory of the profiles, empty: no profiles
+};
+
+extern AdcProfile g_adcProfile;
@@ -12,8 +12,11 @@
 #pragma once
 #include <string>
 #include <map>
+#include <chrono>
+#include <functional>
 #include "bizlars.h"
 #include "adcinterface.h"
+#include "adcprofile.h"
 using namespace std;
 
 typedef enum
@@ -34,6 +37,9 @@ typedef struct
 class AdcProtocol
 {
 public:
+	// gets one log book entry of GetLoggerRange, entry is valid until it returns
+	typedef function<void(const short index, const char *entry, const unsigned long size)> LoggerConsumer;
+
     AdcProtocol();
 	AdcProtocol(AdcInterface *pInterface);
 	virtual ~AdcProtocol();
@@ -47,6 +53,7 @@ public:
     virtual short ClearTare(AdcState *adcState) = 0;
     virtual short ReadWeight(const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice) = 0;
     virtual short GetLogger(const short index, char *entry, unsigned long *size) = 0;
+	virtual short GetLoggerRange(const short first, const short count, char *arena, const unsigned long arenaSize, const LoggerConsumer &consumer) = 0;
     virtual short GetRandomAuthentication(unsigned char *random, unsigned long *size) = 0;
     virtual short SetAuthentication(const AdcAuthentication *authentication) = 0;
     virtual short GetMaxDisplayTextChars(short *number) = 0;
@@ -106,7 +113,24 @@ public:
 	virtual short GetStateAutomaticTiltSensor(bool *state) = 0;
 
 	virtual short FirmwareUpdate(const AdcFrmCmd cmd, const AdcFrmData *data, const string *usbStackVersion = NULL, const string *welmecStructureVersion = NULL, const short force = 0) = 0;
+	virtual short FirmwareWrite(const AdcFrmData *data, const short count, short *errorCodes) = 0;
 	virtual short SetInitialZeroSetting(const AdcInitialZeroSettingParam *initialZeroSettingParam) = 0;
+	virtual short PrefetchIdentification() = 0;
+	virtual short PrefetchSettings(const bool firmwareSettings, AdcProfile::Responses *responses) = 0;
+	virtual short PrefetchProfile(const AdcProfile::Responses &responses) = 0;
+	virtual void  SetProfile(const string &fileName) = 0;
+	virtual short DumpFlightRecorder(const char *fileName) = 0;
+	virtual short SetFlightRecorderAutoDump(const char *fileName) = 0;
+	virtual short GetStatistics(AdcCommandStatistics *statistics, short *count) = 0;
+	virtual short ResetStatistics() = 0;
+	virtual short WriteStatistics(const char *fileName, const string &port) = 0;
+	virtual short SetRegisterCache(const bool enable) = 0;
+
+	// non-blocking read weight, see AdcReactor
+	virtual short StartReadWeight(const short registrationRequest) = 0;
+	virtual short ContinueRequest(bool *done, chrono::steady_clock::time_point *deadline) = 0;
+	virtual void  CancelRequest() = 0;
+	virtual short DecodeReadWeight(short errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice) = 0;
 
 	static const unsigned long RECEIVE_BUFFER_SIZE = 0x10000;
 			
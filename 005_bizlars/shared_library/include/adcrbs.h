@@ -12,8 +12,13 @@
 #pragma once
 #include <string>
 #include <map>
+#include <vector>
 #include "adcinterface.h"
 #include "adcprotocol.h"
+#include "rbstelegram.h"
+#include "rbsresponse.h"
+#include "adcflightrecorder.h"
+#include "adcstatistics.h"
 using namespace std;
 
 
@@ -129,6 +134,7 @@ public:
     short ZeroScale(AdcState *adcState);
     short ReadWeight(const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice);
     short GetLogger(const short index, char *entry, unsigned long *size);
+	short GetLoggerRange(const short first, const short count, char *arena, const unsigned long arenaSize, const LoggerConsumer &consumer);
     short GetRandomAuthentication(unsigned char *random, unsigned long *size);
     short SetAuthentication(const AdcAuthentication *authentication);
     short GetMaxDisplayTextChars(short *number);
@@ -175,7 +181,22 @@ public:
 	short SetStateAutomaticTiltSensor(const bool state);
 	short GetStateAutomaticTiltSensor(bool *state);
 	short FirmwareUpdate(const AdcFrmCmd cmd, const AdcFrmData *data, const string *usbStackVersion = NULL, const string *welmecStructureVersion = NULL, const short force = 0);
+	short FirmwareWrite(const AdcFrmData *data, const short count, short *errorCodes);
 	short SetInitialZeroSetting(const AdcInitialZeroSettingParam *initialZeroSettingParam);
+	short PrefetchIdentification();
+	short PrefetchSettings(const bool firmwareSettings, AdcProfile::Responses *responses);
+	short PrefetchProfile(const AdcProfile::Responses &responses);
+	void  SetProfile(const string &fileName);
+	short DumpFlightRecorder(const char *fileName);
+	short SetFlightRecorderAutoDump(const char *fileName);
+	short GetStatistics(AdcCommandStatistics *statistics, short *count);
+	short ResetStatistics();
+	short WriteStatistics(const char *fileName, const string &port);
+	short SetRegisterCache(const bool enable);
+	short StartReadWeight(const short registrationRequest);
+	short ContinueRequest(bool *done, chrono::steady_clock::time_point *deadline);
+	void  CancelRequest();
+	short DecodeReadWeight(short errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice);
 
 	// country specific strings
 	static const short COUNTRY_SETTING_UPDATE;
@@ -524,12 +545,10 @@ private:
     static const string STRUCT_POS;
 
 
-    // defines for state machine receive
-    static const short  WAIT_FOR_SOH					= 0;
-    static const short  WAIT_FOR_LENGTH					= 1;
-    static const short  READ_REMAINING_DATA				= 2;
-	
+    // defines for receive
     static const short  TIMEOUT_RECEIVE     = 2;
+	static const unsigned long TIMEOUT_RECEIVE_STEP = 1000;		// ms per TIMEOUT_RECEIVE
+	static const short  MAX_LENGTH_DIGITS	= 8;
 	static const short  TIMEOUT_RETRIES_ATTEMPTS = 2;
 	
     // defines for state machine
@@ -571,23 +590,88 @@ private:
 	// defines for flag
 	static const unsigned long FLAG_TELEGRAM_REPEAT = 0x00000001;
 
+	// max. number of telegrams sent without response
+	static const short	MAX_PIPELINE_DEPTH = 8;
+
+	// one command of a pipelined request
+	typedef struct
+	{
+		string			cmd;
+		keyValuePair	request;
+		keyValuePair	response;
+		short			errorCode;
+		short			orderID;
+		bool			pending;
+		short			command;			// slot in m_statistics
+		chrono::steady_clock::time_point sent;
+	} PipelineRequest;
+
+	// takes the response of a pipelined command in place, see ExecutePipeline
+	typedef function<void(PipelineRequest &request, const RbsResponse &response)> PipelineHandler;
+
+	// request of StartRequest, advanced by ContinueRequest
+	typedef struct
+	{
+		bool			active;
+		string			cmd;
+		keyValuePair	request;
+		short			orderID;
+		short			retries;
+		short			command;			// slot in m_statistics
+		chrono::steady_clock::time_point sent;
+		chrono::steady_clock::time_point deadline;
+	} AsyncRequest;
+
 	void	Init();
     void    CreateReferenceData(const RefDataStruct &refData, keyValuePair &output);
     short   GetReferenceData(const string &masterKey, const keyValuePair &refDataMap, RefDataStruct &refData, short sollDefDataReceived);
-	short   CreateTelegram(const string &cmd, const keyValuePair &refDataMap, string &telegram, bool crc16, bool createNewOrderID, short previousOrderID, unsigned long flag);
+	short   GetReferenceData(const string &masterKey, const RbsResponse &response, RefDataStruct &refData, short sollDefDataReceived);
+	short   CreateTelegram(const string &cmd, const keyValuePair &refDataMap, RbsTelegram &telegram, bool crc16, bool createNewOrderID, short previousOrderID, unsigned long flag);
     short   GetOrderID();
 	short   SendRequestReceiveResponse(const string &cmd, keyValuePair &keyValueMap, bool sendRequestCmd = true);
-	short   ReceiveResponse(string &response, short timeoutOffset = 0);
+	short   ExecuteRequest(const string &cmd, const keyValuePair &request, bool sendRequestCmd = true);
+	short   ExecutePipeline(vector<PipelineRequest> &requests, const PipelineHandler &handler = nullptr);
+	short   StartRequest(const string &cmd, const keyValuePair &request);
+	short   SendAsyncRequest(bool createNewOrderID);
+	short   CheckResponse(const string &cmd, short orderID, unsigned long size, short *orderIDResponse, bool *cmdResponseOk, short *stat);
+	short   ReceiveResponse(unsigned long *size, short timeoutOffset = 0);
+	short   FrameTelegram(unsigned long *size);
+	void    AcceptTelegram(unsigned long size);
+	void    ReleaseTelegram();
+	void    DiscardReceived(unsigned long size);
     short   GetKeyValuePair(ProtocolType type, const string &keyValueStr, keyValuePair &headerMap, keyValuePair &refDataMap);
     void    ParseStructure(const string &structStr, keyValuePair &structMap);
     short   GetDebugResponse(const string &cmd, short orderID, string &response);
-	unsigned short CalculateChecksum(string str);
-	short	CheckChecksum(string str, string crc);
+	unsigned short CalculateChecksum(const char *str, unsigned long size);
+	short	CheckChecksum(const RbsResponse &response);
 	bool	CheckErrorCode(short errorCode, bool ignoreADCError = false);
+	short	ConvertAdcStat(short stat);
+	short	Prefetch(vector<PipelineRequest> &requests);
+	short	GetFrameOrderID(const char *frame, unsigned long size);
+	short	FormatLogger(const RbsResponse &response, char *entry, unsigned long *size);
+	void	CountError(short command, short errorCode);
+	bool	IsCachedRegister(const string &cmd, const keyValuePair &request);
+	bool	IsFirmwareSetting(const string &cmd);
+	string	GetRegisterCacheKey(const string &cmd, const keyValuePair &request);
+	void	UpdateRegisterCache(const string &cmd, const keyValuePair &request, short errorCode);
+	void	UpdateProfile(const string &cmd);
 	string  ConvertFloatIEEToInt(string value);
 	bool	ConvertDegreeToDigits(keyValuePair *wdtaSettings);
 
     short               m_orderID;
+	RbsTelegram			m_telegram;			// telegram buffer, reused for every request
+	RbsResponse			m_response;			// last response, points into m_receiveBuffer
+	vector<PipelineRequest> m_prefetch;		// prefetched responses, valid until the next request
+	AsyncRequest		m_async;			// non-blocking request in work
+	map<string, keyValuePair> m_registerCache;	// GSV* responses by command and request, see IsCachedRegister
+	bool				m_registerCacheEnabled;
+	string				m_profile;			// device profile file of the adc, see AdcProfile
+	unsigned long		m_receiveLevel;		// bytes in m_receiveBuffer
+	unsigned long		m_receiveEnd;		// end of the last telegram, following bytes belong to the next one
+	char				m_receiveSaved;		// byte overwritten by the zero termination of the last telegram
+	AdcFlightRecorder	m_flightRecorder;	// last telegrams, always on
+	AdcStatistics		m_statistics;		// counters and latencies of the commands, always on
+	chrono::steady_clock::time_point m_firstByteTime;	// first byte of the last telegram of ReceiveResponse
     static const short  m_base = 10;         // Kodierung Dezimal
 };
 
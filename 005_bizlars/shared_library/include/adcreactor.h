@@ -0,0 +1,82 @@
+/**
+******************************************************************************
+* File       : adcreactor.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcreactor class: one thread waits on the interfaces of many
+*              adc with epoll and advances their requests
+******************************************************************************
+*/
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+using namespace std;
+
+class AdcReactor
+{
+public:
+	// object served by the reactor thread
+	class Handler
+	{
+	public:
+		virtual			~Handler() {}
+
+		// file descriptor to wait for, -1: wait only for the deadline
+		virtual int		GetPollFd() = 0;
+
+		// time of the next OnEvent without data, time_point::max(): none
+		virtual chrono::steady_clock::time_point GetDeadline() = 0;
+
+		// file descriptor is readable or deadline is reached
+		virtual void	OnEvent(bool readable) = 0;
+
+		// handler is removed, end the request in work
+		virtual void	OnRemove() {}
+	};
+
+	AdcReactor();
+	~AdcReactor();
+
+	void			SetEnabled(bool enabled);
+	bool			IsEnabled();
+	short			Add(Handler *handler);
+	void			Remove(Handler *handler);
+	void			Wake();
+	bool			IsReactorThread();
+
+private:
+	static const int	MAX_EVENTS = 64;			// events per epoll_wait
+
+	typedef struct
+	{
+		Handler		*handler;
+		int			fd;						// registered file descriptor, -1: none
+		bool		readable;
+	} Entry;
+
+	short			Start();
+	void			ReactorThread();
+	void			Watch(Entry &entry, int fd);
+	Entry			*Find(Handler *handler);
+	void			ProcessRemoved(unique_lock<mutex> &lock);
+
+	vector<Entry>	m_entries;
+	vector<Entry>	m_work;					// entries of the current cycle, only used by the reactor thread
+	vector<Handler *> m_removed;			// handlers to remove by the reactor thread
+	bool			m_enabled;
+	bool			m_run;
+	thread			m_thread;
+	thread::id		m_threadId;
+	mutex			m_mutex;				// protects m_entries, m_removed and the epoll registrations
+	condition_variable	m_cond;
+	int				m_epoll;
+	int				m_wakeup;				// eventfd, interrupts epoll_wait
+};
+
+extern AdcReactor g_adcReactor;
@@ -0,0 +1,37 @@
+/**
+******************************************************************************
+* File       : adcrequestmutex.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcrequestmutex class: serializes the requests to one adc,
+*              blocking calls and the non-blocking request of the reactor
+******************************************************************************
+*/
+#pragma once
+#include <mutex>
+#include <condition_variable>
+using namespace std;
+
+class AdcRequestMutex
+{
+public:
+	AdcRequestMutex();
+
+	// blocking request of the calling thread
+	void			lock();
+	bool			try_lock();
+	void			unlock();
+
+	// non-blocking request, may be ended by another thread
+	bool			TryBeginAsync();
+	void			EndAsync();
+
+private:
+	mutex				m_mutex;			// only locked to change the flags
+	condition_variable	m_cond;
+	bool				m_locked;			// blocking request in work
+	bool				m_async;			// non-blocking request in work
+};
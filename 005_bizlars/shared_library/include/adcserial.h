@@ -1,12 +1,12 @@
 /**
 ******************************************************************************
-* File       : adcusb.h
+* File       : adcserial.h
 * Project    : BizLars
 * Date       : 25.08.2015
 * Author     : Thomas Buck, Sensor Technology
 * Copyright  : Bizerba GmbH & Co. KG
 *
-* Content    : adcusb class: impement the interface usb
+* Content    : adcserial class: impement the interface serial
 ******************************************************************************
 */
 #pragma once
@@ -14,6 +14,7 @@
 #include <list>
 #include "public.h"
 #include "adcinterface.h"
+#include "ringbuffer.h"
 
 using namespace std;
 
@@ -34,13 +35,31 @@ public:
    
     unsigned long   Write(void *pData, unsigned long size);
     unsigned long   Read(void *pData, unsigned long size);
+	unsigned long   ReadAvailable(void *pData, unsigned long size, unsigned long timeout);
+	void			WaitForData(unsigned long timeout);
+	bool			ResetInterface();
 
 	void			GetPort(string &port);
+	int				GetPollFd();
     
 private:
     void 			Init(const string &port);
 
+#ifdef __GNUC__
+	bool			SetAttributes(unsigned long baudrate, unsigned char bytesize, unsigned char stopbit, unsigned char parity);
+	void			SetLowLatency();
+	bool			WaitForPort(short events, unsigned long timeout);
+	unsigned long	ReadFromPort(unsigned long timeout);
+#endif
+
 	string m_port;
 
-};
+	RingBuffer<char>	*m_ringBuffer;		// received data not yet read by the protocol
+	char				*m_readCache;		// buffer of one bulk read
 
+	// parameters of the last open, used by Reconnect
+	unsigned long	m_baudrate;
+	unsigned char	m_bytesize;
+	unsigned char	m_stopbit;
+	unsigned char	m_parity;
+};
@@ -0,0 +1,64 @@
+/**
+******************************************************************************
+* File       : adcshared.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcshared class: weight snapshot in shared memory for readers
+*              in other processes
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <atomic>
+#include "bizlars.h"
+using namespace std;
+
+class AdcShared
+{
+public:
+	AdcShared();
+	~AdcShared();
+
+	short			Create(const char *name);
+	short			Attach(const char *name);
+	void			Close();
+	bool			IsOpen() const;
+
+	void			Publish(short errorCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare, const AdcPrice *sellPrice);
+	short			Read(short *errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcPrice *sellPrice, unsigned long *age);
+
+private:
+	static const unsigned long	SHARED_MAGIC = 0x42534C53;		// "SLSB"
+	static const unsigned long	SHARED_VERSION = 1;
+	static const unsigned long	READ_RETRIES = 1000;
+
+	// data protected by the sequence counter
+	typedef struct
+	{
+		short				errorCode;				// LarsErr of the last read
+		AdcState			adcState;
+		AdcWeight			weight;
+		AdcTare				tare;
+		AdcPrice			sellPrice;
+		long long			timestamp;				// steady clock in ns
+	} Snapshot;
+
+	typedef struct
+	{
+		unsigned long			magic;
+		unsigned long			version;
+		atomic<unsigned long>	sequence;			// odd while the publisher writes
+		Snapshot				snapshot;
+	} Segment;
+
+	string			GetPath(const char *name);
+	long long		GetTimestamp();
+
+	Segment			*m_segment;
+	Snapshot		m_last;					// publisher: values of fields the caller did not read
+	string			m_path;
+	bool			m_publisher;
+};
@@ -0,0 +1,115 @@
+/**
+******************************************************************************
+* File       : adcsimulator.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcsimulator class: simulated adc behind the interface, answers
+*              the rbs telegrams from an in-memory model
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <map>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include "adcinterface.h"
+#include "rbstelegram.h"
+#include "rbsresponse.h"
+#include "authentication.h"
+
+using namespace std;
+
+class AdcSimulator : public AdcInterface
+{
+public:
+	static const string	PORT_NAME;				// port of AdcOpen, options follow after ':'
+
+	AdcSimulator();
+	AdcSimulator(const string &port);
+	~AdcSimulator();
+
+	bool            Open(string &adcName);
+	bool			Open();
+	bool            Close();
+	bool			Reconnect();
+
+	unsigned long   Write(void *pData, unsigned long size);
+	unsigned long   Read(void *pData, unsigned long size);
+	unsigned long   ReadAvailable(void *pData, unsigned long size, unsigned long timeout);
+	void			WaitForData(unsigned long timeout);
+	bool			ResetInterface();
+
+	void			GetPort(string &port);
+	int				GetPollFd();
+
+	static bool		IsSimulatorPort(const string &port);
+
+private:
+	typedef map<string, string> keyValuePair;
+
+	// response on the link, readable from due
+	typedef struct
+	{
+		chrono::steady_clock::time_point due;
+		string			data;
+	} Response;
+
+	static const short	EEPROM_REGIONS = 4;
+
+	void			Init(const string &port);
+	void			Configure(const string &options);
+	void			InitModel();
+	unsigned long	Receive(const char *data, unsigned long size);
+	void			Execute(const RbsResponse &request, short orderID);
+	short			ExecuteCommand(const string &cmd, const RbsResponse &request, keyValuePair &response);
+	short			ExecuteWeight(const string &cmd, const RbsResponse &request, keyValuePair &response);
+	short			ExecuteEeprom(const string &cmd, const RbsResponse &request, keyValuePair &response);
+	short			ExecuteFirmware(const RbsResponse &request, keyValuePair &response, unsigned long *busyTime);
+	void			Schedule(const string &telegram, unsigned long busyTime);
+	void			ArmTimer();
+	bool			CheckChecksum(const RbsResponse &request);
+	string			Weight(long long value, short decimalPlaces);
+	unsigned long	Random(unsigned long range);
+
+	static string	Join(const char *const *values, short count);
+
+	string			m_port;
+
+	// configuration, see Configure
+	unsigned long	m_latency;				// us from the request to the response
+	unsigned long	m_jitter;				// us, random additional latency
+	unsigned long	m_fragment;				// max. bytes per read, 0: whole telegram
+	unsigned long	m_corrupt;				// 1 of m_corrupt responses with crc error, 0: never
+	unsigned long	m_flashTime;			// us per FRM data block
+	unsigned long long	m_seed;
+
+	// link
+	mutex			m_mutex;
+	bool			m_open;
+	string			m_input;				// received bytes, not yet a full telegram
+	deque<Response>	m_responses;
+	chrono::steady_clock::time_point m_busyUntil;	// end of the command in work
+	RbsResponse		m_request;
+	RbsTelegram		m_telegram;
+	unsigned long long	m_random;
+	short			m_lastOrderID;			// repeated telegrams get the last response again
+	string			m_lastResponse;
+	int				m_timer;				// timerfd, expires when the first response is due
+
+	// device model
+	keyValuePair	m_registers;			// values of GSV* and SSV*, by reference data key
+	vector<unsigned char> m_eeprom[EEPROM_REGIONS];
+	long long		m_gross;				// gross weight in digits of the load capacity
+	long long		m_noise;				// max. random deviation of the gross weight
+	long long		m_zero;
+	long long		m_tare;
+	short			m_tareType;				// ADC_TARE_NO: no tare
+	unsigned long	m_logbookEntries;
+	bool			m_frmActive;
+	unsigned long	m_frmBlocks;
+};
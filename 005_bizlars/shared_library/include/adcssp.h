@@ -13,6 +13,7 @@
 #include <string>
 #include <map>
 #include "adctilt.h"
+#include "adcfilecache.h"
 using namespace std;
 
 class AdcSsp
@@ -33,8 +34,7 @@ public:
 	const KeyValueMap* GetGeneralSettingsSealed();
 	
 private:
-	void	Parse(string &content, short part);
-	void	RemoveCR(string &str);
+	void	Parse(const AdcFileCache::Content &content, short part);
 	void	CalcWdtaSettings(string &wdtaSettings, double maxCapacityKG);
 
 	AdcTilt *m_tilt;
@@ -0,0 +1,86 @@
+/**
+******************************************************************************
+* File       : adcstatistics.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcstatistics class: counters and latency histograms of the
+*              rbs commands of an adc
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <atomic>
+#include <chrono>
+#include "bizlars.h"
+using namespace std;
+
+class AdcStatistics
+{
+public:
+	// counters of a command
+	static const short	CNT_REQUESTS = 0;			// calls of the command
+	static const short	CNT_RETRIES = 1;			// telegrams repeated with FLAG_TELEGRAM_REPEAT
+	static const short	CNT_TIMEOUTS = 2;			// no response within the receive timeout
+	static const short	CNT_CRC_ERRORS = 3;			// crc error of the response or reported by the adc
+	static const short	CNT_PROTOCOL_ERRORS = 4;	// invalid response
+	static const short	CNT_FAILURES = 5;			// transport error after all retries
+	static const short	CNT_COUNT = 6;
+
+	// latencies of a command
+	static const short	LAT_WRITE = 0;				// write of the request
+	static const short	LAT_FIRST_BYTE = 1;			// start of the request until the first byte of the response
+	static const short	LAT_ROUND_TRIP = 2;			// start of the request until the complete response
+	static const short	LAT_COUNT = 3;
+
+	AdcStatistics();
+	~AdcStatistics();
+
+	short			GetCommand(const string &cmd);
+	void			Count(short command, short counter);
+	void			RecordLatency(short command, short latency, chrono::steady_clock::duration duration);
+
+	short			Get(AdcCommandStatistics *statistics, short *count);
+	void			Reset();
+	short			WritePrometheus(const char *fileName, const string &port);
+
+private:
+	static const short			STAT_MAX_COMMANDS = 64;		// power of 2, the rbs protocol has less commands
+
+	// log-linear histogram in us: 8 sub buckets per power of 2, max. error 12.5%
+	static const short			HIST_SUB_BITS = 3;
+	static const short			HIST_SUB_COUNT = 1 << HIST_SUB_BITS;
+	static const short			HIST_MAX_EXPONENT = 25;		// 2^26 us = 67 s, larger values in the last bucket
+	static const short			HIST_BUCKETS = (HIST_MAX_EXPONENT - HIST_SUB_BITS + 2) * HIST_SUB_COUNT;
+
+	static const int			SLOT_FREE = 0;
+	static const int			SLOT_CLAIMED = 1;			// name is written
+	static const int			SLOT_READY = 2;
+
+	typedef struct
+	{
+		atomic<unsigned int>		buckets[HIST_BUCKETS];	// the sum of the buckets is the count
+		atomic<unsigned long long>	sum;				// us
+		atomic<unsigned long>		min;				// us, valid if count > 0
+		atomic<unsigned long>		max;				// us
+	} Histogram;
+
+	typedef struct
+	{
+		atomic<int>				state;					// SLOT_...
+		char					cmd[ADC_STAT_CMD_SIZE];
+		atomic<unsigned long>	counters[CNT_COUNT];
+		Histogram				latencies[LAT_COUNT];
+	} Command;
+
+	static short			GetBucket(unsigned long value);
+	static unsigned long	GetBucketLimit(short bucket);
+	static void				GetLatency(const Histogram &histogram, AdcLatency &latency);
+	static unsigned long	GetPercentile(const Histogram &histogram, unsigned long long count, unsigned long permille);
+	static void				Clear(Command &command);
+	static string			EscapeLabel(const string &value);
+
+	Command			*m_commands;
+};
@@ -14,7 +14,9 @@
 #include <ostream>
 #include <time.h>
 #include <mutex>
-#include <map>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
 using namespace std;
 
 class AdcTrace
@@ -25,6 +27,9 @@ public:
 
 	short	Trace(short level, const char *fmt, ...);
 	void	SetConfig(const char *fileName, const short level);
+	void	Flush();
+
+	static const char	*GetControlChar(char value);
 
 	static const short TRC_OFF = 0;
 	static const short TRC_ERROR_WARNING = 1;
@@ -34,13 +39,46 @@ public:
 	static const long TRC_MAX_FILE_SIZE = 0x100000;				// max file size 1 MByte
 
 private:
+	static const unsigned long	TRC_QUEUE_SIZE = 256;			// messages, power of two
+	static const unsigned long	TRC_MESSAGE_SIZE = 1024;		// max. length of one message, longer ones are truncated
+	static const unsigned long	TRC_BATCH_SIZE = 0x10000;		// max. bytes of one write
+	static const unsigned long	TRC_WRITER_SLEEP = 50;			// ms, max. delay of a message
+	static const unsigned long	TRC_FULL_RETRIES = 10000;		// yields of a producer while the queue is full
+
+	// one message of the queue, sequence is the state of the slot
+	typedef struct
+	{
+		atomic<unsigned long>	sequence;
+		short					level;
+		time_t					time;
+		char					message[TRC_MESSAGE_SIZE];
+	} TraceEntry;
+
 	bool		MakeBackup();
-	char		*GetTime();
+	char		*GetTime(time_t time);
+	bool		Dequeue(string &batch);
+	void		WriteBatch(const string &batch);
+	void		WriterThread();
+	void		StartWriter();
+	void		StopWriter();
 
 	string		m_fileName;
-	short		m_level;
-	mutex		m_mutex;
-    map <string, string> m_controlChar;
+	atomic<short>	m_level;
+	mutex		m_mutex;					// writer thread, file and configuration
+
+	TraceEntry	*m_queue;
+	atomic<unsigned long>	m_writePos;		// next slot of the producers
+	atomic<unsigned long>	m_readPos;		// next slot of the writer thread
+	atomic<unsigned long>	m_dropped;		// messages lost because the queue was full
+
+	thread		m_writer;
+	condition_variable	m_cond;
+	atomic<bool>	m_sleeping;				// writer waits for new messages
+	bool		m_run;
+
+	ofstream	m_file;						// kept open by the writer thread
+	string		m_openFileName;
+	long		m_fileSize;
 };
 
 
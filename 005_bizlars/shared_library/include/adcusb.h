@@ -12,6 +12,11 @@
 #pragma once
 #include <string>
 #include <list>
+#if defined __GNUC__ && defined USE_LIBUSB
+#include <thread>
+#include <mutex>
+#include <atomic>
+#endif
 #include "public.h"
 #include "adcinterface.h"
 #include "ringbuffer.h"
@@ -40,14 +45,19 @@ public:
                               unsigned long *pBytesReturn);
     unsigned long   Write(void *pData, unsigned long size);
     unsigned long   Read(void *pData, unsigned long size);
+	unsigned long   ReadAvailable(void *pData, unsigned long size, unsigned long timeout);
+	void			WaitForData(unsigned long timeout);
 	bool			ResetInterface();
 	bool			DriverVersion(unsigned short *major, unsigned short *minor);
 	void			GetPort(string &port);
+	int				GetPollFd();
     
     TYbizUsbAdcInfo m_usbInfo;
 
 private:
 	static const short	TIMEOUT_RECONNECT_ATTEMPTS = 3;
+	static const short	NUM_ASYNC_TRANSFERS = 4;			// number of bulk in transfers kept in flight
+	static const long	TIMEOUT_READ = 1000;				// read timeout in ms
 
 #ifndef USE_LIBUSB
     void			GetUsbInfo();
@@ -72,6 +82,23 @@ private:
 
 	unsigned char			m_bulkInEndpointAddr;
 	unsigned char			m_bulkOutEndpointAddr;
+
+	bool StartAsyncTransfers();
+	void StopAsyncTransfers();
+	void AsyncEventThread();
+	void AsyncReadCompleted(libusb_transfer *transfer);
+	unsigned long ReadAsync(void *pData, unsigned long size);
+	static void ReadTransferCallback(libusb_transfer *transfer);
+
+	bool					m_asyncMode;			// use asynchronous bulk in transfers
+	bool					m_asyncActive;			// asynchronous transfers are submitted
+	atomic<bool>			m_asyncRun;				// event thread and transfer resubmission enabled
+	atomic<bool>			m_asyncError;			// a transfer failed, device is probably gone
+	short					m_asyncPending;			// number of submitted transfers
+	libusb_transfer			*m_asyncTransfers[NUM_ASYNC_TRANSFERS];
+	thread					m_asyncEventThread;
+	mutex					m_asyncMutex;			// protects pending count and resubmission
+	int						m_asyncEvent;			// eventfd, readable when the event thread has stored data
 #endif
 };
 
@@ -0,0 +1,75 @@
+/**
+******************************************************************************
+* File       : adcweightstream.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcweightstream class: read the weight once and pass it to
+*              all subscribers
+******************************************************************************
+*/
+#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "bizlars.h"
+#include "adcreactor.h"
+using namespace std;
+
+class Lars;
+
+class AdcWeightStream : public AdcReactor::Handler
+{
+public:
+	static const unsigned long	MIN_INTERVAL = 10;				// min. poll interval in ms
+	static const unsigned long	BUSY_RETRY = 1;					// ms until the next try if the adc is busy (reactor mode)
+
+	AdcWeightStream(Lars *lars);
+	~AdcWeightStream();
+
+	short			Subscribe(unsigned long interval, AdcWeightStreamCallback callback, void *ctx);
+	short			Unsubscribe(AdcWeightStreamCallback callback, void *ctx);
+	void			Stop();
+
+	// reactor mode, see AdcReactor
+	int				GetPollFd();
+	chrono::steady_clock::time_point GetDeadline();
+	void			OnEvent(bool readable);
+	void			OnRemove();
+
+private:
+	typedef struct
+	{
+		AdcWeightStreamCallback	callback;
+		void					*ctx;
+		unsigned long			interval;
+	} Subscriber;
+
+	void			StartThread();
+	void			StreamThread();
+	void			Notify(short retCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare);
+	unsigned long	GetInterval();
+
+	Lars					*m_lars;
+	vector<Subscriber>		m_subscribers;
+	vector<Subscriber>		m_notifyList;		// subscribers of the current cycle, only used by the stream thread
+	chrono::steady_clock::time_point m_next;	// time of the next read
+	bool					m_run;
+	thread					m_thread;
+	thread::id				m_threadId;
+	mutex					m_mutex;			// protects subscribers, m_next and m_run
+	mutex					m_callbackMutex;	// locked while the callbacks are called
+	condition_variable		m_cond;
+
+	// reactor mode, only used by the reactor thread
+	bool					m_reactor;			// served by g_adcReactor instead of the stream thread
+	bool					m_pending;			// read weight request in work
+	chrono::steady_clock::time_point m_deadline;	// of the request in work
+	AdcState				m_adcState;
+	AdcWeight				m_weight;
+	AdcTare					m_tare;
+};
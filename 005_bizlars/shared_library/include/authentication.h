@@ -11,6 +11,35 @@
 */
 #pragma once
 
+// crc16 lookup tables for one polynomial, table[0] is the classic byte table,
+// table[n] advances the crc over n additional zero bytes (slicing-by-8)
+struct CrcTable
+{
+    unsigned short poly;
+    unsigned short table[8][256];
+
+    constexpr CrcTable(unsigned short crcPoly) : poly(crcPoly), table()
+    {
+        for (int idx = 0; idx < 256; idx++)
+        {
+            unsigned short crc = (unsigned short)(idx << 8);
+            for (int bit = 0; bit < 8; bit++)
+            {
+                crc = (crc & 0x8000) ? (unsigned short)((crc << 1) ^ crcPoly) : (unsigned short)(crc << 1);
+            }
+            table[0][idx] = crc;
+        }
+        for (int slice = 1; slice < 8; slice++)
+        {
+            for (int idx = 0; idx < 256; idx++)
+            {
+                unsigned short crc = table[slice - 1][idx];
+                table[slice][idx] = (unsigned short)((crc << 8) ^ table[0][crc >> 8]);
+            }
+        }
+    }
+};
+
 class Authentication
 {
 public:
@@ -19,12 +48,25 @@ public:
     ~Authentication();
 
     unsigned short CalcCrc(unsigned char *buffer, unsigned long size);
+
+    // calculate the crc in several steps
+    unsigned short InitCrc();
+    void UpdateCrc(unsigned short *crc, const unsigned char *buffer, unsigned long size);
+    unsigned short FinalCrc(unsigned short crc);
+
+    // single implementations, UpdateCrc selects the fastest one
+    void UpdateCrcBitwise(unsigned short *crc, const unsigned char *buffer, unsigned long size);
+    void UpdateCrcTable(unsigned short *crc, const unsigned char *buffer, unsigned long size);
+    void UpdateCrcSlicing8(unsigned short *crc, const unsigned char *buffer, unsigned long size);
     
 private:
+    static const unsigned long SLICING_MIN_SIZE = 16;   // shorter data is calculated byte by byte
+
     void calcCrcOverOneByte(unsigned char data, unsigned short *crc);
 
     unsigned short m_crcStart;
     unsigned short m_crcPoly;
     unsigned short m_crcMask;
+    const CrcTable *m_crcTable;     // NULL: no table for this polynomial
 };
 
@@ -521,6 +521,40 @@ extern "C" {
 		}Health;
 	} AdcSensorHealth;
 
+	#define DIA_MAX_SENSOR_HEALTH	32		// max. records of the diagnostic sampler
+
+	typedef struct
+	{
+		unsigned long	count;			// number of measurements
+		unsigned long	min;			// all times in us
+		unsigned long	mean;
+		unsigned long	p50;			// 50% of the measurements are less or equal
+		unsigned long	p90;
+		unsigned long	p99;
+		unsigned long	max;
+	} AdcLatency;
+
+	#define ADC_STAT_CMD_SIZE	8
+	typedef struct
+	{
+		char			cmd[ADC_STAT_CMD_SIZE];		// rbs command, e.g. "RW"
+		unsigned long	requests;				// calls of the command
+		unsigned long	retries;				// telegrams repeated after an error
+		unsigned long	timeouts;				// no response within the timeout
+		unsigned long	crcErrors;				// crc errors in both directions
+		unsigned long	protocolErrors;			// invalid responses
+		unsigned long	failures;				// communication error after all retries
+		AdcLatency		writeTime;				// write of the request
+		AdcLatency		firstByte;				// request until the first byte of the response
+		AdcLatency		roundTrip;				// request until the complete response
+	} AdcCommandStatistics;
+
+	typedef void (*AdcWeightStreamCallback)(const short handle, const short retCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare, void *ctx);
+
+	typedef void (*AdcUpdateProgressCallback)(const short handle, const unsigned long written, const unsigned long total, void *ctx);
+
+	typedef void (*AdcLoggerCallback)(const short handle, const short index, const char *entry, const unsigned long size, void *ctx);
+
 
 	/**
 	******************************************************************************
@@ -528,13 +562,16 @@ extern "C" {
 	*
 	* @param    adcName:in		adc identification
 	* @param    protocol:in		protocol (rbs, minibus, siobus ...)
-	* @param    port:in	        interface (usb, COMx ...)
+	* @param    port:in	        interface (usb, COMx, /dev/ttyXXX, AdcSimulator ...)
 	* @param    handle:out		adc handle
 	* @param    performSwReset:in	!= 0 perform an Software-Reset
 	*
 	* @return   ADC_SUCCESS
 	*			ADC_E_NO_DEVICE
-	* @remarks
+	* @remarks	AdcSimulator opens a simulated adc without hardware, options follow
+	*			after ':', e.g. "AdcSimulator:latency=2000,jitter=500,fragment=16,corrupt=100"
+	*			(latency, jitter and flash in us, corrupt: 1 of n responses with crc error,
+	*			further seed, weight, noise, logbook)
 	******************************************************************************
 	*/
 	BIZLARS_API short AdcOpen(const char *adcName, const char *protocol, const char *port, short *handle, const unsigned char performSwReset);
@@ -1816,6 +1853,45 @@ extern "C" {
     BIZLARS_API short AdcGetLogger(const short handle, const short index, char *entry, unsigned long *size);
 
 
+	/**
+	******************************************************************************
+	* AdcGetLoggerRange - function to get several entries of the adc log book
+	*
+	* @param    handle:in				adc handle
+	* @param    first:in				index of the first log book entry, 0: latest entry
+	* @param    count:in				max. number of entries
+	* @param    arena:in				buffer for the entries, NULL: buffer of the library
+	* @param    arenaSize:in			size of arena in byte
+	* @param    callback:in				gets every entry, may be NULL
+	* @param    ctx:in					context passed to the callback
+	* @param    exportFile:in			path of a binary export of the entries, NULL: no export
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_USB_ERROR
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_NOT_ENOUGH_MEMORY	an entry is longer than arena
+	*			ADC_E_FILE_NOT_FOUND	export file could not be written
+	*			ADC_E_ADC_TIMEOUT
+	*			ADC_E_COMMAND_NOT_EXECUTED
+	*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+	* @remarks	Replaces a loop of AdcGetLogger. The requests are sent up to 8 at
+	*			a time without waiting for the responses, the download stops
+	*			without error at the end of the log book. The entries have the
+	*			format of AdcGetLogger and are written one after the other into
+	*			arena, entry points into arena and is valid until the callback
+	*			returns, size includes the terminating \0. The callback is called
+	*			in the context of the caller in the order of the index and must
+	*			not call functions of the same handle.
+	*			The export file starts with a header of 24 byte (magic "BLLG",
+	*			version 1, number of entries, reserved, time_t of the export),
+	*			every entry follows as index (2 byte), reserved (2 byte), size
+	*			(4 byte) and the entry, in the byte order of the host.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcGetLoggerRange(const short handle, const short first, const short count, char *arena, const unsigned long arenaSize, AdcLoggerCallback callback, void *ctx, const char *exportFile);
+
+
     /**
     ******************************************************************************
     * AdcGetRandomAuthentication - function to get the random value for authentication
@@ -2070,6 +2146,63 @@ extern "C" {
 	BIZLARS_API short AdcUpdate(const short handle, const short force = 0);
 
 
+	/**
+	******************************************************************************
+	* AdcUpdateEx - function to update the adc with progress
+	*
+	* @param    handle:in		adc handle
+	* @param    force:in		0: check parameter if update is possible
+	*							1: no check, always execute update
+	* @param    window:in		max. firmware blocks sent without response (1..8),
+	*							0: one block at a time like AdcUpdate
+	* @param    callback:in		called after every window with the written and the
+	*							total bytes of the firmware, may be NULL
+	* @param    ctx:in			context passed to the callback
+	*
+	* @return	ADC_SUCCESS
+	*			ADC_E_USB_ERROR
+	*			ADC_E_INVALID_HANDLE
+	*           ADC_E_FILE_CORRUPT
+	*			ADC_E_FILE_NOT_FOUND
+	*			ADC_E_ADC_TIMEOUT
+	*			ADC_E_COMMAND_NOT_EXECUTED
+	*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+	* @remarks	the firmware file is authenticated before the first block is sent, the
+	*			blocks are decrypted while they are sent. A window > 1 needs a
+	*			bootloader that accepts several outstanding blocks, a block repeated
+	*			after a timeout may be written after the following blocks.
+	*			The callback is called in the context of the caller.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcUpdateEx(const short handle, const short force, const short window, AdcUpdateProgressCallback callback, void *ctx);
+
+
+	/**
+	******************************************************************************
+	* AdcUpdateMany - function to update several adc at the same time
+	*
+	* @param    handles:in		adc handles, all adc must be in bootloader mode
+	* @param    count:in		number of handles
+	* @param    force:in		0: check parameter if update is possible
+	*							1: no check, always execute update
+	* @param    callback:in		called with the handle, the written and the total bytes
+	*							of the firmware, may be NULL
+	* @param    ctx:in			context passed to the callback
+	* @param    retCodes:out	return code of every adc, same order as handles
+	*
+	* @return	ADC_SUCCESS						all adc are updated
+	*			ADC_E_INVALID_PARAMETER
+	*			return code of the first adc that failed, see retCodes
+	* @remarks	Every firmware file is read and decrypted once, adc of the same type
+	*			download the same image. Up to 8 adc are updated in parallel, an error
+	*			of one adc does not stop the update of the others.
+	*			The callback is called by several threads at the same time.
+	*			A handle that is in the list twice gets ADC_E_INVALID_PARAMETER.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcUpdateMany(const short *handles, const short count, const short force, AdcUpdateProgressCallback callback, void *ctx, short *retCodes);
+
+
 	/**
 	******************************************************************************
 	* AdcGetFirmwareFileVersion - function get version of the firmware file
@@ -2164,6 +2297,88 @@ extern "C" {
 	******************************************************************************
 	*/
 	BIZLARS_API short AdcConfigureDiagnosticData(const short handle, const AdcSensorHealth *sensorHealth);
+
+
+	/**
+	******************************************************************************
+	* AdcGetDiagnosticSnapshot - function to get all diagnostic data with one request
+	*
+	* @param    handle:in			adc handle
+	* @param    name:in				if name == EmptyString the function give all diagnostic values
+	* @param    sensorHealth:out	sensor health data, sorted by diaParam
+	* @param    count:in/out		in: number of records of sensorHealth, out: number of records
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_USB_ERROR
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_NOT_ENOUGH_MEMORY	sensorHealth is too small, count is the required number
+	*			ADC_E_ADC_TIMEOUT
+	*			ADC_E_COMMAND_NOT_EXECUTED
+	*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+	* @remarks	Replaces AdcGetFirstDiagnosticData and AdcGetNextDiagnosticData,
+	*			nothing is kept in the library between two calls. With count 0
+	*			it returns the number of records in count.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcGetDiagnosticSnapshot(const short handle, const char *name, AdcSensorHealth *sensorHealth, short *count);
+
+
+	/**
+	******************************************************************************
+	* AdcStartDiagnosticSampler - function to read the diagnostic data periodically
+	*
+	* @param    handle:in			adc handle
+	* @param    interval:in			sample interval in ms, min. 100
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	* @remarks	A thread of the handle reads all diagnostic values like
+	*			AdcGetDiagnosticSnapshot every interval and keeps the latest
+	*			snapshot of up to DIA_MAX_SENSOR_HEALTH records, see
+	*			AdcGetDiagnosticSample. The first sample is read immediately, a
+	*			second call changes the interval. The sampler is stopped by
+	*			AdcStopDiagnosticSampler and AdcClose.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcStartDiagnosticSampler(const short handle, const unsigned long interval);
+
+
+	/**
+	******************************************************************************
+	* AdcStopDiagnosticSampler - function to stop the diagnostic sampler
+	*
+	* @param    handle:in			adc handle
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	* @remarks	a sample in work is finished first, the latest snapshot is kept
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcStopDiagnosticSampler(const short handle);
+
+
+	/**
+	******************************************************************************
+	* AdcGetDiagnosticSample - function to get the latest snapshot of the diagnostic sampler
+	*
+	* @param    handle:in			adc handle
+	* @param    sensorHealth:out	sensor health data, sorted by diaParam
+	* @param    count:in/out		in: number of records of sensorHealth, out: number of records
+	* @param    age:out				ms since the snapshot was read, may be NULL
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER	sampler not started
+	*			ADC_E_NOT_ENOUGH_MEMORY	sensorHealth is too small, count is the required number
+	*			retCode of the latest sample
+	* @remarks	No request is sent to the adc. Waits for the first sample after
+	*			AdcStartDiagnosticSampler. If the latest sample failed, its retCode
+	*			is returned together with the records of the last successful sample.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcGetDiagnosticSample(const short handle, AdcSensorHealth *sensorHealth, short *count, unsigned long *age);
 	
 	
 	/**
@@ -2336,6 +2551,269 @@ extern "C" {
 	*/
 	BIZLARS_API short AdcGetPortNr(const short handle, char *portNr, unsigned long *size);
 
+
+	/**
+	******************************************************************************
+	* AdcStartWeightStream - function to subscribe to the continuous weight stream
+	*
+	* @param    handle:in				adc handle
+	* @param    interval:in				poll interval in ms (min. 10ms)
+	* @param    callback:in				called with adc state, weight and tare of every read
+	* @param    ctx:in					context passed to the callback
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	* @remarks	The weight is read once by a background thread of the device and passed to
+	*			all subscribers, the device is read with the smallest interval of all subscribers.
+	*			The callback is called in the context of this thread, it may call other Adc functions
+	*			except AdcClose for the same handle. retCode of the callback is the return code of the read.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcStartWeightStream(const short handle, const unsigned long interval, AdcWeightStreamCallback callback, void *ctx);
+
+
+	/**
+	******************************************************************************
+	* AdcStopWeightStream - function to unsubscribe from the weight stream
+	*
+	* @param    handle:in				adc handle
+	* @param    callback:in				callback of AdcStartWeightStream
+	* @param    ctx:in					context of AdcStartWeightStream
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	* @remarks	After return the callback is not called anymore. AdcClose stops all subscriptions.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcStopWeightStream(const short handle, AdcWeightStreamCallback callback, void *ctx);
+
+
+	/**
+	******************************************************************************
+	* AdcSetReactorMode - function to serve the weight streams of all adc by one thread
+	*
+	* @param    mode:in					1: weight streams started afterwards use the reactor
+	*									0: every adc has its own stream thread (default)
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+	* @remarks	Linux only. In reactor mode one thread waits with epoll on the interfaces of all
+	*			adc and advances their read weight requests as soon as data is received, so
+	*			dozens of scales are served without a thread per scale. The callbacks of
+	*			AdcStartWeightStream are called in the context of this thread and must not block.
+	*			Applies to serial ports, usb with libusb and the simulator; other interfaces keep
+	*			their stream thread. Running weight streams keep their mode until AdcClose.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcSetReactorMode(const short mode);
+
+
+	/**
+	******************************************************************************
+	* AdcPublishShared - function to publish the weight to shared memory for other processes
+	*
+	* @param    handle:in				adc handle
+	* @param    name:in					segment name (/dev/shm/<name>) or absolute path of a file on a ram disk
+	*									NULL: stop publishing
+	* @param    interval:in				poll interval in ms, 0: publish only the results of AdcReadWeight
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_FILE_NOT_FOUND
+	*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+	* @remarks	Every read weight (AdcReadWeight and weight stream) updates adc state, weight, tare
+	*			and sell price of the segment. Not supported under Windows.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcPublishShared(const short handle, const char *name, const unsigned long interval);
+
+
+	/**
+	******************************************************************************
+	* AdcAttachShared - function to attach to the weight published by another process
+	*
+	* @param    name:in					name of AdcPublishShared
+	* @param    sharedHandle:out		handle for AdcReadShared
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_NOT_ENOUGH_MEMORY	too many attached segments
+	*			ADC_E_FILE_NOT_FOUND	no publisher
+	*			ADC_E_FILE_CORRUPT		incompatible library version of the publisher
+	*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+	* @remarks	does not need an open adc
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcAttachShared(const char *name, short *sharedHandle);
+
+
+	/**
+	******************************************************************************
+	* AdcReadShared - function to read the latest published weight
+	*
+	* @param    sharedHandle:in			handle of AdcAttachShared
+	* @param    adcState:out			adc state, may be NULL
+	* @param    weight:out				weight value, may be NULL
+	* @param    tare:out				tare value, may be NULL
+	* @param    sellPrice:out			sell price value, may be NULL
+	* @param    age:out					age of the values in ms, may be NULL
+	*
+	* @return   return code of the read weight of the publisher
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_NO_DEVICE			publisher has stopped, attach again
+	* @remarks	Lock free, does not block the publisher. Must not be called while
+	*			the same handle is detached.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcReadShared(const short sharedHandle, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcPrice *sellPrice, unsigned long *age);
+
+
+	/**
+	******************************************************************************
+	* AdcDetachShared - function to detach from a published weight
+	*
+	* @param    sharedHandle:in			handle of AdcAttachShared
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	* @remarks
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcDetachShared(const short sharedHandle);
+
+
+	/**
+	******************************************************************************
+	* AdcDumpFlightRecorder - function to write the last telegrams to a file
+	*
+	* @param    handle:in				adc handle
+	* @param    fileName:in				path of the dump file
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_FILE_NOT_FOUND	file could not be written
+	* @remarks	The library always records the last requests and responses with time
+	*			stamp, order ID and error code. The binary dump is decoded by frdecode.
+	*			May be called while another function of the adc hangs.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcDumpFlightRecorder(const short handle, const char *fileName);
+
+
+	/**
+	******************************************************************************
+	* AdcSetFlightRecorderAutoDump - function to dump the last telegrams on protocol errors
+	*
+	* @param    handle:in				adc handle
+	* @param    fileName:in				path of the dump file, NULL: no automatic dump
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	* @remarks	The file is overwritten, at most one dump every 10 seconds.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcSetFlightRecorderAutoDump(const short handle, const char *fileName);
+
+
+	/**
+	******************************************************************************
+	* AdcGetStatistics - function to get the counters and latencies of the rbs commands
+	*
+	* @param    handle:in				adc handle
+	* @param    statistics:out			array of *count entries, sorted by command
+	* @param    count:in/out			in: size of the array
+	*									out: number of commands
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_NOT_ENOUGH_MEMORY	array too small, count is the needed size
+	* @remarks	The library counts every command sent since AdcOpen or the last
+	*			AdcResetStatistics. The percentiles have an accuracy of 12.5%.
+	*			May be called while another function of the adc is running.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcGetStatistics(const short handle, AdcCommandStatistics *statistics, short *count);
+
+
+	/**
+	******************************************************************************
+	* AdcResetStatistics - function to set the counters and latencies to zero
+	*
+	* @param    handle:in				adc handle
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	* @remarks
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcResetStatistics(const short handle);
+
+
+	/**
+	******************************************************************************
+	* AdcWriteStatistics - function to write the statistics in the Prometheus text format
+	*
+	* @param    handle:in				adc handle
+	* @param    fileName:in				path of the file, e.g. in the directory of the
+	*									textfile collector of the node exporter
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	*			ADC_E_FILE_NOT_FOUND	file could not be written
+	* @remarks	The file is replaced atomically, the metrics have the labels port
+	*			and cmd. Call it periodically, e.g. every 15 seconds.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcWriteStatistics(const short handle, const char *fileName);
+
+
+	/**
+	******************************************************************************
+	* AdcSetRegisterCache - function to switch the cache of the scale values
+	*
+	* @param    handle:in				adc handle
+	* @param    mode:in					1: cache on (default), 0: every getter reads from the adc
+	*
+	* @return   ADC_SUCCESS
+	*			ADC_E_INVALID_HANDLE
+	*			ADC_E_INVALID_PARAMETER
+	* @remarks	The library keeps the scale values read by AdcGetScaleValues, AdcGetFilter,
+	*			AdcGetZeroPointTracking etc. and answers further calls without a telegram.
+	*			AdcSetScaleValues and the other setters update the cache, AdcReset, the
+	*			calibration, the operating mode, the settings of country and load
+	*			capacity, the firmware update and a reconnect empty it. Switch it off
+	*			for the verification, when the values must be read from the adc.
+	*			Tilt compensation, eeprom, remaining warm up time and the state of the
+	*			verification switch are never cached.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcSetRegisterCache(const short handle, const short mode);
+
+
+	/**
+	******************************************************************************
+	* AdcSetProfilePath - function to set the directory of the device profiles
+	*
+	* @param    path:in					directory, NULL or "": no device profiles (default)
+	*
+	* @return   ADC_SUCCESS
+	* @remarks	Call it before AdcOpen. After the settings are read from the adc,
+	*			AdcOpen writes the settings fixed by the firmware, capabilities and
+	*			eeprom size, to a device profile of this adc. A later AdcOpen of the
+	*			adc with the same serial number, firmware and boot loader version
+	*			takes them from the profile. Country settings, load capacity, tilt
+	*			sensor resolution and scale model are always read from the adc,
+	*			pipelined with one round trip. A firmware update removes the profile.
+	******************************************************************************
+	*/
+	BIZLARS_API short AdcSetProfilePath(const char *path);
+
 #ifdef __cplusplus
 }
 #endif
@@ -3,6 +3,7 @@
 #include <vector>
 #include <map>
 #include "adctilt.h"
+#include "adcfilecache.h"
 using namespace std;
 
 class CountrySettings
@@ -34,8 +35,7 @@ public:
 private:
 	void    ReadSupportedCountries();
 	void    ReadSupportedCountries(const string &path);
-	bool	Parse(string &fileContent, const string &country);
-    void    RemoveCR(string &str);
+	bool	Parse(const AdcFileCache::Content &content, const string &country);
 
     static const  string m_fileName;
 	string				m_path;
@@ -1,11 +1,15 @@
 #pragma once
 #include <string>
+#include <functional>
 
 using namespace std;
 
 class Crypto
 {
 public:
+    // receives the plain text chunk by chunk, false: stop the decryption
+    typedef function<bool(const char *data, size_t size)> DecryptConsumer;
+
     Crypto();
     ~Crypto();
 
@@ -13,7 +17,11 @@ public:
     int     DecryptAES(string cipherText, string& plainText);
     int     EncryptAES_GCM(string plainText, string& cipherText);
     int     DecryptAES_GCM(string cipherText, string& plainText);
+    int     DecryptAES_GCM(const string& cipherText, const DecryptConsumer& consumer);
     short   ReadEncryptedFile(const string& fileName, string& decryptedText);
+    short   ReadCipherFile(const string& fileName, string& cipherText);
+    void    CreateMAC(const string& data, string& mac);
+    bool    VerifyMAC(const string& data, const string& mac);
 
     static const short E_SUCCESS = 0;
     static const short E_NO_CHANNEL_SUPPORT = 1;
@@ -21,12 +29,14 @@ public:
     static const short E_INVALID_PARAMETER = 3;
     static const short E_DATA_INTEGRITY = 4;
     static const short E_HASH_VERIFICATION_FAILED = 5;
+    static const short E_ABORTED = 6;
 
 private:
     void CreateAccountInfo();
     
     static const char allowedCharacters[64];
     static const int TAG_SIZE;
+    static const size_t DECRYPT_CHUNK_SIZE = 0x1000;
 
     string key;                 // private key
     string iv;                  // Initialization vector
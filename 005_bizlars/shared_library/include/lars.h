@@ -20,8 +20,32 @@
 #include "countrysettings.h"
 #include "loadcapacity.h"
 #include "adcssp.h"
+#include "adcweightstream.h"
+#include "adcdiagnosticsampler.h"
+#include "adcrequestmutex.h"
+#include "adcshared.h"
 using namespace std;
 
+class AdcFirmware;
+
+// export file of GetLoggerRange: header, then the entries in the order of
+// the index, every record is followed by its entry including the \0
+typedef struct
+{
+	unsigned int	magic;				// Lars::LOGGER_MAGIC
+	unsigned int	version;			// Lars::LOGGER_VERSION
+	unsigned int	entryCount;
+	unsigned int	reserved;
+	long long		exportTime;			// time_t of the export
+} LoggerFileHeader;
+
+typedef struct
+{
+	short			index;				// 0: latest entry
+	unsigned short	reserved;
+	unsigned int	size;				// bytes of the entry
+} LoggerRecord;
+
 class Lars
 {
     typedef map<unsigned short, string> ProductID2AdcType;
@@ -41,6 +65,9 @@ public:
     static const char GS = 0x1D;
     static const char ESC = 0x1B;
 
+	static const unsigned int LOGGER_MAGIC = 0x474C4C42;		// "BLLG"
+	static const unsigned int LOGGER_VERSION = 1;
+
  	string*			GetAdcName();
 
 	short			Open(const bool performSwReset = true);
@@ -58,6 +85,7 @@ public:
     short           ClearTare(AdcState *adcState);
     short           ReadWeight(const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice);
     short           GetLogger(const short index, char *entry, unsigned long *size);
+	short			GetLoggerRange(const short first, const short count, char *arena, unsigned long arenaSize, AdcLoggerCallback callback, void *ctx, const char *exportFile);
     short           GetRandomAuthentication(unsigned char *random, unsigned long *size);
     short           SetAuthentication(const AdcAuthentication *authentication);
 	short           GetHighResolution(const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcWeight *weightHighResolution, AdcTare *tare, long *digitValue);
@@ -65,6 +93,10 @@ public:
 	short           GetFirstDiagnosticData(const char *name, long *sensorHealthID, AdcSensorHealth *sensorHealth, short *state);
 	void			GetNextDiagnosticData(const long sensorHealthID, AdcSensorHealth *sensorHealth, short *state);
 	short			ConfigureDiagnosticData(const AdcSensorHealth *sensorHealth);
+	short			GetDiagnosticSnapshot(const char *name, AdcSensorHealth *sensorHealth, short *count);
+	short			StartDiagnosticSampler(const unsigned long interval);
+	short			StopDiagnosticSampler();
+	short			GetDiagnosticSample(AdcSensorHealth *sensorHealth, short *count, unsigned long *age);
 	void			SetCountryFilesPath(const char *path);
 	short           GetSupportedCountries(char *countries, unsigned long *size);
 	short           SetCountry(const char *name);
@@ -74,7 +106,8 @@ public:
     short           SetLoadCapacity(const char *loadCapacity);
 	short			GetLoadCapacity(char *loadCapacity, unsigned long size);
 	void			SetFirmwarePath(const char *path);
-	short			Update(const short force);
+	short			Update(const short force, const short window = 0, AdcUpdateProgressCallback callback = NULL, void *ctx = NULL);
+	static void		UpdateMany(Lars *const *lars, const short count, const short force, AdcUpdateProgressCallback callback, void *ctx, short *errorCodes);
 	short           GetFirmwareFileVersion(char *versionStr, unsigned long *size);
 	short			Calibration(const AdcCalibCmd cmd, AdcState *adcState, long *step, long *calibDigit);
 	short           Reset(const AdcResetType type);
@@ -89,9 +122,24 @@ public:
 	short			GetCalStrings4LoadCapacity(const char *loadCapacity, AdcCalStrings *calStrings);
     bool            operator == (const Lars &lars);
 	short			GetPortNr(char *portNr, unsigned long *size);
+	short			StartWeightStream(const unsigned long interval, AdcWeightStreamCallback callback, void *ctx);
+	short			StopWeightStream(AdcWeightStreamCallback callback, void *ctx);
+	short			StartReadWeight(bool *busy);
+	short			ContinueReadWeight(bool *done, chrono::steady_clock::time_point *deadline, AdcState *adcState, AdcWeight *weight, AdcTare *tare);
+	void			CancelReadWeight();
+	int				GetPollFd();
+	short			PublishShared(const char *name, const unsigned long interval);
+	short			DumpFlightRecorder(const char *fileName);
+	short			SetFlightRecorderAutoDump(const char *fileName);
+	short			GetStatistics(AdcCommandStatistics *statistics, short *count);
+	short			ResetStatistics();
+	short			WriteStatistics(const char *fileName);
+	short			SetRegisterCache(const bool enable);
 
 private:
 	static const long  INVALID_SENSOR_ID = -1;
+	static const short UPDATE_MAX_WORKERS = 8;		// max. devices updated at the same time by UpdateMany
+	static const unsigned long LOGGER_ARENA_SIZE = 0x4000;	// buffer of GetLoggerRange without arena of the caller
 
     static const ProductID2AdcType  m_productID2adcType;
 
@@ -105,9 +153,13 @@ private:
 	void			SetBootLoaderVersion(map<string, string> &versionMap);
 	short			SetAdcVariables();
 	short			ReadLcSettings();
+	short			ReadSettings();
 	void			InitCapabilities();
+	short			OpenFirmware(AdcFirmware &firmware, const bool loadImage);
+	short			CompleteReadWeight(short errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice);
+	short			DownloadFirmware(const AdcFirmware &firmware, const short force, const short window, AdcUpdateProgressCallback callback, void *ctx);
 
-    mutex           m_mutex;
+    AdcRequestMutex m_mutex;		// requests to the adc, see StartReadWeight
 
 	string			m_adcName;
 	string			m_protocolType;
@@ -131,6 +183,9 @@ private:
 	AdcTilt			*m_tilt;
 	AdcOperatingMode m_opMode;
 	double			m_bootLoaderVersion;
+	AdcWeightStream	*m_weightStream;
+	AdcDiagnosticSampler *m_diagnosticSampler;
+	AdcShared		m_shared;			// weight snapshot for other processes
 
 	map<long, map<string, AdcSensorHealth>>	m_sensorHealth;
 };
@@ -0,0 +1,87 @@
+/**
+******************************************************************************
+* File       : larstable.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : larstable class: handle table of all open adc
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include <atomic>
+#include <mutex>
+using namespace std;
+
+class Lars;
+class LarsRef;
+
+class LarsTable
+{
+public:
+	static const short	MAX_HANDLES = 64;		// max. number of open adc
+
+	LarsTable();
+	~LarsTable();
+
+	short			Insert(Lars *lars, short *handle);
+	Lars			*Remove(const short handle);
+	LarsRef			Acquire(const short handle);
+	bool			IsOpen(const string &adcName);
+
+private:
+	friend class LarsRef;
+
+	// handle: generation in the upper bits, slot index in the lower bits
+	static const short	SLOT_BITS = 6;
+	static const short	SLOT_MASK = (1 << SLOT_BITS) - 1;
+	static const short	GENERATION_MASK = 0x7FFF >> SLOT_BITS;
+
+	typedef struct
+	{
+		atomic<Lars *>			lars;
+		atomic<unsigned short>	generation;		// odd: slot is in use
+		atomic<long>			refCount;		// running calls of the application
+	} Slot;
+
+	void			Release(const short handle);
+
+	Slot			m_slots[MAX_HANDLES];
+	mutex			m_mutex;					// serializes Insert and Remove
+};
+
+
+/**
+******************************************************************************
+* LarsRef - reference to an open adc, keeps the lars object alive
+*
+* @remarks	the reference is released when the object goes out of scope,
+*			AdcClose waits until all references are released
+******************************************************************************
+*/
+class LarsRef
+{
+public:
+	LarsRef();
+	LarsRef(LarsRef &&ref);
+	~LarsRef();
+
+	LarsRef			&operator=(LarsRef &&ref);
+	operator		Lars *() const { return m_lars; }
+	Lars			*operator->() const { return m_lars; }
+
+private:
+	friend class LarsTable;
+
+	LarsRef(LarsTable *table, const short handle, Lars *lars);
+	LarsRef(const LarsRef &) = delete;
+	LarsRef			&operator=(const LarsRef &) = delete;
+
+	void			Release();
+
+	LarsTable		*m_table;
+	short			m_handle;
+	Lars			*m_lars;
+};
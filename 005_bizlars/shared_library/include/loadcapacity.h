@@ -3,6 +3,7 @@
 #include <map>
 #include "bizlars.h"
 #include "countrysettings.h"
+#include "adcfilecache.h"
 
 using namespace std;
 
@@ -40,8 +41,7 @@ public:
 	static const long DEFAULT_DIGITS_RESOLUTION;
 
 private:
-	bool Parse(string &fileContent, const string &loadCapacity, const map<string, string> *regParamMap = NULL);
-    void RemoveCR(string &str);
+	bool Parse(const AdcFileCache::Content &content, const string &loadCapacity, const map<string, string> *regParamMap = NULL);
 	void BuildCalStrings();
 	template <typename T> void GetValue(const string &key, T &value);
 	void GetValue(const string &key, string &value);
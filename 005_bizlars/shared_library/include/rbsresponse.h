@@ -0,0 +1,68 @@
+/**
+******************************************************************************
+* File       : rbsresponse.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : rbsresponse class: parse rbs telegrams in place without copies
+******************************************************************************
+*/
+#pragma once
+#include <string>
+using namespace std;
+
+
+// part of a received telegram, points into the receive buffer
+struct RbsField
+{
+	const char		*data;
+	unsigned long	size;
+
+	bool			Empty() const { return size == 0; }
+	bool			Equals(const string &str) const;
+	RbsField		Position(short pos) const;
+	bool			GetLongLong(long long *value) const;
+	bool			GetULongLong(unsigned long long *value) const;
+	bool			GetShort(short *value) const;
+	bool			GetUShort(unsigned short *value) const;
+	bool			GetString(char *str, unsigned long strSize) const;
+	string			ToString() const { return string(data, size); }
+};
+
+
+class RbsResponse
+{
+public:
+	static const short	IDX_LENGTH = 0;				// header fields
+	static const short	IDX_ORDERID = 1;
+	static const short	MAX_HEADER_FIELDS = 4;
+	static const short	MAX_FIELDS = 256;			// max. key value pairs of a telegram
+
+	RbsResponse();
+	~RbsResponse();
+
+	short			Parse(const char *telegram, unsigned long size);
+	void			Clear();
+
+	const RbsField	*Find(const string &key) const;
+	short			GetFieldCount() const;
+	const RbsField	&GetKey(short idx) const;
+	const RbsField	&GetValue(short idx) const;
+	const RbsField	*GetHeader(short idx) const;
+	const RbsField	&GetCmd() const;
+	const RbsField	*GetCrc16() const;
+	bool			GetCrcRange(const char **data, unsigned long *size) const;
+
+private:
+	const char		*m_telegram;
+	unsigned long	m_size;
+	RbsField		m_header[MAX_HEADER_FIELDS];
+	short			m_headerCount;
+	RbsField		m_cmd;
+	RbsField		m_crc16;
+	RbsField		m_key[MAX_FIELDS];
+	RbsField		m_value[MAX_FIELDS];
+	short			m_fieldCount;
+};
@@ -0,0 +1,53 @@
+/**
+******************************************************************************
+* File       : rbstelegram.h
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : rbstelegram class: build rbs telegrams in a preallocated buffer
+******************************************************************************
+*/
+#pragma once
+#include <string>
+#include "authentication.h"
+using namespace std;
+
+// defines for RBS CRC16
+#define RBS_CRC_START      0x6621      /* start value for the Polynomial */
+#define RBS_CRC_POLY       0x7102      /* Polynomial-coeffizient */
+#define RBS_CRC_MASK       0x0000      /* Mask for the Polynomial */
+
+
+class RbsTelegram
+{
+public:
+	static const unsigned long	TELEGRAM_SIZE = 0x10000;	// max. size of a telegram
+
+	RbsTelegram();
+	~RbsTelegram();
+
+	void			Begin(short orderID, unsigned long flag, const string &cmd);
+	void			AddReferenceData(const string &key, const string &value);
+	bool			End(bool crc16);
+
+	const char		*GetData() const;
+	unsigned long	GetSize() const;
+	bool			Overflow() const;
+
+private:
+	static const unsigned long	MAX_LENGTH_DIGITS = 10;		// reserved space for SOH and length in front of the telegram
+
+	void			Append(char value);
+	void			Append(const char *value, unsigned long size);
+	void			AppendNumber(unsigned long value, bool crc16 = true);
+
+	char			m_buffer[MAX_LENGTH_DIGITS + TELEGRAM_SIZE + 1];
+	unsigned long	m_start;			// index of SOH
+	unsigned long	m_end;				// index behind the last character
+	bool			m_refData;			// reference data block is open
+	bool			m_overflow;
+	unsigned short	m_crc;				// crc over the telegram written so far
+	Authentication	m_crc16;
+};
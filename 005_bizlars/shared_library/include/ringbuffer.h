@@ -1,17 +1,31 @@
 #pragma once
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <string.h>
 using namespace std;
 
+// single producer / single consumer ring buffer for trivially copyable data
+// one thread may call SetData, one other thread GetData/Clear/WaitForLevel
 template <typename T>
 class RingBuffer
 {
 public:
 	RingBuffer(unsigned long len)
 	{
-		size = len;
+		// use a power of two, so the index wrap around is a simple mask
+		size = 1;
+		while (size < len)
+			size <<= 1;
+		mask = size - 1;
+
 		dataArray = new T[size];
 
-		Clear();
+		m_head.index = 0;
+		m_tail.index = 0;
+		m_waiters = 0;
+		m_notifyCount = 0;
 	}
 
 	~RingBuffer()
@@ -23,83 +37,121 @@ public:
 		}
 	}
 
+	// drop all data, called by the consumer
 	void Clear()
 	{
-		m_mutex.lock();
-
-		for (unsigned long idx = 0; idx < size; idx++)
-			dataArray[idx] = 0;
-
-		inIndex = 0;
-		outIndex = 0;
-		level = 0;
-
-		m_mutex.unlock();
+		m_tail.index.store(m_head.index.load(memory_order_acquire), memory_order_release);
 	}
 
 	unsigned long GetLevel()
 	{
-		unsigned long tmpLevel;
-
-		m_mutex.lock();
-
-		tmpLevel = level;
-
-		m_mutex.unlock();
-
-		return tmpLevel;
+		return m_head.index.load(memory_order_acquire) - m_tail.index.load(memory_order_acquire);
 	}
 
 
 	bool SetData(T *pData, unsigned long len)
 	{
-		m_mutex.lock();
+		unsigned long head = m_head.index.load(memory_order_relaxed);
+		unsigned long tail = m_tail.index.load(memory_order_acquire);
+		unsigned long offset;
+		unsigned long first;
 
 		// check size
-		if (len > size - level)
+		if (len > size - (head - tail))
 			return false;
 
-		// input data
-		for (unsigned long idx = 0; idx < len; idx++)
+		// copy data in max. two segments
+		offset = head & mask;
+		first = (len < size - offset) ? len : size - offset;
+		memcpy(&dataArray[offset], pData, first * sizeof(T));
+		memcpy(dataArray, pData + first, (len - first) * sizeof(T));
+
+		m_head.index.store(head + len, memory_order_release);
+
+		// wake up a waiting consumer
+		atomic_thread_fence(memory_order_seq_cst);
+		if (m_waiters.load(memory_order_relaxed) > 0)
 		{
-			dataArray[inIndex++] = pData[idx];
-			if (inIndex == size) inIndex = 0;
-			level++;
+			m_mutex.lock();
+			m_mutex.unlock();
+			m_cond.notify_all();
 		}
 
-		m_mutex.unlock();
-
 		return true;
 	}
 
 
 	unsigned long GetData(T *pData, unsigned long len)
 	{
-		unsigned long idx = 0;
+		unsigned long tail = m_tail.index.load(memory_order_relaxed);
+		unsigned long head = m_head.index.load(memory_order_acquire);
+		unsigned long offset;
+		unsigned long first;
 
-		m_mutex.lock();
+		if (len > head - tail)
+			len = head - tail;
 
-		while (level && len)
-		{
-			pData[idx++] = dataArray[outIndex++];
-			if (outIndex == size) outIndex = 0;
-			level--;
-			len--;
-		}
+		// copy data in max. two segments
+		offset = tail & mask;
+		first = (len < size - offset) ? len : size - offset;
+		memcpy(pData, &dataArray[offset], first * sizeof(T));
+		memcpy(pData + first, dataArray, (len - first) * sizeof(T));
 
-		m_mutex.unlock();
+		m_tail.index.store(tail + len, memory_order_release);
 
-		return idx;
+		return len;
+	}
+
+
+	// wait until at least len elements are available, Notify() cancels the wait
+	bool WaitForLevel(unsigned long len, unsigned long timeout)
+	{
+		unsigned long notifyCount = m_notifyCount.load();
+
+		if (GetLevel() >= len)
+			return true;
+
+		unique_lock<mutex> lock(m_mutex);
+		m_waiters.fetch_add(1);
+		atomic_thread_fence(memory_order_seq_cst);
+
+		m_cond.wait_for(lock, chrono::milliseconds(timeout), [&] { return (GetLevel() >= len) || (m_notifyCount.load() != notifyCount); });
+
+		m_waiters.fetch_sub(1);
+
+		return (GetLevel() >= len);
+	}
+
+
+	// wake up all waiting consumers
+	void Notify()
+	{
+		m_notifyCount.fetch_add(1);
+
+		m_mutex.lock();
+		m_mutex.unlock();
+		m_cond.notify_all();
 	}
 
 private:
+	static const unsigned long CACHE_LINE_SIZE = 64;
+
+	// producer and consumer index on separate cache lines
+	struct Index
+	{
+		atomic<unsigned long>	index;
+		char					padding[CACHE_LINE_SIZE - sizeof(atomic<unsigned long>)];
+	};
+
+	Index			m_head;				// written by the producer
+	Index			m_tail;				// written by the consumer
 
 	T				*dataArray;
-	unsigned long	inIndex;
-	unsigned long	outIndex;
-	unsigned long	level;
 	unsigned long	size;
+	unsigned long	mask;
 
-	mutex           m_mutex;
+	atomic<long>			m_waiters;
+	atomic<unsigned long>	m_notifyCount;
+	mutex           		m_mutex;
+	condition_variable		m_cond;
 };
-
@@ -0,0 +1,687 @@
+/**
+******************************************************************************
+* File       : adccountryindex.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adccountryindex class: index of the country settings files of
+*              a directory with their compatible load capacities
+******************************************************************************
+*/
+#ifdef  _MSC_VER
+#include <Windows.h>
+#endif
+#ifdef __GNUC__
+#include <dirent.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include "larsErr.h"
+#include "adctrace.h"
+#include "adcfilecache.h"
+#include "crypto.h"
+#include "adccountryindex.h"
+
+AdcCountryIndex g_adcCountryIndex;
+
+const string AdcCountryIndex::INDEX_FILE = ".bizlars_countryindex";
+const string AdcCountryIndex::FILE_PATTERN = "countrysettings_";
+const string AdcCountryIndex::INDEX_HEADER = "bizlars country index 2";
+
+
+AdcCountryIndex::AdcCountryIndex()
+{
+#ifdef __linux__
+	m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#else
+	m_inotify = -1;
+#endif
+}
+
+AdcCountryIndex::~AdcCountryIndex()
+{
+#ifdef __linux__
+	if (m_inotify >= 0)
+		close(m_inotify);
+#endif
+}
+
+
+/**
+******************************************************************************
+* GetCountries - get the countries of a directory
+*
+* @param    path:in			directory of the country settings files, empty: current directory
+* @param    countries:out	iso codes of all country settings files
+*
+* @return   void
+* @remarks	served from memory, the directory is read only if it has changed
+******************************************************************************
+*/
+void AdcCountryIndex::GetCountries(const string &path, vector<string> &countries)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	Directory &directory = GetDirectory(path);
+
+	countries.clear();
+	for (map<string, Entry>::const_iterator it = directory.files.begin(); it != directory.files.end(); ++it)
+	{
+		countries.push_back(it->second.country);
+	}
+}
+
+
+/**
+******************************************************************************
+* GetLoadCapacities - get the compatible load capacities of a country
+*
+* @param    path:in				directory of the country settings files
+* @param    country:in			iso code
+* @param    loadCapacities:out	load capacities and their files
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_FILE_NOT_FOUND
+*			LarsErr::E_FILE_CORRUPT
+* @remarks	the country file is decrypted only when it is added or changed,
+*			the load capacities of the index file are authenticated, see Load
+******************************************************************************
+*/
+short AdcCountryIndex::GetLoadCapacities(const string &path, const string &country, LoadCapacities &loadCapacities)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	Directory &directory = GetDirectory(path);
+
+	loadCapacities.clear();
+
+	map<string, Entry>::const_iterator it = directory.files.find(FILE_PATTERN + country + ".txt");
+	if (it == directory.files.end())
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	if (it->second.errorCode == LarsErr::E_SUCCESS)
+		loadCapacities = it->second.loadCapacities;
+
+	return it->second.errorCode;
+}
+
+
+/**
+******************************************************************************
+* GetDirectory - get the up to date index of a directory
+*
+* @param    path:in			directory
+*
+* @return   index
+* @remarks	the first call loads the index file and checks every file with
+*			stat, then only the files reported by inotify are checked.
+*			Without inotify every call checks all files with stat.
+*			m_mutex must be locked.
+******************************************************************************
+*/
+AdcCountryIndex::Directory &AdcCountryIndex::GetDirectory(const string &path)
+{
+	map<string, Directory>::iterator it = m_directories.find(path);
+
+	if (it == m_directories.end())
+	{
+		Directory &directory = m_directories[path];
+
+		directory.modified = -1;
+		directory.watch = -1;
+		directory.rescan = true;
+
+#ifdef __linux__
+		// watch before the check, so no change is lost
+		if (m_inotify >= 0)
+		{
+			directory.watch = inotify_add_watch(m_inotify, path.empty() ? "./" : path.c_str(),
+												IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+			if (directory.watch >= 0)
+				m_watches[directory.watch] = path;
+		}
+#endif
+
+		// files may have changed while no process was watching
+		if (Load(path, directory))
+		{
+			for (map<string, Entry>::const_iterator file = directory.files.begin(); file != directory.files.end(); ++file)
+				directory.changed.insert(file->first);
+		}
+
+		if (Validate(path, directory))
+			Save(path, directory);
+
+		return directory;
+	}
+
+	ReadEvents();
+
+	if ((it->second.watch < 0) || it->second.rescan || !it->second.changed.empty())
+	{
+		if (Validate(path, it->second))
+			Save(path, it->second);
+	}
+
+	return it->second;
+}
+
+
+/**
+******************************************************************************
+* Validate - bring the index of a directory up to date
+*
+* @param    path:in			directory
+* @param    directory:in/out	index
+*
+* @return   true: entries of the index have changed
+* @remarks	the directory is read only if its modification time has changed,
+*			otherwise the changed files or, without inotify, all files are
+*			checked with stat. A new time of the directory alone is no
+*			change, e.g. the rename of the index file by Save.
+******************************************************************************
+*/
+bool AdcCountryIndex::Validate(const string &path, Directory &directory)
+{
+	bool			changed = false;
+	long long		modified;
+	long long		size;
+	vector<string>	fileNames;
+
+	if (!GetFileState(path.empty() ? "./" : path, &modified, &size))
+	{
+		changed = !directory.files.empty();
+		directory.files.clear();
+		directory.changed.clear();
+		directory.modified = -1;
+		directory.rescan = true;
+		return changed;
+	}
+
+	if (directory.rescan || (modified != directory.modified))
+	{
+		set<string>		found;
+
+		ListFiles(path, fileNames);
+		for (size_t idx = 0; idx < fileNames.size(); idx++)
+		{
+			found.insert(fileNames[idx]);
+			changed |= UpdateFile(path, fileNames[idx], directory);
+		}
+
+		for (map<string, Entry>::iterator it = directory.files.begin(); it != directory.files.end();)
+		{
+			if (found.find(it->first) == found.end())
+			{
+				it = directory.files.erase(it);
+				changed = true;
+			}
+			else
+				++it;
+		}
+
+		directory.modified = modified;
+		directory.rescan = false;
+	}
+	else if (directory.watch >= 0)
+	{
+		for (set<string>::const_iterator it = directory.changed.begin(); it != directory.changed.end(); ++it)
+			changed |= UpdateFile(path, *it, directory);
+	}
+	else
+	{
+		for (map<string, Entry>::const_iterator it = directory.files.begin(); it != directory.files.end(); ++it)
+			fileNames.push_back(it->first);
+		for (size_t idx = 0; idx < fileNames.size(); idx++)
+			changed |= UpdateFile(path, fileNames[idx], directory);
+	}
+
+	directory.changed.clear();
+
+	return changed;
+}
+
+
+/**
+******************************************************************************
+* UpdateFile - check one country settings file
+*
+* @param    path:in			directory
+* @param    fileName:in		name of the file
+* @param    directory:in/out	index
+*
+* @return   true: index has changed
+* @remarks	a file with new time or size but the same hash is not decrypted
+******************************************************************************
+*/
+bool AdcCountryIndex::UpdateFile(const string &path, const string &fileName, Directory &directory)
+{
+	string			country;
+	string			filePath = GetFilePath(path, fileName);
+	long long		modified;
+	long long		size;
+	unsigned long long	hash = 0;
+	Entry			entry;
+	bool			loadCapacities = false;
+	shared_ptr<const AdcFileCache::Content> content;
+
+	if (!GetCountry(fileName, country))
+		return false;
+
+	if (!GetFileState(filePath, &modified, &size))
+		return directory.files.erase(fileName) != 0;
+
+	map<string, Entry>::iterator it = directory.files.find(fileName);
+	if ((it != directory.files.end()) && (it->second.modified == modified) && (it->second.size == size))
+		return false;
+
+	entry.country = country;
+	entry.modified = modified;
+	entry.size = size;
+	entry.hash = 0;
+	entry.errorCode = LarsErr::E_FILE_NOT_FOUND;
+
+	if (GetHash(filePath, &hash))
+	{
+		if ((it != directory.files.end()) && (it->second.hash == hash))
+		{
+			// only copied or touched
+			it->second.modified = modified;
+			it->second.size = size;
+			return true;
+		}
+
+		entry.hash = hash;
+		entry.errorCode = g_adcFileCache.Read(filePath, content);
+	}
+
+	if (entry.errorCode == LarsErr::E_SUCCESS)
+	{
+		// section [load capacities] of the country settings file
+		for (AdcFileCache::Content::const_iterator row = content->begin(); row != content->end(); ++row)
+		{
+			if (!row->keyValue && (row->key == "[load capacities]"))
+				loadCapacities = true;
+			else if (!row->keyValue && ((row->key == "[country settings " + country + "]") || (row->key == "[registration parameters]")))
+				loadCapacities = false;
+			else if (loadCapacities && row->keyValue)
+				entry.loadCapacities[row->key] = row->value;
+		}
+	}
+	else
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't read %s, error %d", __FUNCTION__, filePath.c_str(), entry.errorCode);
+	}
+
+	directory.files[fileName] = entry;
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* ReadEvents - collect the changes reported by inotify
+*
+* @return   void
+* @remarks	non blocking, m_mutex must be locked
+******************************************************************************
+*/
+void AdcCountryIndex::ReadEvents()
+{
+#ifdef __linux__
+	char		buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	ssize_t		len;
+	string		country;
+	const struct inotify_event *event;
+
+	if (m_inotify < 0)
+		return;
+
+	while ((len = read(m_inotify, buffer, sizeof(buffer))) > 0)
+	{
+		for (char *ptr = buffer; ptr < buffer + len; ptr += sizeof(struct inotify_event) + event->len)
+		{
+			event = (const struct inotify_event *)ptr;
+
+			// events are lost, read all directories again
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				for (map<string, Directory>::iterator it = m_directories.begin(); it != m_directories.end(); ++it)
+					it->second.rescan = true;
+				continue;
+			}
+
+			map<int, string>::iterator watch = m_watches.find(event->wd);
+			if (watch == m_watches.end())
+				continue;
+
+			Directory &directory = m_directories[watch->second];
+
+			if (event->mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))
+			{
+				// directory is gone, check with stat from now on
+				directory.rescan = true;
+				if (event->mask & IN_IGNORED)
+				{
+					directory.watch = -1;
+					m_watches.erase(watch);
+				}
+				continue;
+			}
+
+			if (event->len && GetCountry(event->name, country))
+				directory.changed.insert(event->name);
+		}
+	}
+#endif
+}
+
+
+/**
+******************************************************************************
+* Load - read the index file of a directory
+*
+* @param    path:in			directory
+* @param    directory:out	index
+*
+* @return   true: index file is valid
+* @remarks	line 1: header, line 2: time of the directory, then one line per
+*			file: name, country, time, size, hash, errorCode, load capacities
+*			as load capacity=file, all fields separated by tab. The last line
+*			is the mac of all lines before, an index file that is not written
+*			by the library is ignored like the settings files it replaces.
+******************************************************************************
+*/
+bool AdcCountryIndex::Load(const string &path, Directory &directory)
+{
+	ifstream		input(GetFilePath(path, INDEX_FILE).c_str(), ios::binary);
+	stringstream	content;
+	string			data;
+	string			line;
+	string			field;
+	string			fileName;
+	Entry			entry;
+	size_t			separator;
+	Crypto			cryptVar;
+
+	if (!input.is_open() || !(content << input.rdbuf()))
+		return false;
+
+	// split off the mac line
+	data = content.str();
+	if ((data.size() < 2) || (data[data.size() - 1] != '\n') ||
+		((separator = data.rfind('\n', data.size() - 2)) == string::npos) ||
+		!cryptVar.VerifyMAC(data.substr(0, separator + 1), data.substr(separator + 1, data.size() - separator - 2)))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tindex of %s not authentic", __FUNCTION__, path.c_str());
+		return false;
+	}
+
+	istringstream	file(data.substr(0, separator + 1));
+
+	if (!getline(file, line) || (line != INDEX_HEADER) || !getline(file, line))
+		return false;
+
+	try
+	{
+		directory.modified = stoll(line);
+
+		while (getline(file, line))
+		{
+			istringstream	fields(line);
+
+			if (!getline(fields, fileName, '\t') || !getline(fields, entry.country, '\t'))
+				throw invalid_argument("index line");
+
+			getline(fields, field, '\t');
+			entry.modified = stoll(field);
+			getline(fields, field, '\t');
+			entry.size = stoll(field);
+			getline(fields, field, '\t');
+			entry.hash = stoull(field, NULL, 16);
+			getline(fields, field, '\t');
+			entry.errorCode = (short)stoi(field);
+
+			entry.loadCapacities.clear();
+			while (getline(fields, field, '\t'))
+			{
+				if ((separator = field.find('=')) != string::npos)
+					entry.loadCapacities[field.substr(0, separator)] = field.substr(separator + 1);
+			}
+
+			directory.files[fileName] = entry;
+		}
+	}
+	catch (std::exception &e)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tindex of %s invalid: %s", __FUNCTION__, path.c_str(), e.what());
+		directory.files.clear();
+		directory.modified = -1;
+		return false;
+	}
+
+	directory.rescan = false;
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* Save - write the index file of a directory
+*
+* @param    path:in			directory
+* @param    directory:in/out	index, the time of the directory is updated
+*
+* @return   void
+* @remarks	written to a temporary file with a unique name and renamed, so
+*			processes and hosts that share the directory don't write into
+*			the same file. A read only directory keeps the index only in memory.
+******************************************************************************
+*/
+void AdcCountryIndex::Save(const string &path, Directory &directory)
+{
+	string			fileName = GetFilePath(path, INDEX_FILE);
+	string			tmpFileName;
+	ostringstream	content;
+	string			data;
+	string			mac;
+	long long		size;
+	char			hash[32];
+	FILE			*file = NULL;
+	Crypto			cryptVar;
+
+	content << INDEX_HEADER << "\n" << directory.modified << "\n";
+	for (map<string, Entry>::const_iterator it = directory.files.begin(); it != directory.files.end(); ++it)
+	{
+		snprintf(hash, sizeof(hash), "%016llx", it->second.hash);
+		content << it->first << "\t" << it->second.country << "\t" << it->second.modified << "\t" << it->second.size << "\t" << hash << "\t" << it->second.errorCode;
+		for (LoadCapacities::const_iterator lc = it->second.loadCapacities.begin(); lc != it->second.loadCapacities.end(); ++lc)
+			content << "\t" << lc->first << "=" << lc->second;
+		content << "\n";
+	}
+	data = content.str();
+	cryptVar.CreateMAC(data, mac);
+	data += mac + "\n";
+
+#ifdef _MSC_VER
+	char	tmpName[MAX_PATH];
+
+	if (GetTempFileNameA(path.empty() ? "." : path.c_str(), "bci", 0, tmpName) != 0)
+	{
+		tmpFileName = tmpName;
+		file = fopen(tmpName, "wb");
+	}
+#else
+	int		fd;
+
+	tmpFileName = fileName + ".XXXXXX";
+	if ((fd = mkstemp(&tmpFileName[0])) >= 0)
+	{
+		fchmod(fd, 0644);
+		if ((file = fdopen(fd, "wb")) == NULL)
+			close(fd);
+	}
+	else
+	{
+		tmpFileName.clear();
+	}
+#endif
+
+	if (!file)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tcan't write the index of %s", __FUNCTION__, path.c_str());
+		if (!tmpFileName.empty())
+			remove(tmpFileName.c_str());
+		return;
+	}
+
+	if ((fwrite(data.data(), 1, data.size(), file) != data.size()) || ferror(file))
+	{
+		fclose(file);
+		remove(tmpFileName.c_str());
+		return;
+	}
+
+	if ((fclose(file) != 0) || (rename(tmpFileName.c_str(), fileName.c_str()) != 0))
+	{
+		remove(tmpFileName.c_str());
+		return;
+	}
+
+	// the rename changes the directory, that is not a change of the country files.
+	// The index file keeps the old time, the next process reads the directory once,
+	// finds the same entries and doesn't write the index again, see Validate.
+	GetFileState(path.empty() ? "./" : path, &directory.modified, &size);
+}
+
+
+string AdcCountryIndex::GetFilePath(const string &path, const string &fileName)
+{
+	return path.empty() ? fileName : path + "/" + fileName;
+}
+
+
+/**
+******************************************************************************
+* GetCountry - get the iso code from the name of a country settings file
+*
+* @param    fileName:in		name of the file, e.g. countrysettings_DE.txt
+* @param    country:out		iso code
+*
+* @return   true: country settings file
+* @remarks
+******************************************************************************
+*/
+bool AdcCountryIndex::GetCountry(const string &fileName, string &country)
+{
+	size_t	pos1, pos2;
+
+	if (fileName.find(FILE_PATTERN) == string::npos)
+		return false;
+
+	pos1 = fileName.find_last_of('_');
+	pos2 = fileName.find_last_of('.');
+	if ((pos1 == string::npos) || (pos2 == string::npos))
+		return false;
+
+	country = fileName.substr(pos1 + 1, pos2 - pos1 - 1);
+	return true;
+}
+
+
+void AdcCountryIndex::ListFiles(const string &path, vector<string> &fileNames)
+{
+	string		country;
+
+	fileNames.clear();
+
+#ifdef _MSC_VER
+    WIN32_FIND_DATAA fileData;
+    HANDLE hFind;
+    string filePattern = GetFilePath(path.empty() ? "." : path, FILE_PATTERN + "*.txt");
+
+    if ((hFind = FindFirstFileA(filePattern.c_str(), &fileData)) != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            // check for file
+            if (!(fileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && GetCountry(fileData.cFileName, country))
+				fileNames.push_back(fileData.cFileName);
+        } while (FindNextFileA(hFind, &fileData));
+
+		FindClose(hFind);
+    }
+#endif
+
+#ifdef __GNUC__
+    DIR 			*dp;
+    struct dirent 	*dirp;
+
+    if ((dp = opendir(path.empty() ? "./" : path.c_str())) != NULL)
+    {
+        while ((dirp = readdir(dp)) != NULL)
+        {
+			if (GetCountry(dirp->d_name, country))
+				fileNames.push_back(dirp->d_name);
+        }
+
+		closedir(dp);
+    }
+#endif
+}
+
+
+bool AdcCountryIndex::GetFileState(const string &fileName, long long *modified, long long *size)
+{
+	struct stat		fileState;
+
+	if (stat(fileName.c_str(), &fileState) != 0)
+		return false;
+
+#ifdef __GNUC__
+	*modified = (long long)fileState.st_mtim.tv_sec * 1000000000LL + fileState.st_mtim.tv_nsec;
+#else
+	*modified = (long long)fileState.st_mtime * 1000000000LL;
+#endif
+	*size = (long long)fileState.st_size;
+
+	return true;
+}
+
+
+bool AdcCountryIndex::GetHash(const string &fileName, unsigned long long *hash)
+{
+	FILE			*file;
+	unsigned char	buffer[4096];
+	size_t			len;
+	bool			ok;
+
+	if ((file = fopen(fileName.c_str(), "rb")) == NULL)
+		return false;
+
+	// fnv-1a 64 bit
+	*hash = 0xcbf29ce484222325ULL;
+	while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+	{
+		for (size_t idx = 0; idx < len; idx++)
+		{
+			*hash ^= buffer[idx];
+			*hash *= 0x100000001b3ULL;
+		}
+	}
+	ok = !ferror(file);
+	fclose(file);
+
+	return ok;
+}
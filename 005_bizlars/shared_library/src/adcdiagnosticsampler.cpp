@@ -0,0 +1,194 @@
+/**
+******************************************************************************
+* File       : adcdiagnosticsampler.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcdiagnosticsampler class: read the diagnostic data
+*              periodically and keep the latest snapshot
+******************************************************************************
+*/
+#include "larsErr.h"
+#include "adctrace.h"
+#include "lars.h"
+#include "adcdiagnosticsampler.h"
+
+
+AdcDiagnosticSampler::AdcDiagnosticSampler(Lars *lars)
+{
+	m_lars = lars;
+	m_count = 0;
+	m_errorCode = LarsErr::E_SUCCESS;
+	m_sampled = false;
+	m_interval = 0;
+	m_run = false;
+}
+
+AdcDiagnosticSampler::~AdcDiagnosticSampler()
+{
+	Stop();
+}
+
+
+/**
+******************************************************************************
+* Start - start the sampler thread or change its interval
+*
+* @param    interval:in		sample interval in ms
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+* @remarks	the first sample is read immediately
+******************************************************************************
+*/
+short AdcDiagnosticSampler::Start(unsigned long interval)
+{
+	if (!interval)
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if (interval < MIN_INTERVAL)
+		interval = MIN_INTERVAL;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	m_interval = interval;
+	m_next = chrono::steady_clock::now();
+
+	if (!m_run)
+	{
+		m_run = true;
+		m_count = 0;
+		m_sampled = false;
+		m_thread = thread(&AdcDiagnosticSampler::SamplerThread, this);
+	}
+
+	m_cond.notify_all();
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* Stop - stop the sampler thread
+*
+* @return   void
+* @remarks	a sample in work is finished first
+******************************************************************************
+*/
+void AdcDiagnosticSampler::Stop()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		m_run = false;
+		m_cond.notify_all();
+	}
+
+	if (m_thread.joinable())
+		m_thread.join();
+}
+
+
+/**
+******************************************************************************
+* GetSample - copy the latest snapshot
+*
+* @param    sensorHealth:out	diagnostic values, sorted by name
+* @param    count:in/out		in: size of sensorHealth, out: number of records
+* @param    age:out				ms since the snapshot was read, may be NULL
+*
+* @return   errorCode of the latest sample
+*			LarsErr::E_INVALID_PARAMETER	sampler not started
+*			LarsErr::E_NOT_ENOUGH_MEMORY	sensorHealth is too small, count is the required size
+* @remarks	waits for the first sample after Start. If the latest sample
+*			failed, the records of the last successful one are returned.
+******************************************************************************
+*/
+short AdcDiagnosticSampler::GetSample(AdcSensorHealth *sensorHealth, short *count, unsigned long *age)
+{
+	if (!count || ((*count > 0) && !sensorHealth))
+		return LarsErr::E_INVALID_PARAMETER;
+
+	unique_lock<mutex> lock(m_mutex);
+
+	while (m_run && !m_sampled)
+		m_cond.wait(lock);
+
+	if (!m_sampled)
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if (*count < m_count)
+	{
+		*count = m_count;
+		return LarsErr::E_NOT_ENOUGH_MEMORY;
+	}
+
+	for (short idx = 0; idx < m_count; idx++)
+		sensorHealth[idx] = m_snapshot[idx];
+	*count = m_count;
+
+	if (age)
+		*age = (unsigned long)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - m_sampleTime).count();
+
+	return m_errorCode;
+}
+
+
+/**
+******************************************************************************
+* SamplerThread - read all diagnostic values every interval
+*
+* @return   void
+* @remarks	the read is serialized with all other requests by the mutex of
+*			Lars, m_mutex is not locked during the read
+******************************************************************************
+*/
+void AdcDiagnosticSampler::SamplerThread()
+{
+	short		errorCode;
+	short		count;
+	chrono::steady_clock::time_point now;
+
+	unique_lock<mutex> lock(m_mutex);
+
+	while (m_run)
+	{
+		now = chrono::steady_clock::now();
+		if (now < m_next)
+		{
+			m_cond.wait_until(lock, m_next);
+			continue;
+		}
+
+		// don't try to catch up if the read took longer than the interval
+		m_next += chrono::milliseconds(m_interval);
+		if (m_next < now) m_next = now + chrono::milliseconds(m_interval);
+		lock.unlock();
+
+		count = DIA_MAX_SENSOR_HEALTH;
+		errorCode = m_lars->GetDiagnosticSnapshot(NULL, m_sample, &count);
+		if (errorCode != LarsErr::E_SUCCESS)
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tsample failed, errorCode: %d", __FUNCTION__, errorCode);
+
+		lock.lock();
+		if (errorCode == LarsErr::E_SUCCESS)
+		{
+			for (short idx = 0; idx < count; idx++)
+				m_snapshot[idx] = m_sample[idx];
+			m_count = count;
+			m_sampleTime = chrono::steady_clock::now();
+		}
+		else if (!m_sampled)
+		{
+			m_sampleTime = chrono::steady_clock::now();
+		}
+		m_errorCode = errorCode;
+		m_sampled = true;
+		m_cond.notify_all();
+	}
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tdiagnostic sampler stopped", __FUNCTION__);
+}
@@ -0,0 +1,213 @@
+/**
+******************************************************************************
+* File       : adcfilecache.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcfilecache class: decrypted and split settings files, shared
+*              by all adc of the process
+******************************************************************************
+*/
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "larsErr.h"
+#include "crypto.h"
+#include "adctrace.h"
+#include "adcfilecache.h"
+
+AdcFileCache g_adcFileCache;
+
+
+AdcFileCache::AdcFileCache()
+{
+	m_useCounter = 0;
+}
+
+AdcFileCache::~AdcFileCache()
+{
+}
+
+
+/**
+******************************************************************************
+* Read - get the decrypted lines of an encrypted settings file
+*
+* @param    fileName:in		path of the file
+* @param    content:out		lines of the file, must not be changed
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_FILE_NOT_FOUND
+*			LarsErr::E_FILE_CORRUPT
+* @remarks	see Read with loader
+******************************************************************************
+*/
+short AdcFileCache::Read(const string &fileName, shared_ptr<const Content> &content)
+{
+	return Read(fileName, content, LoadEncryptedFile);
+}
+
+
+/**
+******************************************************************************
+* Read - get the content of a file from the cache or the loader
+*
+* @param    fileName:in		path of the file, key of the cache
+* @param    content:out		content of the file, must not be changed
+* @param    loader:in		reads the file if it is not in the cache
+*
+* @return   errorCode of the loader
+* @remarks	an entry is valid as long as modification time, size and inode
+*			of the file are the same, so the check costs one stat. Errors are
+*			not cached. The content stays valid for the caller even if the
+*			entry is replaced.
+******************************************************************************
+*/
+short AdcFileCache::Read(const string &fileName, shared_ptr<const Content> &content, const Loader &loader)
+{
+	short			errorCode;
+	Entry			state;
+	Entry			after;
+	shared_ptr<Content>	loaded;
+
+	content.reset();
+
+	if (!GetFileState(fileName, state))
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		auto it = m_entries.find(fileName);
+		if ((it != m_entries.end()) && (it->second.modified == state.modified) &&
+			(it->second.size == state.size) && (it->second.inode == state.inode))
+		{
+			it->second.lastUse = ++m_useCounter;
+			content = it->second.content;
+			return LarsErr::E_SUCCESS;
+		}
+	}
+
+	// decrypt without lock, other files can be read in the meantime
+	loaded = make_shared<Content>();
+	if ((errorCode = loader(fileName, *loaded)) != LarsErr::E_SUCCESS)
+		return errorCode;
+
+	content = loaded;
+
+	// a file that is written while it is read is not cached
+	if (!GetFileState(fileName, after) || (after.modified != state.modified) || (after.size != state.size) || (after.inode != state.inode))
+		return LarsErr::E_SUCCESS;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	if ((m_entries.size() >= MAX_ENTRIES) && (m_entries.find(fileName) == m_entries.end()))
+	{
+		// remove the least recently used file
+		auto oldest = m_entries.begin();
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			if (it->second.lastUse < oldest->second.lastUse)
+				oldest = it;
+		}
+		m_entries.erase(oldest);
+	}
+
+	state.lastUse = ++m_useCounter;
+	state.content = content;
+	m_entries[fileName] = state;
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* Clear - remove all files from the cache
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcFileCache::Clear()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_entries.clear();
+}
+
+
+/**
+******************************************************************************
+* LoadEncryptedFile - decrypt a settings file and split it into lines
+*
+* @param    fileName:in		path of the file
+* @param    content:out		lines without CR, empty lines included
+*
+* @return   errorCode of Crypto::ReadEncryptedFile
+* @remarks	the key is split at the first '='
+******************************************************************************
+*/
+short AdcFileCache::LoadEncryptedFile(const string &fileName, Content &content)
+{
+	short		errorCode;
+	Crypto		cryptVar;
+	string		fileContent;
+	size_t		startPos = 0;
+	size_t		endPos;
+	size_t		separator;
+	Row			row;
+
+	// read and decrypt settings file
+	errorCode = cryptVar.ReadEncryptedFile(fileName, fileContent);
+	if (errorCode != LarsErr::E_SUCCESS)
+		return errorCode;
+
+	while (startPos < fileContent.length())
+	{
+		if ((endPos = fileContent.find('\n', startPos)) == string::npos)
+			endPos = fileContent.length();
+
+		row.key = fileContent.substr(startPos, endPos - startPos);
+		for (size_t pos = row.key.find('\r'); pos != string::npos; pos = row.key.find('\r', pos))
+			row.key.erase(pos, 1);
+
+		if ((separator = row.key.find('=')) != string::npos)
+		{
+			row.value = row.key.substr(separator + 1);
+			row.key.erase(separator);
+			row.keyValue = true;
+		}
+		else
+		{
+			row.value.clear();
+			row.keyValue = false;
+		}
+		content.push_back(row);
+
+		startPos = endPos + 1;
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+bool AdcFileCache::GetFileState(const string &fileName, Entry &entry)
+{
+	struct stat		fileState;
+
+	if (stat(fileName.c_str(), &fileState) != 0)
+		return false;
+
+#ifdef __GNUC__
+	entry.modified = (long long)fileState.st_mtim.tv_sec * 1000000000LL + fileState.st_mtim.tv_nsec;
+#else
+	entry.modified = (long long)fileState.st_mtime * 1000000000LL;
+#endif
+	entry.size = (long long)fileState.st_size;
+	entry.inode = (unsigned long long)fileState.st_ino;
+	entry.lastUse = 0;
+
+	return true;
+}
@@ -9,17 +9,25 @@
 * Content    : adcfirmware class 
 ******************************************************************************
 */
-#include <hex.h>
-using CryptoPP::HexEncoder;
-using CryptoPP::HexDecoder;
-
+#include <string.h>
+#include <ctype.h>
 #include "larsErr.h"
 #include "crypto.h"
 #include "adctrace.h"
+#include "adcfilecache.h"
 #include "adcfirmware.h"
 
 const string AdcFirmware::FIRMWARE_FILE = "baf";
 
+
+static unsigned char HexValue(char digit)
+{
+	if ((digit >= '0') && (digit <= '9'))
+		return (unsigned char)(digit - '0');
+
+	return (unsigned char)(toupper((unsigned char)digit) - 'A' + 10);
+}
+
 AdcFirmware::AdcFirmware()
 {
 	m_minAddress = 0xFFFFFFFF;
@@ -42,6 +50,25 @@ AdcFirmware::~AdcFirmware()
 }
 
 
+/**
+******************************************************************************
+* Open - authenticate and scan the firmware file
+*
+* @param    directory:in	directory for the firmware files
+* @param    type:in			adc type
+*
+* @return   errorCode
+* @remarks	only the encrypted file is kept, Download decrypts and parses it
+*			again block by block. Files with unsorted S3 records are loaded
+*			to an image.
+******************************************************************************
+*/
+short AdcFirmware::Open(const string &directory, const string &type)
+{
+	return Scan(directory, type);
+}
+
+
 /**
 ******************************************************************************
 * LoadFile - load firmware file
@@ -50,21 +77,42 @@ AdcFirmware::~AdcFirmware()
 * @param    type:in			adc type
 *
 * @return   errorCode
-* @remarks
+* @remarks	the whole image is decrypted to memory, GetData reads it
 ******************************************************************************
 */
 short AdcFirmware::LoadFile(const string &directory, const string &type)
+{
+	short	errorCode;
+
+	if ((errorCode = Open(directory, type)) != LarsErr::E_SUCCESS)
+		return errorCode;
+
+	if (m_data == 0)
+		errorCode = LoadImage();
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* Scan - read the firmware file, check the tag and parse all s-records
+*
+* @param    directory:in	directory for the firmware files
+* @param    type:in			adc type
+*
+* @return   errorCode
+* @remarks	the plain text is parsed chunk by chunk and not kept
+******************************************************************************
+*/
+short AdcFirmware::Scan(const string &directory, const string &type)
 {
 	short		errorCode;
-	string		fileContent;
+	int			cryptResult;
 	string		firmwareFile;
 	Crypto		cryptVar;
-	list<pair<unsigned long, string>> contentList;
-	HexDecoder	hexDecoder;
-	unsigned long	pos;
-	unsigned long	len;
-	unsigned char	dataRecord[256];
-	
+	ParseState	state;
+
 	m_minAddress = 0xFFFFFFFF;
 	m_maxAddress = 0;
 	if (m_data)
@@ -72,6 +120,7 @@ short AdcFirmware::LoadFile(const string &directory, const string &type)
 		delete[] m_data;
 		m_data = 0;
 	}
+	m_cipherText.clear();
 
 	m_adcType.clear();
 	m_firmwareFileVersion.clear();
@@ -83,225 +132,344 @@ short AdcFirmware::LoadFile(const string &directory, const string &type)
 	else
 		firmwareFile = directory + "/" + type + "." + FIRMWARE_FILE;
 
-	// read and decrypt country settings file
-	errorCode = cryptVar.ReadEncryptedFile(firmwareFile, fileContent);
+	// read encrypted firmware file
+	errorCode = cryptVar.ReadCipherFile(firmwareFile, m_cipherText);
 	if (errorCode != LarsErr::E_SUCCESS)
 	{
 		return errorCode;
 	}
 
-	// parse firmware file
-	errorCode = ParseSRecord(fileContent, &contentList, PARSE_ALL);
-	if (errorCode != LarsErr::E_SUCCESS)
+	// decrypt and parse, the records are only counted
+	InitParse(state);
+	cryptResult = cryptVar.DecryptAES_GCM(m_cipherText, [&](const char *data, size_t size)
 	{
-		contentList.clear();
-		return errorCode;
+		return ParseChunk(state, data, size, [](unsigned long, const unsigned char *, unsigned long) { return LarsErr::E_SUCCESS; }) == LarsErr::E_SUCCESS;
+	});
+	if ((cryptResult == Crypto::E_SUCCESS) && !state.record.empty())
+		ParseRecord(state, NULL);
+
+	if ((cryptResult != Crypto::E_SUCCESS) || (state.errorCode != LarsErr::E_SUCCESS))
+	{
+		if (state.errorCode == LarsErr::E_SUCCESS)
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tdecryption error, file %s corrupted", __FUNCTION__, firmwareFile.c_str());
+		m_cipherText.clear();
+		return LarsErr::E_FILE_CORRUPT;
 	}
 
+	ParseHeader(state.header);
+	m_minAddress = state.endMinAddress;
+	m_maxAddress = state.endMaxAddress;
+
 	// compare adc types
 	if (type != m_adcType)
 	{
+		m_cipherText.clear();
 		return LarsErr::E_FILE_CORRUPT;
 	}
 
-	// copy file content to internal buffer
-	if ((contentList.size() != 0) && (m_maxAddress >= m_minAddress))
+	if ((state.dataRecords == 0) || (m_maxAddress < m_minAddress))
 	{
-		// allocate memory for firmware and copy data from contentMap
-		m_data = new unsigned char[m_maxAddress - m_minAddress];
-		if (m_data != 0)
-		{
-			memset(m_data, 0xFF, m_maxAddress - m_minAddress);
+		m_cipherText.clear();
+		return LarsErr::E_FILE_CORRUPT;
+	}
 
-			for (list<pair<unsigned long, string>>::iterator it = contentList.begin(); it != contentList.end(); it++)
-			{
-				// calculate index for m_data
-				pos = (*it).first - m_minAddress;
+	// blocks can be streamed only from sorted records, otherwise the image is needed
+	if (!state.ordered)
+		return LoadImage();
+
+	return LarsErr::E_SUCCESS;
+}
 
-				hexDecoder.Put((byte *)((*it).second.data()), (*it).second.length());
-				len = hexDecoder.Get(dataRecord, sizeof(dataRecord));
 
-				memcpy(m_data + pos, dataRecord, len);
-			}
-		}
-		else
+/**
+******************************************************************************
+* LoadImage - decrypt the firmware to m_data
+*
+* @return   errorCode
+* @remarks	gaps are filled with 0xFF, m_cipherText is released
+******************************************************************************
+*/
+short AdcFirmware::LoadImage()
+{
+	Crypto		cryptVar;
+	ParseState	state;
+	int			cryptResult;
+
+	if (m_data)
+		return LarsErr::E_SUCCESS;
+
+	m_data = new unsigned char[m_maxAddress - m_minAddress];
+	memset(m_data, 0xFF, m_maxAddress - m_minAddress);
+
+	InitParse(state);
+	RecordSink copyRecord = [&](unsigned long address, const unsigned char *data, unsigned long len)
+	{
+		// records before the last S0 record may be outside of the image
+		for (unsigned long idx = 0; idx < len; idx++)
 		{
-			errorCode = LarsErr::E_NOT_ENOUGH_MEMORY;
+			if ((address + idx >= m_minAddress) && (address + idx < m_maxAddress))
+				m_data[address + idx - m_minAddress] = data[idx];
 		}
-	}
-	else
+		return LarsErr::E_SUCCESS;
+	};
+
+	cryptResult = cryptVar.DecryptAES_GCM(m_cipherText, [&](const char *data, size_t size)
 	{
-		errorCode = LarsErr::E_FILE_CORRUPT;
+		return ParseChunk(state, data, size, copyRecord) == LarsErr::E_SUCCESS;
+	});
+	if ((cryptResult == Crypto::E_SUCCESS) && !state.record.empty())
+		ParseRecord(state, copyRecord);
+
+	m_cipherText.clear();
+
+	if ((cryptResult != Crypto::E_SUCCESS) || (state.errorCode != LarsErr::E_SUCCESS))
+	{
+		delete[] m_data;
+		m_data = 0;
+		return LarsErr::E_FILE_CORRUPT;
 	}
 
-	return errorCode;
+	return LarsErr::E_SUCCESS;
+}
+
+
+void AdcFirmware::InitParse(ParseState &state) const
+{
+	state.record.clear();
+	state.header.clear();
+	state.minAddress = 0xFFFFFFFF;
+	state.maxAddress = 0;
+	state.endMinAddress = 0xFFFFFFFF;
+	state.endMaxAddress = 0;
+	state.lastEnd = 0;
+	state.dataRecords = 0;
+	state.ordered = true;
+	state.errorCode = LarsErr::E_SUCCESS;
 }
 
 
 /**
 ******************************************************************************
-* ParseSRecord - load firmware file
+* ParseChunk - split decrypted text into s-records
 *
-* @param    fileContent:in		s file content
-* @param    contentList:out		list ofa ll s3 records
-* @param    firmwareHeader:out	s0 record content
-* @param    parse:in			attribute parse all or only s0 record 
+* @param    state:in/out	parser state, the last record is completed by the next chunk
+* @param    data:in			decrypted text
+* @param    size:in			size of data
+* @param    sink:in			called with the data of every S3 record
 *
 * @return   errorCode
-* @remarks
+* @remarks	a record starts with 'S' and ends before the next one, line
+*			breaks are ignored
 ******************************************************************************
 */
-short AdcFirmware::ParseSRecord(string &fileContent, list<pair<unsigned long, string>> *contentList, ParseSetting parse)
+short AdcFirmware::ParseChunk(ParseState &state, const char *data, size_t size, const RecordSink &sink) const
 {
-	short			errorCode = LarsErr::E_SUCCESS;
-	unsigned long	pos;
-	unsigned long	lenSRecord, lenData;
-	unsigned long	address, minAddress, maxAddress;
-	string			content;
-	unsigned long	checksum;
-	bool			S0Received;
-
-	try
-	{
-		minAddress = 0xFFFFFFFF;
-		maxAddress = 0;
-		S0Received = false;
-		if (contentList) contentList->clear();
-
-		for (unsigned long idx = 0; idx < fileContent.length(); idx++)
+	const char	*end = data + size;
+	const char	*next;
+
+	while ((data < end) && (state.errorCode == LarsErr::E_SUCCESS))
+	{
+		if ((next = (const char *)memchr(data, 'S', end - data)) == NULL)
+			next = end;
+
+		// rest of the current record
+		for (; data < next; data++)
+		{
+			if ((*data != '\r') && (*data != '\n') && !state.record.empty())
+				state.record += *data;
+		}
+
+		if (next < end)
 		{
-			if (fileContent[idx] == 'S')
+			if (!state.record.empty())
+				ParseRecord(state, sink);
+			state.record.assign(1, 'S');
+			data = next + 1;
+		}
+	}
+
+	return state.errorCode;
+}
+
+
+/**
+******************************************************************************
+* ParseRecord - parse one s-record
+*
+* @param    state:in/out	parser state, state.record is the record
+* @param    sink:in			called with the data of a S3 record, may be NULL
+*
+* @return   errorCode
+* @remarks	S0: header, S3: data with 32 bit address, S7/S8/S9: end of the
+*			data, the address range of the image is taken at the end record
+******************************************************************************
+*/
+short AdcFirmware::ParseRecord(ParseState &state, const RecordSink &sink) const
+{
+	unsigned char	bytes[256];
+	unsigned long	count = 0;
+	unsigned long	checksum = 0;
+	unsigned long	address;
+	unsigned long	len;
+	const string	&record = state.record;
+
+	if (record.size() < 2)
+		return state.errorCode;
+
+	// hex pairs after the record type, the first byte is the byte count
+	for (size_t pos = 2; (pos + 1 < record.size()) && (count < sizeof(bytes)) && isxdigit((unsigned char)record[pos]) && isxdigit((unsigned char)record[pos + 1]); pos += 2)
+	{
+		bytes[count++] = (unsigned char)((HexValue(record[pos]) << 4) | HexValue(record[pos + 1]));
+	}
+
+	switch (record[1])
+	{
+		case '0':
+		case '3':
+			if ((count == 0) || (count < (unsigned long)bytes[0] + 1) || (bytes[0] < ((record[1] == '0') ? 3 : 5)))
 			{
-				switch (fileContent[idx + 1])
-				{
-				case '0':
-					idx += 2;
-					pos = idx;
-					// get length of s-record
-					lenSRecord = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					lenData = lenSRecord - 3;
-					idx += 2;
-					// get address of s-record
-					address = std::stoul(fileContent.substr(idx, 4), 0, 16);
-					idx += 4;
-					// get data of s-record
-					content = fileContent.substr(idx, lenData * 2);
-					idx += lenData * 2;
-					// get checksum of s-record
-					checksum = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					idx += 2;
-
-					if (CheckSumOK(fileContent.substr(pos, lenSRecord * 2), checksum))
-					{
-						ConvertHexAscii2String(content);
-						ParseHeader(content);
-
-						minAddress = 0xFFFFFFFF;
-						maxAddress = 0;
-
-						S0Received = true;
-					}
-					else
-					{
-						throw std::invalid_argument("s-record checksum error");
-					}
-
-					S0Received = true;
-					break;
-
-				case '3':
-					idx += 2;
-					pos = idx;
-					// get length of s-record
-					lenSRecord = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					lenData = lenSRecord - 5;
-					idx += 2;
-					// get address of s-record
-					address = std::stoul(fileContent.substr(idx, 8), 0, 16);
-					idx += 8;
-					// get data of s-record
-					content = fileContent.substr(idx, lenData * 2);
-					idx += lenData * 2;
-					// get checksum of s-record
-					checksum = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					idx += 2;
-
-					if (CheckSumOK(fileContent.substr(pos, lenSRecord * 2), checksum))
-					{
-						if (contentList) contentList->push_back(std::pair<unsigned long, string>(address, content));
-
-						if (minAddress >= address) minAddress = address;
-						if (maxAddress <= address + (content.length() / 2)) maxAddress = address + (content.length() / 2);
-					}
-					else
-					{
-						throw std::invalid_argument("s-record checksum error");
-					}
-					break;
-
-				case '7':
-					idx += 2;
-					// get length of s-record
-					lenSRecord = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					idx += 2;
-					lenData = lenSRecord - 5;
-					// get address of s-record
-					address = std::stoul(fileContent.substr(idx, 4), 0, 16);
-					idx += 4;
-					// get data of s-record
-					idx += lenData * 2;
-					// get checksum of s-record
-					idx += 2;
-
-					m_minAddress = minAddress;
-					m_maxAddress = maxAddress;
-					break;
-				case '8':
-					idx += 2;
-					// get length of s-record
-					lenSRecord = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					idx += 2;
-					lenData = lenSRecord - 4;
-					// get address of s-record
-					address = std::stoul(fileContent.substr(idx, 3), 0, 16);
-					idx += 3;
-					// get data of s-record
-					idx += lenData * 2;
-					// get checksum of s-record
-					idx += 2;
-
-					m_minAddress = minAddress;
-					m_maxAddress = maxAddress;
-					break;
-				case '9':
-					idx += 2;
-					// get length of s-record
-					lenSRecord = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					idx += 2;
-					lenData = lenSRecord - 3;
-					// get address of s-record
-					address = std::stoul(fileContent.substr(idx, 2), 0, 16);
-					idx += 2;
-					// get data of s-record
-					idx += lenData * 2;
-					// get checksum of s-record
-					idx += 2;
-
-					m_minAddress = minAddress;
-					m_maxAddress = maxAddress;
-					break;
-				}
+				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tinvalid s-record", __FUNCTION__);
+				return state.errorCode = LarsErr::E_FILE_CORRUPT;
+			}
+
+			// ones complement of the sum from the byte count up to the data
+			for (unsigned long idx = 0; idx < bytes[0]; idx++)
+				checksum += bytes[idx];
+			if ((~checksum & 0xFF) != bytes[bytes[0]])
+			{
+				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\ts-record checksum error", __FUNCTION__);
+				return state.errorCode = LarsErr::E_FILE_CORRUPT;
 			}
 
-			if ((parse == PARSE_S0RECORD) && (S0Received == true))
+			if (record[1] == '0')
+			{
+				// header is ascii, zero terminated
+				len = bytes[0] - 3;
+				state.header.assign((const char *)&bytes[3], len);
+				state.header = state.header.c_str();
+
+				state.minAddress = 0xFFFFFFFF;
+				state.maxAddress = 0;
+			}
+			else
+			{
+				address = ((unsigned long)bytes[1] << 24) | ((unsigned long)bytes[2] << 16) | ((unsigned long)bytes[3] << 8) | bytes[4];
+				len = bytes[0] - 5;
+
+				if (address < state.lastEnd)
+					state.ordered = false;
+				if (address + len > state.lastEnd)
+					state.lastEnd = address + len;
+
+				if (state.minAddress >= address) state.minAddress = address;
+				if (state.maxAddress <= address + len) state.maxAddress = address + len;
+				state.dataRecords++;
+
+				if (sink)
+					state.errorCode = sink(address, &bytes[5], len);
+			}
+			break;
+
+		case '7':
+		case '8':
+		case '9':
+			state.endMinAddress = state.minAddress;
+			state.endMaxAddress = state.maxAddress;
+			break;
+	}
+
+	return state.errorCode;
+}
+
+
+/**
+******************************************************************************
+* ForEachBlock - pass the firmware block by block
+*
+* @param    sink:in			called with every block that contains data
+*
+* @return   errorCode, first error of the sink
+* @remarks	blocks of FRM_BLOCK_SIZE from m_minAddress like GetData. Without
+*			image the firmware is decrypted and parsed while the blocks are
+*			sent, only the current block is in memory.
+******************************************************************************
+*/
+short AdcFirmware::ForEachBlock(const BlockSink &sink) const
+{
+	Crypto		cryptVar;
+	ParseState	state;
+	AdcFrmData	block;
+	bool		blockUsed = false;
+	int			cryptResult;
+	short		errorCode = LarsErr::E_SUCCESS;
+
+	if (m_data)
+	{
+		for (unsigned long pos = 0; GetData(pos, &block); pos += block.len)
+		{
+			if ((errorCode = sink(block)) != LarsErr::E_SUCCESS)
 				break;
 		}
+		return errorCode;
 	}
-	catch (std::exception &e)
+
+	if (m_cipherText.empty())
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	// Scan has checked that the records are sorted
+	RecordSink fillBlock = [&](unsigned long address, const unsigned char *data, unsigned long len)
 	{
-		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\texception: %s", __FUNCTION__, e.what());
-		errorCode = LarsErr::E_FILE_CORRUPT;
-	}
+		unsigned long	blockStart;
+		unsigned long	copy;
+		short			result;
+
+		while (len)
+		{
+			if ((address < m_minAddress) || (address >= m_maxAddress))
+			{
+				address++;
+				data++;
+				len--;
+				continue;
+			}
+
+			blockStart = m_minAddress + ((address - m_minAddress) / FRM_BLOCK_SIZE) * FRM_BLOCK_SIZE;
+			if (!blockUsed || (block.startAdr != blockStart))
+			{
+				if (blockUsed && ((result = sink(block)) != LarsErr::E_SUCCESS))
+					return result;
+
+				block.startAdr = blockStart;
+				block.len = (short)((m_maxAddress - blockStart < (unsigned long)FRM_BLOCK_SIZE) ? m_maxAddress - blockStart : FRM_BLOCK_SIZE);
+				memset(block.data, 0xFF, sizeof(block.data));
+				blockUsed = true;
+			}
+
+			copy = block.startAdr + block.len - address;
+			if (copy > len) copy = len;
+			memcpy(&block.data[address - block.startAdr], data, copy);
+			address += copy;
+			data += copy;
+			len -= copy;
+		}
+		return LarsErr::E_SUCCESS;
+	};
+
+	InitParse(state);
+	cryptResult = cryptVar.DecryptAES_GCM(m_cipherText, [&](const char *data, size_t size)
+	{
+		return ParseChunk(state, data, size, fillBlock) == LarsErr::E_SUCCESS;
+	});
+	if ((cryptResult == Crypto::E_SUCCESS) && !state.record.empty())
+		ParseRecord(state, fillBlock);
+
+	if (state.errorCode != LarsErr::E_SUCCESS)
+		return state.errorCode;
+	if (cryptResult != Crypto::E_SUCCESS)
+		return LarsErr::E_FILE_CORRUPT;
+
+	if (blockUsed)
+		errorCode = sink(block);
 
 	return errorCode;
 }
@@ -309,37 +477,110 @@ short AdcFirmware::ParseSRecord(string &fileContent, list<pair<unsigned long, st
 
 /**
 ******************************************************************************
-* ChecksumOK - check if S-Record checksum is ok
+* Download - send the firmware to the bootloader
 *
-* @param    len:in		data length
-* @param    address:in			adc type
+* @param    protocol:in		protocol of the adc in bootloader mode
+* @param    force:in		0: check parameter if update is possible
+*							1: no check, always execute update
+* @param    window:in		max. FRM telegrams without response, 0: 1
+* @param    bootLoaderVersion:in	version of the bootloader
+* @param    progress:in		called after every window, may be empty
 *
 * @return   errorCode
-* @remarks
+* @remarks	blocks with 0xFF only are not sent. The next blocks are prepared
+*			while no telegram is outstanding, the window hides the round trip.
+*			Several devices may download the same object at the same time.
 ******************************************************************************
 */
-bool AdcFirmware::CheckSumOK(string content, unsigned long checksum)
+short AdcFirmware::Download(AdcProtocol *protocol, const short force, short window, double bootLoaderVersion, const ProgressCallback &progress) const
 {
-	unsigned long chk = 0;
-
-	try
+	short				errorCode;
+	string				usbStackVersion = m_usbStackVersion;
+	string				welmecStructureVersion = m_welmecStructureVersion;
+	AdcFrmData			batch[FRM_MAX_WINDOW];
+	short				errorCodes[FRM_MAX_WINDOW];
+	short				count = 0;
+	unsigned long		written = 0;
+
+	// a repeated block may overtake blocks that are already written, so the
+	// window is only used if the caller asks for it
+	if (window <= 0)
+		window = 1;
+	if (window > FRM_MAX_WINDOW)
+		window = FRM_MAX_WINDOW;
+
+	// send the collected blocks, the bootloader answers every block
+	auto writeBatch = [&]()
 	{
-		for (unsigned long idx = 0; idx < content.length();)
+		short	result = LarsErr::E_SUCCESS;
+
+		protocol->FirmwareWrite(batch, count, errorCodes);
+
+		for (short idx = 0; idx < count; idx++)
+		{
+			// bugfix for bootloader < 1.05, the error of the flash block [0xFFFF9F00 - 0xFFFF9FFF] is ignored
+			if ((errorCodes[idx] != LarsErr::E_SUCCESS) && !IsBootLoaderBugBlock(batch[idx], bootLoaderVersion))
+			{
+				result = errorCodes[idx];
+				break;
+			}
+		}
+
+		if (result == LarsErr::E_SUCCESS)
 		{
-			chk += std::stoul(content.substr(idx, 2), 0, 16);
-			idx += 2;
+			written = batch[count - 1].startAdr + batch[count - 1].len - m_minAddress;
+			if (progress)
+				progress(written, GetSize());
 		}
+		count = 0;
+		return result;
+	};
 
-		// make ones complement 
-		chk = ~chk & 0xFF;
+	// send start download command
+	errorCode = protocol->FirmwareUpdate(ADC_FRMUPDATE_START, NULL, &usbStackVersion, &welmecStructureVersion, force);
+
+	if (errorCode == LarsErr::E_SUCCESS)
+	{
+		// write new firmware
+		errorCode = ForEachBlock([&](const AdcFrmData &frmData)
+		{
+			// send only data package != 0xFF
+			for (short idx = 0; idx < frmData.len; idx++)
+			{
+				if (frmData.data[idx] != 0xFF)
+				{
+					batch[count++] = frmData;
+					return (count == window) ? writeBatch() : LarsErr::E_SUCCESS;
+				}
+			}
+			return LarsErr::E_SUCCESS;
+		});
 
-		return (chk == checksum ? true: false);
+		if ((errorCode == LarsErr::E_SUCCESS) && (count > 0))
+			errorCode = writeBatch();
 	}
-	catch (std::exception &e)
+
+	if (errorCode == LarsErr::E_SUCCESS)
 	{
-		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\texception: %s", __FUNCTION__, e.what());
-		return false;
+		// send end download command
+		errorCode = protocol->FirmwareUpdate(ADC_FRMUPDATE_END, NULL);
 	}
+	else
+	{
+		// error occured, also after a failed start, send cancel download command
+		protocol->FirmwareUpdate(ADC_FRMUPDATE_CANCEL, NULL);
+	}
+
+	if ((errorCode == LarsErr::E_SUCCESS) && progress && (written != GetSize()))
+		progress(GetSize(), GetSize());
+
+	return errorCode;
+}
+
+
+bool AdcFirmware::IsBootLoaderBugBlock(const AdcFrmData &frmData, double bootLoaderVersion) const
+{
+	return (bootLoaderVersion < 1.05) && ((frmData.startAdr + frmData.len - 1) >= 0xFFFF9F00) && ((frmData.startAdr + frmData.len - 1) <= 0xFFFF9FFF);
 }
 
 
@@ -351,16 +592,19 @@ bool AdcFirmware::CheckSumOK(string content, unsigned long checksum)
 * @param    frmData:out		pointer to struct of firmware data
 *
 * @return   errorCode
-* @remarks
+* @remarks	only after LoadFile or Open of a file with unsorted records
 ******************************************************************************
 */
-bool AdcFirmware::GetData(unsigned long pos, AdcFrmData *frmData)
+bool AdcFirmware::GetData(unsigned long pos, AdcFrmData *frmData) const
 {
 	unsigned long size;
 
-	if ((m_minAddress + pos + 256) <= m_maxAddress)
+	if (!m_data)
+		return false;
+
+	if ((m_minAddress + pos + FRM_BLOCK_SIZE) <= m_maxAddress)
 	{
-		size = 256;
+		size = FRM_BLOCK_SIZE;
 	}
 	else
 	{
@@ -383,6 +627,20 @@ bool AdcFirmware::GetData(unsigned long pos, AdcFrmData *frmData)
 }
 
 
+/**
+******************************************************************************
+* GetSize - size of the firmware image
+*
+* @return   bytes from the lowest to the highest address
+* @remarks
+******************************************************************************
+*/
+unsigned long AdcFirmware::GetSize() const
+{
+	return (m_maxAddress >= m_minAddress) ? m_maxAddress - m_minAddress : 0;
+}
+
+
 /**
 ******************************************************************************
 * GetVersion - get the version of the firmware file
@@ -392,15 +650,15 @@ bool AdcFirmware::GetData(unsigned long pos, AdcFrmData *frmData)
 * @param    version:in		firmware file version
 *
 * @return   errorCode
-* @remarks
+* @remarks	the versions of the header are kept in g_adcFileCache, the file
+*			is scanned again only if it has changed
 ******************************************************************************
 */
 short AdcFirmware::GetVersion(const string &directory, const string &type, string &version)
 {
 	short	errorCode;
 	string	firmwareFile;
-	string	fileContent;
-	Crypto	cryptVar;
+	shared_ptr<const AdcFileCache::Content> header;
 
 	version.clear();
 
@@ -409,25 +667,28 @@ short AdcFirmware::GetVersion(const string &directory, const string &type, strin
 	else
 		firmwareFile = directory + "/" + type + "." + FIRMWARE_FILE;
 
-	// read and decrypt country settings file
-	errorCode = cryptVar.ReadEncryptedFile(firmwareFile, fileContent);
-	if (errorCode != LarsErr::E_SUCCESS)
+	errorCode = g_adcFileCache.Read(firmwareFile, header, [&](const string &, AdcFileCache::Content &content)
 	{
-		return errorCode;
-	}
+		short	result;
 
-	// parse firmware file
-	errorCode = ParseSRecord(fileContent, NULL, PARSE_S0RECORD);
+		if ((result = Scan(directory, type)) == LarsErr::E_SUCCESS)
+		{
+			content.push_back({ "adc", m_adcType, true });
+			content.push_back({ "version", m_firmwareFileVersion, true });
+			content.push_back({ "usb", m_usbStackVersion, true });
+			content.push_back({ "welmec", m_welmecStructureVersion, true });
+		}
+		return result;
+	});
 	if (errorCode != LarsErr::E_SUCCESS)
 	{
 		return errorCode;
 	}
 
-	// compare adc types
-	if (type != m_adcType)
-	{
-		return LarsErr::E_FILE_CORRUPT;
-	}
+	m_adcType = (*header)[0].value;
+	m_firmwareFileVersion = (*header)[1].value;
+	m_usbStackVersion = (*header)[2].value;
+	m_welmecStructureVersion = (*header)[3].value;
 
 	if (!m_firmwareFileVersion.empty())
 	{
@@ -551,17 +812,3 @@ string AdcFirmware::GetWelmecStructureVersion()
 	return m_welmecStructureVersion;
 }
 
-
-void AdcFirmware::ConvertHexAscii2String(string &header)
-{
-	HexDecoder	hexDecoder;
-	unsigned long	len;
-	unsigned char	dataRecord[256];
-
-	// convert hex ascii to ascii
-	hexDecoder.Put((byte *)header.c_str(), header.length());
-	len = hexDecoder.Get(dataRecord, sizeof(dataRecord) - 1);
-	// add terminating 0
-	dataRecord[len] = '\0';
-	header = (char *)dataRecord;
-}
@@ -0,0 +1,237 @@
+/**
+******************************************************************************
+* File       : adcflightrecorder.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcflightrecorder class: the last telegrams of an adc in a
+*              ring buffer, dumped to a binary file on demand
+******************************************************************************
+*/
+#include <fstream>
+#include <string.h>
+#include <time.h>
+#include "larsErr.h"
+#include "adctrace.h"
+#include "adcflightrecorder.h"
+
+
+AdcFlightRecorder::AdcFlightRecorder()
+{
+	m_buffer = new char[FLIGHT_BUFFER_SIZE];
+	m_head = 0;
+	m_tail = 0;
+	m_count = 0;
+	m_autoDumped = false;
+}
+
+AdcFlightRecorder::~AdcFlightRecorder()
+{
+	delete[] m_buffer;
+}
+
+
+/**
+******************************************************************************
+* Record - store a frame, the oldest records are overwritten
+*
+* @param    direction:in	DIR_REQUEST, DIR_RESPONSE or DIR_ERROR
+* @param    frame:in		telegram or received bytes, may be NULL
+* @param    size:in			size of the frame
+* @param    orderID:in		order ID, -1: unknown
+* @param    errorCode:in	result of the exchange
+*
+* @return   void
+* @remarks	no allocation, always on. An error record with a protocol error
+*			triggers the automatic dump.
+******************************************************************************
+*/
+void AdcFlightRecorder::Record(unsigned char direction, const char *frame, unsigned long size, short orderID, short errorCode)
+{
+	FlightRecord	record;
+	FlightRecord	oldest;
+	string			autoDumpFile;
+
+	if (!frame)
+		size = 0;
+	if (size > FLIGHT_MAX_FRAME)
+		size = FLIGHT_MAX_FRAME;
+
+	memset(&record, 0, sizeof(record));
+	record.timestamp = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	record.size = (unsigned int)size;
+	record.orderID = orderID;
+	record.errorCode = errorCode;
+	record.direction = direction;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		// drop the oldest records until the new one fits
+		while (m_head + sizeof(record) + size - m_tail > FLIGHT_BUFFER_SIZE)
+		{
+			Read(m_tail, &oldest, sizeof(oldest));
+			m_tail += sizeof(oldest) + oldest.size;
+			m_count--;
+		}
+
+		Write(&record, sizeof(record));
+		Write(frame, size);
+		m_count++;
+
+		if ((direction == DIR_ERROR) && ((errorCode == LarsErr::E_PROTOCOL) || (errorCode == LarsErr::E_PROTOCOL_CRC)) && !m_autoDumpFile.empty())
+		{
+			// a bad line produces many errors, keep the first dump for some time
+			if (!m_autoDumped || (chrono::steady_clock::now() - m_lastAutoDump > chrono::seconds(FLIGHT_AUTO_DUMP_INTERVAL)))
+			{
+				autoDumpFile = m_autoDumpFile;
+				m_lastAutoDump = chrono::steady_clock::now();
+				m_autoDumped = true;
+			}
+		}
+	}
+
+	if (!autoDumpFile.empty())
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error %d, dump to %s", __FUNCTION__, errorCode, autoDumpFile.c_str());
+		WriteFile(autoDumpFile);
+	}
+}
+
+
+/**
+******************************************************************************
+* Dump - write all records to a file
+*
+* @param    fileName:in		path of the dump file
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+*			LarsErr::E_FILE_NOT_FOUND	file could not be written
+* @remarks	see FlightFileHeader for the format
+******************************************************************************
+*/
+short AdcFlightRecorder::Dump(const char *fileName)
+{
+	if (!fileName || !fileName[0])
+		return LarsErr::E_INVALID_PARAMETER;
+
+	return WriteFile(fileName);
+}
+
+
+/**
+******************************************************************************
+* SetAutoDump - dump automatically on protocol errors
+*
+* @param    fileName:in		path of the dump file, NULL or empty: no automatic dump
+*
+* @return   LarsErr::E_SUCCESS
+* @remarks	the file is overwritten with every dump, at most one dump in
+*			FLIGHT_AUTO_DUMP_INTERVAL
+******************************************************************************
+*/
+short AdcFlightRecorder::SetAutoDump(const char *fileName)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_autoDumpFile = fileName ? fileName : "";
+	m_autoDumped = false;
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* WriteFile - copy the ring buffer and write it to a file
+*
+* @param    fileName:in		path of the dump file
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_FILE_NOT_FOUND	file could not be written
+* @remarks	the recorder is locked only for the copy
+******************************************************************************
+*/
+short AdcFlightRecorder::WriteFile(const string &fileName)
+{
+	FlightFileHeader	header;
+	string				records;
+	ofstream			file;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = FLIGHT_MAGIC;
+	header.version = FLIGHT_VERSION;
+	header.dumpTime = (long long)time(NULL);
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		records.resize((size_t)(m_head - m_tail));
+		if (!records.empty())
+			Read(m_tail, &records[0], (unsigned long)records.size());
+		header.recordCount = (unsigned int)m_count;
+		header.dumpTimestamp = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	file.open(fileName, ios::binary | ios::trunc);
+	if (!file.is_open())
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't create %s", __FUNCTION__, fileName.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	file.write((const char *)&header, sizeof(header));
+	file.write(records.c_str(), records.size());
+	file.close();
+
+	if (file.fail())
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't write %s", __FUNCTION__, fileName.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* Write - append data at the head of the ring buffer
+*
+* @remarks	m_mutex must be locked, the space must be free
+******************************************************************************
+*/
+void AdcFlightRecorder::Write(const void *data, unsigned long size)
+{
+	unsigned long offset = (unsigned long)(m_head % FLIGHT_BUFFER_SIZE);
+	unsigned long first = (size < FLIGHT_BUFFER_SIZE - offset) ? size : FLIGHT_BUFFER_SIZE - offset;
+
+	if (!size)
+		return;
+
+	// copy data in max. two segments
+	memcpy(&m_buffer[offset], data, first);
+	memcpy(m_buffer, (const char *)data + first, size - first);
+
+	m_head += size;
+}
+
+
+/**
+******************************************************************************
+* Read - copy data out of the ring buffer
+*
+* @remarks	m_mutex must be locked
+******************************************************************************
+*/
+void AdcFlightRecorder::Read(unsigned long long pos, void *data, unsigned long size)
+{
+	unsigned long offset = (unsigned long)(pos % FLIGHT_BUFFER_SIZE);
+	unsigned long first = (size < FLIGHT_BUFFER_SIZE - offset) ? size : FLIGHT_BUFFER_SIZE - offset;
+
+	memcpy(data, &m_buffer[offset], first);
+	memcpy((char *)data + first, m_buffer, size - first);
+}
@@ -9,6 +9,7 @@
 * Content    : adcinterface class (virtual)
 ******************************************************************************
 */
+#include <thread>         // std::this_thread::sleep_for
 #include "adcinterface.h"
 
 
@@ -27,6 +28,48 @@ short AdcInterface::GetInterfaceType()
     return m_InterfaceType;
 }
 
+/**
+******************************************************************************
+* WaitForData - wait until the interface receives new data
+*
+* @param    timeout:in	maximum wait time in ms
+*
+* @return   void
+* @remarks  default implementation just sleeps, interfaces with a receive
+*           thread return as soon as data is available
+******************************************************************************
+*/
+void AdcInterface::WaitForData(unsigned long timeout)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+}
+
+
+/**
+******************************************************************************
+* ReadAvailable - read the data that is already received
+*
+* @param    pData:out	buffer
+* @param    size:in		size of the buffer
+* @param    timeout:in	maximum wait time in ms if no data is available
+*
+* @return   number of bytes read, 0: no data within the timeout
+* @remarks  default implementation reads byte by byte, interfaces with a
+*           receive buffer return all buffered bytes at once
+******************************************************************************
+*/
+unsigned long AdcInterface::ReadAvailable(void *pData, unsigned long size, unsigned long timeout)
+{
+	if (!size)
+		return 0;
+
+	if (Read(pData, 1) == 1)
+		return 1;
+
+	WaitForData(timeout < 10 ? timeout : 10);
+	return 0;
+}
+
 bool AdcInterface::UseCRC16()
 {
 	return m_useCRC16;
@@ -47,3 +90,18 @@ void AdcInterface::GetPort(string &port)
 	port = "";
 }
 
+
+/**
+******************************************************************************
+* GetPollFd - file descriptor that is readable when data is received
+*
+* @return   file descriptor, -1: interface can't be polled
+* @remarks  used by AdcReactor, the data is read with ReadAvailable and
+*           timeout 0
+******************************************************************************
+*/
+int AdcInterface::GetPollFd()
+{
+	return -1;
+}
+
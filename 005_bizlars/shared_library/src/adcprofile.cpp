@@ -0,0 +1,381 @@
+/**
+******************************************************************************
+* File       : adcprofile.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcprofile class: settings fixed by the firmware read by
+*              Lars::Open, stored per adc and firmware for the next open
+******************************************************************************
+*/
+#include <stdio.h>
+#include <fstream>
+#include <sstream>
+#include "larsErr.h"
+#include "adctrace.h"
+#include "adcprofile.h"
+
+AdcProfile g_adcProfile;
+
+const string AdcProfile::FILE_PATTERN = "bizlars_profile_";
+const string AdcProfile::PROFILE_HEADER = "bizlars device profile 2";
+
+
+AdcProfile::AdcProfile()
+{
+}
+
+AdcProfile::~AdcProfile()
+{
+}
+
+
+/**
+******************************************************************************
+* SetPath - set the directory of the device profiles
+*
+* @param    path:in			directory, NULL or "": no device profiles
+*
+* @return   void
+* @remarks	used by the following Lars::Open
+******************************************************************************
+*/
+void AdcProfile::SetPath(const char *path)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_path = path ? path : "";
+}
+
+
+/**
+******************************************************************************
+* GetFileName - get the profile file of an adc
+*
+* @param    version:in		response of VERS
+*
+* @return   path of the file, empty: no profile
+* @remarks	the file is named by adc type and serial number, firmware and
+*			boot loader version are checked by Load
+******************************************************************************
+*/
+string AdcProfile::GetFileName(const keyValuePair &version)
+{
+	string		name;
+	keyValuePair::const_iterator sn = version.find("sn");
+	keyValuePair::const_iterator adct = version.find("adct");
+
+	lock_guard<mutex> lock(m_mutex);
+
+	if (m_path.empty() || (sn == version.end()) || sn->second.empty())
+		return "";
+
+	name = FILE_PATTERN + ((adct != version.end()) ? adct->second : "") + "_" + sn->second;
+
+	// the serial number becomes part of a file name
+	for (size_t pos = 0; pos < name.size(); pos++)
+	{
+		if (!isalnum((unsigned char)name[pos]) && (name[pos] != '-') && (name[pos] != '.'))
+			name[pos] = '_';
+	}
+
+	return m_path + "/" + name + ".txt";
+}
+
+
+/**
+******************************************************************************
+* Load - read the profile of an adc
+*
+* @param    fileName:in		file of GetFileName
+* @param    version:in		response of VERS
+* @param    responses:out	responses of the settings requests
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_FILE_NOT_FOUND	no profile
+*			LarsErr::E_FILE_CORRUPT		profile damaged or of another firmware
+* @remarks	line 1: header, line 2: VERS response, then one line per response:
+*			cmd, number of request values, request and response values as
+*			key=value, all fields separated by tab. The last line is the
+*			fnv-1a hash of the lines before.
+******************************************************************************
+*/
+short AdcProfile::Load(const string &fileName, const keyValuePair &version, Responses &responses)
+{
+	ifstream		file;
+	string			line;
+	string			content;
+	Response		response;
+	size_t			count;
+	size_t			pos;
+	keyValuePair	values;
+	keyValuePair	unused;
+
+	responses.clear();
+
+	if (fileName.empty())
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	file.open(fileName.c_str());
+	if (!file.is_open())
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	if (!getline(file, line) || (line != PROFILE_HEADER) || !getline(file, line))
+		return LarsErr::E_FILE_CORRUPT;
+	content = PROFILE_HEADER + "\n" + line + "\n";
+
+	// another firmware or boot loader may answer different
+	if (!Split(line, 0, unused, values) || (values != version))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\t%s belongs to another firmware", __FUNCTION__, fileName.c_str());
+		return LarsErr::E_FILE_CORRUPT;
+	}
+
+	while (getline(file, line))
+	{
+		if ((line.size() == 16) && (line.find('\t') == string::npos))
+		{
+			char	hash[32];
+
+			snprintf(hash, sizeof(hash), "%016llx", GetHash(content));
+			if (line != hash)
+				break;
+
+			g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tsettings of %s", __FUNCTION__, fileName.c_str());
+			return LarsErr::E_SUCCESS;
+		}
+
+		content += line + "\n";
+
+		// cmd, number of request values, request values, response values
+		if ((pos = line.find('\t')) == string::npos)
+			break;
+		response.cmd = line.substr(0, pos);
+		count = strtoul(line.c_str() + pos + 1, NULL, 10);
+		pos = line.find('\t', pos + 1);
+
+		response.request.clear();
+		response.response.clear();
+		if ((pos != string::npos) && !Split(line.substr(pos + 1), count, response.request, response.response))
+			break;
+		if (response.request.size() < count)
+			break;
+
+		responses.push_back(response);
+	}
+
+	g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\t%s invalid", __FUNCTION__, fileName.c_str());
+	responses.clear();
+
+	return LarsErr::E_FILE_CORRUPT;
+}
+
+
+/**
+******************************************************************************
+* Save - write the profile of an adc
+*
+* @param    fileName:in		file of GetFileName
+* @param    version:in		response of VERS
+* @param    responses:in	responses of the settings requests
+*
+* @return   void
+* @remarks	written to a temporary file and renamed, a read only directory
+*			writes no profile
+******************************************************************************
+*/
+void AdcProfile::Save(const string &fileName, const keyValuePair &version, const Responses &responses)
+{
+	string		tmpFileName = fileName + ".tmp";
+	string		content;
+	char		hash[32];
+
+	if (fileName.empty())
+		return;
+
+	content = PROFILE_HEADER + "\n" + Join(version) + "\n";
+	for (Responses::const_iterator it = responses.begin(); it != responses.end(); ++it)
+	{
+		stringstream	line;
+
+
+		line << it->cmd << "\t" << it->request.size();
+		if (!it->request.empty())
+			line << "\t" << Join(it->request);
+		if (!it->response.empty())
+			line << "\t" << Join(it->response);
+		content += line.str() + "\n";
+	}
+	{
+		ofstream	file(tmpFileName.c_str(), ios::trunc);
+
+		if (!file.is_open())
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tcan't write %s", __FUNCTION__, tmpFileName.c_str());
+			return;
+		}
+
+		snprintf(hash, sizeof(hash), "%016llx", GetHash(content));
+		file << content << hash << "\n";
+
+		if (!file.flush())
+		{
+			file.close();
+			remove(tmpFileName.c_str());
+			return;
+		}
+	}
+
+	if (rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+	{
+		remove(tmpFileName.c_str());
+		return;
+	}
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\t%s written", __FUNCTION__, fileName.c_str());
+}
+
+
+/**
+******************************************************************************
+* Remove - delete the profile of an adc
+*
+* @param    fileName:in		file of GetFileName
+*
+* @return   void
+* @remarks	called on a firmware update or when the adc rejects the profile
+******************************************************************************
+*/
+void AdcProfile::Remove(const string &fileName)
+{
+	if (!fileName.empty() && (remove(fileName.c_str()) == 0))
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\t%s removed", __FUNCTION__, fileName.c_str());
+}
+
+
+string AdcProfile::Join(const keyValuePair &values)
+{
+	string		line;
+
+	for (keyValuePair::const_iterator it = values.begin(); it != values.end(); ++it)
+	{
+		if (it != values.begin())
+			line += "\t";
+		line += Escape(it->first, true) + "=" + Escape(it->second, false);
+	}
+
+	return line;
+}
+
+
+/**
+******************************************************************************
+* Split - get the key=value fields of a line
+*
+* @param    fields:in		key=value separated by tab
+* @param    count:in		number of fields that belong to first
+* @param    first:out		the first count fields
+* @param    second:out		the other fields
+*
+* @return   true: all fields have a key
+* @remarks
+******************************************************************************
+*/
+bool AdcProfile::Split(const string &fields, size_t count, keyValuePair &first, keyValuePair &second)
+{
+	istringstream	stream(fields);
+	string			field;
+	string			key;
+	string			value;
+	size_t			separator;
+
+	first.clear();
+	second.clear();
+	while (getline(stream, field, '\t'))
+	{
+		if (((separator = field.find('=')) == string::npos) ||
+			!Unescape(field.substr(0, separator), key) || !Unescape(field.substr(separator + 1), value))
+			return false;
+		(count ? first : second)[key] = value;
+		if (count)
+			count--;
+	}
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* Escape - make a key or value a field of the profile
+*
+* @param    text:in			key or value
+* @param    key:in			true: '=' is escaped too
+*
+* @return   text with '\\' and control characters as \xhh
+* @remarks	the structures of the adc are separated by ESC, tab and line feed
+*			separate the fields and lines of the profile
+******************************************************************************
+*/
+string AdcProfile::Escape(const string &text, bool key)
+{
+	string		escaped;
+	char		hex[8];
+
+	for (size_t pos = 0; pos < text.size(); pos++)
+	{
+		if (((unsigned char)text[pos] < 0x20) || (text[pos] == '\\') || (key && (text[pos] == '=')))
+		{
+			snprintf(hex, sizeof(hex), "\\x%02x", (unsigned char)text[pos]);
+			escaped += hex;
+		}
+		else
+		{
+			escaped += text[pos];
+		}
+	}
+
+	return escaped;
+}
+
+
+bool AdcProfile::Unescape(const string &field, string &text)
+{
+	text.clear();
+
+	for (size_t pos = 0; pos < field.size(); pos++)
+	{
+		if (field[pos] != '\\')
+		{
+			text += field[pos];
+		}
+		else if ((pos + 3 < field.size()) && (field[pos + 1] == 'x') && isxdigit((unsigned char)field[pos + 2]) && isxdigit((unsigned char)field[pos + 3]))
+		{
+			text += (char)strtoul(field.substr(pos + 2, 2).c_str(), NULL, 16);
+			pos += 3;
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+
+unsigned long long AdcProfile::GetHash(const string &text)
+{
+	unsigned long long	hash = 0xcbf29ce484222325ULL;
+
+	// fnv-1a 64 bit
+	for (size_t idx = 0; idx < text.size(); idx++)
+	{
+		hash ^= (unsigned char)text[idx];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
@@ -14,6 +14,7 @@
 #include <thread>         // std::this_thread::sleep_for
 #include <chrono>         // std::chrono::seconds
 #include <math.h>		  // sin()
+#include <limits.h>
 #include "helpers.h"
 
 // header for cryptopp
@@ -37,11 +38,6 @@ using CryptoPP::HexDecoder;
 
 #define PI 3.14159265
 
-// defines for RBS CRC16
-#define RBS_CRC_START      0x6621      /* start value for the Polynomial */
-#define RBS_CRC_POLY       0x7102      /* Polynomial-coeffizient */
-#define RBS_CRC_MASK       0x0000      /* Mask for the Polynomial */
-
 
 // command identifier
 const string AdcRbs::CMD_CALIB					= "CAL";
@@ -468,6 +464,11 @@ AdcRbs::~AdcRbs()
 void AdcRbs::Init()
 {
 	m_orderID = 0;
+	m_receiveLevel = 0;
+	m_receiveEnd = 0;
+	m_receiveSaved = 0;
+	m_async.active = false;
+	m_registerCacheEnabled = true;
 }
 
 /**
@@ -2414,6 +2415,55 @@ short AdcRbs::FirmwareUpdate(const AdcFrmCmd cmd, const AdcFrmData *data, const
 }
 
 
+/**
+******************************************************************************
+* FirmwareWrite - write several firmware blocks pipelined
+*
+* @param	data:in			firmware blocks
+* @param	count:in		number of blocks
+* @param	errorCodes:out	errorCode of every block
+*
+* @return   errorCode, transport error of the pipeline
+* @remarks	the bootloader answers every block, up to MAX_PIPELINE_DEPTH
+*			blocks are outstanding
+******************************************************************************
+*/
+short AdcRbs::FirmwareWrite(const AdcFrmData *data, const short count, short *errorCodes)
+{
+	short					errorCode;
+	RefDataStruct			refData;
+	vector<PipelineRequest>	requests(count);
+
+	if (count == 1)
+	{
+		errorCodes[0] = FirmwareUpdate(ADC_FRMUPDATE_WRITE_DATA, data);
+		return errorCodes[0];
+	}
+
+	for (short idx = 0; idx < count; idx++)
+	{
+		requests[idx].cmd = CMD_FRM_UPDATE;
+
+		refData.id = REF_DATA_ID_FRM_COMMAND;
+		refData.u.frmCmd = ADC_FRMUPDATE_WRITE_DATA;
+		CreateReferenceData(refData, requests[idx].request);
+
+		refData.id = REF_DATA_ID_FRM_DATA;
+		refData.u.frmData = (AdcFrmData *)&data[idx];
+		CreateReferenceData(refData, requests[idx].request);
+	}
+
+	errorCode = ExecutePipeline(requests);
+
+	for (short idx = 0; idx < count; idx++)
+	{
+		errorCodes[idx] = requests[idx].errorCode;
+	}
+
+	return errorCode;
+}
+
+
 /**
 ******************************************************************************
 * Reset - send reset command to adc
@@ -2463,11 +2513,8 @@ short AdcRbs::Reset(const AdcResetType type)
 short AdcRbs::ReadWeight(const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice)
 {
     short           errorCode;
-	short			errorCodeRefData;
     keyValuePair    refDataMap;
     RefDataStruct   refData;
-    string          key;
-    string          value;
 
     refDataMap.clear();
 
@@ -2477,14 +2524,63 @@ short AdcRbs::ReadWeight(const short registrationRequest, AdcState *adcState, Ad
     CreateReferenceData(refData, refDataMap);
 
     // send request receive respnse
-    errorCode = SendRequestReceiveResponse(CMD_READ_WEIGHT, refDataMap);
+    // the response is decoded in place, see m_response
+    errorCode = ExecuteRequest(CMD_READ_WEIGHT, refDataMap);
+
+    return DecodeReadWeight(errorCode, adcState, weight, tare, basePrice, sellPrice);
+}
+
+
+/**
+******************************************************************************
+* StartReadWeight - send the read weight request without waiting
+*
+* @param    registrationRequest:in  see ReadWeight
+*
+* @return   errorCode
+* @remarks	the response is received by ContinueRequest and decoded by
+*			DecodeReadWeight
+******************************************************************************
+*/
+short AdcRbs::StartReadWeight(const short registrationRequest)
+{
+    keyValuePair    refDataMap;
+    RefDataStruct   refData;
+
+    refData.id = REF_DATA_ID_REGISTRATION_REQ;
+    refData.u.rr = registrationRequest;
+    CreateReferenceData(refData, refDataMap);
+
+    return StartRequest(CMD_READ_WEIGHT, refDataMap);
+}
+
+
+/**
+******************************************************************************
+* DecodeReadWeight - get the values of the read weight response
+*
+* @param    errorCode:in            result of the request
+* @param    adcState:out            state of the adc
+* @param    weight:out              current weight
+* @param    tare:out                current tare
+* @param    basePrice:out           current base price
+* @param    sellPrice:out           current sell price
+*
+* @return   errorCode
+* @remarks	the response is taken from m_response
+******************************************************************************
+*/
+short AdcRbs::DecodeReadWeight(short errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice)
+{
+	short			errorCodeRefData;
+    RefDataStruct   refData;
 
     // get adcState
     if (CheckErrorCode(errorCode, true) && adcState)
     {
         refData.id = REF_DATA_ID_LCSTATE;
         refData.u.adcState = adcState;
-		errorCodeRefData = GetReferenceData(REF_DATA_ID_LCSTATE_STR, refDataMap, refData, 1);
+		errorCodeRefData = GetReferenceData(REF_DATA_ID_LCSTATE_STR, m_response, refData, 1);
 		if (errorCode == LarsErr::E_SUCCESS) errorCode = errorCodeRefData;
     }
 
@@ -2493,7 +2589,7 @@ short AdcRbs::ReadWeight(const short registrationRequest, AdcState *adcState, Ad
     {
         refData.id = REF_DATA_ID_WEIGHT;
         refData.u.wt = weight;
-		errorCodeRefData = GetReferenceData(REF_DATA_ID_WEIGHT_STR, refDataMap, refData, 3);
+		errorCodeRefData = GetReferenceData(REF_DATA_ID_WEIGHT_STR, m_response, refData, 3);
 		if (errorCode == LarsErr::E_SUCCESS) errorCode = errorCodeRefData;
     }
 
@@ -2503,7 +2599,7 @@ short AdcRbs::ReadWeight(const short registrationRequest, AdcState *adcState, Ad
         refData.id = REF_DATA_ID_TARE;
 		tare->frozen = 0;
         refData.u.tare = tare;
-		if ((errorCodeRefData = GetReferenceData(REF_DATA_ID_TARE_STR, refDataMap, refData, 4)) == LarsErr::E_KEY_NOT_FOUND)
+		if ((errorCodeRefData = GetReferenceData(REF_DATA_ID_TARE_STR, m_response, refData, 4)) == LarsErr::E_KEY_NOT_FOUND)
 		{
 			tare->type = AdcTareType::ADC_TARE_NO;
 			tare->frozen = 0;
@@ -2520,7 +2616,7 @@ short AdcRbs::ReadWeight(const short registrationRequest, AdcState *adcState, Ad
     {
         refData.id = REF_DATA_ID_BASEPRICE;
         refData.u.bp = basePrice;
-		if ((errorCodeRefData = GetReferenceData(REF_DATA_ID_BASEPRICE_STR, refDataMap, refData, 4)) == LarsErr::E_KEY_NOT_FOUND)
+		if ((errorCodeRefData = GetReferenceData(REF_DATA_ID_BASEPRICE_STR, m_response, refData, 4)) == LarsErr::E_KEY_NOT_FOUND)
         {
             basePrice->price.value = 0;
             basePrice->price.decimalPlaces = 0;
@@ -2536,7 +2632,7 @@ short AdcRbs::ReadWeight(const short registrationRequest, AdcState *adcState, Ad
     {
         refData.id = REF_DATA_ID_SELLPRICE;
         refData.u.sp = sellPrice;
-		if ((errorCodeRefData = GetReferenceData(REF_DATA_ID_SELLPRICE_STR, refDataMap, refData, 3)) == LarsErr::E_KEY_NOT_FOUND)
+		if ((errorCodeRefData = GetReferenceData(REF_DATA_ID_SELLPRICE_STR, m_response, refData, 3)) == LarsErr::E_KEY_NOT_FOUND)
         {
             sellPrice->value = 0;
             sellPrice->decimalPlaces = 0;
@@ -2579,43 +2675,12 @@ short AdcRbs::GetLogger(const short index, char *entry, unsigned long *size)
         refData.u.idx = index;
         CreateReferenceData(refData, refDataMap);
 
-        // send request receive respnse
-        errorCode = SendRequestReceiveResponse(CMD_LOGBOOK, refDataMap);
+        // send request receive respnse, the entry is formatted from m_response
+        errorCode = ExecuteRequest(CMD_LOGBOOK, refDataMap);
 
         if (errorCode == LarsErr::E_SUCCESS)
         {
-            stringstream    logBookRow;
-            bool            bFirstRun = true;
-
-            // remove key stat from map
-            refDataMap.erase(REF_DATA_ID_STAT_STR);
-
-            if (refDataMap.size())
-            {
-                logBookRow << setbase(m_base);
-                logBookRow << Lars::STX;
-
-                for (keyValuePair::iterator it = refDataMap.begin(); it != refDataMap.end(); it++)
-                {
-                    if (!bFirstRun) logBookRow << Lars::GS;
-                    logBookRow << (*it).first << Lars::FS << (*it).second;
-                    bFirstRun = false;
-                }
-                logBookRow << Lars::ETX;
-
-                if ((logBookRow.str().size() + 1 <= (size_t)*size) && entry)
-                    strcpy(entry, logBookRow.str().c_str());
-                else
-                    errorCode = LarsErr::E_NOT_ENOUGH_MEMORY;
-
-                // don't forget the terminating \0
-                *size = logBookRow.str().size() + 1;
-            }
-            else if ((*size >= 1) && entry)
-            {
-                entry[0] = '\0';
-                *size = 1;
-            }
+            errorCode = FormatLogger(m_response, entry, size);
         }
     }
     else
@@ -2627,6 +2692,203 @@ short AdcRbs::GetLogger(const short index, char *entry, unsigned long *size)
 }
 
 
+/**
+******************************************************************************
+* GetLoggerRange - read several log book entries pipelined
+*
+* @param    first:in				index of the first entry, 0: latest entry
+* @param    count:in				max. number of entries
+* @param    arena:in				buffer for the formatted entries
+* @param    arenaSize:in			size of arena in byte
+* @param    consumer:in				gets every entry with its size including \0 in the order of the index
+*
+* @return   LarsErr::E_SUCCESS		all entries or all entries up to the end of the log book are read
+*			LarsErr::E_NOT_ENOUGH_MEMORY	an entry is longer than arena
+*			errorCode of the first entry that could not be read
+* @remarks	MAX_PIPELINE_DEPTH LOG requests are sent back to back. Every
+*			response is formatted like GetLogger straight from m_response into
+*			arena when it arrives, the entries of a window are passed to the
+*			consumer when the window is answered. The requests of the window
+*			are reused, so no memory is allocated per entry. An entry that
+*			doesn't fit into the rest of arena is requested again in the
+*			next window.
+******************************************************************************
+*/
+short AdcRbs::GetLoggerRange(const short first, const short count, char *arena, const unsigned long arenaSize, const LoggerConsumer &consumer)
+{
+	short					errorCode = LarsErr::E_SUCCESS;
+	vector<PipelineRequest>	requests;
+	unsigned long			offset[MAX_PIPELINE_DEPTH];		// entry of requests[idx] in arena
+	unsigned long			length[MAX_PIPELINE_DEPTH];		// size of the entry including \0
+	unsigned long			used = 0;
+	char					value[8];
+	size_t					idx;
+	size_t					window = MAX_PIPELINE_DEPTH;
+	long					index = first;					// index of requests[0]
+	long					end = (long)first + count;
+	bool					lastEntry = false;
+
+	// the responses are formatted in the order they arrive
+	auto format = [&](PipelineRequest &request, const RbsResponse &response)
+	{
+		size_t entry = &request - &requests[0];
+
+		if (request.errorCode != LarsErr::E_SUCCESS)
+			return;
+
+		length[entry] = arenaSize - used;
+		if (FormatLogger(response, arena + used, &length[entry]) == LarsErr::E_SUCCESS)
+		{
+			offset[entry] = used;
+			used += length[entry];
+		}
+		else
+		{
+			request.errorCode = LarsErr::E_NOT_ENOUGH_MEMORY;
+		}
+	};
+
+	if ((first < 0) || (count <= 0) || !arena || !arenaSize)
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if (end > SHRT_MAX + 1L)
+		end = SHRT_MAX + 1L;
+
+	requests.reserve(MAX_PIPELINE_DEPTH);
+
+	while ((index < end) && !lastEntry && (errorCode == LarsErr::E_SUCCESS))
+	{
+		requests.resize((size_t)min(end - index, (long)window));
+		for (idx = 0; idx < requests.size(); idx++)
+		{
+			if (requests[idx].request.empty())
+			{
+				requests[idx].cmd = CMD_LOGBOOK;
+				requests[idx].request[REF_DATA_ID_LOGBOOK_STR] = "";
+			}
+			snprintf(value, sizeof(value), "%ld", index + (long)idx);
+			requests[idx].request.begin()->second.assign(value);
+		}
+
+		used = 0;
+		if ((errorCode = ExecutePipeline(requests, format)) != LarsErr::E_SUCCESS)
+			break;
+
+		// pass the entries in the order of the index
+		window = MAX_PIPELINE_DEPTH;
+		for (idx = 0; idx < requests.size(); idx++)
+		{
+			if (requests[idx].errorCode == LarsErr::E_LOGBOOK_NO_FURTHER_ENTRY)
+			{
+				lastEntry = true;
+				break;
+			}
+			if (requests[idx].errorCode == LarsErr::E_NOT_ENOUGH_MEMORY)
+			{
+				// the entry is requested alone with the empty arena
+				if ((idx == 0) && (length[idx] > arenaSize))
+					errorCode = LarsErr::E_NOT_ENOUGH_MEMORY;
+				else if (idx == 0)
+					window = 1;
+				break;
+			}
+			if ((errorCode = requests[idx].errorCode) != LarsErr::E_SUCCESS)
+				break;
+
+			consumer((short)(index + idx), arena + offset[idx], length[idx]);
+		}
+		index += idx;
+	}
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* FormatLogger - format the response of a LOG request
+*
+* @param    response:in				response of the LOG request
+* @param    entry:out				STX key FS value GS key FS value ... ETX, "" without values
+* @param    size:in/out				in: size of entry, out: length of the entry with \0
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_NOT_ENOUGH_MEMORY	entry is too small, size is the required size
+* @remarks	the key stat is left out, the keys are sorted like in a keyValuePair,
+*			of a repeated key the last value is taken
+******************************************************************************
+*/
+short AdcRbs::FormatLogger(const RbsResponse &response, char *entry, unsigned long *size)
+{
+	short			order[RbsResponse::MAX_FIELDS];
+	short			fields = 0;
+	short			idx, pos;
+	unsigned long	length = 0;
+	unsigned long	offset = 0;
+
+	auto before = [&response](short left, short right)
+	{
+		const RbsField &l = response.GetKey(left);
+		const RbsField &r = response.GetKey(right);
+		int cmp = memcmp(l.data, r.data, min(l.size, r.size));
+
+		return (cmp < 0) || ((cmp == 0) && (l.size < r.size));
+	};
+
+	// sort the keys by insertion, equal keys keep their order
+	for (idx = 0; idx < response.GetFieldCount(); idx++)
+	{
+		if (response.GetKey(idx).Equals(REF_DATA_ID_STAT_STR))
+			continue;
+
+		for (pos = fields; (pos > 0) && before(idx, order[pos - 1]); pos--)
+			order[pos] = order[pos - 1];
+		order[pos] = idx;
+		fields++;
+	}
+
+	// of equal keys only the last one is used
+	for (idx = 0, pos = 0; idx < fields; idx++)
+	{
+		if ((idx + 1 < fields) && !before(order[idx], order[idx + 1]))
+			continue;
+
+		order[pos++] = order[idx];
+		length += response.GetKey(order[idx]).size + response.GetValue(order[idx]).size + 2;	// GS or STX, key, FS, value
+	}
+	fields = pos;
+	if (length)
+		length++;													// ETX
+
+	// don't forget the terminating \0
+	if (!entry || (length + 1 > *size))
+	{
+		*size = length + 1;
+		return LarsErr::E_NOT_ENOUGH_MEMORY;
+	}
+
+	for (idx = 0; idx < fields; idx++)
+	{
+		const RbsField &key = response.GetKey(order[idx]);
+		const RbsField &value = response.GetValue(order[idx]);
+
+		entry[offset] = offset ? Lars::GS : Lars::STX;
+		offset++;
+		memcpy(entry + offset, key.data, key.size);
+		offset += key.size;
+		entry[offset++] = Lars::FS;
+		memcpy(entry + offset, value.data, value.size);
+		offset += value.size;
+	}
+	if (offset)
+		entry[offset++] = Lars::ETX;
+	entry[offset] = '\0';
+
+	*size = length + 1;
+	return LarsErr::E_SUCCESS;
+}
+
+
 /**
 ******************************************************************************
 * GetRandomAuthentication - function to request the random value from adc
@@ -4156,57 +4418,29 @@ void AdcRbs::CreateReferenceData(const RefDataStruct &refData, keyValuePair &ref
 * @remarks
 ******************************************************************************
 */
-short AdcRbs::CreateTelegram(const string &cmd, const keyValuePair &refDataMap, string &telegram, bool crc16, bool createNewOrderID, short previousOrderID, unsigned long flag)
+short AdcRbs::CreateTelegram(const string &cmd, const keyValuePair &refDataMap, RbsTelegram &telegram, bool crc16, bool createNewOrderID, short previousOrderID, unsigned long flag)
 {
-    stringstream    output;
-    bool            bFirst = true;
-    stringstream    length;
     short           orderID;
 
-    output << setbase(m_base);
 	if (createNewOrderID)
 		orderID = GetOrderID();
 	else
 		orderID = previousOrderID;
-	output << Lars::ESC << orderID;
-	
-	if (flag) output << Lars::ESC << flag;
-		
-	output << Lars::GS << cmd;
 
-    if (refDataMap.size())
-    {
-        output << Lars::STX;
-        for (keyValuePair::const_iterator it = refDataMap.begin(); it != refDataMap.end(); ++it)
-        {
-            if (!bFirst)
-            {
-                output << Lars::GS;
-            }
+	// ESC orderID [ESC flag] GS cmd
+	telegram.Begin(orderID, flag, cmd);
 
-            output << (*it).first;
-            if (!(*it).second.empty()) output << Lars::FS << (*it).second;
-
-            bFirst = false;
-        }
-		output << Lars::ETX;
-		
-		if (crc16) output << CalculateChecksum(output.str());
-    }
-	else
+	// STX key FS value GS ... ETX
+	for (keyValuePair::const_iterator it = refDataMap.begin(); it != refDataMap.end(); ++it)
 	{
-		if (crc16)
-		{
-			output << Lars::GS;
-			output << CalculateChecksum(output.str());
-		}
+		telegram.AddReferenceData((*it).first, (*it).second);
 	}
-    
-	output << Lars::ETB;
 
-    length << setbase(m_base);
-	length << output.str().size();
-	telegram = Lars::SOH + length.str() + output.str();
+	// crc16 ETB, SOH and length in front
+	if (!telegram.End(crc16))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\ttelegram %s too large", __FUNCTION__, cmd.c_str());
+	}
 
     return orderID;
 }
@@ -4243,11 +4477,11 @@ short AdcRbs::GetOrderID()
 * @remarks
 ******************************************************************************
 */
-unsigned short AdcRbs::CalculateChecksum(string str)
+unsigned short AdcRbs::CalculateChecksum(const char *str, unsigned long size)
 {
 	Authentication crc16(RBS_CRC_START, RBS_CRC_POLY, RBS_CRC_MASK);
 
-	return crc16.CalcCrc((unsigned char *)str.c_str(), str.length());
+	return crc16.CalcCrc((unsigned char *)str, size);
 }
 
 
@@ -4255,32 +4489,28 @@ unsigned short AdcRbs::CalculateChecksum(string str)
 ******************************************************************************
 * CheckChecksum - check the telegram checksum
 *
-* @param
-* @return
-* @remarks
+* @param    response:in		parsed telegram
+* @return   LarsErr::E_SUCCESS, LarsErr::E_PROTOCOL_CRC
+* @remarks	the crc covers the telegram from the first ESC up to the last ETX,
+*			without user data up to the last GS
 ******************************************************************************
 */
-short AdcRbs::CheckChecksum(string str, string crc)
+short AdcRbs::CheckChecksum(const RbsResponse &response)
 {
-	short errorCode = LarsErr::E_SUCCESS;
-	size_t start = 0;
-	size_t end = 0;
-	unsigned short crcNew;
-
-	// index of first ESC
-	start = str.find(Lars::ESC);
-	// check if telegram contains user data
-	if ((end = str.find_last_of(Lars::ETX)) == string::npos)
-	{
-		// no user data, get pos from last GS
-		end = str.find_last_of(Lars::GS);
-	}
+	short				errorCode = LarsErr::E_SUCCESS;
+	const RbsField		*crc;
+	const char			*data;
+	unsigned long		size;
+	unsigned long long	crcReceived;
 
-	if ((start != string::npos) && (end != string::npos))
+	if ((crc = response.GetCrc16()) == NULL)
+		return LarsErr::E_SUCCESS;
+
+	if (response.GetCrcRange(&data, &size))
 	{
-		crcNew = CalculateChecksum(str.substr(start, end - start + 1));
+		if (!crc->GetULongLong(&crcReceived)) crcReceived = 0;
 
-		if (crcNew != atoi(crc.c_str()))
+		if (CalculateChecksum(data, size) != crcReceived)
 			errorCode = LarsErr::E_PROTOCOL_CRC;
 	}
 	else
@@ -4296,32 +4526,96 @@ short AdcRbs::CheckChecksum(string str, string crc)
 ******************************************************************************
 * SendRequest - send an request to the ADC
 *
-* @param    telegram:in			prepared rbs telegram
+* @param    cmd:in				rbs command
+* @param    keyValueMap:in/out	in: reference data of the request
+*								out: reference data of the response
 * @param	sendRequestCmd:in	send the request command (supported only for special adw versions !!)
 * @return
 * @remarks
 ******************************************************************************
 */
 short AdcRbs::SendRequestReceiveResponse(const string &cmd, keyValuePair &keyValueMap, bool sendRequestCmd)
+{
+	short	errorCode;
+	bool	cached = sendRequestCmd && m_registerCacheEnabled && IsCachedRegister(cmd, keyValueMap);
+	string	cacheKey;
+	map<string, keyValuePair>::const_iterator register_;
+
+	// scale values only change by our own SSV* or by RST, CAL and AP
+	if (cached)
+	{
+		cacheKey = GetRegisterCacheKey(cmd, keyValueMap);
+		if ((register_ = m_registerCache.find(cacheKey)) != m_registerCache.end())
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tcached response %s", __FUNCTION__, cmd.c_str());
+			keyValueMap = register_->second;
+			return LarsErr::E_SUCCESS;
+		}
+	}
+
+	// take a prefetched response of the same request
+	for (vector<PipelineRequest>::iterator it = m_prefetch.begin(); it != m_prefetch.end(); ++it)
+	{
+		if (sendRequestCmd && ((*it).cmd == cmd) && ((*it).request == keyValueMap))
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tprefetched response %s", __FUNCTION__, cmd.c_str());
+			errorCode = (*it).errorCode;
+			keyValueMap.swap((*it).response);
+			m_prefetch.erase(it);
+			return errorCode;
+		}
+	}
+
+	errorCode = ExecuteRequest(cmd, keyValueMap, sendRequestCmd);
+
+	// copy content of response to keyValueMap
+	keyValueMap.clear();
+	for (short idx = 0; idx < m_response.GetFieldCount(); idx++)
+	{
+		keyValueMap[m_response.GetKey(idx).ToString()] = m_response.GetValue(idx).ToString();
+	}
+
+	if (cached && (errorCode == LarsErr::E_SUCCESS))
+		m_registerCache[cacheKey] = keyValueMap;
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* ExecuteRequest - send an request to the ADC and receive the response
+*
+* @param    cmd:in				rbs command
+* @param    request:in			reference data of the request
+* @param	sendRequestCmd:in	send the request command (supported only for special adw versions !!)
+* @return
+* @remarks	the response is parsed in place to m_response, it is valid until
+*			the next request. On transport or protocol errors m_response is empty.
+******************************************************************************
+*/
+short AdcRbs::ExecuteRequest(const string &cmd, const keyValuePair &request, bool sendRequestCmd)
 {
     short           errorCode = LarsErr::E_SUCCESS;
-    string          telegram;
-    string          response;
+    unsigned long   responseSize;
     short           orderID = 0;
     short           orderIDResponse = 0;
-	string          cmdResponse = "";
+	bool			cmdResponseOk = false;
     unsigned long   bytesWritten;
-    keyValuePair    headerMap;
-	keyValuePair    refDataMap;
-    string          key;
-    string          value;
-    RefDataStruct   refData;
     short           stat;
 	short			retries;
 	bool			createNewOrderID;
 	unsigned long   flag = 0;
 	short			timeoutOffset = 0;
 	bool			cmdOrderIdOk;
+	bool			received = false;
+	short			command = m_statistics.GetCommand(cmd);
+	chrono::steady_clock::time_point sent;
+
+	m_response.Clear();
+
+	// the adc state may change with every request
+	m_prefetch.clear();
 
     if (m_interface)
     {
@@ -4340,6 +4634,7 @@ short AdcRbs::SendRequestReceiveResponse(const string &cmd, keyValuePair &keyVal
 				createNewOrderID = false;
 
 				flag |= FLAG_TELEGRAM_REPEAT;
+				m_statistics.Count(command, AdcStatistics::CNT_RETRIES);
 			}
 
 			if (sendRequestCmd)
@@ -4348,15 +4643,23 @@ short AdcRbs::SendRequestReceiveResponse(const string &cmd, keyValuePair &keyVal
 				errorCode = LarsErr::E_SUCCESS;
 
 				// create telegram
-				orderID = CreateTelegram(cmd, keyValueMap, telegram, m_interface->UseCRC16(), createNewOrderID, orderID, flag);
+				orderID = CreateTelegram(cmd, request, m_telegram, m_interface->UseCRC16(), createNewOrderID, orderID, flag);
+				if (m_telegram.Overflow())
+				{
+					m_response.Clear();
+					return LarsErr::E_INVALID_PARAMETER;
+				}
 
-				g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tAPPL -> ADC %s", __FUNCTION__, telegram.c_str());
+				g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tAPPL -> ADC %s", __FUNCTION__, m_telegram.GetData());
 				// send telegram 
-				bytesWritten = m_interface->Write((void *)telegram.c_str(), telegram.size());
-				if (bytesWritten != telegram.size())
+				sent = chrono::steady_clock::now();
+				bytesWritten = m_interface->Write((void *)m_telegram.GetData(), m_telegram.GetSize());
+				m_statistics.RecordLatency(command, AdcStatistics::LAT_WRITE, chrono::steady_clock::now() - sent);
+				if (bytesWritten != m_telegram.GetSize())
 				{
 					errorCode = LarsErr::E_ADC_ERROR;
 				}
+				m_flightRecorder.Record(AdcFlightRecorder::DIR_REQUEST, m_telegram.GetData(), m_telegram.GetSize(), orderID, errorCode);
 			}
 
 			if (errorCode != LarsErr::E_ADC_ERROR)
@@ -4374,91 +4677,40 @@ short AdcRbs::SendRequestReceiveResponse(const string &cmd, keyValuePair &keyVal
 						std::this_thread::sleep_for(std::chrono::milliseconds(0));
 #endif
 						if (cmd == CMD_ADC_RESET) timeoutOffset = 2;
-						errorCode = ReceiveResponse(response, timeoutOffset);
-					}
-
-					// parse response
-					if (errorCode == LarsErr::E_SUCCESS)
-					{
-						errorCode = GetKeyValuePair(RBS_FULL_TELEGRAM, response, headerMap, refDataMap);
-					}
-
-					if (errorCode == LarsErr::E_SUCCESS)
-					{
-						// check if checksum exits and if checksum is ok
-						key = HEADER_CRC16;
-						if (Helpers::KeyExists(headerMap, key, value))
-						{
-							errorCode = CheckChecksum(response, value);
-						}
-					}
-
-					if (errorCode == LarsErr::E_SUCCESS)
-					{
-						// get orderID from response
-						key = HEADER_ORDERID;
-						if (Helpers::KeyExists(headerMap, key, value))
-						{
-							istringstream input(value);
-							input >> setbase(m_base);
-							input >> orderIDResponse;
-
-							if (orderID != orderIDResponse)
-								g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\torderID %d  responseID %d", __FUNCTION__, orderID, orderIDResponse);
-						}
-						else
-						{
-							errorCode = LarsErr::E_PROTOCOL;
-						}
-					}
-
-					if (errorCode == LarsErr::E_SUCCESS)
-					{
-						// get cmd from response
-						key = HEADER_CMD;
-						if (Helpers::KeyExists(headerMap, key, value))
-						{
-							cmdResponse = value;
-
-							if (cmd != cmdResponse)
-								g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcmd %s  cmdResponse %s", __FUNCTION__, cmd.c_str(), cmdResponse.c_str());
-						}
-						else
-						{
-							errorCode = LarsErr::E_PROTOCOL;
-						}
+						errorCode = ReceiveResponse(&responseSize, timeoutOffset);
+						received = (errorCode == LarsErr::E_SUCCESS);
 					}
 
+					// parse response in place, check crc, order ID, cmd and stat
 					if (errorCode == LarsErr::E_SUCCESS)
-					{
-						// check status for protocol crc error
-						refData.id = REF_DATA_ID_STAT;
-						if (GetReferenceData(REF_DATA_ID_STAT_STR, refDataMap, refData, 1) == LarsErr::E_SUCCESS)
-						{
-							stat = refData.u.stat;
-							if (stat == ADC_ERROR_PROTOCOL_CRC)
-							{
-								errorCode = LarsErr::E_PROTOCOL_CRC;
-								g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tadc receives telegram with crc error", __FUNCTION__);
-							}
-						}
-						else
-						{
-							errorCode = LarsErr::E_PROTOCOL;
-						}
-					}
+						errorCode = CheckResponse(cmd, orderID, responseSize, &orderIDResponse, &cmdResponseOk, &stat);
 
 					// check cmd and orderID
 					cmdOrderIdOk = true;
-					if (sendRequestCmd && ((cmd != cmdResponse) || (orderID != orderIDResponse)))
+					if (sendRequestCmd && (!cmdResponseOk || (orderID != orderIDResponse)))
 						cmdOrderIdOk = false;
 
 				} while ((errorCode == LarsErr::E_SUCCESS) && (cmdOrderIdOk == false));
+
+				// errors of the received telegram, errors of the receive itself are recorded by ReceiveResponse
+				if (received && ((errorCode == LarsErr::E_PROTOCOL) || (errorCode == LarsErr::E_PROTOCOL_CRC)))
+					m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, NULL, 0, orderID, errorCode);
+
+				// without request there is no start of the exchange
+				if ((errorCode == LarsErr::E_SUCCESS) && sendRequestCmd)
+				{
+					m_statistics.RecordLatency(command, AdcStatistics::LAT_FIRST_BYTE, m_firstByteTime - sent);
+					m_statistics.RecordLatency(command, AdcStatistics::LAT_ROUND_TRIP, chrono::steady_clock::now() - sent);
+				}
 			}
 
+			CountError(command, errorCode);
+
 			// on error try to reconnect to adc
 			if (((errorCode == LarsErr::E_ADC_ERROR) || (errorCode == LarsErr::E_ADC_TIMEOUT)) && (retries < TIMEOUT_RETRIES_ATTEMPTS - 1))
 			{
+				// the adc may have restarted meanwhile
+				m_registerCache.clear();
 				if (!m_interface->Reconnect())
 				{
 					errorCode = LarsErr::E_NO_DEVICE;
@@ -4468,201 +4720,1204 @@ short AdcRbs::SendRequestReceiveResponse(const string &cmd, keyValuePair &keyVal
 		} while (((errorCode == LarsErr::E_ADC_ERROR) || (errorCode == LarsErr::E_ADC_TIMEOUT) || (errorCode == LarsErr::E_PROTOCOL_CRC) || (errorCode == LarsErr::E_PROTOCOL)) 
 				   && (++retries < TIMEOUT_RETRIES_ATTEMPTS));
 
-		keyValueMap.clear();
-		if (errorCode == LarsErr::E_SUCCESS)
+		m_statistics.Count(command, AdcStatistics::CNT_REQUESTS);
+
+		// keep the response only if it is valid
+		if (errorCode != LarsErr::E_SUCCESS)
 		{
-			// copy content of refDataMap to keyValueMap
-			keyValueMap.insert(refDataMap.begin(), refDataMap.end());
+			m_statistics.Count(command, AdcStatistics::CNT_FAILURES);
+			m_response.Clear();
 		}
 
         // get state
         if (errorCode == LarsErr::E_SUCCESS)
         {
 			// map adc stat error to library error
-			switch (stat)
-			{
-				case ADC_CMD_SUCCESSFUL:			errorCode = LarsErr::E_SUCCESS; break;
-				case ADC_CMD_NOT_EXECUTED:			errorCode = LarsErr::E_COMMAND_NOT_EXECUTED; break;
-				case ADC_INVALID_PARAMETER:			errorCode = LarsErr::E_INVALID_PARAMETER; break;
-				case ADC_FUNCTION_NOT_IMPLEMENTED:	errorCode = LarsErr::E_FUNCTION_NOT_IMPLEMENTED; break;
-				case ADC_ERROR_AUTHENTICATION:		errorCode = LarsErr::E_AUTHENTICATION; break;
-				case ADC_COMMAND_NOT_SUPPORTED_IN_THIS_OPERATING_MODE:	errorCode = LarsErr::E_COMMAND_NOT_SUPPORTED_IN_THIS_OPERATING_MODE; break;
-				case ADC_LOGBOOK_NO_FURTHER_ENTRY:	errorCode = LarsErr::E_LOGBOOK_NO_FURTHER_ENTRY; break;
-				case ADC_LOGBOOK_FULL:				errorCode = LarsErr::E_LOGBOOK_FULL; break;
-				case ADC_ERROR_TILT_COMPENSATION_SWITCH_ON:				errorCode = LarsErr::E_TILT_COMPENSATION_SWITCH_ON; break;
-				case ADC_ERROR_CHKSUM_BLOCK_3_4:	errorCode = LarsErr::E_CHKSUM_BLOCK_3_4; break;
-				case ADC_ERROR_PROTOCOL_CRC:		errorCode = LarsErr::E_PROTOCOL_CRC; break;
-				case ADC_ERROR_LINEAR_CALIBRATION:	errorCode = LarsErr::E_LINEAR_CALIBRATION; break;
-				case ADC_ERROR_EEPROM_ACCESS_VIOLATION:					errorCode = LarsErr::E_EEPROM_ACCESS_VIOLATION; break;
-				case ADC_ERROR_CMD_ONLY_FOR_SEPARATE_LOADCELL:			errorCode = LarsErr::E_COMMAND_ONLY_FOR_SEPARATE_LOADCELL; break;
-				case ADC_ERROR_UPDATE_NOT_ALLOWED:	errorCode = LarsErr::E_UPDATE_NOT_ALLOWED; break;
-				case ADC_ERROR_TCC_SWITCH_ON:		errorCode = LarsErr::E_TCC_SWITCH_ON; break;
-				case ADC_ERROR_INCOMPATIBLE_PROD_DATA:					errorCode = LarsErr::E_INCOMPATIBLE_PROD_DATA; break;
-				case ADC_ERROR_TARE_OCCUPIED:		errorCode = LarsErr::E_TARE_OCCUPIED; break;
-				case ADC_ERROR_KNOWN_TARE_LESS_E:	errorCode = LarsErr::E_KNOWN_TARE_LESS_E; break;
-				case ADC_ERROR_BATCH_TARE_NOT_ALLOWED:					errorCode = LarsErr::E_BATCH_TARE_NOT_ALLOWED; break;
-				case ADC_ERROR_TARE_OUT_OF_RANGE:	errorCode = LarsErr::E_TARE_OUT_OF_RANGE; break;
-				case ADC_ERROR_TARE_OUTSIDE_CLEARING_AREA:				errorCode = LarsErr::E_TARE_OUTSIDE_CLEARING_AREA; break;
-				case ADC_ERROR_WS_NOT_SUPPORT_LOAD_CAPACITY:			errorCode = LarsErr::E_WS_NOT_SUPPORT_LOAD_CAPACITY; break;
-				case ADC_ERROR_CHKSUM_FIRMWARE:		errorCode = LarsErr::E_CHKSUM_FIRMWARE; break;
-				default: errorCode = LarsErr::E_ADC_ERROR; break;
-			}
+			errorCode = ConvertAdcStat(stat);
         }
+
+		UpdateRegisterCache(cmd, request, errorCode);
+		UpdateProfile(cmd);
     }
 
     return errorCode;
 }
 
 
-short AdcRbs::ReceiveResponse(string &response, short timeoutOffset)
-{
-    short   errorCode = LarsErr::E_SUCCESS;
-    short   modulState = WAIT_FOR_SOH;
-    short   retry = 0;
-    char    receiveByte;
-    unsigned long length = 0;
-	unsigned long currentReceived = 0;
-    short   index = 0;
-    short   idxLenStart = 0, idxLenEnd = 0;
-    bool    bReceiveOK = false;
-
-    response.clear();
-
-	while (!bReceiveOK && (errorCode == LarsErr::E_SUCCESS) && (retry < (TIMEOUT_RECEIVE + timeoutOffset)))
-    {
-        switch (modulState)
-        {
-			case WAIT_FOR_SOH:
-				if (m_interface->Read(&receiveByte, 1) == 1)
+/**
+******************************************************************************
+* ExecutePipeline - send several requests without waiting for the responses
+*
+* @param    requests:in/out		in: cmd and request of every command
+*								out: response and errorCode of every command
+* @param    handler:in			takes the responses instead of requests[].response, may be empty
+* @return   LarsErr::E_SUCCESS	all commands are answered, see errorCode of the commands
+*			first transport error
+* @remarks	up to MAX_PIPELINE_DEPTH telegrams are sent back to back, the
+*			responses are matched by order ID in the order they arrive.
+*			Unanswered commands are repeated with their order ID and
+*			FLAG_TELEGRAM_REPEAT like in ExecuteRequest.
+*			The handler gets every answered command with its errorCode and
+*			the response in m_response, it may change the errorCode.
+******************************************************************************
+*/
+short AdcRbs::ExecutePipeline(vector<PipelineRequest> &requests, const PipelineHandler &handler)
+{
+	short			errorCode = LarsErr::E_SUCCESS;
+	short			retries = 0;
+	bool			writeError;
+	unsigned long	responseSize;
+	unsigned long	bytesWritten;
+	short			outstanding;
+	short			orderIDResponse;
+	const RbsField	*field;
+	RefDataStruct	refData;
+	size_t			idx, first, last;
+
+	m_response.Clear();
+	m_prefetch.clear();
+
+	if (!m_interface)
+		return LarsErr::E_NO_DEVICE;
+
+	for (idx = 0; idx < requests.size(); idx++)
+	{
+		requests[idx].response.clear();
+		requests[idx].errorCode = LarsErr::E_ADC_TIMEOUT;
+		requests[idx].orderID = 0;
+		requests[idx].pending = true;
+		requests[idx].command = m_statistics.GetCommand(requests[idx].cmd);
+	}
+
+	do
+	{
+		for (first = 0; first < requests.size(); first = last)
+		{
+			// send the next pending commands back to back
+			outstanding = 0;
+			writeError = false;
+			for (last = first; (last < requests.size()) && (outstanding < MAX_PIPELINE_DEPTH); last++)
+			{
+				PipelineRequest &request = requests[last];
+
+				if (!request.pending)
+					continue;
+
+				if (request.orderID)
+					m_statistics.Count(request.command, AdcStatistics::CNT_RETRIES);
+
+				// a repeated command keeps its order ID
+				request.orderID = CreateTelegram(request.cmd, request.request, m_telegram, m_interface->UseCRC16(),
+												 request.orderID == 0, request.orderID, request.orderID ? FLAG_TELEGRAM_REPEAT : 0);
+				if (m_telegram.Overflow())
 				{
-					if (receiveByte == Lars::SOH)
+					request.errorCode = LarsErr::E_INVALID_PARAMETER;
+					request.pending = false;
+					continue;
+				}
+
+				g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tAPPL -> ADC %s", __FUNCTION__, m_telegram.GetData());
+				request.sent = chrono::steady_clock::now();
+				bytesWritten = m_interface->Write((void *)m_telegram.GetData(), m_telegram.GetSize());
+				m_statistics.RecordLatency(request.command, AdcStatistics::LAT_WRITE, chrono::steady_clock::now() - request.sent);
+				m_flightRecorder.Record(AdcFlightRecorder::DIR_REQUEST, m_telegram.GetData(), m_telegram.GetSize(), request.orderID,
+										(bytesWritten == m_telegram.GetSize()) ? LarsErr::E_SUCCESS : LarsErr::E_ADC_ERROR);
+				if (bytesWritten != m_telegram.GetSize())
+				{
+					request.errorCode = LarsErr::E_ADC_ERROR;
+					writeError = true;
+					last++;
+					break;
+				}
+
+				request.errorCode = LarsErr::E_ADC_TIMEOUT;
+				outstanding++;
+			}
+
+			// receive the responses in any order
+			while (outstanding > 0)
+			{
+				if ((errorCode = ReceiveResponse(&responseSize)) != LarsErr::E_SUCCESS)
+				{
+					// adc does not answer anymore, repeat all outstanding commands
+					if (errorCode != LarsErr::E_PROTOCOL)
 					{
-						// reset index
-						index = 0;
-						idxLenStart = 0;
-						idxLenEnd = 0;
+						for (idx = first; idx < last; idx++)
+						{
+							if (requests[idx].pending && (requests[idx].errorCode == LarsErr::E_ADC_TIMEOUT))
+								CountError(requests[idx].command, errorCode);
+						}
+						break;
+					}
+					continue;
+				}
+
+				if (m_response.Parse(m_receiveBuffer, responseSize) != LarsErr::E_SUCCESS)
+				{
+					g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, invalid telegram [%s]", __FUNCTION__, m_receiveBuffer);
+					m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, NULL, 0, -1, LarsErr::E_PROTOCOL);
+					continue;
+				}
+
+				// responses with crc error can't be assigned, the command is repeated after the timeout
+				if ((CheckChecksum(m_response) != LarsErr::E_SUCCESS) ||
+					((field = m_response.GetHeader(RbsResponse::IDX_ORDERID)) == NULL) ||
+					!field->GetShort(&orderIDResponse))
+				{
+					g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, response ignored", __FUNCTION__);
+					m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, NULL, 0, -1, LarsErr::E_PROTOCOL_CRC);
+					continue;
+				}
+
+				for (idx = first; idx < last; idx++)
+				{
+					PipelineRequest &request = requests[idx];
+
+					if (!request.pending || (request.errorCode != LarsErr::E_ADC_TIMEOUT) ||
+						(request.orderID != orderIDResponse) || !m_response.GetCmd().Equals(request.cmd))
+						continue;
+
+					outstanding--;
+
+					m_statistics.RecordLatency(request.command, AdcStatistics::LAT_FIRST_BYTE, m_firstByteTime - request.sent);
+					m_statistics.RecordLatency(request.command, AdcStatistics::LAT_ROUND_TRIP, chrono::steady_clock::now() - request.sent);
+
+					refData.id = REF_DATA_ID_STAT;
+					if (GetReferenceData(REF_DATA_ID_STAT_STR, m_response, refData, 1) != LarsErr::E_SUCCESS)
+					{
+						request.errorCode = LarsErr::E_PROTOCOL;
+						m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, NULL, 0, request.orderID, request.errorCode);
+						CountError(request.command, request.errorCode);
+					}
+					else if (refData.u.stat == ADC_ERROR_PROTOCOL_CRC)
+					{
+						g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tadc receives telegram with crc error", __FUNCTION__);
+						request.errorCode = LarsErr::E_PROTOCOL_CRC;
+						m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, NULL, 0, request.orderID, request.errorCode);
+						CountError(request.command, request.errorCode);
+					}
+					else if (handler)
+					{
+						request.errorCode = ConvertAdcStat(refData.u.stat);
+						request.pending = false;
+						handler(request, m_response);
+						UpdateRegisterCache(request.cmd, request.request, request.errorCode);
+					}
+					else
+					{
+						for (short key = 0; key < m_response.GetFieldCount(); key++)
+						{
+							request.response[m_response.GetKey(key).ToString()] = m_response.GetValue(key).ToString();
+						}
+						request.errorCode = ConvertAdcStat(refData.u.stat);
+						request.pending = false;
+
+						// prefetched scale values fill the register cache
+						if (m_registerCacheEnabled && (request.errorCode == LarsErr::E_SUCCESS) && IsCachedRegister(request.cmd, request.request))
+							m_registerCache[GetRegisterCacheKey(request.cmd, request.request)] = request.response;
+						UpdateRegisterCache(request.cmd, request.request, request.errorCode);
+					}
+					break;
+				}
+
+				if (idx == last)
+					g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tresponse orderID %d without request", __FUNCTION__, orderIDResponse);
+			}
+
+			if ((outstanding > 0) || writeError)
+				break;
+		}
+
+		// find the first unanswered command
+		errorCode = LarsErr::E_SUCCESS;
+		for (idx = 0; idx < requests.size(); idx++)
+		{
+			if (requests[idx].pending)
+			{
+				errorCode = requests[idx].errorCode;
+				break;
+			}
+		}
+
+		// on error try to reconnect to adc
+		if (((errorCode == LarsErr::E_ADC_ERROR) || (errorCode == LarsErr::E_ADC_TIMEOUT)) && (retries < TIMEOUT_RETRIES_ATTEMPTS - 1))
+		{
+			m_registerCache.clear();
+			if (!m_interface->Reconnect())
+			{
+				errorCode = LarsErr::E_NO_DEVICE;
+			}
+		}
+
+	} while (((errorCode == LarsErr::E_ADC_ERROR) || (errorCode == LarsErr::E_ADC_TIMEOUT) || (errorCode == LarsErr::E_PROTOCOL_CRC) || (errorCode == LarsErr::E_PROTOCOL))
+			   && (++retries < TIMEOUT_RETRIES_ATTEMPTS));
+
+	// unanswered commands get the transport error
+	for (idx = 0; idx < requests.size(); idx++)
+	{
+		m_statistics.Count(requests[idx].command, AdcStatistics::CNT_REQUESTS);
+		if (requests[idx].pending)
+		{
+			m_statistics.Count(requests[idx].command, AdcStatistics::CNT_FAILURES);
+			if (errorCode == LarsErr::E_NO_DEVICE) requests[idx].errorCode = errorCode;
+			requests[idx].pending = false;
+		}
+	}
+
+	m_response.Clear();
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* CheckResponse - parse the received telegram and check it
+*
+* @param    cmd:in				rbs command of the request
+* @param    orderID:in			order ID of the request
+* @param    size:in				size of the telegram in m_receiveBuffer
+* @param    orderIDResponse:out	order ID of the response
+* @param    cmdResponseOk:out	response belongs to cmd
+* @param    stat:out			stat of the response
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_PROTOCOL		invalid telegram
+*			LarsErr::E_PROTOCOL_CRC	crc error of the response or of the request
+* @remarks	the response is parsed in place to m_response. A response of
+*			another request is no error, see orderIDResponse and cmdResponseOk.
+******************************************************************************
+*/
+short AdcRbs::CheckResponse(const string &cmd, short orderID, unsigned long size, short *orderIDResponse, bool *cmdResponseOk, short *stat)
+{
+	short			errorCode;
+	const RbsField	*field;
+	RefDataStruct	refData;
+
+	if ((errorCode = m_response.Parse(m_receiveBuffer, size)) != LarsErr::E_SUCCESS)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, invalid telegram [%s]", __FUNCTION__, m_receiveBuffer);
+		return errorCode;
+	}
+
+	// check if checksum exits and if checksum is ok
+	if ((errorCode = CheckChecksum(m_response)) != LarsErr::E_SUCCESS)
+		return errorCode;
+
+	// get orderID from response
+	if ((field = m_response.GetHeader(RbsResponse::IDX_ORDERID)) == NULL)
+		return LarsErr::E_PROTOCOL;
+
+	if (!field->GetShort(orderIDResponse)) *orderIDResponse = 0;
+	if (orderID != *orderIDResponse)
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\torderID %d  responseID %d", __FUNCTION__, orderID, *orderIDResponse);
+
+	// get cmd from response
+	*cmdResponseOk = m_response.GetCmd().Equals(cmd);
+	if (!*cmdResponseOk)
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcmd %s  cmdResponse %s", __FUNCTION__, cmd.c_str(), m_response.GetCmd().ToString().c_str());
+
+	// check status for protocol crc error
+	refData.id = REF_DATA_ID_STAT;
+	if (GetReferenceData(REF_DATA_ID_STAT_STR, m_response, refData, 1) != LarsErr::E_SUCCESS)
+		return LarsErr::E_PROTOCOL;
+
+	*stat = refData.u.stat;
+	if (*stat == ADC_ERROR_PROTOCOL_CRC)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tadc receives telegram with crc error", __FUNCTION__);
+		return LarsErr::E_PROTOCOL_CRC;
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* StartRequest - send a request to the ADC without waiting for the response
+*
+* @param    cmd:in			rbs command
+* @param    request:in		reference data of the request
+* @return   errorCode
+* @remarks	ContinueRequest receives the response when the interface has
+*			data, see AdcInterface::GetPollFd. Only one request may be in work.
+******************************************************************************
+*/
+short AdcRbs::StartRequest(const string &cmd, const keyValuePair &request)
+{
+	short	errorCode;
+
+	m_response.Clear();
+
+	// the adc state may change with every request
+	m_prefetch.clear();
+
+	if (!m_interface)
+		return LarsErr::E_NO_DEVICE;
+
+	m_async.cmd = cmd;
+	m_async.request = request;
+	m_async.orderID = 0;
+	m_async.retries = 0;
+	m_async.command = m_statistics.GetCommand(cmd);
+
+	if ((errorCode = SendAsyncRequest(true)) != LarsErr::E_SUCCESS)
+	{
+		m_statistics.Count(m_async.command, AdcStatistics::CNT_REQUESTS);
+		m_statistics.Count(m_async.command, AdcStatistics::CNT_FAILURES);
+		return errorCode;
+	}
+
+	m_async.active = true;
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* SendAsyncRequest - send the telegram of m_async
+*
+* @param    createNewOrderID:in		false: repeat with the previous order ID
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short AdcRbs::SendAsyncRequest(bool createNewOrderID)
+{
+	short			errorCode = LarsErr::E_SUCCESS;
+	unsigned long	bytesWritten;
+
+	// the previous response is not needed anymore
+	ReleaseTelegram();
+
+	m_async.orderID = CreateTelegram(m_async.cmd, m_async.request, m_telegram, m_interface->UseCRC16(), createNewOrderID, m_async.orderID,
+									 createNewOrderID ? 0 : FLAG_TELEGRAM_REPEAT);
+	if (m_telegram.Overflow())
+		return LarsErr::E_INVALID_PARAMETER;
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tAPPL -> ADC %s", __FUNCTION__, m_telegram.GetData());
+	m_async.sent = chrono::steady_clock::now();
+	bytesWritten = m_interface->Write((void *)m_telegram.GetData(), m_telegram.GetSize());
+	m_statistics.RecordLatency(m_async.command, AdcStatistics::LAT_WRITE, chrono::steady_clock::now() - m_async.sent);
+	if (bytesWritten != m_telegram.GetSize())
+	{
+		errorCode = LarsErr::E_ADC_ERROR;
+	}
+	m_flightRecorder.Record(AdcFlightRecorder::DIR_REQUEST, m_telegram.GetData(), m_telegram.GetSize(), m_async.orderID, errorCode);
+
+	m_async.deadline = chrono::steady_clock::now() + chrono::milliseconds(TIMEOUT_RECEIVE * TIMEOUT_RECEIVE_STEP);
+	m_firstByteTime = m_async.sent;
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* ContinueRequest - receive the response of StartRequest as far as possible
+*
+* @param    done:out		true: request is finished, see return value
+* @param    deadline:out	latest time of the next call if not done
+* @return   errorCode of the request if done, else LarsErr::E_SUCCESS
+* @remarks	never waits, only the bytes already received are read. On
+*			timeout, crc and protocol errors the request is repeated like
+*			in ExecuteRequest, but without reconnect as that would block.
+******************************************************************************
+*/
+short AdcRbs::ContinueRequest(bool *done, chrono::steady_clock::time_point *deadline)
+{
+	short			errorCode;
+	unsigned long	size;
+	unsigned long	numRd;
+	short			orderIDResponse = 0;
+	bool			cmdResponseOk = false;
+	short			stat = 0;
+
+	*done = false;
+
+	if (!m_async.active)
+	{
+		*done = true;
+		return LarsErr::E_INVALID_PARAMETER;
+	}
+
+	while (true)
+	{
+		// responses of earlier requests are dropped
+		ReleaseTelegram();
+
+		if ((errorCode = FrameTelegram(&size)) != LarsErr::E_SUCCESS)
+		{
+			// framing error, the invalid SOH is already dropped
+			m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, m_receiveBuffer, m_receiveLevel, -1, errorCode);
+			break;
+		}
+
+		if (size)
+		{
+			AcceptTelegram(size);
+			errorCode = CheckResponse(m_async.cmd, m_async.orderID, size, &orderIDResponse, &cmdResponseOk, &stat);
+			if (errorCode != LarsErr::E_SUCCESS)
+				m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, NULL, 0, m_async.orderID, errorCode);
+			if ((errorCode != LarsErr::E_SUCCESS) || (cmdResponseOk && (orderIDResponse == m_async.orderID)))
+				break;
+			continue;
+		}
+
+		numRd = m_interface->ReadAvailable(&m_receiveBuffer[m_receiveLevel], AdcProtocol::RECEIVE_BUFFER_SIZE - 1 - m_receiveLevel, 0);
+		if (numRd)
+		{
+			if (!m_receiveLevel)
+				m_firstByteTime = chrono::steady_clock::now();
+			m_receiveLevel += numRd;
+			continue;
+		}
+
+		// wait for the next data
+		if (chrono::steady_clock::now() < m_async.deadline)
+		{
+			*deadline = m_async.deadline;
+			return LarsErr::E_SUCCESS;
+		}
+
+		m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, m_receiveBuffer, m_receiveLevel, -1, LarsErr::E_ADC_TIMEOUT);
+		m_interface->ResetInterface();
+		m_receiveLevel = 0;
+		errorCode = LarsErr::E_ADC_TIMEOUT;
+		break;
+	}
+
+	CountError(m_async.command, errorCode);
+
+	// repeat the request with the same order ID
+	if (((errorCode == LarsErr::E_ADC_TIMEOUT) || (errorCode == LarsErr::E_PROTOCOL_CRC) || (errorCode == LarsErr::E_PROTOCOL))
+		&& (++m_async.retries < TIMEOUT_RETRIES_ATTEMPTS))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\trepeat %s, error 0x%X", __FUNCTION__, m_async.cmd.c_str(), errorCode);
+		m_statistics.Count(m_async.command, AdcStatistics::CNT_RETRIES);
+		if ((errorCode = SendAsyncRequest(false)) == LarsErr::E_SUCCESS)
+		{
+			*deadline = m_async.deadline;
+			return LarsErr::E_SUCCESS;
+		}
+	}
+
+	m_async.active = false;
+	*done = true;
+
+	m_statistics.Count(m_async.command, AdcStatistics::CNT_REQUESTS);
+
+	// keep the response only if it is valid
+	if (errorCode != LarsErr::E_SUCCESS)
+	{
+		m_statistics.Count(m_async.command, AdcStatistics::CNT_FAILURES);
+		m_response.Clear();
+		return errorCode;
+	}
+
+	m_statistics.RecordLatency(m_async.command, AdcStatistics::LAT_FIRST_BYTE, m_firstByteTime - m_async.sent);
+	m_statistics.RecordLatency(m_async.command, AdcStatistics::LAT_ROUND_TRIP, chrono::steady_clock::now() - m_async.sent);
+
+	// map adc stat error to library error
+	return ConvertAdcStat(stat);
+}
+
+
+/**
+******************************************************************************
+* CancelRequest - give up the request of StartRequest
+*
+* @return   void
+* @remarks	a late response is dropped by the next request as its order ID
+*			doesn't match
+******************************************************************************
+*/
+void AdcRbs::CancelRequest()
+{
+	if (!m_async.active)
+		return;
+
+	m_async.active = false;
+	m_response.Clear();
+	m_statistics.Count(m_async.command, AdcStatistics::CNT_REQUESTS);
+	m_statistics.Count(m_async.command, AdcStatistics::CNT_FAILURES);
+}
+
+
+/**
+******************************************************************************
+* Prefetch - execute requests pipelined and keep the responses
+*
+* @param    requests:in		requests, the getters send later
+* @return   errorCode of ExecutePipeline
+* @remarks	SendRequestReceiveResponse takes the response of the same command
+*			and request from m_prefetch instead of sending it. The responses
+*			are dropped with the next request that is sent to the adc.
+******************************************************************************
+*/
+short AdcRbs::Prefetch(vector<PipelineRequest> &requests)
+{
+	short	errorCode;
+
+	errorCode = ExecutePipeline(requests);
+
+	// on transport errors the getters send their requests again
+	if (errorCode == LarsErr::E_SUCCESS)
+		m_prefetch.swap(requests);
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* PrefetchIdentification - request version and operating mode pipelined
+*
+* @return   errorCode
+* @remarks	see Prefetch, used by Lars::SetAdcVariables
+******************************************************************************
+*/
+short AdcRbs::PrefetchIdentification()
+{
+	vector<PipelineRequest> requests(2);
+
+	requests[0].cmd = CMD_GET_VERSION;
+	requests[1].cmd = CMD_GET_SCALE_VALUE;
+	requests[1].request[REF_DATA_ID_OPERATING_MODE_STR] = "";
+
+	return Prefetch(requests);
+}
+
+
+/**
+******************************************************************************
+* PrefetchSettings - request the settings of the application mode pipelined
+*
+* @param    firmwareSettings:in	also request the settings fixed by the firmware
+* @param    responses:out	successful responses of the firmware settings for the device profile, may be NULL
+*
+* @return   errorCode
+* @remarks	see Prefetch, same requests as GetCountrySettings, GetLoadCapacity,
+*			GetTiltCompensation, GetScaleModel and with firmwareSettings
+*			GetCapabilities and GetEepromSize
+******************************************************************************
+*/
+short AdcRbs::PrefetchSettings(const bool firmwareSettings, AdcProfile::Responses *responses)
+{
+	short	errorCode;
+	vector<PipelineRequest> requests(firmwareSettings ? 6 : 4);
+
+	requests[0].cmd = CMD_GET_COUNTRY_SETTINGS;
+	requests[1].cmd = CMD_GET_LC_SETTINGS;
+	requests[2].cmd = CMD_GET_SCALE_VALUE_TC;
+	requests[3].cmd = CMD_GET_SCALE_VALUE;
+	requests[3].request[REF_DATA_ID_SCALE_MODEL_STR] = "";
+	if (firmwareSettings)
+	{
+		requests[4].cmd = CMD_GET_CAPABILITIES;
+		requests[5].cmd = CMD_GET_SCALE_VALUE_EE_SIZE;
+	}
+
+	if (((errorCode = Prefetch(requests)) == LarsErr::E_SUCCESS) && responses)
+	{
+		responses->clear();
+		for (vector<PipelineRequest>::const_iterator it = m_prefetch.begin(); it != m_prefetch.end(); ++it)
+		{
+			if (((*it).errorCode == LarsErr::E_SUCCESS) && IsFirmwareSetting((*it).cmd))
+			{
+				AdcProfile::Response response = { (*it).cmd, (*it).request, (*it).response };
+				responses->push_back(response);
+			}
+		}
+	}
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* PrefetchProfile - take the firmware settings from the device profile
+*
+* @param    responses:in	responses of PrefetchSettings of an earlier open
+*
+* @return   LarsErr::E_SUCCESS
+* @remarks	called after PrefetchSettings without firmwareSettings, the
+*			getters take the responses like prefetched responses. The eeprom
+*			size is put into the register cache. Only the settings fixed by
+*			the firmware are taken, see IsFirmwareSetting.
+******************************************************************************
+*/
+short AdcRbs::PrefetchProfile(const AdcProfile::Responses &responses)
+{
+	PipelineRequest	request;
+
+	for (AdcProfile::Responses::const_iterator it = responses.begin(); it != responses.end(); ++it)
+	{
+		if (!IsFirmwareSetting(it->cmd))
+			continue;
+
+		if (m_registerCacheEnabled && IsCachedRegister(it->cmd, it->request))
+		{
+			m_registerCache[GetRegisterCacheKey(it->cmd, it->request)] = it->response;
+		}
+		else
+		{
+			request.cmd = it->cmd;
+			request.request = it->request;
+			request.response = it->response;
+			request.errorCode = LarsErr::E_SUCCESS;
+			request.pending = false;
+			m_prefetch.push_back(request);
+		}
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* SetProfile - set the device profile file of the adc
+*
+* @param    fileName:in		file of AdcProfile::GetFileName, empty: none
+*
+* @return   void
+* @remarks	see UpdateProfile
+******************************************************************************
+*/
+void AdcRbs::SetProfile(const string &fileName)
+{
+	m_profile = fileName;
+}
+
+
+/**
+******************************************************************************
+* DumpFlightRecorder - write the last telegrams to a file
+*
+* @param    fileName:in		path of the dump file
+*
+* @return   errorCode
+* @remarks	see AdcFlightRecorder, may be called while a request is running
+******************************************************************************
+*/
+short AdcRbs::DumpFlightRecorder(const char *fileName)
+{
+	return m_flightRecorder.Dump(fileName);
+}
+
+
+/**
+******************************************************************************
+* SetFlightRecorderAutoDump - dump the last telegrams on protocol errors
+*
+* @param    fileName:in		path of the dump file, NULL: no automatic dump
+*
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short AdcRbs::SetFlightRecorderAutoDump(const char *fileName)
+{
+	return m_flightRecorder.SetAutoDump(fileName);
+}
+
+
+/**
+******************************************************************************
+* GetStatistics - counters and latencies of the commands
+*
+* @param    statistics:out	array of *count entries
+* @param    count:in/out	in: size of the array, out: number of commands
+*
+* @return   errorCode
+* @remarks	see AdcStatistics, may be called while a request is running
+******************************************************************************
+*/
+short AdcRbs::GetStatistics(AdcCommandStatistics *statistics, short *count)
+{
+	return m_statistics.Get(statistics, count);
+}
+
+
+short AdcRbs::ResetStatistics()
+{
+	m_statistics.Reset();
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* WriteStatistics - write the statistics in the Prometheus text format
+*
+* @param    fileName:in		path of the file
+* @param    port:in			port of the adc, label of the metrics
+*
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short AdcRbs::WriteStatistics(const char *fileName, const string &port)
+{
+	return m_statistics.WritePrometheus(fileName, port);
+}
+
+
+/**
+******************************************************************************
+* SetRegisterCache - switch the cache of the scale values
+*
+* @param    enable:in		false: every getter asks the adc, e.g. for verification
+*
+* @return   LarsErr::E_SUCCESS
+* @remarks	see IsCachedRegister, the cache is emptied in both cases
+******************************************************************************
+*/
+short AdcRbs::SetRegisterCache(const bool enable)
+{
+	m_registerCacheEnabled = enable;
+	m_registerCache.clear();
 
-						// store byte in puffer
-						m_receiveBuffer[index++] = receiveByte;
+	return LarsErr::E_SUCCESS;
+}
 
-						// next state
-						modulState = WAIT_FOR_LENGTH;
-					}
-				}
-				else
-				{
-					std::this_thread::sleep_for(std::chrono::milliseconds(10));
-					retry++;
-				}
-				break;
 
-            case WAIT_FOR_LENGTH:
-                if (m_interface->Read(&receiveByte, 1) == 1)
-                {
-					// check if adc send SOH again
-					if (receiveByte == Lars::SOH)
-					{
-						// make resynchronization, reset index
-						index = 0;
-						idxLenStart = 0;
-						idxLenEnd = 0;
+/**
+******************************************************************************
+* IsCachedRegister - check if the response of a request may be cached
+*
+* @param    cmd:in			rbs command
+* @param    request:in		reference data of the request
+*
+* @return   true: GSV* of a value that only changes by SSV*, RST, CAL or AP
+* @remarks	tilt compensation (live spirit level), eeprom content, the
+*			remaining warm up time and the state of the verification switch
+*			are always read from the adc
+******************************************************************************
+*/
+bool AdcRbs::IsCachedRegister(const string &cmd, const keyValuePair &request)
+{
+	if ((cmd.compare(0, CMD_GET_SCALE_VALUE.size(), CMD_GET_SCALE_VALUE) != 0) ||
+		(cmd == CMD_GET_SCALE_VALUE_TC) || (cmd == CMD_GET_SCALE_VALUE_EE))
+		return false;
 
-						g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\treceive SOH while waiting for protocol length, make resynchronization", __FUNCTION__);
-					}
-					else if (idxLenStart == 0)
-					{
-						// set length start index
-						idxLenStart = index;
-					}
+	return (request.find(REF_DATA_ID_REMAINING_WARM_UP_TIME_STR) == request.end()) &&
+		   (request.find(REF_DATA_ID_VERIF_PARAM_PROTECTED_STR) == request.end());
+}
 
-                    // store byte in puffer
-                    m_receiveBuffer[index++] = receiveByte;
-
-                    if ((receiveByte == Lars::ESC) || (receiveByte == Lars::GS))
-                    {
-                        // convert lenght to long
-						length = strtol(&m_receiveBuffer[idxLenStart], NULL, 10);
-						if ((!length) || (length > AdcProtocol::RECEIVE_BUFFER_SIZE - 1 - index))
-                        {
-                            // protocol error, try to resync to SOH
-							errorCode = LarsErr::E_PROTOCOL;
-
-							m_receiveBuffer[index] = '\0';
-							g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, receive length larger than buffer  ADC -> APPL %s", __FUNCTION__, m_receiveBuffer);
-                        }
-                        else
-                        {
-                            // decrement length because the character after length is already received
-                            length--;
-                            idxLenEnd = index;
-                            modulState = READ_REMAINING_DATA;
-                        }
-                    }
-                    else if ((index - idxLenStart) > 8)
-                    {
-						// protocol error
-						errorCode = LarsErr::E_PROTOCOL;
 
-						m_receiveBuffer[index] = '\0';
-						g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, receive length too large  ADC -> APPL %s", __FUNCTION__, m_receiveBuffer);
-                    }
-                }
-                else
-                {
-                    // protocol error, try to resync to SOH
-                    modulState = WAIT_FOR_SOH;
-					retry++;
-                }
-                break;
+/**
+******************************************************************************
+* IsFirmwareSetting - check if a setting is fixed by the firmware
+*
+* @param    cmd:in			rbs command
+*
+* @return   true: capabilities or eeprom size
+* @remarks	only these are kept in the device profile. Country and load
+*			capacity settings, calibration and scale values may be changed by
+*			other processes or service tools and are always read from the adc.
+******************************************************************************
+*/
+bool AdcRbs::IsFirmwareSetting(const string &cmd)
+{
+	return (cmd == CMD_GET_CAPABILITIES) || (cmd == CMD_GET_SCALE_VALUE_EE_SIZE);
+}
 
-            case READ_REMAINING_DATA:
-                if ((currentReceived = m_interface->Read(&m_receiveBuffer[idxLenEnd], length)) == length)
-                {
-                    // check for ETB
-                    if (m_receiveBuffer[idxLenEnd + length - 1] != Lars::ETB)
-                    {
-                        // protocol error
-						errorCode = LarsErr::E_PROTOCOL;
 
-						m_receiveBuffer[idxLenEnd + length] = '\0';
-						g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, check for ETB failed  ADC -> APPL %s", __FUNCTION__, m_receiveBuffer);
-					}
-                    else
-                    {
-                        m_receiveBuffer[idxLenEnd + length] = '\0';
-                        bReceiveOK = true;
+/**
+******************************************************************************
+* GetRegisterCacheKey - key of a request in m_registerCache
+*
+* @param    cmd:in			rbs command
+* @param    request:in		reference data of the request
+*
+* @return   cmd FS key = value FS key = value FS ...
+* @remarks
+******************************************************************************
+*/
+string AdcRbs::GetRegisterCacheKey(const string &cmd, const keyValuePair &request)
+{
+	string key = cmd + Lars::FS;
 
-						errorCode = LarsErr::E_SUCCESS;
-                    }
-                }
-                else
-                {
-                    // protocol error
-					errorCode = LarsErr::E_PROTOCOL;
+	for (keyValuePair::const_iterator it = request.begin(); it != request.end(); ++it)
+	{
+		key += it->first + "=" + it->second;
+		key += Lars::FS;
+	}
 
-					m_receiveBuffer[idxLenEnd + currentReceived] = '\0';
-					g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, receive user data length expected: 0x%X  received: 0x%X  ADC -> APPL %s", __FUNCTION__, length, currentReceived, m_receiveBuffer);
-                }
-                break;
-        }
-    }
+	return key;
+}
 
-    if (!bReceiveOK)
-    {
-		if ((retry == TIMEOUT_RECEIVE) && (errorCode == LarsErr::E_SUCCESS))
+
+/**
+******************************************************************************
+* UpdateRegisterCache - keep the register cache coherent after a request
+*
+* @param    cmd:in			rbs command
+* @param    request:in		reference data of the request
+* @param    errorCode:in	result of the request
+*
+* @return   void
+* @remarks	RST, CAL, AP, FRM, SCTR and SLC empty the cache. A successful SSV
+*			or SSVd writes its values through to the cached GSV and GSVd
+*			responses, the other SSV* drop the responses of their GSV*.
+******************************************************************************
+*/
+void AdcRbs::UpdateRegisterCache(const string &cmd, const keyValuePair &request, short errorCode)
+{
+	string	getCmd;
+	bool	writeThrough;
+
+	if (m_registerCache.empty())
+		return;
+
+	if ((cmd == CMD_ADC_RESET) || (cmd == CMD_CALIB) || (cmd == CMD_PARAMETER_MODE) || (cmd == CMD_FRM_UPDATE) ||
+		(cmd == CMD_SET_COUNTRY_SETTINGS) || (cmd == CMD_SET_LC_SETTINGS))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\t%s, register cache cleared", __FUNCTION__, cmd.c_str());
+		m_registerCache.clear();
+		return;
+	}
+
+	if (cmd.compare(0, CMD_SET_SCALE_VALUE.size(), CMD_SET_SCALE_VALUE) != 0)
+		return;
+
+	// GSVx belongs to SSVx
+	getCmd = CMD_GET_SCALE_VALUE + cmd.substr(CMD_SET_SCALE_VALUE.size()) + Lars::FS;
+	writeThrough = (errorCode == LarsErr::E_SUCCESS) && ((cmd == CMD_SET_SCALE_VALUE) || (cmd == CMD_SET_ZEROSETTING_ZEROTRACKING_CONFIG));
+
+	for (map<string, keyValuePair>::iterator it = m_registerCache.begin(); it != m_registerCache.end(); )
+	{
+		if (it->first.compare(0, getCmd.size(), getCmd) != 0)
+		{
+			++it;
+		}
+		else if (writeThrough)
+		{
+			// single values, the request has the format of the response
+			for (keyValuePair::const_iterator value = request.begin(); value != request.end(); ++value)
+			{
+				keyValuePair::iterator cachedValue = it->second.find(value->first);
+				if (cachedValue != it->second.end())
+					cachedValue->second = value->second;
+			}
+			++it;
+		}
+		else
+		{
+			it = m_registerCache.erase(it);
+		}
+	}
+}
+
+
+/**
+******************************************************************************
+* UpdateProfile - remove the device profile if a request changes the firmware
+*
+* @param    cmd:in			rbs command
+*
+* @return   void
+* @remarks	the profile holds only the settings fixed by the firmware, see
+*			IsFirmwareSetting. A new firmware also has a new VERS response,
+*			the profile is removed anyway so the next open doesn't read it.
+******************************************************************************
+*/
+void AdcRbs::UpdateProfile(const string &cmd)
+{
+	if (!m_profile.empty() && (cmd == CMD_FRM_UPDATE))
+	{
+		g_adcProfile.Remove(m_profile);
+		m_profile.clear();
+	}
+}
+
+
+/**
+******************************************************************************
+* CountError - count a transport error of a command
+*
+* @param    command:in		slot in m_statistics
+* @param    errorCode:in	result of one exchange
+*
+* @return   void
+* @remarks	every attempt is counted, the failure after the last retry is
+*			counted by the caller
+******************************************************************************
+*/
+void AdcRbs::CountError(short command, short errorCode)
+{
+	switch (errorCode)
+	{
+		case LarsErr::E_ADC_TIMEOUT:	m_statistics.Count(command, AdcStatistics::CNT_TIMEOUTS); break;
+		case LarsErr::E_PROTOCOL_CRC:	m_statistics.Count(command, AdcStatistics::CNT_CRC_ERRORS); break;
+		case LarsErr::E_PROTOCOL:		m_statistics.Count(command, AdcStatistics::CNT_PROTOCOL_ERRORS); break;
+		default: break;
+	}
+}
+
+
+/**
+******************************************************************************
+* GetFrameOrderID - order ID of a received telegram without parsing it
+*
+* @param    frame:in		telegram, SOH length ESC orderID ...
+* @param    size:in			size of the telegram
+*
+* @return   order ID, -1: no order ID
+* @remarks
+******************************************************************************
+*/
+short AdcRbs::GetFrameOrderID(const char *frame, unsigned long size)
+{
+	const char	*esc;
+	const char	*gs;
+	const char	*end = frame + size;
+	long		orderID = 0;
+
+	// the order ID is part of the header, the header ends with GS
+	if (((esc = (const char *)memchr(frame, Lars::ESC, size)) == NULL) ||
+		(((gs = (const char *)memchr(frame, Lars::GS, size)) != NULL) && (gs < esc)))
+		return -1;
+
+	for (esc++; (esc < end) && (*esc >= '0') && (*esc <= '9') && (orderID <= SHRT_MAX); esc++)
+		orderID = orderID * 10 + (*esc - '0');
+
+	return (orderID <= SHRT_MAX) ? (short)orderID : -1;
+}
+
+
+/**
+******************************************************************************
+* ConvertAdcStat - map the adc stat error to the library error
+*
+* @param    stat:in			stat of the response
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short AdcRbs::ConvertAdcStat(short stat)
+{
+	switch (stat)
+	{
+		case ADC_CMD_SUCCESSFUL:			return LarsErr::E_SUCCESS;
+		case ADC_CMD_NOT_EXECUTED:			return LarsErr::E_COMMAND_NOT_EXECUTED;
+		case ADC_INVALID_PARAMETER:			return LarsErr::E_INVALID_PARAMETER;
+		case ADC_FUNCTION_NOT_IMPLEMENTED:	return LarsErr::E_FUNCTION_NOT_IMPLEMENTED;
+		case ADC_ERROR_AUTHENTICATION:		return LarsErr::E_AUTHENTICATION;
+		case ADC_COMMAND_NOT_SUPPORTED_IN_THIS_OPERATING_MODE:	return LarsErr::E_COMMAND_NOT_SUPPORTED_IN_THIS_OPERATING_MODE;
+		case ADC_LOGBOOK_NO_FURTHER_ENTRY:	return LarsErr::E_LOGBOOK_NO_FURTHER_ENTRY;
+		case ADC_LOGBOOK_FULL:				return LarsErr::E_LOGBOOK_FULL;
+		case ADC_ERROR_TILT_COMPENSATION_SWITCH_ON:				return LarsErr::E_TILT_COMPENSATION_SWITCH_ON;
+		case ADC_ERROR_CHKSUM_BLOCK_3_4:	return LarsErr::E_CHKSUM_BLOCK_3_4;
+		case ADC_ERROR_PROTOCOL_CRC:		return LarsErr::E_PROTOCOL_CRC;
+		case ADC_ERROR_LINEAR_CALIBRATION:	return LarsErr::E_LINEAR_CALIBRATION;
+		case ADC_ERROR_EEPROM_ACCESS_VIOLATION:					return LarsErr::E_EEPROM_ACCESS_VIOLATION;
+		case ADC_ERROR_CMD_ONLY_FOR_SEPARATE_LOADCELL:			return LarsErr::E_COMMAND_ONLY_FOR_SEPARATE_LOADCELL;
+		case ADC_ERROR_UPDATE_NOT_ALLOWED:	return LarsErr::E_UPDATE_NOT_ALLOWED;
+		case ADC_ERROR_TCC_SWITCH_ON:		return LarsErr::E_TCC_SWITCH_ON;
+		case ADC_ERROR_INCOMPATIBLE_PROD_DATA:					return LarsErr::E_INCOMPATIBLE_PROD_DATA;
+		case ADC_ERROR_TARE_OCCUPIED:		return LarsErr::E_TARE_OCCUPIED;
+		case ADC_ERROR_KNOWN_TARE_LESS_E:	return LarsErr::E_KNOWN_TARE_LESS_E;
+		case ADC_ERROR_BATCH_TARE_NOT_ALLOWED:					return LarsErr::E_BATCH_TARE_NOT_ALLOWED;
+		case ADC_ERROR_TARE_OUT_OF_RANGE:	return LarsErr::E_TARE_OUT_OF_RANGE;
+		case ADC_ERROR_TARE_OUTSIDE_CLEARING_AREA:				return LarsErr::E_TARE_OUTSIDE_CLEARING_AREA;
+		case ADC_ERROR_WS_NOT_SUPPORT_LOAD_CAPACITY:			return LarsErr::E_WS_NOT_SUPPORT_LOAD_CAPACITY;
+		case ADC_ERROR_CHKSUM_FIRMWARE:		return LarsErr::E_CHKSUM_FIRMWARE;
+		default: return LarsErr::E_ADC_ERROR;
+	}
+}
+
+
+/**
+******************************************************************************
+* ReceiveResponse - receive a telegram to m_receiveBuffer
+*
+* @param    size:out			size of the telegram
+* @param    timeoutOffset:in	additional timeout in TIMEOUT_RECEIVE_STEP
+* @return
+* @remarks	the telegram is zero terminated. All available bytes are read at
+*			once, bytes of the next telegram are kept for the next call.
+******************************************************************************
+*/
+short AdcRbs::ReceiveResponse(unsigned long *size, short timeoutOffset)
+{
+	short			errorCode;
+	unsigned long	numRd;
+	long			remaining;
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds((TIMEOUT_RECEIVE + timeoutOffset) * TIMEOUT_RECEIVE_STEP);
+
+	*size = 0;
+
+	ReleaseTelegram();
+
+	// bytes of the next telegram are already received
+	m_firstByteTime = chrono::steady_clock::now();
+
+	while (((errorCode = FrameTelegram(size)) == LarsErr::E_SUCCESS) && !*size)
+	{
+		remaining = (long)chrono::duration_cast<chrono::milliseconds>(deadline - chrono::steady_clock::now()).count();
+		if (remaining <= 0)
 		{
+			m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, m_receiveBuffer, m_receiveLevel, -1, LarsErr::E_ADC_TIMEOUT);
 			m_interface->ResetInterface();
+			m_receiveLevel = 0;
 			errorCode = LarsErr::E_ADC_TIMEOUT;
+			break;
 		}
+
+		numRd = m_interface->ReadAvailable(&m_receiveBuffer[m_receiveLevel], AdcProtocol::RECEIVE_BUFFER_SIZE - 1 - m_receiveLevel, remaining);
+		if (numRd && !m_receiveLevel)
+			m_firstByteTime = chrono::steady_clock::now();
+		m_receiveLevel += numRd;
+	}
+
+	if (errorCode != LarsErr::E_SUCCESS)
+	{
+		// framing error, the invalid SOH is already dropped
+		if (errorCode == LarsErr::E_PROTOCOL)
+			m_flightRecorder.Record(AdcFlightRecorder::DIR_ERROR, m_receiveBuffer, m_receiveLevel, -1, errorCode);
+
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error: 0x%X", __FUNCTION__, errorCode);
-    }
-    else
-    {
-        response = string(m_receiveBuffer);
-		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tADC -> APPL %s", __FUNCTION__, response.c_str());
-    }
+		return errorCode;
+	}
 
-    return errorCode;
+	AcceptTelegram(*size);
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* AcceptTelegram - take the framed telegram at the start of m_receiveBuffer
+*
+* @param    size:in			size of the telegram
+* @return   void
+* @remarks	the telegram is zero terminated, the overwritten byte is restored
+*			by ReleaseTelegram
+******************************************************************************
+*/
+void AdcRbs::AcceptTelegram(unsigned long size)
+{
+	m_flightRecorder.Record(AdcFlightRecorder::DIR_RESPONSE, m_receiveBuffer, size, GetFrameOrderID(m_receiveBuffer, size), LarsErr::E_SUCCESS);
+
+	m_receiveEnd = size;
+	m_receiveSaved = m_receiveBuffer[m_receiveEnd];
+	m_receiveBuffer[m_receiveEnd] = '\0';
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tADC -> APPL %s", __FUNCTION__, m_receiveBuffer);
+}
+
+
+/**
+******************************************************************************
+* ReleaseTelegram - drop the telegram of AcceptTelegram
+*
+* @return   void
+* @remarks	bytes of the next telegram move to the start of m_receiveBuffer
+******************************************************************************
+*/
+void AdcRbs::ReleaseTelegram()
+{
+	if (m_receiveEnd)
+	{
+		m_receiveBuffer[m_receiveEnd] = m_receiveSaved;
+		DiscardReceived(m_receiveEnd);
+		m_receiveEnd = 0;
+	}
+}
+
+
+/**
+******************************************************************************
+* FrameTelegram - search a complete telegram in the received bytes
+*
+* @param    size:out			size of the telegram, 0: more data necessary
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_PROTOCOL	invalid telegram, SOH is dropped
+* @remarks	bytes before SOH are dropped, the telegram starts at m_receiveBuffer
+******************************************************************************
+*/
+short AdcRbs::FrameTelegram(unsigned long *size)
+{
+	const char		*soh;
+	unsigned long	idx;
+	unsigned long	length;
+
+	*size = 0;
+
+	// wait for SOH
+	if ((soh = (const char *)memchr(m_receiveBuffer, Lars::SOH, m_receiveLevel)) == NULL)
+	{
+		m_receiveLevel = 0;
+		return LarsErr::E_SUCCESS;
+	}
+	DiscardReceived(soh - m_receiveBuffer);
+
+	// wait for length, terminated by ESC or GS
+	for (idx = 1; idx < m_receiveLevel; idx++)
+	{
+		if (m_receiveBuffer[idx] == Lars::SOH)
+		{
+			// adc sends SOH again, make resynchronization
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\treceive SOH while waiting for protocol length, make resynchronization", __FUNCTION__);
+			DiscardReceived(idx);
+			idx = 0;
+		}
+		else if ((m_receiveBuffer[idx] == Lars::ESC) || (m_receiveBuffer[idx] == Lars::GS))
+		{
+			break;
+		}
+		else if (idx > MAX_LENGTH_DIGITS)
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, receive length too large  ADC -> APPL %.*s", __FUNCTION__, (int)idx, m_receiveBuffer);
+			DiscardReceived(1);
+			return LarsErr::E_PROTOCOL;
+		}
+	}
+	if (idx >= m_receiveLevel)
+		return LarsErr::E_SUCCESS;
+
+	// the length counts from the character after the length up to ETB
+	length = strtol(&m_receiveBuffer[1], NULL, 10);
+	if ((!length) || (length > AdcProtocol::RECEIVE_BUFFER_SIZE - 2 - idx))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, receive length larger than buffer  ADC -> APPL %.*s", __FUNCTION__, (int)idx + 1, m_receiveBuffer);
+		DiscardReceived(1);
+		return LarsErr::E_PROTOCOL;
+	}
+
+	// wait for the remaining data
+	if (m_receiveLevel < idx + length)
+		return LarsErr::E_SUCCESS;
+
+	if (m_receiveBuffer[idx + length - 1] != Lars::ETB)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tprotocol error, check for ETB failed  ADC -> APPL %.*s", __FUNCTION__, (int)(idx + length), m_receiveBuffer);
+		DiscardReceived(1);
+		return LarsErr::E_PROTOCOL;
+	}
+
+	*size = idx + length;
+	return LarsErr::E_SUCCESS;
+}
+
+
+void AdcRbs::DiscardReceived(unsigned long size)
+{
+	if (size >= m_receiveLevel)
+	{
+		m_receiveLevel = 0;
+		return;
+	}
+
+	memmove(m_receiveBuffer, &m_receiveBuffer[size], m_receiveLevel - size);
+	m_receiveLevel -= size;
 }
 
 short AdcRbs::GetKeyValuePair(ProtocolType type, const string &keyValueStr, keyValuePair &headerMap, keyValuePair &refDataMap)
@@ -5368,6 +6623,82 @@ short AdcRbs::GetReferenceData(const string &masterKey, const keyValuePair &refD
 }
 
 
+/**
+******************************************************************************
+* GetReferenceData - decode reference data directly from the parsed response
+*
+* @param    masterKey:in			key of the reference data
+* @param    response:in				parsed response
+* @param    refData:in/out			id and destination of the reference data
+* @param    sollDefDataReceived:in	number of expected elements
+*
+* @return   errorCode
+* @remarks	supports the reference data of the hot path (stat, lcs, wt, tare, bp, sp)
+*			with the same rules as the map based version, but without copies
+******************************************************************************
+*/
+short AdcRbs::GetReferenceData(const string &masterKey, const RbsResponse &response, RefDataStruct &refData, short sollDefDataReceived)
+{
+    short           errorCode = LarsErr::E_SUCCESS;
+    short           defDataReceived = 0;
+    const RbsField  *value;
+    RbsField        pos;
+    unsigned short  tmpValue;
+    bool            ok;
+
+    if ((value = response.Find(masterKey)) == NULL)
+    {
+        g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\terror key %s not found", __FUNCTION__, masterKey.c_str());
+        return LarsErr::E_KEY_NOT_FOUND;
+    }
+
+    for (short idx = 0; idx < 4; idx++)
+    {
+        // check for empty content -> empty means optional
+        pos = value->Position(idx);
+        if (pos.Empty())
+            continue;
+
+        ok = true;
+        switch (refData.id * 4 + idx)
+        {
+            // get stat
+        case REF_DATA_ID_STAT * 4 + 0: ok = pos.GetShort(&refData.u.stat); defDataReceived++; break;
+            // get adcState
+        case REF_DATA_ID_LCSTATE * 4 + 0: ok = pos.GetULongLong(&refData.u.adcState->state); defDataReceived++; break;
+            // get weight
+        case REF_DATA_ID_WEIGHT * 4 + 0: ok = pos.GetLongLong(&refData.u.wt->value); defDataReceived++; break;
+        case REF_DATA_ID_WEIGHT * 4 + 1: ok = pos.GetShort(&refData.u.wt->decimalPlaces); defDataReceived++; break;
+        case REF_DATA_ID_WEIGHT * 4 + 2: ok = pos.GetUShort(&tmpValue); refData.u.wt->weightUnit = (AdcWeightUnit)tmpValue; defDataReceived++; break;
+            // get tare
+        case REF_DATA_ID_TARE * 4 + 0: ok = pos.GetUShort(&tmpValue); refData.u.tare->type = (AdcTareType)tmpValue; defDataReceived++; break;
+        case REF_DATA_ID_TARE * 4 + 1: ok = pos.GetLongLong(&refData.u.tare->value.value); defDataReceived++; break;
+        case REF_DATA_ID_TARE * 4 + 2: ok = pos.GetShort(&refData.u.tare->value.decimalPlaces); defDataReceived++; break;
+        case REF_DATA_ID_TARE * 4 + 3: ok = pos.GetUShort(&tmpValue); refData.u.tare->value.weightUnit = (AdcWeightUnit)tmpValue; defDataReceived++; break;
+            // get base price
+        case REF_DATA_ID_BASEPRICE * 4 + 0: ok = pos.GetLongLong(&refData.u.bp->price.value); defDataReceived++; break;
+        case REF_DATA_ID_BASEPRICE * 4 + 1: pos.GetString(refData.u.bp->price.currency, sizeof(refData.u.bp->price.currency)); break;
+        case REF_DATA_ID_BASEPRICE * 4 + 2: ok = pos.GetShort(&refData.u.bp->price.decimalPlaces); defDataReceived++; break;
+        case REF_DATA_ID_BASEPRICE * 4 + 3: ok = pos.GetUShort(&tmpValue); refData.u.bp->weightUnit = (AdcWeightUnit)tmpValue; defDataReceived++; break;
+            // get sell price
+        case REF_DATA_ID_SELLPRICE * 4 + 0: ok = pos.GetLongLong(&refData.u.sp->value); defDataReceived++; break;
+        case REF_DATA_ID_SELLPRICE * 4 + 1: pos.GetString(refData.u.sp->currency, sizeof(refData.u.sp->currency)); break;
+        case REF_DATA_ID_SELLPRICE * 4 + 2: ok = pos.GetShort(&refData.u.sp->decimalPlaces); defDataReceived++; break;
+        }
+
+        if (!ok)
+        {
+            errorCode = LarsErr::E_PROTOCOL;
+            g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror set key %s with value %s", __FUNCTION__, masterKey.c_str(), value->ToString().c_str());
+        }
+    }
+
+    if (defDataReceived < sollDefDataReceived) errorCode = LarsErr::E_PROTOCOL;
+
+    return errorCode;
+}
+
+
 short AdcRbs::GetDebugResponse(const string &cmd, short orderID, string &response)
 {
     stringstream refData;
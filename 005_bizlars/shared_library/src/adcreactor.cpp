@@ -0,0 +1,409 @@
+/**
+******************************************************************************
+* File       : adcreactor.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcreactor class: one thread waits on the interfaces of many
+*              adc with epoll and advances their requests
+******************************************************************************
+*/
+#include <limits.h>
+#include <errno.h>
+#include <algorithm>
+#ifdef __GNUC__
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#endif
+#include "larsErr.h"
+#include "adctrace.h"
+#include "adcreactor.h"
+
+AdcReactor g_adcReactor;
+
+
+AdcReactor::AdcReactor()
+{
+	m_enabled = false;
+	m_run = false;
+	m_epoll = -1;
+	m_wakeup = -1;
+}
+
+AdcReactor::~AdcReactor()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_run = false;
+	}
+	Wake();
+
+	if (m_thread.joinable())
+		m_thread.join();
+
+#ifdef __GNUC__
+	if (m_epoll >= 0) close(m_epoll);
+	if (m_wakeup >= 0) close(m_wakeup);
+#endif
+}
+
+
+/**
+******************************************************************************
+* SetEnabled - switch the reactor mode
+*
+* @param    enabled:in		true: weight streams started later use the reactor
+*
+* @return   void
+* @remarks	running weight streams keep their mode
+******************************************************************************
+*/
+void AdcReactor::SetEnabled(bool enabled)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_enabled = enabled;
+}
+
+bool AdcReactor::IsEnabled()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	return m_enabled;
+}
+
+
+/**
+******************************************************************************
+* Add - let the reactor thread serve a handler
+*
+* @param    handler:in		handler, valid until Remove
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_FUNCTION_NOT_IMPLEMENTED	no epoll
+* @remarks	the reactor thread is started with the first handler
+******************************************************************************
+*/
+short AdcReactor::Add(Handler *handler)
+{
+	short	errorCode;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		if ((errorCode = Start()) != LarsErr::E_SUCCESS)
+			return errorCode;
+
+		if (!Find(handler))
+		{
+			Entry entry = { handler, -1, false };
+			m_entries.push_back(entry);
+		}
+	}
+
+	Wake();
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* Remove - stop serving a handler
+*
+* @param    handler:in		handler of Add
+*
+* @return   void
+* @remarks	OnRemove of the handler is called by the reactor thread, so a
+*			request is ended by the thread that started it. After return the
+*			handler is not called anymore, a running call is finished before.
+*			May be called from a handler.
+******************************************************************************
+*/
+void AdcReactor::Remove(Handler *handler)
+{
+	unique_lock<mutex> lock(m_mutex);
+	Entry	*entry;
+
+	if (!Find(handler))
+		return;
+
+	if (IsReactorThread() || !m_run)
+	{
+		// handlers of the current cycle are not called anymore
+		for (vector<Entry>::iterator it = m_work.begin(); it != m_work.end(); ++it)
+		{
+			if ((*it).handler == handler)
+				(*it).handler = NULL;
+		}
+
+		entry = Find(handler);
+		Watch(*entry, -1);
+		m_entries.erase(m_entries.begin() + (entry - &m_entries[0]));
+		lock.unlock();
+
+		handler->OnRemove();
+		return;
+	}
+
+	// let the reactor thread remove it between two cycles
+	m_removed.push_back(handler);
+	lock.unlock();
+	Wake();
+	lock.lock();
+
+	while (find(m_removed.begin(), m_removed.end(), handler) != m_removed.end())
+		m_cond.wait(lock);
+}
+
+
+/**
+******************************************************************************
+* Wake - let the reactor thread ask the handlers for their fd and deadline
+*
+* @return   void
+* @remarks	call it when a handler has something to do earlier
+******************************************************************************
+*/
+void AdcReactor::Wake()
+{
+#ifdef __GNUC__
+	if (m_wakeup >= 0)
+		eventfd_write(m_wakeup, 1);
+#endif
+}
+
+
+bool AdcReactor::IsReactorThread()
+{
+	return m_threadId == this_thread::get_id();
+}
+
+
+/**
+******************************************************************************
+* Start - create the epoll instance and start the reactor thread
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_FUNCTION_NOT_IMPLEMENTED	no epoll
+* @remarks	m_mutex must be locked
+******************************************************************************
+*/
+short AdcReactor::Start()
+{
+	if (m_run)
+		return LarsErr::E_SUCCESS;
+
+#ifdef __GNUC__
+	struct epoll_event	event = {};
+
+	if (m_epoll < 0)
+	{
+		m_epoll = epoll_create1(EPOLL_CLOEXEC);
+		m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+		event.events = EPOLLIN;
+		event.data.ptr = NULL;
+		if ((m_epoll < 0) || (m_wakeup < 0) || (epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event) != 0))
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't create epoll instance (error: %d)", __FUNCTION__, errno);
+			if (m_epoll >= 0) close(m_epoll);
+			if (m_wakeup >= 0) close(m_wakeup);
+			m_epoll = -1;
+			m_wakeup = -1;
+			return LarsErr::E_FUNCTION_NOT_IMPLEMENTED;
+		}
+	}
+
+	m_run = true;
+	m_thread = thread(&AdcReactor::ReactorThread, this);
+	m_threadId = m_thread.get_id();
+
+	return LarsErr::E_SUCCESS;
+#else
+	return LarsErr::E_FUNCTION_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+******************************************************************************
+* Watch - register the file descriptor of a handler with epoll
+*
+* @param    entry:in/out	handler
+* @param    fd:in			file descriptor, -1: none
+*
+* @return   void
+* @remarks	m_mutex must be locked. The fd is registered again for every
+*			request, so a port that is reopened with the same number is found.
+******************************************************************************
+*/
+void AdcReactor::Watch(Entry &entry, int fd)
+{
+#ifdef __GNUC__
+	struct epoll_event	event = {};
+
+	if (fd == entry.fd)
+		return;
+
+	if (entry.fd >= 0)
+		epoll_ctl(m_epoll, EPOLL_CTL_DEL, entry.fd, &event);
+
+	entry.fd = -1;
+	if (fd >= 0)
+	{
+		event.events = EPOLLIN;
+		event.data.ptr = entry.handler;
+		if ((epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) == 0) ||
+			((errno == EEXIST) && (epoll_ctl(m_epoll, EPOLL_CTL_MOD, fd, &event) == 0)))
+			entry.fd = fd;
+		else
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't watch fd %d (error: %d)", __FUNCTION__, fd, errno);
+	}
+#endif
+}
+
+
+/**
+******************************************************************************
+* ProcessRemoved - remove the handlers of Remove and call their OnRemove
+*
+* @param    lock:in			lock of m_mutex, unlocked during OnRemove
+*
+* @return   void
+* @remarks	called by the reactor thread between two cycles
+******************************************************************************
+*/
+void AdcReactor::ProcessRemoved(unique_lock<mutex> &lock)
+{
+	Handler	*handler;
+	Entry	*entry;
+
+	while (!m_removed.empty())
+	{
+		handler = m_removed.front();
+		if ((entry = Find(handler)) != NULL)
+		{
+			Watch(*entry, -1);
+			m_entries.erase(m_entries.begin() + (entry - &m_entries[0]));
+		}
+		lock.unlock();
+
+		handler->OnRemove();
+
+		lock.lock();
+		m_removed.erase(m_removed.begin());
+		m_cond.notify_all();
+	}
+}
+
+
+AdcReactor::Entry *AdcReactor::Find(Handler *handler)
+{
+	for (vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+	{
+		if ((*it).handler == handler)
+			return &(*it);
+	}
+
+	return NULL;
+}
+
+
+/**
+******************************************************************************
+* ReactorThread - wait for data or the next deadline and call the handlers
+*
+* @return   void
+* @remarks	the handlers are called without m_mutex, Remove waits until
+*			the reactor thread has removed the handler
+******************************************************************************
+*/
+void AdcReactor::ReactorThread()
+{
+#ifdef __GNUC__
+	struct epoll_event	events[MAX_EVENTS];
+	vector<int>			fds;
+	int					count;
+	int					timeout;
+	eventfd_t			value;
+	Entry				*entry;
+	chrono::steady_clock::time_point deadline;
+	chrono::steady_clock::time_point next;
+	chrono::steady_clock::time_point now;
+
+	unique_lock<mutex> lock(m_mutex);
+
+	while (m_run)
+	{
+		ProcessRemoved(lock);
+
+		// ask the handlers what to wait for
+		m_work = m_entries;
+		lock.unlock();
+
+		fds.resize(m_work.size());
+		deadline = chrono::steady_clock::time_point::max();
+		for (size_t idx = 0; idx < m_work.size(); idx++)
+		{
+			fds[idx] = m_work[idx].handler->GetPollFd();
+			next = m_work[idx].handler->GetDeadline();
+			if (next < deadline)
+				deadline = next;
+		}
+
+		lock.lock();
+		for (size_t idx = 0; idx < m_work.size(); idx++)
+		{
+			if ((entry = Find(m_work[idx].handler)) != NULL)
+				Watch(*entry, fds[idx]);
+		}
+		lock.unlock();
+
+		// round up, a deadline must not be missed by less than a ms
+		timeout = -1;
+		if (deadline != chrono::steady_clock::time_point::max())
+		{
+			now = chrono::steady_clock::now();
+			if (deadline <= now)
+				timeout = 0;
+			else if (deadline - now < chrono::milliseconds(INT_MAX))
+				timeout = (int)chrono::duration_cast<chrono::milliseconds>(deadline - now + chrono::microseconds(999)).count();
+			else
+				timeout = INT_MAX;
+		}
+
+		count = epoll_wait(m_epoll, events, MAX_EVENTS, timeout);
+
+		lock.lock();
+		for (int idx = 0; idx < count; idx++)
+		{
+			if (events[idx].data.ptr == NULL)
+				eventfd_read(m_wakeup, &value);
+			else if ((entry = Find((Handler *)events[idx].data.ptr)) != NULL)
+				entry->readable = true;
+		}
+		m_work = m_entries;
+		for (vector<Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ++it)
+			(*it).readable = false;
+		lock.unlock();
+
+		// handlers with data or reached deadline, a handler removed meanwhile is NULL
+		now = chrono::steady_clock::now();
+		for (size_t idx = 0; idx < m_work.size(); idx++)
+		{
+			if (m_work[idx].handler && (m_work[idx].readable || (m_work[idx].handler->GetDeadline() <= now)))
+				m_work[idx].handler->OnEvent(m_work[idx].readable);
+		}
+
+		lock.lock();
+	}
+
+	ProcessRemoved(lock);
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\treactor stopped", __FUNCTION__);
+#endif
+}
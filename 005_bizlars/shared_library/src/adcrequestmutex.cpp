@@ -0,0 +1,90 @@
+/**
+******************************************************************************
+* File       : adcrequestmutex.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcrequestmutex class: serializes the requests to one adc,
+*              blocking calls and the non-blocking request of the reactor
+******************************************************************************
+*/
+#include "adcrequestmutex.h"
+
+
+AdcRequestMutex::AdcRequestMutex()
+{
+	m_locked = false;
+	m_async = false;
+}
+
+
+/**
+******************************************************************************
+* lock - wait until no request is in work and mark a blocking request
+*
+* @return   void
+* @remarks	waits for a non-blocking request of the reactor until it is done,
+*			that is at most one round trip
+******************************************************************************
+*/
+void AdcRequestMutex::lock()
+{
+	unique_lock<mutex> lock(m_mutex);
+
+	while (m_locked || m_async)
+		m_cond.wait(lock);
+
+	m_locked = true;
+}
+
+bool AdcRequestMutex::try_lock()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	if (m_locked || m_async)
+		return false;
+
+	m_locked = true;
+	return true;
+}
+
+void AdcRequestMutex::unlock()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_locked = false;
+	}
+	m_cond.notify_all();
+}
+
+
+/**
+******************************************************************************
+* TryBeginAsync - mark a non-blocking request if no request is in work
+*
+* @return   true: request marked, false: adc busy
+* @remarks	the mark is a flag, not an owned mutex, so the request may be
+*			continued over several reactor cycles
+******************************************************************************
+*/
+bool AdcRequestMutex::TryBeginAsync()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	if (m_locked || m_async)
+		return false;
+
+	m_async = true;
+	return true;
+}
+
+void AdcRequestMutex::EndAsync()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_async = false;
+	}
+	m_cond.notify_all();
+}
@@ -1,12 +1,12 @@
 /**
 ******************************************************************************
-* File       : adcusb.cpp
+* File       : adcserial.cpp
 * Project    : BizLars
 * Date       : 25.08.2015
 * Author     : Thomas Buck, Sensor Technology
 * Copyright  : Bizerba GmbH & Co. KG
 *
-* Content    : adcusb class: impement the interface usb
+* Content    : adcserial class: impement the interface serial
 ******************************************************************************
 */
 #ifdef  _MSC_VER
@@ -17,45 +17,75 @@
 #endif
 #ifdef  __GNUC__
 #include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <poll.h>
+#include <termios.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
 #endif
 #include "public.h"
 #include "adctrace.h"
 #include "adcserial.h"
 
+// size of the ringbuffer, commands can not be longer than the ringbuffer size
+#define	SIZE_RINGBUFFER		4096
+// max. size of one read from the serial driver
+#define	SIZE_READ_CACHE		1024
+// timeout of Read and Write in ms
+#define	TIMEOUT_SERIAL_IO	1000
+
 
 AdcSerial::AdcSerial() : AdcInterface()
 {
-	string port = "//./COM1";
+	string port = "COM1";
 	Init(port);
 }
 
 
 AdcSerial::AdcSerial(const string &port) : AdcInterface()
 {
-	string tmpPort = "//./" + port;
-	Init(tmpPort);
+	Init(port);
 }
 
 AdcSerial::~AdcSerial()
 {
-	m_InterfaceType = INTERFACE_SERIAL;
-	// Defaultport COM1
-	m_port = "//./COM1";
+	Close();
 
-	m_useCRC16 = true;
+	delete m_ringBuffer;
+	delete[] m_readCache;
 }
 
 
 void AdcSerial::Init(const string &port)
 {
 	m_InterfaceType = INTERFACE_SERIAL;
-	// Defaultport COM1
-	m_port = port;
+
+#ifdef _MSC_VER
+	m_port = "//./" + port;
+#endif
+#ifdef __GNUC__
+	// COMn is the n-th serial port, a device path is used as it is
+	if ((port.substr(0, 3) == "COM") && (atoi(port.c_str() + 3) > 0))
+		m_port = "/dev/ttyS" + to_string(atoi(port.c_str() + 3) - 1);
+	else
+		m_port = port;
+#endif
+
+	m_ringBuffer = new RingBuffer<char>(SIZE_RINGBUFFER);
+	m_ringBuffer->Clear();
+	m_readCache = new char[SIZE_READ_CACHE];
+
+	m_baudrate = 115200;
+	m_bytesize = 8;
+	m_stopbit = 0;
+	m_parity = 0;
 
 	m_useCRC16 = true;
 }
@@ -107,6 +137,11 @@ bool AdcSerial::Open(unsigned long baudrate, unsigned char bytesize, unsigned ch
     // first close the device before trying again to open it
     Close();
 
+	m_baudrate = baudrate;
+	m_bytesize = bytesize;
+	m_stopbit = stopbit;
+	m_parity = parity;
+
 	if ((m_hDevice = CreateFileA(m_port.c_str(),
 		GENERIC_READ | GENERIC_WRITE,
 		0,
@@ -253,13 +288,49 @@ bool AdcSerial::Open()
 ******************************************************************************
 * Open - Open the connection the Bizerba weighing system
 *
-* @return
-* @remarks
+* @param    baudrate:in		baud rate, e.g. 115200
+* @param    bytesize:in		data bits 5..8
+* @param    stopbit:in		2: two stop bits, else one
+* @param    parity:in		0: none, 1: odd, 2: even
+*
+* @return	false	error open device, see log
+*			true	device is open
+* @remarks	the port is used in raw mode without flow control. The file is
+*			non blocking, reads wait with poll, so VMIN and VTIME are 0.
 ******************************************************************************
 */
 bool AdcSerial::Open(unsigned long baudrate, unsigned char bytesize, unsigned char stopbit, unsigned char parity)
 {
-	return false;
+	int fd;
+
+	// first close the device before trying again to open it
+	Close();
+
+	m_baudrate = baudrate;
+	m_bytesize = bytesize;
+	m_stopbit = stopbit;
+	m_parity = parity;
+
+	if ((fd = open(m_port.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)) < 0)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't open adc %s (error: %d)", __FUNCTION__, m_port.c_str(), errno);
+		return false;
+	}
+	m_hDevice = fd;
+
+	if (!SetAttributes(baudrate, bytesize, stopbit, parity))
+	{
+		Close();
+		return false;
+	}
+
+	SetLowLatency();
+
+	// drop data of a previous connection
+	tcflush(m_hDevice, TCIOFLUSH);
+	m_ringBuffer->Clear();
+
+	return true;
 }
 
 
@@ -277,7 +348,205 @@ bool AdcSerial::Open(unsigned long baudrate, unsigned char bytesize, unsigned ch
 
 bool AdcSerial::Close()
 {
-    return true;
+	if (m_hDevice != 0)
+	{
+		if (close(m_hDevice) != 0)
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tclose device failed (error %d)", __FUNCTION__, errno);
+		m_hDevice = 0;
+	}
+	m_ringBuffer->Clear();
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* SetAttributes - set the line parameters, raw mode
+*
+* @param    baudrate:in		baud rate
+* @param    bytesize:in		data bits 5..8
+* @param    stopbit:in		2: two stop bits, else one
+* @param    parity:in		0: none, 1: odd, 2: even
+*
+* @return   false:	error, see log
+*			true:	ok
+* @remarks
+******************************************************************************
+*/
+bool AdcSerial::SetAttributes(unsigned long baudrate, unsigned char bytesize, unsigned char stopbit, unsigned char parity)
+{
+	struct termios	tio;
+	speed_t			speed;
+
+	switch (baudrate)
+	{
+	case 1200:		speed = B1200;		break;
+	case 2400:		speed = B2400;		break;
+	case 4800:		speed = B4800;		break;
+	case 9600:		speed = B9600;		break;
+	case 19200:		speed = B19200;		break;
+	case 38400:		speed = B38400;		break;
+	case 57600:		speed = B57600;		break;
+	case 115200:	speed = B115200;	break;
+#ifdef B230400
+	case 230400:	speed = B230400;	break;
+#endif
+#ifdef B460800
+	case 460800:	speed = B460800;	break;
+#endif
+#ifdef B921600
+	case 921600:	speed = B921600;	break;
+#endif
+	default:
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tbaud rate %lu not supported", __FUNCTION__, baudrate);
+		return false;
+	}
+
+	if (tcgetattr(m_hDevice, &tio) != 0)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't read attributes of %s (error: %d)", __FUNCTION__, m_port.c_str(), errno);
+		return false;
+	}
+
+	// no echo, no line editing, no character translation
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+
+	tio.c_cflag &= ~(CSIZE | CSTOPB | PARENB | PARODD | CRTSCTS);
+	switch (bytesize)
+	{
+	case 5:		tio.c_cflag |= CS5;	break;
+	case 6:		tio.c_cflag |= CS6;	break;
+	case 7:		tio.c_cflag |= CS7;	break;
+	default:	tio.c_cflag |= CS8;	break;
+	}
+	if (stopbit == 2)
+		tio.c_cflag |= CSTOPB;
+	if (parity == 1)
+		tio.c_cflag |= PARENB | PARODD;
+	else if (parity == 2)
+		tio.c_cflag |= PARENB;
+	tio.c_cflag |= CLOCAL | CREAD;
+	tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+	// read returns immediately, the wait is done with poll
+	tio.c_cc[VMIN] = 0;
+	tio.c_cc[VTIME] = 0;
+
+	if (tcsetattr(m_hDevice, TCSANOW, &tio) != 0)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't write attributes of %s (error: %d)", __FUNCTION__, m_port.c_str(), errno);
+		return false;
+	}
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* SetLowLatency - switch off the receive fifo delay of the uart driver
+*
+* @return   void
+* @remarks	not all drivers (e.g. pty, some usb serial adapters) support it,
+*			then the default latency is used
+******************************************************************************
+*/
+void AdcSerial::SetLowLatency()
+{
+#if defined __linux__ && defined ASYNC_LOW_LATENCY
+	struct serial_struct serial;
+
+	if (ioctl(m_hDevice, TIOCGSERIAL, &serial) != 0)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tlow latency not supported by %s", __FUNCTION__, m_port.c_str());
+		return;
+	}
+
+	serial.flags |= ASYNC_LOW_LATENCY;
+	if (ioctl(m_hDevice, TIOCSSERIAL, &serial) != 0)
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tcan't set low latency of %s (error: %d)", __FUNCTION__, m_port.c_str(), errno);
+#endif
+}
+
+
+/**
+******************************************************************************
+* WaitForPort - wait until the port is readable or writable
+*
+* @param    events:in		POLLIN or POLLOUT
+* @param    timeout:in		maximum wait time in ms
+*
+* @return   false:	timeout or error
+*			true:	port is ready
+* @remarks
+******************************************************************************
+*/
+bool AdcSerial::WaitForPort(short events, unsigned long timeout)
+{
+	struct pollfd	pfd;
+	int				ret;
+
+	pfd.fd = m_hDevice;
+	pfd.events = events;
+	pfd.revents = 0;
+
+	while ((ret = poll(&pfd, 1, (int)timeout)) < 0)
+	{
+		if (errno != EINTR)
+			return false;
+	}
+
+	return (ret > 0) && (pfd.revents & events);
+}
+
+
+/**
+******************************************************************************
+* ReadFromPort - move all received data from the driver to the ring buffer
+*
+* @param    timeout:in		maximum wait time in ms if the driver has no data
+*
+* @return   number of bytes read, 0: no data within the timeout
+* @remarks	one read gets everything the driver has received, so a telegram
+*			is read with a few system calls instead of one per byte
+******************************************************************************
+*/
+unsigned long AdcSerial::ReadFromPort(unsigned long timeout)
+{
+	unsigned long	space;
+	ssize_t			bytesRead;
+
+	if (m_hDevice == 0)
+		return 0;
+
+	space = SIZE_RINGBUFFER - m_ringBuffer->GetLevel();
+	if (space > SIZE_READ_CACHE)
+		space = SIZE_READ_CACHE;
+	if (space == 0)
+		return 0;
+
+	// with VMIN and VTIME 0 the tty driver returns 0 instead of EAGAIN
+	bytesRead = read(m_hDevice, m_readCache, space);
+	if ((bytesRead == 0) || ((bytesRead < 0) && (errno == EAGAIN)))
+	{
+		if (!timeout || !WaitForPort(POLLIN, timeout))
+			return 0;
+		bytesRead = read(m_hDevice, m_readCache, space);
+	}
+
+	if (bytesRead <= 0)
+	{
+		if ((bytesRead < 0) && (errno != EAGAIN) && (errno != EINTR))
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror read %d", __FUNCTION__, errno);
+		return 0;
+	}
+
+	m_ringBuffer->SetData(m_readCache, (unsigned long)bytesRead);
+
+	return (unsigned long)bytesRead;
 }
 
 #endif  // __GNUC__
@@ -308,17 +577,31 @@ unsigned long AdcSerial::Write(void *pData, unsigned long size)
 #endif  // _MSC_VER
 
 #ifdef __GNUC__
-    ssize_t bytesWritten;
-    bytesWritten = write(m_hDevice, pData, size);
-    if (bytesWritten == -1)
-    {
-        g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror write %d", __FUNCTION__, errno);
-        numWr = 0;
-    }
-    else
-    {
-    	numWr = bytesWritten;
-    }
+	ssize_t bytesWritten;
+
+	// no tcdrain, the telegram is on the way when the driver has taken it
+	while (numWr < size)
+	{
+		bytesWritten = write(m_hDevice, (char *)pData + numWr, size - numWr);
+		if (bytesWritten > 0)
+		{
+			numWr += bytesWritten;
+		}
+		else if ((bytesWritten < 0) && ((errno == EAGAIN) || (errno == EINTR)))
+		{
+			// driver buffer is full
+			if (!WaitForPort(POLLOUT, TIMEOUT_SERIAL_IO))
+			{
+				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\twrite timeout", __FUNCTION__);
+				return 0;
+			}
+		}
+		else
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror write %d", __FUNCTION__, errno);
+			return 0;
+		}
+	}
 #endif
 
     return numWr;
@@ -327,9 +610,8 @@ unsigned long AdcSerial::Write(void *pData, unsigned long size)
 
 /**
 ******************************************************************************
-* Read - get data from printer
+* Read - get data from adc
 *
-* @param    lpHdl  : printer handle
 * @param    pData  : pointer of data buffer
 * @param    size   : size of data buffer
 *
@@ -351,23 +633,98 @@ unsigned long AdcSerial::Read(void *pData, unsigned long size)
 #endif  // _MSC_VER
 
 #ifdef __GNUC__
-    ssize_t bytesRead;
-    bytesRead = read(m_hDevice, pData, size);
-    if (bytesRead == -1)
-    {
-        g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror read %d", __FUNCTION__, errno);
-        numRd = 0;
-    }
-    else
-    {
-    	numRd = bytesRead;
-    }
+	if (size > SIZE_RINGBUFFER)
+		size = SIZE_RINGBUFFER;
+
+	while (m_ringBuffer->GetLevel() < size)
+	{
+		if (ReadFromPort(TIMEOUT_SERIAL_IO) == 0)
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tadc sends no data", __FUNCTION__);
+			return 0;
+		}
+	}
+
+	// read data from ring buffer
+	numRd = m_ringBuffer->GetData((char *)pData, size);
 #endif
 
     return numRd;
 }
 
 
+/**
+******************************************************************************
+* ReadAvailable - read all data that is already received from the adc
+*
+* @param    pData:out	buffer
+* @param    size:in		size of the buffer
+* @param    timeout:in	maximum wait time in ms if no data is available
+*
+* @return   number of bytes read, 0: no data within the timeout
+* @remarks
+******************************************************************************
+*/
+unsigned long AdcSerial::ReadAvailable(void *pData, unsigned long size, unsigned long timeout)
+{
+#ifdef __GNUC__
+	// take what the driver has, wait only if nothing is buffered
+	if ((ReadFromPort(0) == 0) && (m_ringBuffer->GetLevel() == 0))
+		ReadFromPort(timeout);
+
+	return m_ringBuffer->GetData((char *)pData, size);
+#else
+	return AdcInterface::ReadAvailable(pData, size, timeout);
+#endif
+}
+
+
+/**
+******************************************************************************
+* WaitForData - wait until the adc sends new data
+*
+* @param    timeout:in	maximum wait time in ms
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcSerial::WaitForData(unsigned long timeout)
+{
+#ifdef __GNUC__
+	if ((m_ringBuffer->GetLevel() == 0) && (m_hDevice != 0))
+		WaitForPort(POLLIN, timeout);
+#else
+	AdcInterface::WaitForData(timeout);
+#endif
+}
+
+
+/**
+******************************************************************************
+* ResetInterface - drop all received data
+*
+* @return   false:	error, see log
+*			true:	ok
+* @remarks
+******************************************************************************
+*/
+bool AdcSerial::ResetInterface()
+{
+	m_ringBuffer->Clear();
+
+#ifdef __GNUC__
+	if ((m_hDevice != 0) && (tcflush(m_hDevice, TCIFLUSH) != 0))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tflush failed (error %d)", __FUNCTION__, errno);
+		return false;
+	}
+#endif
+
+	return true;
+}
+
+
 /**
 ******************************************************************************
 * Reconnect - try to reconnect to device
@@ -379,7 +736,9 @@ unsigned long AdcSerial::Read(void *pData, unsigned long size)
 */
 bool AdcSerial::Reconnect()
 {
-	return true;
+	Close();
+
+	return Open(m_baudrate, m_bytesize, m_stopbit, m_parity);
 }
 
 
@@ -395,3 +754,22 @@ void AdcSerial::GetPort(string &port)
 {
 	port = m_port;
 }
+
+
+/**
+******************************************************************************
+* GetPollFd - file descriptor of the tty
+*
+* @return   file descriptor, -1: port is closed
+* @remarks  bytes already in the ring buffer don't make the tty readable,
+*           read them with ReadAvailable before waiting
+******************************************************************************
+*/
+int AdcSerial::GetPollFd()
+{
+#ifdef __GNUC__
+	return m_hDevice ? (int)m_hDevice : -1;
+#else
+	return AdcInterface::GetPollFd();
+#endif
+}
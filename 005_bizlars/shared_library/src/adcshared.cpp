@@ -0,0 +1,331 @@
+/**
+******************************************************************************
+* File       : adcshared.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcshared class: weight snapshot in shared memory for readers
+*              in other processes
+******************************************************************************
+*/
+#include <chrono>
+#include <string.h>
+#ifdef  __GNUC__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "larsErr.h"
+#include "adctrace.h"
+#include "adcshared.h"
+
+
+AdcShared::AdcShared()
+{
+	m_segment = NULL;
+	m_publisher = false;
+	memset(&m_last, 0, sizeof(m_last));
+}
+
+AdcShared::~AdcShared()
+{
+	Close();
+}
+
+
+/**
+******************************************************************************
+* Create - create the shared memory segment and publish into it
+*
+* @param    name:in			name of the segment, e.g. "bizlars_scale1" (/dev/shm/bizlars_scale1)
+*							or an absolute path of a file on a ram disk
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+*			LarsErr::E_FILE_NOT_FOUND		segment could not be created
+*			LarsErr::E_FUNCTION_NOT_IMPLEMENTED	not supported on this platform
+* @remarks	an existing segment of the same name is reused, so readers of
+*			a previous publisher see the new data. Publishing again under
+*			the same name keeps the mapped segment, Close would unlink it
+*			and the attached readers would stay on the removed segment.
+******************************************************************************
+*/
+short AdcShared::Create(const char *name)
+{
+#ifdef  __GNUC__
+	int		fd;
+	void	*addr;
+	string	path = GetPath(name);
+
+	if (path.empty())
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if (m_segment && m_publisher && (path == m_path))
+	{
+		// no valid data until the first read
+		memset(&m_last, 0, sizeof(m_last));
+		m_last.errorCode = LarsErr::E_NO_DEVICE;
+		Publish(LarsErr::E_NO_DEVICE, NULL, NULL, NULL, NULL);
+		return LarsErr::E_SUCCESS;
+	}
+
+	Close();
+
+	m_path = path;
+
+	if ((fd = open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)) < 0)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't create %s", __FUNCTION__, m_path.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	if (ftruncate(fd, sizeof(Segment)) != 0)
+	{
+		close(fd);
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't resize %s", __FUNCTION__, m_path.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	addr = mmap(NULL, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't map %s", __FUNCTION__, m_path.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	m_segment = (Segment *)addr;
+	m_publisher = true;
+
+	// a previous publisher may have stopped while writing
+	if (m_segment->sequence.load() & 1)
+		m_segment->sequence.fetch_add(1);
+
+	// no valid data until the first read
+	memset(&m_last, 0, sizeof(m_last));
+	m_last.errorCode = LarsErr::E_NO_DEVICE;
+	Publish(LarsErr::E_NO_DEVICE, NULL, NULL, NULL, NULL);
+
+	m_segment->version = SHARED_VERSION;
+	m_segment->magic = SHARED_MAGIC;
+
+	return LarsErr::E_SUCCESS;
+#else
+	return LarsErr::E_FUNCTION_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+******************************************************************************
+* Attach - map an existing segment read only
+*
+* @param    name:in			name of the segment, see Create
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+*			LarsErr::E_FILE_NOT_FOUND		no publisher for this name
+*			LarsErr::E_FILE_CORRUPT			segment has a different layout
+*			LarsErr::E_FUNCTION_NOT_IMPLEMENTED	not supported on this platform
+* @remarks
+******************************************************************************
+*/
+short AdcShared::Attach(const char *name)
+{
+#ifdef  __GNUC__
+	int		fd;
+	void	*addr;
+	struct stat st;
+
+	Close();
+
+	m_path = GetPath(name);
+	if (m_path.empty())
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if ((fd = open(m_path.c_str(), O_RDONLY | O_CLOEXEC)) < 0)
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	if ((fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(Segment)))
+	{
+		close(fd);
+		return LarsErr::E_FILE_CORRUPT;
+	}
+
+	addr = mmap(NULL, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED)
+		return LarsErr::E_FILE_NOT_FOUND;
+
+	m_segment = (Segment *)addr;
+	m_publisher = false;
+
+	if ((m_segment->magic != SHARED_MAGIC) || (m_segment->version != SHARED_VERSION))
+	{
+		Close();
+		return LarsErr::E_FILE_CORRUPT;
+	}
+
+	return LarsErr::E_SUCCESS;
+#else
+	return LarsErr::E_FUNCTION_NOT_IMPLEMENTED;
+#endif
+}
+
+
+/**
+******************************************************************************
+* Close - unmap the segment
+*
+* @return   void
+* @remarks	the publisher marks the data as invalid and removes the name,
+*			attached readers get E_NO_DEVICE and may attach again
+******************************************************************************
+*/
+void AdcShared::Close()
+{
+#ifdef  __GNUC__
+	if (m_segment)
+	{
+		if (m_publisher)
+		{
+			Publish(LarsErr::E_NO_DEVICE, NULL, NULL, NULL, NULL);
+			unlink(m_path.c_str());
+		}
+		munmap(m_segment, sizeof(Segment));
+		m_segment = NULL;
+	}
+#endif
+	m_publisher = false;
+}
+
+
+bool AdcShared::IsOpen() const
+{
+	return m_segment != NULL;
+}
+
+
+/**
+******************************************************************************
+* Publish - write a new snapshot
+*
+* @param    errorCode:in	result of the read
+* @param    adcState:in		NULL: keep the previous value
+* @param    weight:in		NULL: keep the previous value
+* @param    tare:in			NULL: keep the previous value
+* @param    sellPrice:in	NULL: keep the previous value
+*
+* @return   void
+* @remarks	only one thread may publish, readers never block the publisher
+******************************************************************************
+*/
+void AdcShared::Publish(short errorCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare, const AdcPrice *sellPrice)
+{
+	unsigned long sequence;
+
+	if (!m_segment || !m_publisher)
+		return;
+
+	m_last.errorCode = errorCode;
+	if (adcState) m_last.adcState = *adcState;
+	if (weight) m_last.weight = *weight;
+	if (tare) m_last.tare = *tare;
+	if (sellPrice) m_last.sellPrice = *sellPrice;
+	m_last.timestamp = GetTimestamp();
+
+	// seqlock: odd sequence while the snapshot is written
+	sequence = m_segment->sequence.load(memory_order_relaxed);
+	m_segment->sequence.store(sequence + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	memcpy(&m_segment->snapshot, &m_last, sizeof(m_last));
+
+	m_segment->sequence.store(sequence + 2, memory_order_release);
+}
+
+
+/**
+******************************************************************************
+* Read - read the latest snapshot
+*
+* @param    errorCode:out	result of the last read of the publisher
+* @param    adcState:out	may be NULL
+* @param    weight:out		may be NULL
+* @param    tare:out		may be NULL
+* @param    sellPrice:out	may be NULL
+* @param    age:out			age of the snapshot in ms, may be NULL
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_HANDLE		segment is not attached
+*			LarsErr::E_ADC_TIMEOUT			no consistent snapshot, publisher writes too often
+* @remarks	lock free, retries while the publisher writes
+******************************************************************************
+*/
+short AdcShared::Read(short *errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcPrice *sellPrice, unsigned long *age)
+{
+	Snapshot		snapshot;
+	unsigned long	sequence;
+
+	if (!m_segment)
+		return LarsErr::E_INVALID_HANDLE;
+
+	for (unsigned long retry = 0; retry < READ_RETRIES; retry++)
+	{
+		sequence = m_segment->sequence.load(memory_order_acquire);
+		if (sequence & 1)
+			continue;
+
+		memcpy(&snapshot, (const void *)&m_segment->snapshot, sizeof(snapshot));
+		atomic_thread_fence(memory_order_acquire);
+
+		if (m_segment->sequence.load(memory_order_relaxed) != sequence)
+			continue;
+
+		if (errorCode) *errorCode = snapshot.errorCode;
+		if (adcState) *adcState = snapshot.adcState;
+		if (weight) *weight = snapshot.weight;
+		if (tare) *tare = snapshot.tare;
+		if (sellPrice) *sellPrice = snapshot.sellPrice;
+		if (age) *age = (unsigned long)((GetTimestamp() - snapshot.timestamp) / 1000000);
+
+		return LarsErr::E_SUCCESS;
+	}
+
+	return LarsErr::E_ADC_TIMEOUT;
+}
+
+
+/**
+******************************************************************************
+* GetPath - file of the segment
+*
+* @param    name:in			segment name or absolute path
+*
+* @return   path, empty: invalid name
+* @remarks	Android has no /dev/shm, there an absolute path must be used
+******************************************************************************
+*/
+string AdcShared::GetPath(const char *name)
+{
+	if (!name || !name[0])
+		return string();
+
+	if (name[0] == '/')
+		return string(name);
+
+	if (strchr(name, '/'))
+		return string();
+
+	return string("/dev/shm/") + name;
+}
+
+
+long long AdcShared::GetTimestamp()
+{
+	// steady clock is CLOCK_MONOTONIC, so the timestamps are comparable between processes
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,1160 @@
+/**
+******************************************************************************
+* File       : adcsimulator.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcsimulator class: simulated adc behind the interface, answers
+*              the rbs telegrams from an in-memory model
+******************************************************************************
+*/
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#ifdef __GNUC__
+#include <unistd.h>
+#include <sys/timerfd.h>
+#endif
+#include "lars.h"
+#include "adctrace.h"
+#include "adcsimulator.h"
+
+const string AdcSimulator::PORT_NAME = "AdcSimulator";
+
+// stat of the responses, see AdcRbs::ADC_CMD_SUCCESSFUL ...
+#define SIM_STAT_SUCCESSFUL				0
+#define SIM_STAT_NOT_EXECUTED			1
+#define SIM_STAT_INVALID_PARAMETER		2
+#define SIM_STAT_NOT_IMPLEMENTED		3
+#define SIM_STAT_LOGBOOK_NO_ENTRY		6
+#define SIM_STAT_PROTOCOL_CRC			10
+#define SIM_STAT_EEPROM_ACCESS			12
+#define SIM_STAT_TARE_OUT_OF_RANGE		20
+
+// header flag of a repeated telegram, see AdcRbs::FLAG_TELEGRAM_REPEAT
+#define SIM_FLAG_TELEGRAM_REPEAT		0x00000001
+
+// weights of the model are in g, the load capacity below has 3 decimal places kg
+#define SIM_DECIMAL_PLACES				3
+#define SIM_WEIGHT_UNIT					0
+
+// sizes of the eeprom regions welmec, open, prod, params
+static const unsigned long	EEPROM_SIZES[] = { 256, 1024, 256, 256 };
+
+// country settings, see AdcRbs::COUNTRY_SPECIFIC_STRINGS
+static const char *const	DEFAULT_COUNTRY_SETTINGS[] = { "0", "0", "0", "0", "98100", "DE", "Max {wx}/{w0} {ux}", "Min {wm} {um}", "e={t0}/{t1} {ut}", "0" };
+
+// 6/15 kg dual range, see AdcRbs::LOAD_CAPACITY_STRINGS
+static const char *const	DEFAULT_LOAD_CAPACITY[] = { "15000", "9", "3", "2", "6000", "15000", "2", "5", "0", "-20", "20", "-2", "2",
+														"6000", "6000", "1", "150502", "40", "0", "0", "20", "0", "0", "0", "0",
+														"0", "0", "0", "0", "0", "0", "0" };
+
+// capabilities c0 .. c18, see AdcCapabilities
+static const char *const	DEFAULT_CAPABILITIES[] = { "0", "1", "1", "1", "1", "1", "1", "1", "1", "0", "1", "0", "0", "1", "1",
+													   "0", "0", "0", "0" };
+
+// values of GSV* and SSV*
+static const char *const	DEFAULT_REGISTERS[][2] = {
+	{ "bm", "1" }, { "sm", "0" }, { "ats", "0" }, { "wut", "0" }, { "rwut", "0" }, { "vpp", "0" }, { "upd", "0" },
+	{ "fac", "1" }, { "tc", "0\x1b" "0\x1b" "0\x1b" "0\x1b" "0" }, { "zpt", "1" }, { "zsi", "0" }, { "azst", "0" },
+	{ "idx", "2" }, { "rstt", "300" }, { "rstr", "1" }, { "gfac", "98100" }, { "ad", "0" }, { "mode", "0" },
+	{ "pdp", "0" }, { "gofs", "0" }, { "date", "17.10.26" }, { "wsc", "WS-SIM" }, { "m", "0" }, { "ndt", "2" },
+	{ "bp", "0\x1b" "EUR\x1b" "2\x1b" "0" }, { "conb", "0" }, { "dt", "0\x1b" "0\x1b" }
+};
+
+// keys of a GSV* response without requested keys
+static const char *const	DEFAULT_KEYS[][5] = {
+	{ "GSVb", "fac" }, { "GSVc", "tc" }, { "GSVd", "zpt", "zsi", "azst" }, { "GSVf", "idx", "rstt", "rstr" },
+	{ "GSVg", "gfac" }, { "GSVi", "ad", "mode" }, { "GSVl", "pdp", "gofs", "date", "wsc" }, { "GSVm", "m" },
+	{ "GSVn", "ndt" }, { "GSVp", "bp", "conb" }, { "GSVt", "dt" }
+};
+
+// diagnostic data, type 0: value ESC unit
+static const char *const	DEFAULT_DIAGNOSTIC[][2] = {
+	{ "ovl", "0\x1b" "3\x1b" "0" }, { "udl", "0\x1b" "1\x1b" "0" }, { "upd", "0\x1b" "0\x1b" "0" },
+	{ "tmp", "0\x1b" "23\x1b" "1" }, { "opt", "0\x1b" "1250\x1b" "2" }
+};
+
+
+/**
+******************************************************************************
+* AdcSimulator - constructor
+*
+* @param    port:in		PORT_NAME, optional followed by ':' and the options,
+*						see Configure
+* @return
+* @remarks
+******************************************************************************
+*/
+AdcSimulator::AdcSimulator()
+{
+	Init(PORT_NAME);
+}
+
+
+AdcSimulator::AdcSimulator(const string &port)
+{
+	Init(port);
+}
+
+
+/**
+******************************************************************************
+* ~AdcSimulator - destructor
+*
+* @param
+* @return
+* @remarks
+******************************************************************************
+*/
+AdcSimulator::~AdcSimulator()
+{
+#ifdef __GNUC__
+	if (m_timer >= 0) close(m_timer);
+#endif
+}
+
+
+/**
+******************************************************************************
+* Init - init all member variables
+*
+* @param    port:in		see constructor
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcSimulator::Init(const string &port)
+{
+	size_t	pos;
+
+	m_InterfaceType = INTERFACE_SIMULATOR;
+	m_useCRC16 = true;
+	m_port = port;
+
+	m_latency = 1000;
+	m_jitter = 0;
+	m_fragment = 0;
+	m_corrupt = 0;
+	m_flashTime = 200;
+	m_seed = 1;
+	m_gross = 1250;
+	m_noise = 0;
+	m_logbookEntries = 16;
+
+	if ((pos = port.find(':')) != string::npos)
+		Configure(port.substr(pos + 1));
+
+	m_open = false;
+	m_random = m_seed ? m_seed : 1;
+	m_busyUntil = chrono::steady_clock::now();
+#ifdef __GNUC__
+	m_timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#else
+	m_timer = -1;
+#endif
+
+	InitModel();
+}
+
+
+/**
+******************************************************************************
+* Configure - set the options of the port
+*
+* @param    options:in		key=value separated by ',':
+*							latency		us from request to response (1000)
+*							jitter		us, random additional latency (0)
+*							fragment	max. bytes per read, 0: whole telegram (0)
+*							corrupt		1 of n responses with wrong crc, 0: never (0)
+*							flash		us per firmware data block (200)
+*							seed		start of the random generator (1)
+*							weight		gross weight in g (1250)
+*							noise		max. random deviation of the weight in g (0)
+*							logbook		number of log book entries (16)
+* @return   void
+* @remarks	e.g. AdcSimulator:latency=2000,jitter=500,corrupt=100
+******************************************************************************
+*/
+void AdcSimulator::Configure(const string &options)
+{
+	size_t	start = 0;
+	size_t	end;
+	size_t	pos;
+	string	option;
+	string	key;
+	long long value;
+
+	while (start < options.size())
+	{
+		if ((end = options.find(',', start)) == string::npos)
+			end = options.size();
+		option = options.substr(start, end - start);
+		start = end + 1;
+
+		if ((pos = option.find('=')) == string::npos)
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tinvalid option %s", __FUNCTION__, option.c_str());
+			continue;
+		}
+		key = option.substr(0, pos);
+		value = atoll(option.c_str() + pos + 1);
+
+		if (key == "latency") m_latency = (unsigned long)value;
+		else if (key == "jitter") m_jitter = (unsigned long)value;
+		else if (key == "fragment") m_fragment = (unsigned long)value;
+		else if (key == "corrupt") m_corrupt = (unsigned long)value;
+		else if (key == "flash") m_flashTime = (unsigned long)value;
+		else if (key == "seed") m_seed = (unsigned long long)value;
+		else if (key == "weight") m_gross = value;
+		else if (key == "noise") m_noise = value;
+		else if (key == "logbook") m_logbookEntries = (unsigned long)value;
+		else g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tunknown option %s", __FUNCTION__, option.c_str());
+	}
+}
+
+
+/**
+******************************************************************************
+* InitModel - set the device model to the state after power on
+*
+* @param
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcSimulator::InitModel()
+{
+	m_registers.clear();
+	for (size_t idx = 0; idx < sizeof(DEFAULT_REGISTERS) / sizeof(DEFAULT_REGISTERS[0]); idx++)
+		m_registers[DEFAULT_REGISTERS[idx][0]] = DEFAULT_REGISTERS[idx][1];
+
+	m_registers["css"] = Join(DEFAULT_COUNTRY_SETTINGS, sizeof(DEFAULT_COUNTRY_SETTINGS) / sizeof(DEFAULT_COUNTRY_SETTINGS[0]));
+	m_registers["lcp"] = Join(DEFAULT_LOAD_CAPACITY, sizeof(DEFAULT_LOAD_CAPACITY) / sizeof(DEFAULT_LOAD_CAPACITY[0]));
+	m_registers["eew"] = to_string(EEPROM_SIZES[0]);
+	m_registers["ees"] = to_string(EEPROM_SIZES[1]);
+	m_registers["eep"] = to_string(EEPROM_SIZES[2]);
+	m_registers["eeps"] = to_string(EEPROM_SIZES[3]);
+
+	for (short region = 0; region < EEPROM_REGIONS; region++)
+		m_eeprom[region].assign(EEPROM_SIZES[region], 0xFF);
+
+	m_zero = 0;
+	m_tare = 0;
+	m_tareType = AdcTareType::ADC_TARE_NO;
+	m_frmActive = false;
+	m_frmBlocks = 0;
+	m_lastOrderID = -1;
+	m_lastResponse.clear();
+}
+
+
+/**
+******************************************************************************
+* Open - open the simulated adc
+*
+* @param    adcName:in		name of the adc
+* @return   true
+* @remarks	the model keeps its state over close and open like the adc
+******************************************************************************
+*/
+bool AdcSimulator::Open(string &adcName)
+{
+	m_adcName = adcName;
+
+	return Open();
+}
+
+
+bool AdcSimulator::Open()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_open = true;
+	m_input.clear();
+	m_responses.clear();
+	ArmTimer();
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\t%s opened", __FUNCTION__, m_port.c_str());
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* Close - close the simulated adc
+*
+* @param
+* @return   true
+* @remarks
+******************************************************************************
+*/
+bool AdcSimulator::Close()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_open = false;
+	m_input.clear();
+	m_responses.clear();
+	ArmTimer();
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* Reconnect - reconnect to the simulated adc
+*
+* @param
+* @return   true
+* @remarks	responses on the link get lost
+******************************************************************************
+*/
+bool AdcSimulator::Reconnect()
+{
+	return Open();
+}
+
+
+/**
+******************************************************************************
+* Write - send bytes to the simulated adc
+*
+* @param    pData:in	bytes
+* @param    size:in		number of bytes
+* @return   number of bytes written, 0 if not open
+* @remarks	every complete telegram is executed at once, the response is
+*			readable after the latency
+******************************************************************************
+*/
+unsigned long AdcSimulator::Write(void *pData, unsigned long size)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	if (!m_open || !pData)
+		return 0;
+
+	m_input.append((const char *)pData, size);
+	while (Receive(m_input.data(), m_input.size()) != 0)
+		;
+
+	return size;
+}
+
+
+/**
+******************************************************************************
+* Receive - take the first complete telegram from the received bytes
+*
+* @param    data:in		received bytes
+* @param    size:in		number of bytes
+* @return   number of bytes removed from m_input, 0: no complete telegram
+* @remarks	SOH, decimal length up to ETB, like AdcRbs::FrameTelegram
+******************************************************************************
+*/
+unsigned long AdcSimulator::Receive(const char *data, unsigned long size)
+{
+	unsigned long	idx;
+	unsigned long	length = 0;
+	const RbsField	*field;
+	short			orderID;
+	string			telegram;
+
+	// skip noise before SOH
+	for (idx = 0; (idx < size) && (data[idx] != Lars::SOH); idx++)
+		;
+	if (idx)
+	{
+		m_input.erase(0, idx);
+		return idx;
+	}
+
+	for (idx = 1; (idx < size) && (data[idx] >= '0') && (data[idx] <= '9'); idx++)
+		length = length * 10 + (data[idx] - '0');
+	if (idx >= size)
+		return 0;
+
+	// no length, drop the SOH
+	if ((idx == 1) || (length == 0))
+	{
+		m_input.erase(0, 1);
+		return 1;
+	}
+	if (idx + length > size)
+		return 0;
+
+	telegram.assign(data, idx + length);
+	m_input.erase(0, idx + length);
+
+	// the adc ignores telegrams it can not parse, the host runs into the timeout
+	if ((m_request.Parse(telegram.data(), telegram.size()) == 0) &&
+		((field = m_request.GetHeader(RbsResponse::IDX_ORDERID)) != NULL) && field->GetShort(&orderID))
+	{
+		Execute(m_request, orderID);
+	}
+	else
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tinvalid telegram", __FUNCTION__);
+	}
+
+	return telegram.size();
+}
+
+
+/**
+******************************************************************************
+* Execute - execute a request and schedule the response
+*
+* @param    request:in		parsed request
+* @param    orderID:in		order id of the request
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcSimulator::Execute(const RbsResponse &request, short orderID)
+{
+	const RbsField		*field;
+	unsigned long long	flag = 0;
+	keyValuePair		response;
+	unsigned long		busyTime = 0;
+	short				stat;
+	string				cmd = request.GetCmd().ToString();
+	string				telegram;
+
+	if (((field = request.GetHeader(RbsResponse::IDX_ORDERID + 1)) != NULL) && !field->GetULongLong(&flag))
+		flag = 0;
+
+	// the response got lost, send it again without a second execution
+	if ((flag & SIM_FLAG_TELEGRAM_REPEAT) && (orderID == m_lastOrderID) && !m_lastResponse.empty())
+	{
+		Schedule(m_lastResponse, 0);
+		return;
+	}
+
+	if (!CheckChecksum(request))
+		stat = SIM_STAT_PROTOCOL_CRC;
+	else if (cmd == "FRM")
+		stat = ExecuteFirmware(request, response, &busyTime);
+	else
+		stat = ExecuteCommand(cmd, request, response);
+
+	m_telegram.Begin(orderID, 0, cmd);
+	m_telegram.AddReferenceData("stat", to_string(stat));
+	for (keyValuePair::iterator it = response.begin(); it != response.end(); it++)
+		m_telegram.AddReferenceData((*it).first, (*it).second);
+	m_telegram.End(UseCRC16());
+
+	telegram.assign(m_telegram.GetData(), m_telegram.GetSize());
+	m_lastOrderID = orderID;
+	m_lastResponse = telegram;
+
+	Schedule(telegram, busyTime);
+}
+
+
+/**
+******************************************************************************
+* ExecuteCommand - execute a request on the model
+*
+* @param    cmd:in			rbs command
+* @param    request:in		parsed request
+* @param    response:out	reference data of the response without stat
+* @return   stat of the response
+* @remarks
+******************************************************************************
+*/
+short AdcSimulator::ExecuteCommand(const string &cmd, const RbsResponse &request, keyValuePair &response)
+{
+	const RbsField	*field;
+	long long		value;
+
+	if ((cmd == "RW") || (cmd == "GHR") || (cmd == "GGW") || (cmd == "ST") || (cmd == "CT") || (cmd == "GT") ||
+		(cmd == "SZ") || (cmd == "STP"))
+	{
+		return ExecuteWeight(cmd, request, response);
+	}
+
+	if ((cmd == "SSVe") || (cmd == "GSVe"))
+		return ExecuteEeprom(cmd, request, response);
+
+	if (cmd == "VERS")
+	{
+		response["adct"] = "ADC505";
+		response["fw"] = "1.44";
+		response["boot"] = "1.10";
+		response["pno"] = "1.02";
+		response["wsc"] = m_registers["wsc"];
+		response["sn"] = "SIM" + to_string(m_seed);
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd == "CAP")
+	{
+		for (size_t idx = 0; idx < sizeof(DEFAULT_CAPABILITIES) / sizeof(DEFAULT_CAPABILITIES[0]); idx++)
+			response["c" + to_string(idx)] = DEFAULT_CAPABILITIES[idx];
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if ((cmd == "SCTR") || (cmd == "SLC"))
+	{
+		string key = (cmd == "SCTR") ? "css" : "lcp";
+
+		if ((field = request.Find(key)) == NULL)
+			return SIM_STAT_INVALID_PARAMETER;
+		m_registers[key] = field->ToString();
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if ((cmd == "GCTR") || (cmd == "GLC"))
+	{
+		string key = (cmd == "GCTR") ? "css" : "lcp";
+
+		response[key] = m_registers[key];
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd == "RST")
+	{
+		m_zero = 0;
+		m_tareType = AdcTareType::ADC_TARE_NO;
+		m_frmActive = false;
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd == "CAL")
+	{
+		response["lcs"] = "0";
+		response["step"] = "0";
+		response["cdig"] = to_string(m_gross);
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if ((cmd == "AP") || (cmd == "SA") || (cmd == "DIAC") || (cmd == "INTD"))
+		return SIM_STAT_SUCCESSFUL;
+
+	if (cmd == "GA")
+	{
+		char	hex[3];
+		string	random;
+
+		for (short idx = 0; idx < 16; idx++)
+		{
+			snprintf(hex, sizeof(hex), "%02X", (unsigned int)Random(256));
+			random += hex;
+		}
+		response["no"] = random;
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd == "LOG")
+	{
+		char	date[32];
+
+		if (((field = request.Find("idx")) == NULL) || !field->GetLongLong(&value) || (value < 0))
+			return SIM_STAT_INVALID_PARAMETER;
+		if (value >= (long long)m_logbookEntries)
+			return SIM_STAT_LOGBOOK_NO_ENTRY;
+
+		// the latest entry has index 0
+		snprintf(date, sizeof(date), "%02d.%02d.26 %02d:%02d", (int)(28 - value % 28), (int)(12 - (value / 28) % 12),
+			(int)(value % 24), (int)((value * 7) % 60));
+		response["vid"] = "0081";
+		response["cid"] = to_string(1 + value % 3);
+		response["swv"] = "1.44";
+		response["swid"] = to_string(1000 + value);
+		response["date"] = date;
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd == "DIA")
+	{
+		for (size_t idx = 0; idx < sizeof(DEFAULT_DIAGNOSTIC) / sizeof(DEFAULT_DIAGNOSTIC[0]); idx++)
+		{
+			if ((request.GetFieldCount() == 0) || request.Find(DEFAULT_DIAGNOSTIC[idx][0]))
+				response[DEFAULT_DIAGNOSTIC[idx][0]] = DEFAULT_DIAGNOSTIC[idx][1];
+		}
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd.substr(0, 3) == "SSV")
+	{
+		for (short idx = 0; idx < request.GetFieldCount(); idx++)
+			m_registers[request.GetKey(idx).ToString()] = request.GetValue(idx).ToString();
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	if (cmd.substr(0, 3) == "GSV")
+	{
+		if (request.GetFieldCount())
+		{
+			for (short idx = 0; idx < request.GetFieldCount(); idx++)
+			{
+				string key = request.GetKey(idx).ToString();
+				keyValuePair::iterator it = m_registers.find(key);
+
+				if (it == m_registers.end())
+					return SIM_STAT_NOT_IMPLEMENTED;
+				response[key] = (*it).second;
+			}
+			return SIM_STAT_SUCCESSFUL;
+		}
+
+		if (cmd == "GSVs")
+		{
+			response["eew"] = m_registers["eew"];
+			response["ees"] = m_registers["ees"];
+			response["eep"] = m_registers["eep"];
+			response["eeps"] = m_registers["eeps"];
+			return SIM_STAT_SUCCESSFUL;
+		}
+
+		for (size_t idx = 0; idx < sizeof(DEFAULT_KEYS) / sizeof(DEFAULT_KEYS[0]); idx++)
+		{
+			if (cmd == DEFAULT_KEYS[idx][0])
+			{
+				for (short key = 1; (key < 5) && DEFAULT_KEYS[idx][key]; key++)
+					response[DEFAULT_KEYS[idx][key]] = m_registers[DEFAULT_KEYS[idx][key]];
+				return SIM_STAT_SUCCESSFUL;
+			}
+		}
+		return SIM_STAT_INVALID_PARAMETER;
+	}
+
+	g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcommand %s not simulated", __FUNCTION__, cmd.c_str());
+
+	return SIM_STAT_NOT_IMPLEMENTED;
+}
+
+
+/**
+******************************************************************************
+* ExecuteWeight - weight, tare and zero commands
+*
+* @param    cmd:in			RW, GHR, GGW, ST, CT, GT, SZ or STP
+* @param    request:in		parsed request
+* @param    response:out	reference data of the response without stat
+* @return   stat of the response
+* @remarks	weights in g, the high resolution has one decimal place more,
+*			no price calculation: RW without bp and sp
+******************************************************************************
+*/
+short AdcSimulator::ExecuteWeight(const string &cmd, const RbsResponse &request, keyValuePair &response)
+{
+	const RbsField	*field;
+	long long		gross;
+	long long		net;
+	long long		value;
+	short			type;
+
+	gross = m_gross - m_zero;
+	if (m_noise)
+		gross += (long long)Random((unsigned long)(2 * m_noise + 1)) - m_noise;
+
+	if (cmd == "ST")
+	{
+		if (((field = request.Find("tare")) == NULL) || !field->Position(0).GetShort(&type))
+			return SIM_STAT_INVALID_PARAMETER;
+
+		switch (type)
+		{
+		case AdcTareType::ADC_TARE_WEIGHED:
+		case AdcTareType::ADC_TARE_WEIGHED_SET_ZERO:
+			if (gross <= 0)
+				return SIM_STAT_TARE_OUT_OF_RANGE;
+			m_tare = gross;
+			break;
+		case AdcTareType::ADC_TARE_KNOWN:
+		case AdcTareType::ADC_TARE_LIMIT_DEVICE:
+		case AdcTareType::ADC_TARE_LIMIT_CW_CUSTOM:
+		case AdcTareType::ADC_TARE_LIMIT_WEIGHED_CUSTOM:
+		case AdcTareType::ADC_TARE_LIMIT_KNOWN_CUSTOM:
+			if (!field->Position(1).GetLongLong(&value) || (value < 0))
+				return SIM_STAT_INVALID_PARAMETER;
+			m_tare = value;
+			break;
+		default:
+			return SIM_STAT_INVALID_PARAMETER;
+		}
+		m_tareType = type;
+	}
+	else if (cmd == "CT")
+	{
+		m_tareType = AdcTareType::ADC_TARE_NO;
+	}
+	else if (cmd == "SZ")
+	{
+		m_zero += gross;
+		gross = 0;
+	}
+	else if (cmd == "STP")
+	{
+		if ((field = request.Find("tp")) == NULL)
+			return SIM_STAT_INVALID_PARAMETER;
+		m_registers["tp"] = field->ToString();
+	}
+
+	net = gross - ((m_tareType != AdcTareType::ADC_TARE_NO) ? m_tare : 0);
+
+	// bit 0: under zero
+	response["lcs"] = (net < 0) ? "1" : "0";
+
+	if ((cmd == "RW") || (cmd == "GHR"))
+	{
+		response["wt"] = Weight(net, SIM_DECIMAL_PLACES);
+		if (cmd == "GHR")
+		{
+			response["wth"] = Weight(net * 10, SIM_DECIMAL_PLACES + 1);
+			response["digi"] = to_string(gross * 10);
+		}
+	}
+	else if (cmd == "GGW")
+	{
+		response["gw"] = Weight(gross, SIM_DECIMAL_PLACES);
+		response["gwh"] = Weight(gross * 10, SIM_DECIMAL_PLACES + 1);
+		response["digi"] = to_string(gross * 10);
+	}
+
+	if ((cmd == "RW") || (cmd == "GHR") || (cmd == "GT"))
+	{
+		value = (m_tareType != AdcTareType::ADC_TARE_NO) ? m_tare : 0;
+		response["tare"] = to_string(m_tareType) + Lars::ESC + to_string(value) + Lars::ESC + to_string(SIM_DECIMAL_PLACES) +
+						   Lars::ESC + to_string(SIM_WEIGHT_UNIT);
+	}
+
+	return SIM_STAT_SUCCESSFUL;
+}
+
+
+/**
+******************************************************************************
+* ExecuteEeprom - read and write the eeprom regions
+*
+* @param    cmd:in			SSVe or GSVe
+* @param    request:in		parsed request, ee: region ESC start ESC length ESC hex data
+* @param    response:out	reference data of the response without stat
+* @return   stat of the response
+* @remarks
+******************************************************************************
+*/
+short AdcSimulator::ExecuteEeprom(const string &cmd, const RbsResponse &request, keyValuePair &response)
+{
+	const RbsField	*field;
+	short			region;
+	long long		start;
+	long long		len;
+	RbsField		hex;
+	char			byte[3];
+	string			data;
+
+	if (((field = request.Find("ee")) == NULL) || !field->Position(0).GetShort(&region) ||
+		!field->Position(1).GetLongLong(&start) || !field->Position(2).GetLongLong(&len))
+	{
+		return SIM_STAT_INVALID_PARAMETER;
+	}
+	if ((region < 0) || (region >= EEPROM_REGIONS) || (start < 0) || (len < 0) ||
+		((unsigned long long)(start + len) > m_eeprom[region].size()))
+	{
+		return SIM_STAT_EEPROM_ACCESS;
+	}
+
+	if (cmd == "SSVe")
+	{
+		hex = field->Position(3);
+		if (hex.size != (unsigned long)len * 2)
+			return SIM_STAT_INVALID_PARAMETER;
+
+		for (long long idx = 0; idx < len; idx++)
+		{
+			byte[0] = hex.data[2 * idx];
+			byte[1] = hex.data[2 * idx + 1];
+			byte[2] = '\0';
+			m_eeprom[region][start + idx] = (unsigned char)strtoul(byte, NULL, 16);
+		}
+		return SIM_STAT_SUCCESSFUL;
+	}
+
+	for (long long idx = 0; idx < len; idx++)
+	{
+		snprintf(byte, sizeof(byte), "%02X", m_eeprom[region][start + idx]);
+		data += byte;
+	}
+	response["ee"] = to_string(region) + Lars::ESC + to_string(start) + Lars::ESC + to_string(len) + Lars::ESC + data;
+
+	return SIM_STAT_SUCCESSFUL;
+}
+
+
+/**
+******************************************************************************
+* ExecuteFirmware - firmware update commands
+*
+* @param    request:in		parsed request, cmd: 0 start, 1 end, 2 cancel, 3 data
+* @param    response:out	reference data of the response without stat
+* @param    busyTime:out	us the adc needs to flash the data
+* @return   stat of the response
+* @remarks	the data is not kept, only the blocks are counted
+******************************************************************************
+*/
+short AdcSimulator::ExecuteFirmware(const RbsResponse &request, keyValuePair &response, unsigned long *busyTime)
+{
+	const RbsField	*field;
+	short			frmCmd;
+	long long		len;
+
+	if (((field = request.Find("cmd")) == NULL) || !field->GetShort(&frmCmd))
+		return SIM_STAT_INVALID_PARAMETER;
+
+	switch (frmCmd)
+	{
+	case 0:
+		m_frmActive = true;
+		m_frmBlocks = 0;
+		break;
+	case 1:
+		if (!m_frmActive)
+			return SIM_STAT_NOT_EXECUTED;
+		m_frmActive = false;
+		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tfirmware update with %lu blocks", __FUNCTION__, m_frmBlocks);
+		break;
+	case 2:
+		m_frmActive = false;
+		break;
+	case 3:
+		if (!m_frmActive)
+			return SIM_STAT_NOT_EXECUTED;
+		if (((field = request.Find("data")) == NULL) || !field->Position(1).GetLongLong(&len) ||
+			(field->Position(2).size != (unsigned long)len * 2))
+		{
+			return SIM_STAT_INVALID_PARAMETER;
+		}
+		m_frmBlocks++;
+		*busyTime = m_flashTime;
+		break;
+	default:
+		return SIM_STAT_INVALID_PARAMETER;
+	}
+
+	return SIM_STAT_SUCCESSFUL;
+}
+
+
+/**
+******************************************************************************
+* Schedule - put a response on the link
+*
+* @param    telegram:in		response
+* @param    busyTime:in		us the adc works on the request
+* @return   void
+* @remarks	the adc works on one request after the other, responses keep
+*			their order, option corrupt damages the crc on the link
+******************************************************************************
+*/
+void AdcSimulator::Schedule(const string &telegram, unsigned long busyTime)
+{
+	Response	response;
+	unsigned long latency = m_latency;
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	if (m_busyUntil < now)
+		m_busyUntil = now;
+	m_busyUntil += chrono::microseconds(busyTime);
+
+	if (m_jitter)
+		latency += Random(m_jitter + 1);
+
+	response.due = m_busyUntil + chrono::microseconds(latency);
+	if (!m_responses.empty() && (response.due < m_responses.back().due))
+		response.due = m_responses.back().due;
+	response.data = telegram;
+
+	// damage a digit of the crc, the telegram stays parseable
+	if (m_corrupt && (Random(m_corrupt) == 0) && (response.data.size() > 2))
+	{
+		char &digit = response.data[response.data.size() - 2];
+		digit = ((digit >= '0') && (digit < '9')) ? digit + 1 : '0';
+	}
+
+	m_responses.push_back(response);
+	ArmTimer();
+}
+
+
+/**
+******************************************************************************
+* ArmTimer - let m_timer expire when the first response is due
+*
+* @param
+* @return   void
+* @remarks	m_mutex must be locked. Setting the timer clears an expiration
+*			that is not read yet, without responses the timer is stopped.
+******************************************************************************
+*/
+void AdcSimulator::ArmTimer()
+{
+#ifdef __GNUC__
+	struct itimerspec	timer = {};
+	chrono::nanoseconds	due;
+
+	if (m_timer < 0)
+		return;
+
+	// steady_clock is CLOCK_MONOTONIC, a due time in the past expires at once
+	if (!m_responses.empty())
+	{
+		due = chrono::duration_cast<chrono::nanoseconds>(m_responses.front().due.time_since_epoch());
+		timer.it_value.tv_sec = (time_t)(due.count() / 1000000000);
+		timer.it_value.tv_nsec = (long)(due.count() % 1000000000);
+		if (!timer.it_value.tv_sec && !timer.it_value.tv_nsec)
+			timer.it_value.tv_nsec = 1;
+	}
+
+	timerfd_settime(m_timer, TFD_TIMER_ABSTIME, &timer, NULL);
+#endif
+}
+
+
+/**
+******************************************************************************
+* Read - read the bytes available now
+*
+* @param    pData:out	buffer
+* @param    size:in		size of the buffer
+* @return   number of bytes read
+* @remarks
+******************************************************************************
+*/
+unsigned long AdcSimulator::Read(void *pData, unsigned long size)
+{
+	return ReadAvailable(pData, size, 0);
+}
+
+
+/**
+******************************************************************************
+* ReadAvailable - read bytes, wait up to timeout for the next response
+*
+* @param    pData:out	buffer
+* @param    size:in		size of the buffer
+* @param    timeout:in	ms
+* @return   number of bytes read, 0 on timeout
+* @remarks	with option fragment the response is read in pieces
+******************************************************************************
+*/
+unsigned long AdcSimulator::ReadAvailable(void *pData, unsigned long size, unsigned long timeout)
+{
+	unsigned long	count;
+	chrono::steady_clock::time_point due;
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout);
+	unique_lock<mutex> lock(m_mutex);
+
+	if (!m_open || !pData || m_responses.empty() || (m_responses.front().due > deadline))
+	{
+		lock.unlock();
+		this_thread::sleep_until(deadline);
+		return 0;
+	}
+
+	due = m_responses.front().due;
+	lock.unlock();
+	this_thread::sleep_until(due);
+	lock.lock();
+
+	// closed or reconnected in between
+	if (m_responses.empty())
+	{
+		ArmTimer();
+		return 0;
+	}
+
+	string &response = m_responses.front().data;
+	count = (response.size() < size) ? response.size() : size;
+	if (m_fragment && (count > m_fragment))
+		count = m_fragment;
+	memcpy(pData, response.data(), count);
+	response.erase(0, count);
+	if (response.empty())
+		m_responses.pop_front();
+	ArmTimer();
+
+	return count;
+}
+
+
+/**
+******************************************************************************
+* WaitForData - wait up to timeout for the next response
+*
+* @param    timeout:in	ms
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcSimulator::WaitForData(unsigned long timeout)
+{
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout);
+	unique_lock<mutex> lock(m_mutex);
+
+	if (!m_responses.empty() && (m_responses.front().due < deadline))
+		deadline = m_responses.front().due;
+	lock.unlock();
+
+	this_thread::sleep_until(deadline);
+}
+
+
+/**
+******************************************************************************
+* ResetInterface - drop received bytes and pending responses
+*
+* @param
+* @return   true
+* @remarks
+******************************************************************************
+*/
+bool AdcSimulator::ResetInterface()
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	m_input.clear();
+	m_responses.clear();
+	ArmTimer();
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* GetPort - get the port
+*
+* @param    port:out	port with options
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcSimulator::GetPort(string &port)
+{
+	port = m_port;
+}
+
+
+/**
+******************************************************************************
+* GetPollFd - file descriptor that is readable when a response is due
+*
+* @param
+* @return   timerfd, -1: no timer
+* @remarks	see ArmTimer
+******************************************************************************
+*/
+int AdcSimulator::GetPollFd()
+{
+	return m_timer;
+}
+
+
+/**
+******************************************************************************
+* IsSimulatorPort - check the port of AdcOpen
+*
+* @param    port:in		port
+* @return   true if the port selects the simulator
+* @remarks
+******************************************************************************
+*/
+bool AdcSimulator::IsSimulatorPort(const string &port)
+{
+	return (port.compare(0, PORT_NAME.size(), PORT_NAME) == 0) &&
+		   ((port.size() == PORT_NAME.size()) || (port[PORT_NAME.size()] == ':'));
+}
+
+
+/**
+******************************************************************************
+* CheckChecksum - check the crc of a request
+*
+* @param    request:in		parsed request
+* @return   true if the crc is correct or the request has no crc
+* @remarks	like AdcRbs::CheckChecksum
+******************************************************************************
+*/
+bool AdcSimulator::CheckChecksum(const RbsResponse &request)
+{
+	const RbsField		*crc;
+	const char			*data;
+	unsigned long		size;
+	unsigned long long	crcReceived;
+	Authentication		crc16(RBS_CRC_START, RBS_CRC_POLY, RBS_CRC_MASK);
+
+	if ((crc = request.GetCrc16()) == NULL)
+		return true;
+
+	if (!request.GetCrcRange(&data, &size) || !crc->GetULongLong(&crcReceived))
+		return false;
+
+	return crc16.CalcCrc((unsigned char *)data, size) == crcReceived;
+}
+
+
+/**
+******************************************************************************
+* Weight - format a weight as reference data
+*
+* @param    value:in			weight
+* @param    decimalPlaces:in	decimal places of value
+* @return   value ESC decimal places ESC weight unit
+* @remarks
+******************************************************************************
+*/
+string AdcSimulator::Weight(long long value, short decimalPlaces)
+{
+	return to_string(value) + Lars::ESC + to_string(decimalPlaces) + Lars::ESC + to_string(SIM_WEIGHT_UNIT);
+}
+
+
+/**
+******************************************************************************
+* Random - deterministic random numbers, xorshift
+*
+* @param    range:in	number of values
+* @return   0 .. range - 1, 0 if range is 0
+* @remarks	same seed, same sequence
+******************************************************************************
+*/
+unsigned long AdcSimulator::Random(unsigned long range)
+{
+	m_random ^= m_random >> 12;
+	m_random ^= m_random << 25;
+	m_random ^= m_random >> 27;
+
+	return range ? (unsigned long)(((m_random * 2685821657736338717ULL) >> 32) % range) : 0;
+}
+
+
+/**
+******************************************************************************
+* Join - join values with ESC
+*
+* @param    values:in	values
+* @param    count:in	number of values
+* @return   joined values
+* @remarks
+******************************************************************************
+*/
+string AdcSimulator::Join(const char *const *values, short count)
+{
+	string	joined;
+
+	for (short idx = 0; idx < count; idx++)
+	{
+		if (idx) joined += Lars::ESC;
+		joined += values[idx];
+	}
+
+	return joined;
+}
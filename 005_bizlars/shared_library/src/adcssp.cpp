@@ -14,7 +14,6 @@
 #include <iomanip>
 #include "adcssp.h"
 #include "larsErr.h"
-#include "crypto.h"
 #include "helpers.h"
 #include "adctrace.h"
 
@@ -77,9 +76,8 @@ void AdcSsp::Clear()
 short AdcSsp::LoadFile(const string *directory, const string *adcType, const string *wsType, const string *scaleModel)
 {
 	short		errorCode;
-	Crypto		cryptVar;
 	string		sspFile;
-	string		fileContent;
+	shared_ptr<const AdcFileCache::Content> fileContent;
 	string		tmpAdcType, tmpWsType, tmpScaleModel;
 	short		setFlag, actFlag;
 
@@ -106,15 +104,15 @@ short AdcSsp::LoadFile(const string *directory, const string *adcType, const str
 	if (!directory->empty())
 		sspFile = *directory + "/" + sspFile;
 
-	// read and decrypt country settings file
-	errorCode = cryptVar.ReadEncryptedFile(sspFile, fileContent);
+	// read and decrypt ssp file, other adc of the same model share it
+	errorCode = g_adcFileCache.Read(sspFile, fileContent);
 	if (errorCode != LarsErr::E_SUCCESS)
 	{
 		return errorCode;
 	}
 
 	// parse ssp file
-	Parse(fileContent, PARSE_ONLY_HEADER);
+	Parse(*fileContent, PARSE_ONLY_HEADER);
 
 	// check for key adc type
 	tmpAdcType.clear();
@@ -148,7 +146,7 @@ short AdcSsp::LoadFile(const string *directory, const string *adcType, const str
 	if ((setFlag & 0x04) && (*scaleModel != tmpScaleModel)) return LarsErr::E_FILE_CORRUPT;
 
 	// parse ssp file
-	Parse(fileContent, PARSE_COMPLETE);
+	Parse(*fileContent, PARSE_COMPLETE);
 
 	return errorCode;
 }
@@ -165,24 +163,18 @@ short AdcSsp::LoadFile(const string *directory, const string *adcType, const str
 * @remarks
 ******************************************************************************
 */
-void AdcSsp::Parse(string &content, short type)
+void AdcSsp::Parse(const AdcFileCache::Content &content, short type)
 {
 	short   state = UNSUPPORTED;
 	string  oneRow, key, value;
-	size_t  startPos = 0, endPos = 0;
-	size_t  pos1 = 0, posSeparator = 0;
+	size_t  posSeparator = 0;
 
-	// remove all CR from string
-	RemoveCR(content);
-
-	while (startPos < content.length())
+	for (AdcFileCache::Content::const_iterator row = content.begin(); row != content.end(); ++row)
 	{
-		endPos = content.find('\n', startPos);
-		if (endPos == string::npos) 
-			endPos = content.length();
-		oneRow = content.substr(startPos, endPos - startPos);
+		// sections are lines without '='
+		oneRow = row->keyValue ? "" : row->key;
 
-		if (!oneRow.empty())
+		if (row->keyValue || !oneRow.empty())
 		{
 			if (oneRow == SCALE_STRING)
 			{
@@ -238,11 +230,10 @@ void AdcSsp::Parse(string &content, short type)
 				switch (state)
 				{
 				case SCALE:
-					pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
+					if (row->keyValue)
 					{
-						key = oneRow.substr(0, pos1);
-						value = oneRow.substr(pos1 + 1);
+						key = row->key;
+						value = row->value;
 						Helpers::KeyAddOrReplace(m_scaleSettings, key, value);
 					}
 					else
@@ -250,11 +241,10 @@ void AdcSsp::Parse(string &content, short type)
 					break;
 
 				case TCC_SETTINGS:
-					pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
+					if (row->keyValue)
 					{
-						key = oneRow.substr(0, pos1);
-						value = oneRow.substr(pos1 + 1);
+						key = row->key;
+						value = row->value;
 						Helpers::KeyAddOrReplace(m_tccSettings, key, value);
 					}
 					else
@@ -262,11 +252,10 @@ void AdcSsp::Parse(string &content, short type)
 					break;
 
 				case LIN_SETTINGS:
-					pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
+					if (row->keyValue)
 					{
-						key = oneRow.substr(0, pos1);
-						value = oneRow.substr(pos1 + 1);
+						key = row->key;
+						value = row->value;
 						Helpers::KeyAddOrReplace(m_linSettings, key, value);
 					}
 					else
@@ -274,11 +263,10 @@ void AdcSsp::Parse(string &content, short type)
 					break;
 
 				case WDTA_SETTINGS:
-					pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
+					if (row->keyValue)
 					{
-						key = oneRow.substr(0, pos1);
-						value = oneRow.substr(pos1 + 1);
+						key = row->key;
+						value = row->value;
 						Helpers::KeyAddOrReplace(m_wdtaSettings, key, value);
 					}
 					else
@@ -286,11 +274,10 @@ void AdcSsp::Parse(string &content, short type)
 					break;
 
 				case GENERAL_SETTINGS_SEALED:
-					pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
+					if (row->keyValue)
 					{
-						key = oneRow.substr(0, pos1);
-						value = oneRow.substr(pos1 + 1);
+						key = row->key;
+						value = row->value;
 
 						// patch key spiritLevel
 						if (key == SPIRIT_LEVEL_FLOAT || 
@@ -298,7 +285,7 @@ void AdcSsp::Parse(string &content, short type)
 							key == SPIRIT_LEVEL_ZEROING_RANGE_FLOAT)
 						{
 							posSeparator = key.find('|');
-							if (posSeparator != string::npos) key.replace(posSeparator + 1, pos1 - posSeparator - 1, "INT");
+							if (posSeparator != string::npos) key.replace(posSeparator + 1, row->key.size() - posSeparator - 1, "INT");
 
 							Helpers::ReplaceDecimalPoint(value);
 							value = to_string(m_tilt->GetAngleDigit(stof(value)));
@@ -312,33 +299,10 @@ void AdcSsp::Parse(string &content, short type)
 				}
 			}
 		}
-		startPos = endPos + 1;
 	}
 }
 
 
-/**
-******************************************************************************
-* RemoveCR - remove all cr from string
-*
-* @param    str:in	string
-*
-* @return   errorCode
-* @remarks
-******************************************************************************
-*/
-void AdcSsp::RemoveCR(string &str)
-{
-	size_t  pos = 0;
-	// first remove all \n
-	do
-	{
-		pos = str.find('\r', pos);
-		if (pos != string::npos) str.erase(pos, 1);
-	} while (pos != string::npos);
-}
-
-
 /**
 ******************************************************************************
 * GetTccSettings - get AdcSsp settings
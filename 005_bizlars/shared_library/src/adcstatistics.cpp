@@ -0,0 +1,495 @@
+/**
+******************************************************************************
+* File       : adcstatistics.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcstatistics class: counters and latency histograms of the
+*              rbs commands of an adc
+******************************************************************************
+*/
+#include <fstream>
+#include <algorithm>
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+#include "larsErr.h"
+#include "adctrace.h"
+#include "adcstatistics.h"
+
+
+AdcStatistics::AdcStatistics()
+{
+	m_commands = new Command[STAT_MAX_COMMANDS];
+
+	for (short idx = 0; idx < STAT_MAX_COMMANDS; idx++)
+	{
+		m_commands[idx].state.store(SLOT_FREE);
+		memset(m_commands[idx].cmd, 0, sizeof(m_commands[idx].cmd));
+		Clear(m_commands[idx]);
+	}
+}
+
+AdcStatistics::~AdcStatistics()
+{
+	delete[] m_commands;
+}
+
+
+/**
+******************************************************************************
+* GetCommand - slot of a command, a new command gets a free slot
+*
+* @param    cmd:in			rbs command
+*
+* @return   slot, -1: table is full or cmd is too long
+* @remarks	lock free, the slots are never released
+******************************************************************************
+*/
+short AdcStatistics::GetCommand(const string &cmd)
+{
+	unsigned long	hash = 0;
+	short			idx;
+	int				state;
+
+	if (cmd.empty() || (cmd.size() >= ADC_STAT_CMD_SIZE))
+		return -1;
+
+	for (size_t pos = 0; pos < cmd.size(); pos++)
+		hash = hash * 31 + (unsigned char)cmd[pos];
+
+	for (short probe = 0; probe < STAT_MAX_COMMANDS; probe++)
+	{
+		Command &command = m_commands[idx = (short)((hash + probe) & (STAT_MAX_COMMANDS - 1))];
+
+		state = command.state.load(memory_order_acquire);
+		if (state == SLOT_FREE)
+		{
+			if (command.state.compare_exchange_strong(state, SLOT_CLAIMED, memory_order_acquire))
+			{
+				strcpy(command.cmd, cmd.c_str());
+				command.state.store(SLOT_READY, memory_order_release);
+				return idx;
+			}
+		}
+
+		// another thread writes the name just now
+		while (state == SLOT_CLAIMED)
+			state = command.state.load(memory_order_acquire);
+
+		if (strcmp(command.cmd, cmd.c_str()) == 0)
+			return idx;
+	}
+
+	return -1;
+}
+
+
+/**
+******************************************************************************
+* Count - increment a counter of a command
+*
+* @param    command:in		slot of GetCommand, -1 is ignored
+* @param    counter:in		CNT_...
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcStatistics::Count(short command, short counter)
+{
+	if ((command < 0) || (command >= STAT_MAX_COMMANDS) || (counter < 0) || (counter >= CNT_COUNT))
+		return;
+
+	m_commands[command].counters[counter].fetch_add(1, memory_order_relaxed);
+}
+
+
+/**
+******************************************************************************
+* RecordLatency - add a measurement to a histogram of a command
+*
+* @param    command:in		slot of GetCommand, -1 is ignored
+* @param    latency:in		LAT_...
+* @param    duration:in		measured time
+*
+* @return   void
+* @remarks	the resolution is 1 us
+******************************************************************************
+*/
+void AdcStatistics::RecordLatency(short command, short latency, chrono::steady_clock::duration duration)
+{
+	long long		us;
+	unsigned long	value;
+	unsigned long	current;
+
+	if ((command < 0) || (command >= STAT_MAX_COMMANDS) || (latency < 0) || (latency >= LAT_COUNT))
+		return;
+
+	us = chrono::duration_cast<chrono::microseconds>(duration).count();
+	value = (us < 0) ? 0 : (((unsigned long long)us > ULONG_MAX) ? ULONG_MAX : (unsigned long)us);
+
+	Histogram &histogram = m_commands[command].latencies[latency];
+
+	histogram.buckets[GetBucket(value)].fetch_add(1, memory_order_relaxed);
+	histogram.sum.fetch_add(value, memory_order_relaxed);
+
+	current = histogram.min.load(memory_order_relaxed);
+	while ((value < current) && !histogram.min.compare_exchange_weak(current, value, memory_order_relaxed));
+
+	current = histogram.max.load(memory_order_relaxed);
+	while ((value > current) && !histogram.max.compare_exchange_weak(current, value, memory_order_relaxed));
+}
+
+
+/**
+******************************************************************************
+* Get - copy the statistics of all used commands
+*
+* @param    statistics:out	array of *count entries, sorted by command
+* @param    count:in/out	in: size of the array, out: number of commands
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+*			LarsErr::E_NOT_ENOUGH_MEMORY	array too small, *count is the needed size
+* @remarks	the counters are read while requests are running, so the values of
+*			a command may differ by the running request
+******************************************************************************
+*/
+short AdcStatistics::Get(AdcCommandStatistics *statistics, short *count)
+{
+	short	used = 0;
+
+	if (!count || ((*count > 0) && !statistics))
+		return LarsErr::E_INVALID_PARAMETER;
+
+	for (short idx = 0; idx < STAT_MAX_COMMANDS; idx++)
+	{
+		const Command &command = m_commands[idx];
+
+		if (command.state.load(memory_order_acquire) != SLOT_READY)
+			continue;
+
+		if (used < *count)
+		{
+			AdcCommandStatistics &entry = statistics[used];
+
+			memset(&entry, 0, sizeof(entry));
+			strcpy(entry.cmd, command.cmd);
+			entry.requests = command.counters[CNT_REQUESTS].load(memory_order_relaxed);
+			entry.retries = command.counters[CNT_RETRIES].load(memory_order_relaxed);
+			entry.timeouts = command.counters[CNT_TIMEOUTS].load(memory_order_relaxed);
+			entry.crcErrors = command.counters[CNT_CRC_ERRORS].load(memory_order_relaxed);
+			entry.protocolErrors = command.counters[CNT_PROTOCOL_ERRORS].load(memory_order_relaxed);
+			entry.failures = command.counters[CNT_FAILURES].load(memory_order_relaxed);
+			GetLatency(command.latencies[LAT_WRITE], entry.writeTime);
+			GetLatency(command.latencies[LAT_FIRST_BYTE], entry.firstByte);
+			GetLatency(command.latencies[LAT_ROUND_TRIP], entry.roundTrip);
+		}
+		used++;
+	}
+
+	if (used > *count)
+	{
+		*count = used;
+		return LarsErr::E_NOT_ENOUGH_MEMORY;
+	}
+
+	*count = used;
+	sort(statistics, statistics + used, [](const AdcCommandStatistics &a, const AdcCommandStatistics &b) { return strcmp(a.cmd, b.cmd) < 0; });
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* Reset - set all counters and histograms to zero
+*
+* @return   void
+* @remarks	the commands keep their slots
+******************************************************************************
+*/
+void AdcStatistics::Reset()
+{
+	for (short idx = 0; idx < STAT_MAX_COMMANDS; idx++)
+		Clear(m_commands[idx]);
+}
+
+
+/**
+******************************************************************************
+* WritePrometheus - write the statistics in the Prometheus text format
+*
+* @param    fileName:in		path of the file
+* @param    port:in			value of the port label
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+*			LarsErr::E_FILE_NOT_FOUND	file could not be written
+* @remarks	the file is written to fileName.tmp and renamed, so the textfile
+*			collector of the node exporter never reads a partial file.
+*			The histogram buckets are the powers of 2 from 64 us to 33 s.
+******************************************************************************
+*/
+short AdcStatistics::WritePrometheus(const char *fileName, const string &port)
+{
+	static const struct
+	{
+		short		counter;
+		const char	*name;
+		const char	*help;
+	} counterNames[CNT_COUNT] =
+	{
+		{ CNT_REQUESTS,			"bizlars_requests_total",			"Requests of the rbs command." },
+		{ CNT_RETRIES,			"bizlars_retries_total",			"Telegrams repeated with the repeat flag." },
+		{ CNT_TIMEOUTS,			"bizlars_timeouts_total",			"Responses not received within the timeout." },
+		{ CNT_CRC_ERRORS,		"bizlars_crc_errors_total",			"Responses with crc error or crc error reported by the adc." },
+		{ CNT_PROTOCOL_ERRORS,	"bizlars_protocol_errors_total",	"Invalid responses." },
+		{ CNT_FAILURES,			"bizlars_failures_total",			"Requests failed after all retries." },
+	};
+	static const struct
+	{
+		short		latency;
+		const char	*name;
+		const char	*help;
+	} latencyNames[LAT_COUNT] =
+	{
+		{ LAT_WRITE,			"bizlars_write_seconds",			"Write time of the request." },
+		{ LAT_FIRST_BYTE,		"bizlars_first_byte_seconds",		"Time from the request to the first byte of the response." },
+		{ LAT_ROUND_TRIP,		"bizlars_round_trip_seconds",		"Time from the request to the complete response." },
+	};
+	static const short	FIRST_LIMIT_EXPONENT = 6;		// 64 us
+
+	ofstream			file;
+	string				tmpName;
+	string				labels;
+	char				line[256];
+	unsigned long long	cumulated;
+	unsigned long long	sum;
+	short				bucket;
+
+	if (!fileName || !fileName[0])
+		return LarsErr::E_INVALID_PARAMETER;
+
+	tmpName = string(fileName) + ".tmp";
+	file.open(tmpName.c_str(), ios::trunc);
+	if (!file.is_open())
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't create %s", __FUNCTION__, tmpName.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	for (short cnt = 0; cnt < CNT_COUNT; cnt++)
+	{
+		file << "# HELP " << counterNames[cnt].name << " " << counterNames[cnt].help << "\n";
+		file << "# TYPE " << counterNames[cnt].name << " counter\n";
+
+		for (short idx = 0; idx < STAT_MAX_COMMANDS; idx++)
+		{
+			if (m_commands[idx].state.load(memory_order_acquire) != SLOT_READY)
+				continue;
+
+			file << counterNames[cnt].name << "{port=\"" << EscapeLabel(port) << "\",cmd=\"" << EscapeLabel(m_commands[idx].cmd) << "\"} "
+				 << m_commands[idx].counters[counterNames[cnt].counter].load(memory_order_relaxed) << "\n";
+		}
+	}
+
+	for (short lat = 0; lat < LAT_COUNT; lat++)
+	{
+		file << "# HELP " << latencyNames[lat].name << " " << latencyNames[lat].help << "\n";
+		file << "# TYPE " << latencyNames[lat].name << " histogram\n";
+
+		for (short idx = 0; idx < STAT_MAX_COMMANDS; idx++)
+		{
+			if (m_commands[idx].state.load(memory_order_acquire) != SLOT_READY)
+				continue;
+
+			const Histogram &histogram = m_commands[idx].latencies[latencyNames[lat].latency];
+
+			labels = "port=\"" + EscapeLabel(port) + "\",cmd=\"" + EscapeLabel(m_commands[idx].cmd) + "\"";
+			sum = histogram.sum.load(memory_order_relaxed);
+
+			// the sub buckets end exactly at the powers of 2
+			cumulated = 0;
+			bucket = 0;
+			for (short exponent = FIRST_LIMIT_EXPONENT; exponent <= HIST_MAX_EXPONENT; exponent++)
+			{
+				for (; (bucket < HIST_BUCKETS) && (GetBucketLimit(bucket) <= (1UL << exponent)); bucket++)
+					cumulated += histogram.buckets[bucket].load(memory_order_relaxed);
+
+				snprintf(line, sizeof(line), "%s_bucket{%s,le=\"%.6f\"} %llu\n", latencyNames[lat].name, labels.c_str(), (double)(1UL << exponent) / 1e6, cumulated);
+				file << line;
+			}
+			for (; bucket < HIST_BUCKETS; bucket++)
+				cumulated += histogram.buckets[bucket].load(memory_order_relaxed);
+
+			snprintf(line, sizeof(line), "%s_bucket{%s,le=\"+Inf\"} %llu\n", latencyNames[lat].name, labels.c_str(), cumulated);
+			file << line;
+			snprintf(line, sizeof(line), "%s_sum{%s} %.6f\n", latencyNames[lat].name, labels.c_str(), (double)sum / 1e6);
+			file << line;
+			snprintf(line, sizeof(line), "%s_count{%s} %llu\n", latencyNames[lat].name, labels.c_str(), cumulated);
+			file << line;
+		}
+	}
+
+	file.close();
+
+	if (file.fail() || (rename(tmpName.c_str(), fileName) != 0))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tcan't write %s", __FUNCTION__, fileName);
+		remove(tmpName.c_str());
+		return LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* GetBucket - histogram bucket of a value
+*
+* @param    value:in		us
+*
+* @return   bucket
+* @remarks	values below HIST_SUB_COUNT have their own bucket, above the
+*			exponent selects the group and the next HIST_SUB_BITS the bucket
+******************************************************************************
+*/
+short AdcStatistics::GetBucket(unsigned long value)
+{
+	short	exponent = HIST_SUB_BITS;
+
+	if (value < (unsigned long)HIST_SUB_COUNT)
+		return (short)value;
+
+	while ((exponent < HIST_MAX_EXPONENT + 1) && (value >> (exponent + 1)))
+		exponent++;
+
+	if (exponent > HIST_MAX_EXPONENT)
+		return HIST_BUCKETS - 1;
+
+	return (short)((exponent - HIST_SUB_BITS + 1) * HIST_SUB_COUNT + ((value >> (exponent - HIST_SUB_BITS)) & (HIST_SUB_COUNT - 1)));
+}
+
+
+/**
+******************************************************************************
+* GetBucketLimit - first value above a histogram bucket
+*
+* @param    bucket:in		bucket
+*
+* @return   us
+* @remarks
+******************************************************************************
+*/
+unsigned long AdcStatistics::GetBucketLimit(short bucket)
+{
+	short	exponent = bucket / HIST_SUB_COUNT + HIST_SUB_BITS - 1;
+	short	sub = bucket % HIST_SUB_COUNT;
+
+	if (bucket < HIST_SUB_COUNT)
+		return (unsigned long)bucket + 1;
+
+	return (unsigned long)(HIST_SUB_COUNT + sub + 1) << (exponent - HIST_SUB_BITS);
+}
+
+
+/**
+******************************************************************************
+* GetLatency - summary of a histogram
+*
+* @param    histogram:in	histogram
+* @param    latency:out		count, min, mean, percentiles and max in us
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcStatistics::GetLatency(const Histogram &histogram, AdcLatency &latency)
+{
+	unsigned long long	count = 0;
+
+	for (short bucket = 0; bucket < HIST_BUCKETS; bucket++)
+		count += histogram.buckets[bucket].load(memory_order_relaxed);
+
+	memset(&latency, 0, sizeof(latency));
+	if (!count)
+		return;
+
+	latency.count = (unsigned long)count;
+	latency.min = histogram.min.load(memory_order_relaxed);
+	latency.mean = (unsigned long)(histogram.sum.load(memory_order_relaxed) / count);
+	latency.p50 = GetPercentile(histogram, count, 500);
+	latency.p90 = GetPercentile(histogram, count, 900);
+	latency.p99 = GetPercentile(histogram, count, 990);
+	latency.max = histogram.max.load(memory_order_relaxed);
+}
+
+
+/**
+******************************************************************************
+* GetPercentile - value below which the given part of the measurements lies
+*
+* @param    histogram:in	histogram
+* @param    count:in		sum of the buckets
+* @param    permille:in		e.g. 990 for the 99th percentile
+*
+* @return   us, highest value of the bucket but not above the max.
+* @remarks
+******************************************************************************
+*/
+unsigned long AdcStatistics::GetPercentile(const Histogram &histogram, unsigned long long count, unsigned long permille)
+{
+	unsigned long long	rank = (count * permille + 999) / 1000;
+	unsigned long long	cumulated = 0;
+	unsigned long		max = histogram.max.load(memory_order_relaxed);
+
+	for (short bucket = 0; bucket < HIST_BUCKETS; bucket++)
+	{
+		cumulated += histogram.buckets[bucket].load(memory_order_relaxed);
+		if (cumulated >= rank)
+			return (GetBucketLimit(bucket) - 1 < max) ? GetBucketLimit(bucket) - 1 : max;
+	}
+
+	return max;
+}
+
+
+void AdcStatistics::Clear(Command &command)
+{
+	for (short cnt = 0; cnt < CNT_COUNT; cnt++)
+		command.counters[cnt].store(0, memory_order_relaxed);
+
+	for (short lat = 0; lat < LAT_COUNT; lat++)
+	{
+		Histogram &histogram = command.latencies[lat];
+
+		for (short bucket = 0; bucket < HIST_BUCKETS; bucket++)
+			histogram.buckets[bucket].store(0, memory_order_relaxed);
+		histogram.sum.store(0, memory_order_relaxed);
+		histogram.min.store(ULONG_MAX, memory_order_relaxed);
+		histogram.max.store(0, memory_order_relaxed);
+	}
+}
+
+
+string AdcStatistics::EscapeLabel(const string &value)
+{
+	string	escaped;
+
+	for (size_t pos = 0; pos < value.size(); pos++)
+	{
+		if ((value[pos] == '\\') || (value[pos] == '"'))
+			escaped += '\\';
+		if (value[pos] == '\n')
+			escaped += "\\n";
+		else
+			escaped += value[pos];
+	}
+
+	return escaped;
+}
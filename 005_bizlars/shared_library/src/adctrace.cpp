@@ -10,8 +10,10 @@
 ******************************************************************************
 */
 #include <stdarg.h>
+#include <stdio.h>
 #include <algorithm>
 #include <sstream>
+#include <chrono>
 #define TRACE_CREATE
 #include "adctrace.h"
 #include "helpers.h"
@@ -22,47 +24,52 @@ AdcTrace::AdcTrace()
 	m_fileName.clear();
 	m_level = TRC_OFF;
 
-    string controlSequence;
-    controlSequence = 0x01;
-    m_controlChar[controlSequence] = "<SOH>";
-    controlSequence = 0x02;
-    m_controlChar[controlSequence] = "<STX>";
-    controlSequence = 0x03;
-    m_controlChar[controlSequence] = "<ETX>";
-    controlSequence = 0x1b;
-    m_controlChar[controlSequence] = "<ESC>";
-    controlSequence = 0x17;
-    m_controlChar[controlSequence] = "<ETB>";
-    controlSequence = 0x1c;
-    m_controlChar[controlSequence] = "<FS>";
-    controlSequence = 0x1d;
-    m_controlChar[controlSequence] = "<GS>";
+	// all slots are free for the first round of the producers
+	m_queue = new TraceEntry[TRC_QUEUE_SIZE];
+	for (unsigned long idx = 0; idx < TRC_QUEUE_SIZE; idx++)
+		m_queue[idx].sequence.store(idx);
+	m_writePos = 0;
+	m_readPos = 0;
+	m_dropped = 0;
+
+	m_sleeping = false;
+	m_run = false;
+	m_fileSize = 0;
 }
 
 
 AdcTrace::~AdcTrace()
 {
+	// late traces of other global objects are ignored
+	m_level = TRC_OFF;
+	StopWriter();
+
+	delete[] m_queue;
+	m_queue = NULL;
 }
 
 /**
 ******************************************************************************
-* Trace - function to write into the trace file
+* GetTime - format a time stamp of the trace file
 *
-* @param    level:in		loglevel
-* @param    trcMessage:in	Tracedata
+* @param    time:in			time of the message
 *
-* @return   Bytes written
-* @remarks
+* @return   formatted local time
+* @remarks	only called by the writer thread
 ******************************************************************************
 */
-char* AdcTrace::GetTime()
+char* AdcTrace::GetTime(time_t time)
 {
-	struct tm * timeinfo;
+	struct tm timeinfo;
 	static char buffer[80];
 
-	timeinfo = Helpers::GetTime();
+#ifdef _MSC_VER
+	localtime_s(&timeinfo, &time);
+#else
+	localtime_r(&time, &timeinfo);
+#endif
 
-	strftime(buffer, 80, "%Y-%m-%d %H:%M:%S", timeinfo);
+	strftime(buffer, 80, "%Y-%m-%d %H:%M:%S", &timeinfo);
 
 	return buffer;
 }
@@ -72,70 +79,309 @@ char* AdcTrace::GetTime()
 * Trace - function to write into the trace file
 *
 * @param    level:in		loglevel
-* @param    trcMessage:in	Tracedata
+* @param    fmt:in			format of the message, see printf
 *
-* @return   Bytes written
-* @remarks
+* @return   length of the message, 0: not traced
+* @remarks	lock free, the message is formatted into a free slot of the
+*			queue and written by the writer thread. The arguments are
+*			formatted here because strings of the caller don't live longer
+*			than the call. If the queue stays full because the writer is
+*			blocked, the message is dropped.
 ******************************************************************************
 */
 short AdcTrace::Trace(short level, const char *fmt, ...)
 {
-	short		ret = 0;
-	ofstream	fHandle;
-	string	    trcMessage;
-	char		buffer[1024];
-    size_t      pos;
-
-	if (m_level && (level <= m_level))
+	TraceEntry		*entry;
+	unsigned long	pos;
+	unsigned long	sequence;
+	unsigned long	retry = 0;
+	int				length;
+	short			traceLevel = m_level.load(memory_order_relaxed);
+
+	if (!traceLevel || (level > traceLevel))
+		return 0;
+
+	// reserve a slot
+	pos = m_writePos.load(memory_order_relaxed);
+	for (;;)
 	{
-		m_mutex.lock();
+		entry = &m_queue[pos & (TRC_QUEUE_SIZE - 1)];
+		sequence = entry->sequence.load(memory_order_acquire);
 
-		fHandle.open(m_fileName, ios::binary | ios::app);
-		if (!fHandle.is_open())
+		if (sequence == pos)
 		{
-			m_mutex.unlock();
-			return ret;
+			if (m_writePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+				break;
 		}
-		// check file size
-		fHandle.seekp(0, ios::end);
-		if (fHandle.tellp() > TRC_MAX_FILE_SIZE)
+		else if ((long)(sequence - pos) < 0)
 		{
-			fHandle.close();
-
-			MakeBackup();
-
-			fHandle.open(m_fileName, ios::binary);
-			if (!fHandle.is_open())
+			// the writer has not written this slot yet
+			if (++retry > TRC_FULL_RETRIES)
 			{
-				m_mutex.unlock();
-				return ret;
+				m_dropped.fetch_add(1, memory_order_relaxed);
+				return 0;
 			}
+			m_cond.notify_one();
+			this_thread::yield();
+			pos = m_writePos.load(memory_order_relaxed);
+		}
+		else
+		{
+			pos = m_writePos.load(memory_order_relaxed);
+		}
+	}
+
+	entry->level = level;
+	entry->time = time(NULL);
+
+	va_list args;
+	va_start(args, fmt);
+	length = vsnprintf(entry->message, TRC_MESSAGE_SIZE, fmt, args);
+	va_end(args);
+	if (length < 0)
+		entry->message[0] = '\0';
+
+	// publish the slot
+	entry->sequence.store(pos + 1, memory_order_release);
+
+	if (m_sleeping.load(memory_order_relaxed))
+		m_cond.notify_one();
+
+	if (length < 0)
+		return 0;
+	return (short)((length < (int)TRC_MESSAGE_SIZE) ? length : TRC_MESSAGE_SIZE - 1);
+}
+
+/**
+******************************************************************************
+* GetControlChar - readable name of a control character of the telegrams
+*
+* @param    value:in		character
+*
+* @return   name, e.g. "<SOH>", NULL: no control character of the protocol
+* @remarks	also used by the decoder of the flight recorder
+******************************************************************************
+*/
+const char *AdcTrace::GetControlChar(char value)
+{
+	switch (value)
+	{
+	case 0x01:	return "<SOH>";
+	case 0x02:	return "<STX>";
+	case 0x03:	return "<ETX>";
+	case 0x1b:	return "<ESC>";
+	case 0x17:	return "<ETB>";
+	case 0x1c:	return "<FS>";
+	case 0x1d:	return "<GS>";
+	default:	return NULL;
+	}
+}
+
+/**
+******************************************************************************
+* Dequeue - append the next message of the queue to the batch
+*
+* @param    batch:out		formatted trace lines
+*
+* @return   false: queue is empty
+* @remarks	only called by the writer thread
+******************************************************************************
+*/
+bool AdcTrace::Dequeue(string &batch)
+{
+	unsigned long	pos = m_readPos.load(memory_order_relaxed);
+	TraceEntry		*entry = &m_queue[pos & (TRC_QUEUE_SIZE - 1)];
+
+	if (entry->sequence.load(memory_order_acquire) != pos + 1)
+		return false;
+
+	batch.append(GetTime(entry->time));
+	batch.append("   ");
+	batch.append(to_string(entry->level));
+	batch.append("   ");
+
+	// replace control characters of the telegrams
+	for (const char *pChar = entry->message; *pChar; pChar++)
+	{
+		const char *name = GetControlChar(*pChar);
+
+		if (name)
+			batch.append(name);
+		else
+			batch.push_back(*pChar);
+	}
+	batch.append("\r\n");
+
+	// slot is free for the next round of the producers
+	entry->sequence.store(pos + TRC_QUEUE_SIZE, memory_order_release);
+	m_readPos.store(pos + 1, memory_order_release);
+
+	return true;
+}
+
+/**
+******************************************************************************
+* WriteBatch - write trace lines to the file
+*
+* @param    batch:in		formatted trace lines
+*
+* @return   void
+* @remarks	m_mutex must be locked. The file is kept open, it is opened again
+*			after a new configuration and a backup is made when it is full.
+******************************************************************************
+*/
+void AdcTrace::WriteBatch(const string &batch)
+{
+	if (m_file.is_open() && (m_openFileName != m_fileName))
+		m_file.close();
+
+	if (!m_file.is_open())
+	{
+		if (m_fileName.empty())
+			return;
+
+		m_file.open(m_fileName, ios::binary | ios::app);
+		if (!m_file.is_open())
+			return;
+		m_openFileName = m_fileName;
+
+		m_file.seekp(0, ios::end);
+		m_fileSize = (long)m_file.tellp();
+	}
+
+	// check file size
+	if (m_fileSize > TRC_MAX_FILE_SIZE)
+	{
+		m_file.close();
+
+		MakeBackup();
+
+		m_file.open(m_fileName, ios::binary | ios::trunc);
+		if (!m_file.is_open())
+			return;
+		m_fileSize = 0;
+	}
+
+	m_file.write(batch.c_str(), batch.size());
+	m_file.flush();
+	m_fileSize += (long)batch.size();
+}
+
+/**
+******************************************************************************
+* WriterThread - write the queued messages into the trace file
+*
+* @return   void
+* @remarks	all waiting messages are written with one write, without
+*			messages the thread sleeps until a producer wakes it up
+******************************************************************************
+*/
+void AdcTrace::WriterThread()
+{
+	string			batch;
+	unsigned long	dropped;
+
+	batch.reserve(TRC_BATCH_SIZE + TRC_MESSAGE_SIZE * 2);
+
+	unique_lock<mutex> lock(m_mutex);
+
+	for (;;)
+	{
+		lock.unlock();
+
+		batch.clear();
+		while ((batch.size() < TRC_BATCH_SIZE) && Dequeue(batch))
+			;
+
+		if ((dropped = m_dropped.exchange(0)) != 0)
+			batch.append(string(GetTime(time(NULL))) + "   " + to_string(TRC_ERROR_WARNING) + "   AdcTrace\t" + to_string(dropped) + " messages dropped\r\n");
+
+		lock.lock();
+
+		if (!batch.empty())
+		{
+			WriteBatch(batch);
+			continue;
 		}
 
-		// prepare buffer
-		va_list args;
-		va_start(args, fmt);
-		vsprintf(buffer, fmt, args);
-		va_end(args);
+		if (!m_run)
+			break;
+
+		// a producer may miss the flag, then the message waits for the timeout
+		m_sleeping = true;
+		m_cond.wait_for(lock, chrono::milliseconds(TRC_WRITER_SLEEP));
+		m_sleeping = false;
+	}
+
+	if (m_file.is_open())
+		m_file.close();
+}
+
+/**
+******************************************************************************
+* StartWriter - start the writer thread
+*
+* @return   void
+* @remarks	m_mutex must be locked
+******************************************************************************
+*/
+void AdcTrace::StartWriter()
+{
+	if (m_run)
+		return;
 
-		// write buffer
-		trcMessage = GetTime() + string("   ") + to_string(level) + string("   ") + buffer + string("\r\n");
-        for (map<string, string>::iterator it = m_controlChar.begin(); it != m_controlChar.end(); ++it)
-        {
-            // replace control sequence
-            while ((pos = trcMessage.find((*it).first)) != std::string::npos)
-                trcMessage.replace(pos, (*it).first.size(), (*it).second);
-        }
-        fHandle.write(trcMessage.c_str(), trcMessage.size());
+	// writer thread stopped before
+	if (m_writer.joinable())
+		m_writer.join();
 
-		fHandle.close();
+	m_run = true;
+	m_writer = thread(&AdcTrace::WriterThread, this);
+}
 
-		ret = trcMessage.size();
+/**
+******************************************************************************
+* StopWriter - write all queued messages and stop the writer thread
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcTrace::StopWriter()
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
 
-		m_mutex.unlock();
+		m_run = false;
+		m_cond.notify_all();
 	}
 
-	return ret;
+	if (m_writer.joinable())
+		m_writer.join();
+}
+
+/**
+******************************************************************************
+* Flush - wait until all queued messages are written
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcTrace::Flush()
+{
+	unsigned long pos = m_writePos.load();
+
+	for (unsigned long retry = 0; retry < 1000; retry++)
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+
+			if (!m_run || ((long)(m_readPos.load() - pos) >= 0))
+				return;
+			m_cond.notify_all();
+		}
+		this_thread::sleep_for(chrono::milliseconds(1));
+	}
 }
 
 /**
@@ -145,13 +391,11 @@ short AdcTrace::Trace(short level, const char *fmt, ...)
 * @param 
 *
 * @return	
-* @remarks
+* @remarks	the full file is renamed, the previous backup is lost
 ******************************************************************************
 */
 bool AdcTrace::MakeBackup()
 {
-	ofstream	fOutHandle;
-	ifstream	fInHandle;
 	string		BackupFileName;
 	size_t		pos;
 
@@ -164,56 +408,55 @@ bool AdcTrace::MakeBackup()
 
 	BackupFileName.append(".bak");
 
-	fInHandle.open(m_fileName, ios::binary);
-	if (!fInHandle.is_open())
-		return false;
+	remove(BackupFileName.c_str());
 
-	fOutHandle.open(BackupFileName, ios::binary);
-	if (!fOutHandle.is_open())
-	{
-		fInHandle.close();
-		return false;
-	}
-
-	copy(istreambuf_iterator<char>(fInHandle), istreambuf_iterator<char>(), ostreambuf_iterator<char>(fOutHandle));
-
-	fInHandle.close();
-	fOutHandle.close();
-
-	return true;
+	return (rename(m_fileName.c_str(), BackupFileName.c_str()) == 0);
 }
 
 /**
 ******************************************************************************
-* MakeBackup - function to make the configuration
+* SetConfig - function to make the configuration
 *
 * @param	fileName:in		Path + Filename
 * @param	level:in		Tracelevel
 *
 * @return
-* @remarks
+* @remarks	messages of the previous configuration are written first,
+*			without trace the writer thread is stopped
 ******************************************************************************
 */
 void AdcTrace::SetConfig(const char *fileName, const short level)
 {
-	m_mutex.lock();
+	short	newLevel;
 
-	if ((level >= TRC_ERROR_WARNING) && (level <= TRC_INFO))
-		m_level = level;
-	else
-		m_level = TRC_OFF;
+	Flush();
 
-	if (fileName)
-	{
-		m_fileName = string(fileName);
-		if (m_fileName.empty()) m_level = TRC_OFF;
-	}
-	else
 	{
-		m_level = TRC_OFF;
+		lock_guard<mutex> lock(m_mutex);
+
+		if ((level >= TRC_ERROR_WARNING) && (level <= TRC_INFO))
+			newLevel = level;
+		else
+			newLevel = TRC_OFF;
+
+		if (fileName)
+		{
+			m_fileName = string(fileName);
+			if (m_fileName.empty()) newLevel = TRC_OFF;
+		}
+		else
+		{
+			newLevel = TRC_OFF;
+		}
+
+		if (newLevel != TRC_OFF)
+			StartWriter();
+
+		m_level = newLevel;
 	}
 
-	m_mutex.unlock();
+	if (newLevel == TRC_OFF)
+		StopWriter();
 
 	return;
 }
@@ -19,11 +19,13 @@
 #endif
 #ifdef  __GNUC__
 #include <string.h>
+#include <stdlib.h>
 #include <sys/ioctl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
 
 #ifdef USE_LIBUSB
 //#include <libusb-1.0/libusb.h>
@@ -41,6 +43,8 @@
 #define	SIZE_RINGBUFFER	2048
 // read always data packages with size 64 Bytes, because the adc send usb packets with 64 bytes
 #define	SIZE_READ_USB_DATA_PACKAGE	64
+// buffer size of one asynchronous bulk in transfer, multiple of the usb packet size
+#define	SIZE_ASYNC_TRANSFER_BUFFER	512
 
 #ifdef USE_LIBUSB
 #define IOCTL_BIZWSD_RESET_DEVICE	1
@@ -76,6 +80,16 @@ AdcUsb::AdcUsb() : AdcInterface()
 	m_devs = NULL;
 	m_bulkInEndpointAddr = 0;
 	m_bulkInEndpointAddr = 0;
+
+	m_asyncMode = true;
+	m_asyncActive = false;
+	m_asyncRun = false;
+	m_asyncError = false;
+	m_asyncPending = 0;
+	for (short idx = 0; idx < NUM_ASYNC_TRANSFERS; idx++)
+		m_asyncTransfers[idx] = NULL;
+	m_asyncEvent = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
 	if ((retCode = libusb_init(&m_context)) < LIBUSB_SUCCESS)
 	{
 		ConvertLibUsbErrorCodeToString(errorMessage, retCode);
@@ -88,13 +102,15 @@ AdcUsb::AdcUsb() : AdcInterface()
 
 AdcUsb::~AdcUsb()
 {
-	delete m_ringBuffer;
-	delete[] m_readCache;
-
 #if defined __GNUC__ && defined USE_LIBUSB
+	// the transfer callbacks write into m_ringBuffer
+	StopAsyncTransfers();
 	libusb_exit(m_context);
+	if (m_asyncEvent >= 0) close(m_asyncEvent);
 #endif
 
+	delete m_ringBuffer;
+	delete[] m_readCache;
 }
 
 #ifdef _MSC_VER
@@ -500,6 +516,13 @@ bool AdcUsb::Open()
 				}
 			}
 
+			// keep bulk in transfers in flight, fall back to synchronous reads on error
+			if (m_asyncMode && !StartAsyncTransfers())
+			{
+				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tasynchronous transfers not available, use synchronous reads", __FUNCTION__);
+				m_asyncMode = false;
+			}
+
 			m_hDevice = (adcHandle)m_libusbHandle;
 			break;
 		}
@@ -547,6 +570,9 @@ bool AdcUsb::Close()
         int ifaceNr = 0;
         char errorMessage[MAX_SIZE_OF_LIBUSB_ERROR_MESSAGE];
 
+        // all transfers must be finished before the interface is released
+        StopAsyncTransfers();
+
         int retCode = libusb_release_interface(m_libusbHandle, ifaceNr);
 		if (retCode != LIBUSB_SUCCESS)
 		{
@@ -1000,6 +1026,14 @@ unsigned long AdcUsb::Read(void *pData, unsigned long size)
 {
 	unsigned long numRdAdc = 0;
 
+#if defined __GNUC__ && defined USE_LIBUSB
+	if (m_asyncActive)
+	{
+		// data is received by the event thread
+		return ReadAsync(pData, size);
+	}
+#endif
+
 	while (m_ringBuffer->GetLevel() < size)
 	{
 		numRdAdc = ReadFromADC(m_readCache, SIZE_READ_USB_DATA_PACKAGE);
@@ -1020,6 +1054,79 @@ unsigned long AdcUsb::Read(void *pData, unsigned long size)
 }
 
 
+/**
+******************************************************************************
+* ReadAvailable - read all data that is already received from the adc
+*
+* @param    pData:out	buffer
+* @param    size:in		size of the buffer
+* @param    timeout:in	maximum wait time in ms if no data is available
+*
+* @return   number of bytes read, 0: no data within the timeout
+* @remarks	with asynchronous transfers the function waits on the ring
+*			buffer, else one bulk transfer is read
+******************************************************************************
+*/
+unsigned long AdcUsb::ReadAvailable(void *pData, unsigned long size, unsigned long timeout)
+{
+	unsigned long numRdAdc;
+
+#if defined __GNUC__ && defined USE_LIBUSB
+	if (m_asyncActive)
+	{
+		eventfd_t	events;
+
+		// clear the event before the data is taken, data of a later transfer signals again
+		if (m_asyncEvent >= 0)
+			eventfd_read(m_asyncEvent, &events);
+
+		// data is received by the event thread
+		if ((m_ringBuffer->GetLevel() == 0) && timeout)
+			m_ringBuffer->WaitForLevel(1, timeout);
+
+		return m_ringBuffer->GetData((char *)pData, size);
+	}
+#endif
+
+	if (m_ringBuffer->GetLevel() == 0)
+	{
+		numRdAdc = ReadFromADC(m_readCache, SIZE_READ_USB_DATA_PACKAGE);
+		if (numRdAdc > 0)
+		{
+			// store data to ring buffer
+			m_ringBuffer->SetData(m_readCache, numRdAdc);
+		}
+	}
+
+	return m_ringBuffer->GetData((char *)pData, size);
+}
+
+
+/**
+******************************************************************************
+* WaitForData - wait until the adc sends new data
+*
+* @param    timeout:in	maximum wait time in ms
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcUsb::WaitForData(unsigned long timeout)
+{
+#if defined __GNUC__ && defined USE_LIBUSB
+	if (m_asyncActive)
+	{
+		if (!m_asyncError)
+			m_ringBuffer->WaitForLevel(1, timeout);
+		return;
+	}
+#endif
+
+	AdcInterface::WaitForData(timeout);
+}
+
+
 /**
 ******************************************************************************
 * ResetInterface - reset the usb interface - pipes
@@ -1156,6 +1263,260 @@ void AdcUsb::GetPort(string &port)
 }
 
 
+/**
+******************************************************************************
+* GetPollFd - file descriptor that is readable when data is received
+*
+* @return   eventfd of the asynchronous transfers, -1: no asynchronous transfers
+* @remarks  the event thread signals the eventfd, ReadAvailable clears it.
+*           The bizwsd driver has no poll support, so /dev/bizwsd can't be
+*           polled.
+******************************************************************************
+*/
+int AdcUsb::GetPollFd()
+{
+#if defined __GNUC__ && defined USE_LIBUSB
+	if (m_asyncActive)
+		return m_asyncEvent;
+#endif
+
+	return AdcInterface::GetPollFd();
+}
+
+
+#if defined __GNUC__ && defined USE_LIBUSB
+/**
+******************************************************************************
+* StartAsyncTransfers - submit the bulk in transfers and start the event thread
+*
+* @return   false:	no transfer could be submitted
+*			true:	ok
+* @remarks  the received data is stored by the event thread in the ring buffer
+******************************************************************************
+*/
+bool AdcUsb::StartAsyncTransfers()
+{
+	int retCode = LIBUSB_SUCCESS;
+	char errorMessage[MAX_SIZE_OF_LIBUSB_ERROR_MESSAGE];
+	unsigned char *buffer;
+
+	m_ringBuffer->Clear();
+	m_asyncError = false;
+	m_asyncRun = true;
+
+	m_asyncMutex.lock();
+	m_asyncPending = 0;
+	for (short idx = 0; idx < NUM_ASYNC_TRANSFERS; idx++)
+	{
+		if ((m_asyncTransfers[idx] = libusb_alloc_transfer(0)) == NULL)
+			break;
+
+		// buffer is released with the transfer
+		buffer = (unsigned char *)malloc(SIZE_ASYNC_TRANSFER_BUFFER);
+		libusb_fill_bulk_transfer(m_asyncTransfers[idx], m_libusbHandle, m_bulkInEndpointAddr, buffer, SIZE_ASYNC_TRANSFER_BUFFER, ReadTransferCallback, this, 0);
+		m_asyncTransfers[idx]->flags = LIBUSB_TRANSFER_FREE_BUFFER;
+
+		if ((buffer == NULL) || ((retCode = libusb_submit_transfer(m_asyncTransfers[idx])) != LIBUSB_SUCCESS))
+		{
+			if (buffer != NULL)
+			{
+				ConvertLibUsbErrorCodeToString(errorMessage, retCode);
+				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror submit bulk transfer %d (error: %s)", __FUNCTION__, idx, errorMessage);
+			}
+			libusb_free_transfer(m_asyncTransfers[idx]);
+			m_asyncTransfers[idx] = NULL;
+			break;
+		}
+		m_asyncPending++;
+	}
+	m_asyncMutex.unlock();
+
+	if (m_asyncPending == 0)
+	{
+		m_asyncRun = false;
+		return false;
+	}
+
+	m_asyncActive = true;
+	m_asyncEventThread = thread(&AdcUsb::AsyncEventThread, this);
+
+	return true;
+}
+
+
+/**
+******************************************************************************
+* StopAsyncTransfers - cancel all bulk in transfers and stop the event thread
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcUsb::StopAsyncTransfers()
+{
+	if (!m_asyncActive)
+		return;
+
+	// no resubmission after this point, cancel all transfers in flight
+	m_asyncMutex.lock();
+	m_asyncRun = false;
+	for (short idx = 0; idx < NUM_ASYNC_TRANSFERS; idx++)
+	{
+		if (m_asyncTransfers[idx] != NULL)
+			libusb_cancel_transfer(m_asyncTransfers[idx]);
+	}
+	m_asyncMutex.unlock();
+
+	// event thread terminates after the last callback
+	if (m_asyncEventThread.joinable())
+		m_asyncEventThread.join();
+
+	for (short idx = 0; idx < NUM_ASYNC_TRANSFERS; idx++)
+	{
+		if (m_asyncTransfers[idx] != NULL)
+		{
+			libusb_free_transfer(m_asyncTransfers[idx]);
+			m_asyncTransfers[idx] = NULL;
+		}
+	}
+
+	m_asyncActive = false;
+}
+
+
+/**
+******************************************************************************
+* AsyncEventThread - handle libusb events until all transfers are finished
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcUsb::AsyncEventThread()
+{
+	struct timeval tv;
+
+	while (true)
+	{
+		m_asyncMutex.lock();
+		if (!m_asyncRun && (m_asyncPending == 0))
+		{
+			m_asyncMutex.unlock();
+			break;
+		}
+		m_asyncMutex.unlock();
+
+		tv.tv_sec = 0;
+		tv.tv_usec = 100000;
+		libusb_handle_events_timeout(m_context, &tv);
+	}
+}
+
+
+/**
+******************************************************************************
+* ReadTransferCallback - libusb callback of a finished bulk in transfer
+*
+* @param    transfer:in		finished transfer
+*
+* @return   void
+* @remarks  called in the context of the event thread
+******************************************************************************
+*/
+void AdcUsb::ReadTransferCallback(libusb_transfer *transfer)
+{
+	((AdcUsb *)transfer->user_data)->AsyncReadCompleted(transfer);
+}
+
+
+/**
+******************************************************************************
+* AsyncReadCompleted - store the received data and resubmit the transfer
+*
+* @param    transfer:in		finished transfer
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void AdcUsb::AsyncReadCompleted(libusb_transfer *transfer)
+{
+	if (transfer->status == LIBUSB_TRANSFER_COMPLETED)
+	{
+		if ((transfer->actual_length > 0) && !m_ringBuffer->SetData((char *)transfer->buffer, transfer->actual_length))
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tring buffer overflow, %d bytes lost", __FUNCTION__, transfer->actual_length);
+		}
+		if ((transfer->actual_length > 0) && (m_asyncEvent >= 0))
+			eventfd_write(m_asyncEvent, 1);
+	}
+	else if (transfer->status != LIBUSB_TRANSFER_CANCELLED)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror read bulk transfer (status: %d)", __FUNCTION__, transfer->status);
+		m_asyncError = true;
+
+		// wake up the reader, it must not wait for the timeout
+		m_ringBuffer->Notify();
+		if (m_asyncEvent >= 0)
+			eventfd_write(m_asyncEvent, 1);
+	}
+
+	m_asyncMutex.lock();
+	if (!m_asyncRun || m_asyncError || (libusb_submit_transfer(transfer) != LIBUSB_SUCCESS))
+	{
+		m_asyncPending--;
+	}
+	m_asyncMutex.unlock();
+}
+
+
+/**
+******************************************************************************
+* ReadAsync - get data from ring buffer filled by the event thread
+*
+* @param    pData  : pointer of data buffer
+* @param    size   : size of data buffer
+*
+* @return   number of data bytes actually receives
+* @remarks  waits until all data is received or timeout
+******************************************************************************
+*/
+unsigned long AdcUsb::ReadAsync(void *pData, unsigned long size)
+{
+	unsigned long numRd = 0;
+	long remaining;
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(TIMEOUT_READ);
+
+	while (true)
+	{
+		numRd += m_ringBuffer->GetData((char *)pData + numRd, size - numRd);
+		if (numRd == size)
+			break;
+
+		if (m_asyncError)
+		{
+			g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tadc transfer error", __FUNCTION__);
+			break;
+		}
+
+		// wait for the rest of the data, larger requests than the ring buffer are read in parts
+		remaining = (long)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+		if ((remaining <= 0) || !m_ringBuffer->WaitForLevel(size - numRd < SIZE_RINGBUFFER ? size - numRd : 1, remaining))
+		{
+			if (m_ringBuffer->GetLevel() > 0)
+				continue;
+
+			if (numRd == 0)
+				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tadc sends no data", __FUNCTION__);
+			break;
+		}
+	}
+
+	return numRd;
+}
+#endif	// __GNUC__ && USE_LIBUSB
+
+
 #ifdef USE_LIBUSB
 void AdcUsb::ConvertLibUsbErrorCodeToString(char* errorMessage, int errorCode)
 {
@@ -0,0 +1,429 @@
+/**
+******************************************************************************
+* File       : adcweightstream.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : adcweightstream class: read the weight once and pass it to
+*              all subscribers
+******************************************************************************
+*/
+#include "larsErr.h"
+#include "adctrace.h"
+#include "lars.h"
+#include "adcweightstream.h"
+
+short ConvertLarsE2bizlarsE(short errorCode);
+
+
+AdcWeightStream::AdcWeightStream(Lars *lars)
+{
+	m_lars = lars;
+	m_run = false;
+	m_reactor = false;
+	m_pending = false;
+}
+
+AdcWeightStream::~AdcWeightStream()
+{
+	Stop();
+}
+
+
+/**
+******************************************************************************
+* Subscribe - add a subscriber, the stream thread is started with the first one
+*
+* @param    interval:in		poll interval in ms
+* @param    callback:in		function called for every weight
+* @param    ctx:in			context passed to the callback
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER
+* @remarks	the device is read with the smallest interval of all subscribers.
+*			A subscriber with the same callback and ctx only gets a new interval.
+*			In reactor mode an interface that can be polled is served by
+*			g_adcReactor instead of an own thread.
+******************************************************************************
+*/
+short AdcWeightStream::Subscribe(unsigned long interval, AdcWeightStreamCallback callback, void *ctx)
+{
+	bool	found = false;
+	bool	reactor;
+	bool	addToReactor = false;
+
+	if (!callback)
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if (interval < MIN_INTERVAL)
+		interval = MIN_INTERVAL;
+
+	unique_lock<mutex> lock(m_mutex);
+
+	for (vector<Subscriber>::iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+	{
+		if (((*it).callback == callback) && ((*it).ctx == ctx))
+		{
+			(*it).interval = interval;
+			found = true;
+		}
+	}
+
+	if (!found)
+	{
+		Subscriber subscriber = { callback, ctx, interval };
+		m_subscribers.push_back(subscriber);
+	}
+
+	// new subscriber gets the first weight immediately
+	m_next = chrono::steady_clock::now();
+
+	if (!m_run)
+	{
+		m_run = true;
+		m_reactor = g_adcReactor.IsEnabled() && (m_lars->GetPollFd() >= 0);
+		addToReactor = m_reactor;
+		if (!m_reactor)
+			StartThread();
+	}
+	reactor = m_reactor;
+
+	m_cond.notify_all();
+	lock.unlock();
+
+	// not within m_mutex, the reactor thread calls GetDeadline with its own lock
+	if (addToReactor && (g_adcReactor.Add(this) != LarsErr::E_SUCCESS))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\treactor not available, use stream thread", __FUNCTION__);
+
+		lock.lock();
+		m_reactor = false;
+		if (m_run)
+			StartThread();
+	}
+	else if (reactor)
+	{
+		// new subscriber gets the first weight immediately
+		g_adcReactor.Wake();
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* StartThread - start the stream thread
+*
+* @return   void
+* @remarks	m_mutex must be locked
+******************************************************************************
+*/
+void AdcWeightStream::StartThread()
+{
+	// stream thread stopped itself
+	if (m_thread.joinable()) m_thread.detach();
+
+	m_thread = thread(&AdcWeightStream::StreamThread, this);
+	m_threadId = m_thread.get_id();
+}
+
+
+/**
+******************************************************************************
+* Unsubscribe - remove a subscriber
+*
+* @param    callback:in		function of the subscriber
+* @param    ctx:in			context of the subscriber
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER	subscriber not found
+* @remarks	after return the callback is not called anymore. May be called
+*			from the callback itself.
+******************************************************************************
+*/
+short AdcWeightStream::Unsubscribe(AdcWeightStreamCallback callback, void *ctx)
+{
+	bool	found = false;
+	bool	ownThread;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		for (vector<Subscriber>::iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+		{
+			if (((*it).callback == callback) && ((*it).ctx == ctx))
+			{
+				m_subscribers.erase(it);
+				found = true;
+				break;
+			}
+		}
+		ownThread = (m_threadId == this_thread::get_id()) || (m_reactor && g_adcReactor.IsReactorThread());
+		m_cond.notify_all();
+	}
+
+	if (!found)
+		return LarsErr::E_INVALID_PARAMETER;
+
+	// wait until a running fan out is finished
+	if (!ownThread)
+	{
+		lock_guard<mutex> callbackLock(m_callbackMutex);
+	}
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* Stop - remove all subscribers and stop the stream thread
+*
+* @return   void
+* @remarks	must not be called from a callback
+******************************************************************************
+*/
+void AdcWeightStream::Stop()
+{
+	bool	reactor;
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		m_subscribers.clear();
+		m_run = false;
+		m_cond.notify_all();
+		reactor = m_reactor;
+		m_reactor = false;
+	}
+
+	// a request in work is cancelled by the reactor thread, see OnRemove
+	if (reactor)
+		g_adcReactor.Remove(this);
+
+	if (m_thread.joinable() && (m_thread.get_id() != this_thread::get_id()))
+	{
+		m_thread.join();
+
+		lock_guard<mutex> lock(m_mutex);
+		m_threadId = thread::id();
+	}
+}
+
+
+/**
+******************************************************************************
+* GetInterval - smallest interval of all subscribers
+*
+* @return   interval in ms
+* @remarks	m_mutex must be locked
+******************************************************************************
+*/
+unsigned long AdcWeightStream::GetInterval()
+{
+	unsigned long interval = 0;
+
+	for (vector<Subscriber>::const_iterator it = m_subscribers.begin(); it != m_subscribers.end(); ++it)
+	{
+		if (!interval || ((*it).interval < interval))
+			interval = (*it).interval;
+	}
+
+	return interval;
+}
+
+
+/**
+******************************************************************************
+* StreamThread - read the weight and call all subscribers
+*
+* @return   void
+* @remarks	without subscribers the thread sleeps until the next Subscribe
+******************************************************************************
+*/
+void AdcWeightStream::StreamThread()
+{
+	short		retCode;
+	AdcState	adcState;
+	AdcWeight	weight;
+	AdcTare		tare;
+	chrono::steady_clock::time_point now;
+
+	unique_lock<mutex> lock(m_mutex);
+
+	while (m_run)
+	{
+		if (m_subscribers.empty())
+		{
+			m_cond.wait(lock);
+			continue;
+		}
+
+		now = chrono::steady_clock::now();
+		if (now < m_next)
+		{
+			m_cond.wait_until(lock, m_next);
+			continue;
+		}
+
+		// don't try to catch up if the read took longer than the interval
+		m_next += chrono::milliseconds(GetInterval());
+		if (m_next < now) m_next = now + chrono::milliseconds(GetInterval());
+		lock.unlock();
+
+		// one read for all subscribers
+		adcState.state = 0;
+		retCode = ConvertLarsE2bizlarsE(m_lars->ReadWeight(0, &adcState, &weight, &tare, NULL, NULL));
+		Notify(retCode, &adcState, &weight, &tare);
+		lock.lock();
+	}
+
+	g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tweight stream stopped", __FUNCTION__);
+}
+
+
+/**
+******************************************************************************
+* Notify - pass one read to all subscribers
+*
+* @param    retCode:in		return code of the read
+* @param    adcState:in		state of the adc
+* @param    weight:in		weight
+* @param    tare:in			tare
+*
+* @return   void
+* @remarks	m_mutex must not be locked
+******************************************************************************
+*/
+void AdcWeightStream::Notify(short retCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare)
+{
+	lock_guard<mutex> callbackLock(m_callbackMutex);
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_notifyList = m_subscribers;
+	}
+
+	for (vector<Subscriber>::const_iterator it = m_notifyList.begin(); it != m_notifyList.end(); ++it)
+	{
+		(*it).callback(m_lars->GetHandle(), retCode, adcState, weight, tare, (*it).ctx);
+	}
+}
+
+
+/**
+******************************************************************************
+* GetPollFd - interface to wait for in reactor mode
+*
+* @return   file descriptor, -1: no request in work
+* @remarks	called by the reactor thread
+******************************************************************************
+*/
+int AdcWeightStream::GetPollFd()
+{
+	return m_pending ? m_lars->GetPollFd() : -1;
+}
+
+
+/**
+******************************************************************************
+* GetDeadline - time of the next read or the timeout of the request in work
+*
+* @return   time point, time_point::max() without subscribers
+* @remarks	called by the reactor thread
+******************************************************************************
+*/
+chrono::steady_clock::time_point AdcWeightStream::GetDeadline()
+{
+	if (m_pending)
+		return m_deadline;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	return m_subscribers.empty() ? chrono::steady_clock::time_point::max() : m_next;
+}
+
+
+/**
+******************************************************************************
+* OnEvent - start the next read or advance the read in work
+*
+* @param    readable:in		the interface has data
+*
+* @return   void
+* @remarks	called by the reactor thread, never waits for the adc. If an
+*			application call holds the adc the read is tried again after
+*			BUSY_RETRY.
+******************************************************************************
+*/
+void AdcWeightStream::OnEvent(bool readable)
+{
+	short	errorCode;
+	bool	busy;
+	bool	done;
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	if (!m_pending)
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+
+			if (m_subscribers.empty() || (now < m_next))
+				return;
+		}
+
+		m_adcState.state = 0;
+		errorCode = m_lars->StartReadWeight(&busy);
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+
+			if (busy)
+			{
+				m_next = now + chrono::milliseconds(BUSY_RETRY);
+				return;
+			}
+
+			// don't try to catch up if the read took longer than the interval
+			m_next += chrono::milliseconds(GetInterval());
+			if (m_next < now) m_next = now + chrono::milliseconds(GetInterval());
+		}
+
+		if (errorCode != LarsErr::E_SUCCESS)
+		{
+			Notify(ConvertLarsE2bizlarsE(errorCode), &m_adcState, &m_weight, &m_tare);
+			return;
+		}
+		m_pending = true;
+	}
+
+	// bytes may already be buffered by the interface, so read even if not readable
+	errorCode = m_lars->ContinueReadWeight(&done, &m_deadline, &m_adcState, &m_weight, &m_tare);
+	if (!done)
+		return;
+
+	m_pending = false;
+	Notify(ConvertLarsE2bizlarsE(errorCode), &m_adcState, &m_weight, &m_tare);
+}
+
+
+/**
+******************************************************************************
+* OnRemove - cancel the read in work
+*
+* @return   void
+* @remarks	called by the reactor thread after Stop, so the request is ended
+*			by the thread that started it
+******************************************************************************
+*/
+void AdcWeightStream::OnRemove()
+{
+	if (m_pending)
+	{
+		m_lars->CancelReadWeight();
+		m_pending = false;
+	}
+}
@@ -11,12 +11,23 @@
 */
 #include "authentication.h"
 
+// crc tables for the polynomials used by the adc, generated at compile time
+static constexpr CrcTable crcTableRbs(0x7102);			// RBS_CRC_POLY
+static constexpr CrcTable crcTableAuthentication(0x1021);	// ADW_AUTH_CRC_POLY
+
 
 Authentication::Authentication(unsigned short crcStart, unsigned short crcPoly, unsigned short crcMask)
 {
     m_crcStart = crcStart;
     m_crcPoly = crcPoly;
     m_crcMask = crcMask;
+
+    if (crcPoly == crcTableRbs.poly)
+        m_crcTable = &crcTableRbs;
+    else if (crcPoly == crcTableAuthentication.poly)
+        m_crcTable = &crcTableAuthentication;
+    else
+        m_crcTable = 0;
 }
 
 
@@ -41,17 +52,161 @@ unsigned short Authentication::CalcCrc(unsigned char *buffer, unsigned long size
     unsigned short crc;
 
     // set start polynom
-    crc = m_crcStart;
+    crc = InitCrc();
 
     // calculate the crc
+    UpdateCrc(&crc, buffer, size);
+
+    return FinalCrc(crc);
+}
+
+
+/**
+******************************************************************************
+* InitCrc - start value for a crc calculated with UpdateCrc
+*
+* @return   crc start value
+* @remarks
+******************************************************************************
+*/
+unsigned short Authentication::InitCrc()
+{
+    return m_crcStart;
+}
+
+
+/**
+******************************************************************************
+* UpdateCrc - continue the crc calculation over the next part of the data
+*
+* @param    crc:in/out				current crc value
+* @param    buffer:in				buffer over which the checksum is calculated
+* @param    size:in 				size of buffer
+*
+* @return
+* @remarks
+******************************************************************************
+*/
+void Authentication::UpdateCrc(unsigned short *crc, const unsigned char *buffer, unsigned long size)
+{
+    if (size >= SLICING_MIN_SIZE)
+        UpdateCrcSlicing8(crc, buffer, size);
+    else
+        UpdateCrcTable(crc, buffer, size);
+}
+
+
+/**
+******************************************************************************
+* UpdateCrcBitwise - crc calculation bit by bit
+*
+* @param    crc:in/out				current crc value
+* @param    buffer:in				buffer over which the checksum is calculated
+* @param    size:in 				size of buffer
+*
+* @return
+* @remarks  reference implementation, works for every polynomial
+******************************************************************************
+*/
+void Authentication::UpdateCrcBitwise(unsigned short *crc, const unsigned char *buffer, unsigned long size)
+{
     for (unsigned long i = 0; i < size; i++)
     {
-        calcCrcOverOneByte(buffer[i], &crc);
+        calcCrcOverOneByte(buffer[i], crc);
     }
+}
+
 
-    crc ^= m_crcMask;
-   
-    return crc;
+/**
+******************************************************************************
+* UpdateCrcTable - crc calculation with one table lookup per byte
+*
+* @param    crc:in/out				current crc value
+* @param    buffer:in				buffer over which the checksum is calculated
+* @param    size:in 				size of buffer
+*
+* @return
+* @remarks  falls back to the bitwise calculation if there is no table
+******************************************************************************
+*/
+void Authentication::UpdateCrcTable(unsigned short *crc, const unsigned char *buffer, unsigned long size)
+{
+    unsigned short value = *crc;
+
+    if (!m_crcTable)
+    {
+        UpdateCrcBitwise(crc, buffer, size);
+        return;
+    }
+
+    for (unsigned long i = 0; i < size; i++)
+    {
+        value = (unsigned short)((value << 8) ^ m_crcTable->table[0][(value >> 8) ^ buffer[i]]);
+    }
+
+    *crc = value;
+}
+
+
+/**
+******************************************************************************
+* UpdateCrcSlicing8 - crc calculation over 8 bytes per step
+*
+* @param    crc:in/out				current crc value
+* @param    buffer:in				buffer over which the checksum is calculated
+* @param    size:in 				size of buffer
+*
+* @return
+* @remarks  falls back to the bitwise calculation if there is no table
+******************************************************************************
+*/
+void Authentication::UpdateCrcSlicing8(unsigned short *crc, const unsigned char *buffer, unsigned long size)
+{
+    unsigned short value = *crc;
+
+    if (!m_crcTable)
+    {
+        UpdateCrcBitwise(crc, buffer, size);
+        return;
+    }
+
+    const unsigned short (*table)[256] = m_crcTable->table;
+
+    while (size >= 8)
+    {
+        // the two crc bytes are combined with the first two data bytes
+        value = table[7][buffer[0] ^ (value >> 8)] ^
+                table[6][buffer[1] ^ (value & 0xFF)] ^
+                table[5][buffer[2]] ^
+                table[4][buffer[3]] ^
+                table[3][buffer[4]] ^
+                table[2][buffer[5]] ^
+                table[1][buffer[6]] ^
+                table[0][buffer[7]];
+
+        buffer += 8;
+        size -= 8;
+    }
+
+    *crc = value;
+
+    UpdateCrcTable(crc, buffer, size);
+}
+
+
+/**
+******************************************************************************
+* FinalCrc - finish a crc calculated with UpdateCrc
+*
+* @param    crc:in					current crc value
+*
+* @return   crc
+* @remarks
+******************************************************************************
+*/
+unsigned short Authentication::FinalCrc(unsigned short crc)
+{
+    return crc ^ m_crcMask;
 }
 
 
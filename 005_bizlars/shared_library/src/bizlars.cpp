@@ -17,7 +17,8 @@
 #include <sstream>
 #include <string>
 #include <mutex>
-#include <list>
+#include <vector>
+#include <algorithm>
 #include <stdlib.h>     /* srand, rand */
 #include <time.h>       /* time */
 #include <version.h>
@@ -29,25 +30,29 @@
 #include "adctrace.h"
 #include "adctilt.h"
 #include "lars.h"
+#include "larstable.h"
+#include "adcfirmware.h"
+#include "adcreactor.h"
+#include "adcprofile.h"
 
 /**
 ******************************************************************************
 * typedefs
 ******************************************************************************
 */
-typedef list <Lars *> LarsList;
+static LarsTable g_larsTable;
 
-static mutex g_larsMutex;
-static LarsList g_larsList;
+#define MAX_SHARED_READERS	16
+static mutex g_sharedMutex;
+static AdcShared g_sharedList[MAX_SHARED_READERS];
 
 /**
 ******************************************************************************
 * internal functions
 ******************************************************************************
 */
-bool CheckIfAdcIsAlreadyOpen(list <Lars *> &larsList, Lars *lars);
-short CreateLogicalDeviceHandle(list <Lars *> &larsList);
-Lars *AdcCheckHandle(list <Lars *> &larsList, const short handle);
+bool CheckIfAdcIsAlreadyOpen(LarsTable &larsTable, Lars *lars);
+LarsRef AdcCheckHandle(LarsTable &larsTable, const short handle);
 short ConvertLarsE2bizlarsE(short errorCode);
 
 
@@ -85,7 +90,7 @@ BIZLARS_API short AdcOpen(const char *adcName, const char *protocol, const char
     }
 
     // check if adc already open
-	if (CheckIfAdcIsAlreadyOpen(g_larsList, lars))
+	if (CheckIfAdcIsAlreadyOpen(g_larsTable, lars))
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_INFO, "%s\tend retCode: %d", __FUNCTION__, ADC_E_ADC_ALREADY_OPEN);
         delete lars;
@@ -103,14 +108,17 @@ BIZLARS_API short AdcOpen(const char *adcName, const char *protocol, const char
 		return retCode;
 	}
 
-	// create the logical device handle
-    lars->SetHandle(CreateLogicalDeviceHandle(g_larsList));
-	*handle = lars->GetHandle();
-
-    // queue lars object in list
-    g_larsMutex.lock();
-    g_larsList.push_back(lars);
-    g_larsMutex.unlock();
+	// queue lars object in table, create the logical device handle and set it
+	retCode = g_larsTable.Insert(lars, handle);
+	if (retCode != LarsErr::E_SUCCESS)
+	{
+		lars->Close();
+		delete lars;
+		*handle = 0;
+		retCode = ConvertLarsE2bizlarsE(retCode);
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, retCode);
+		return retCode;
+	}
 
     retCode = ConvertLarsE2bizlarsE(retCode);
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
@@ -136,7 +144,8 @@ short AdcClose(const short handle)
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    // remove lars from table, waits until running calls of other threads are finished
+    if ((lars = g_larsTable.Remove(handle)) == NULL)
     {
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -144,11 +153,6 @@ short AdcClose(const short handle)
 
     lars->Close();
 
-    // remove lars from list
-    g_larsMutex.lock();
-    g_larsList.remove(lars);
-    g_larsMutex.unlock();
-
     // delete lars
     delete lars;
 
@@ -177,11 +181,11 @@ short AdcClose(const short handle)
 short AdcReset(const short handle, const AdcResetType type)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -217,11 +221,11 @@ short AdcReset(const short handle, const AdcResetType type)
 short AdcSetScaleValues(const short handle, const AdcScaleValues *scaleValues)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tretCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -257,11 +261,11 @@ short AdcSetBasePrice(const short handle, const AdcBasePrice *basePrice, short f
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -299,11 +303,11 @@ short AdcSetDisplayText(const short handle, const AdcDisplayText *displayText)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -340,11 +344,11 @@ short AdcSetScaleMode(const short handle, const AdcScaleMode scaleMode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -382,11 +386,11 @@ short AdcSetEeprom(const short handle, const AdcEeprom *eeprom)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -416,11 +420,11 @@ short AdcSetEeprom(const short handle, const AdcEeprom *eeprom)
 short AdcSetSspPath(const short handle, const char *path)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -458,11 +462,11 @@ short AdcSetTiltCompensation(const short handle, const AdcTiltComp *tiltCompensa
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -500,11 +504,11 @@ short AdcSetScaleSpecificParam(const short handle, const bool presealed)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -544,11 +548,11 @@ short AdcSetFilter(const short handle, const AdcFilter *filter)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -586,11 +590,11 @@ short AdcSetGFactor(const short handle, const short gFactor)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -628,11 +632,11 @@ BIZLARS_API short AdcSetProdSettings(const short handle, const AdcProdSettings *
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -670,11 +674,11 @@ BIZLARS_API short AdcSetConversionWeightUnit(const short handle, const long fact
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -712,11 +716,11 @@ BIZLARS_API short AdcSetInterfaceMode(const short handle, const AdcInterfaceMode
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -755,11 +759,11 @@ BIZLARS_API short AdcSetZeroPointTracking(const short handle, const short mode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -797,11 +801,11 @@ BIZLARS_API short AdcSetZeroSettingInterval(const short handle, const long time)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -839,11 +843,11 @@ BIZLARS_API short AdcSetAutomaticZeroSettingTime(const short handle, const long
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -881,11 +885,11 @@ BIZLARS_API short AdcSetVerificationParameterProtected(const short handle)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -924,11 +928,11 @@ BIZLARS_API short AdcSetUpdateMode(const short handle, const short mode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -965,11 +969,11 @@ BIZLARS_API short AdcSetWarmUpTime(const short handle, const long time)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1008,11 +1012,11 @@ BIZLARS_API short AdcSetOperatingMode(const short handle, const AdcOperatingMode
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1044,11 +1048,11 @@ BIZLARS_API short AdcCalSpiritLevel(const short handle, const AdcSpiritLevelCmd
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1085,11 +1089,11 @@ BIZLARS_API short AdcSetInitialZeroSetting(const short handle, AdcInitialZeroSet
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1127,11 +1131,11 @@ BIZLARS_API short AdcSetStateAutomaticTiltSensor(const short handle, const bool
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1168,11 +1172,11 @@ BIZLARS_API short AdcSetStateAutomaticTiltSensor(const short handle, const bool
 short AdcGetScaleValues(const short handle, AdcScaleValues *scaleValues)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -1214,11 +1218,11 @@ short AdcGetBasePrice(const short handle, AdcBasePrice *basePrice)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1261,11 +1265,11 @@ short AdcGetDisplayText(const short handle, AdcDisplayText *displayText)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1308,11 +1312,11 @@ short AdcGetMaxDisplayTextChar(const short handle, short *maxDisplayTextChar)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1354,11 +1358,11 @@ short AdcGetScaleMode(const short handle, AdcScaleMode *scaleMode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1402,11 +1406,11 @@ short AdcGetEeprom(const short handle, AdcEeprom *eeprom)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1450,11 +1454,11 @@ short AdcGetEepromSize(const short handle, AdcEepromSize *eepromSize)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1497,11 +1501,11 @@ short AdcGetTiltCompensation(const short handle, AdcTiltComp *tiltCompensation)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1544,11 +1548,11 @@ short AdcGetFilter(const short handle, AdcFilter *filter)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1591,11 +1595,11 @@ BIZLARS_API short AdcGetCalStrings(const short handle, AdcCalStrings *calStrings
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1636,11 +1640,11 @@ BIZLARS_API short AdcGetCalStrings(const short handle, AdcCalStrings *calStrings
 BIZLARS_API short AdcGetCalStrings4LoadCapacity(const short handle, const char *loadCapacity, AdcCalStrings *calStrings)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1682,11 +1686,11 @@ BIZLARS_API short AdcGetGFactor(const short handle, short *gFactor)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1730,11 +1734,11 @@ BIZLARS_API short AdcGetProdSettings(const short handle, AdcProdSettings *prodSe
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1777,11 +1781,11 @@ BIZLARS_API short AdcGetInterfaceMode(const short handle, AdcInterfaceMode *inte
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1824,11 +1828,11 @@ BIZLARS_API short AdcGetLoadCapacityUnit(const short handle, AdcWeightUnit *unit
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1874,11 +1878,11 @@ BIZLARS_API short AdcGetZeroPointTracking(const short handle, short *mode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1923,11 +1927,11 @@ BIZLARS_API short AdcGetZeroSettingInterval(const short handle, long *time)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -1972,11 +1976,11 @@ BIZLARS_API short AdcGetAutomaticZeroSettingTime(const short handle, long *time)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2022,11 +2026,11 @@ BIZLARS_API short AdcGetVerificationParameter(const short handle, short *mode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2072,11 +2076,11 @@ BIZLARS_API short AdcGetUpdateMode(const short handle, short *mode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2121,11 +2125,11 @@ BIZLARS_API short AdcGetWarmUpTime(const short handle, long *time)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2170,11 +2174,11 @@ BIZLARS_API short AdcGetRemainingWarmUpTime(const short handle, long *time)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2219,11 +2223,11 @@ BIZLARS_API short AdcGetOperatingMode(const short handle, AdcOperatingMode *mode
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2268,11 +2272,11 @@ BIZLARS_API short AdcGetMaxCapacity(const short handle, AdcWeight *maxCapacity)
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2317,11 +2321,11 @@ BIZLARS_API short AdcGetLoadCapacityParams(const short handle, AdcLoadCapacityPa
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2366,11 +2370,11 @@ BIZLARS_API short AdcGetInitialZeroSetting(const short handle, AdcInitialZeroSet
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2415,11 +2419,11 @@ BIZLARS_API short AdcGetStateAutomaticTiltSensor(const short handle, bool *state
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2462,11 +2466,11 @@ BIZLARS_API short AdcGetStateAutomaticTiltSensor(const short handle, bool *state
 short AdcZeroScale(const short handle, AdcState *adcState)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2501,11 +2505,11 @@ short AdcZeroScale(const short handle, AdcState *adcState)
 short AdcSetTare(const short handle, AdcState *adcState, const AdcTare *tare)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2540,11 +2544,11 @@ short AdcSetTare(const short handle, AdcState *adcState, const AdcTare *tare)
 BIZLARS_API short AdcGetTare(const short handle, AdcState *adcState, AdcTare *tare)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2579,11 +2583,11 @@ BIZLARS_API short AdcGetTare(const short handle, AdcState *adcState, AdcTare *ta
 BIZLARS_API short AdcSetTarePriority(const short handle, AdcState *adcState, const AdcTarePriority prio)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2616,11 +2620,11 @@ BIZLARS_API short AdcSetTarePriority(const short handle, AdcState *adcState, con
 short AdcClearTare(const short handle, AdcState *adcState)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2661,11 +2665,11 @@ short AdcClearTare(const short handle, AdcState *adcState)
 short AdcReadWeight(const short handle, const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2696,11 +2700,11 @@ short AdcReadWeight(const short handle, const short registrationRequest, AdcStat
 short AdcGetCapability(const short handle, const AdcCapabilities cap, unsigned char *value)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2741,11 +2745,11 @@ short AdcGetCapability(const short handle, const AdcCapabilities cap, unsigned c
 short AdcGetLogger(const short handle, const short index, char *entry, unsigned long *size)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2757,6 +2761,61 @@ short AdcGetLogger(const short handle, const short index, char *entry, unsigned
 }
 
 
+/**
+******************************************************************************
+* AdcGetLoggerRange - function to get several entries of the adc log book
+*
+* @param    handle:in				adc handle
+* @param    first:in				index of the first log book entry, 0: latest entry
+* @param    count:in				max. number of entries
+* @param    arena:in				buffer for the entries, NULL: buffer of the library
+* @param    arenaSize:in			size of arena in byte
+* @param    callback:in				gets every entry, may be NULL
+* @param    ctx:in					context passed to the callback
+* @param    exportFile:in			path of a binary export of the entries, NULL: no export
+*
+* @return   ADC_SUCCESS
+*			ADC_E_USB_ERROR
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_NOT_ENOUGH_MEMORY	an entry is longer than arena
+*			ADC_E_FILE_NOT_FOUND	export file could not be written
+*			ADC_E_ADC_TIMEOUT
+*			ADC_E_COMMAND_NOT_EXECUTED
+*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+* @remarks	Replaces a loop of AdcGetLogger. The requests are sent up to 8 at
+*			a time without waiting for the responses, the download stops
+*			without error at the end of the log book. The entries have the
+*			format of AdcGetLogger and are written one after the other into
+*			arena, entry points into arena and is valid until the callback
+*			returns, size includes the terminating \0. The callback is called
+*			in the context of the caller in the order of the index and must
+*			not call functions of the same handle.
+*			The export file starts with a header of 24 byte (magic "BLLG",
+*			version 1, number of entries, reserved, time_t of the export),
+*			every entry follows as index (2 byte), reserved (2 byte), size
+*			(4 byte) and the entry, in the byte order of the host.
+******************************************************************************
+*/
+short AdcGetLoggerRange(const short handle, const short first, const short count, char *arena, const unsigned long arenaSize, AdcLoggerCallback callback, void *ctx, const char *exportFile)
+{
+	short	retCode;
+	LarsRef	lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x, first: %d, count: %d", __FUNCTION__, handle, first, count);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->GetLoggerRange(first, count, arena, arenaSize, callback, ctx, exportFile));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
 /**
 ******************************************************************************
 * AdcGetRandomAuthentication - function to get the random value for authentication
@@ -2778,11 +2837,11 @@ short AdcGetLogger(const short handle, const short index, char *entry, unsigned
 short AdcGetRandomAuthentication(const short handle, unsigned char *random, unsigned long *size)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2813,11 +2872,11 @@ short AdcGetRandomAuthentication(const short handle, unsigned char *random, unsi
 short AdcSetAuthentication(const short handle, const AdcAuthentication *authentication)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2844,11 +2903,11 @@ short AdcSetAuthentication(const short handle, const AdcAuthentication *authenti
 short AdcSetCountryFilesPath(const short handle, const char *path)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2877,11 +2936,11 @@ short AdcSetCountryFilesPath(const short handle, const char *path)
 BIZLARS_API short AdcGetSupportedCountries(const short handle, char *countries, unsigned long *size)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -2915,11 +2974,11 @@ BIZLARS_API short AdcGetSupportedCountries(const short handle, char *countries,
 short AdcSetCountry(const short handle, const char *name)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2947,11 +3006,11 @@ short AdcSetCountry(const short handle, const char *name)
 BIZLARS_API short AdcGetCountry(const short handle, char *name, unsigned long size)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -2981,11 +3040,11 @@ BIZLARS_API short AdcGetCountry(const short handle, char *name, unsigned long si
 BIZLARS_API short AdcGetCompatibleLoadCapacities(const short handle, const char *country, char *loadCapacities, unsigned long *size)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -3018,11 +3077,11 @@ BIZLARS_API short AdcGetCompatibleLoadCapacities(const short handle, const char
 BIZLARS_API short AdcSetLoadCapacity(const short handle, const char *loadCapacity)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -3049,11 +3108,11 @@ BIZLARS_API short AdcSetLoadCapacity(const short handle, const char *loadCapacit
 BIZLARS_API short AdcGetLoadCapacity(const short handle, char *loadCapacity, unsigned long size)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3091,11 +3150,11 @@ BIZLARS_API short AdcGetLoadCapacity(const short handle, char *loadCapacity, uns
 short AdcGetHighResolution(const short handle, const short registrationRequest, AdcState *adcState, AdcWeight *weight, AdcWeight *weightHighResolution, AdcTare *tare, long *digitValue)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -3131,11 +3190,11 @@ short AdcGetHighResolution(const short handle, const short registrationRequest,
 short AdcGetGrossWeight(const short handle, AdcState *adcState, AdcWeight *grossWeight, AdcWeight *grossWeightHighResolution, long *digitValue)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3168,12 +3227,12 @@ short AdcGetGrossWeight(const short handle, AdcState *adcState, AdcWeight *gross
 BIZLARS_API short AdcGetVersion(const short handle, char *versionStr, unsigned long *size)
 {
     short           retCode = LarsErr::E_SUCCESS;
-    Lars            *lars;
+    LarsRef         lars;
     stringstream    versionStream;
    
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -3214,11 +3273,11 @@ BIZLARS_API short AdcGetVersion(const short handle, char *versionStr, unsigned l
 short AdcGetFirstDiagnosticData(const short handle, const char *name, long *sensorHealthID, AdcSensorHealth *sensorHealth, short *state)
 {
     short   retCode = LarsErr::E_SUCCESS;
-    Lars    *lars;
+    LarsRef lars;
 
     g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+    if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
     {
         g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
         return ADC_E_INVALID_HANDLE;
@@ -3248,11 +3307,11 @@ short AdcGetFirstDiagnosticData(const short handle, const char *name, long *sens
 short AdcGetNextDiagnosticData(const short handle, const long sensorHealthID, AdcSensorHealth *sensorHealth, short *state)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3280,11 +3339,11 @@ short AdcGetNextDiagnosticData(const short handle, const long sensorHealthID, Ad
 BIZLARS_API short AdcConfigureDiagnosticData(const short handle, const AdcSensorHealth *sensorHealth)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3296,6 +3355,152 @@ BIZLARS_API short AdcConfigureDiagnosticData(const short handle, const AdcSensor
 }
 
 
+/**
+******************************************************************************
+* AdcGetDiagnosticSnapshot - function to get all diagnostic data with one request
+*
+* @param    handle:in			adc handle
+* @param    name:in				if name == EmptyString the function give all diagnostic values
+* @param    sensorHealth:out	sensor health data, sorted by diaParam
+* @param    count:in/out		in: number of records of sensorHealth, out: number of records
+*
+* @return   ADC_SUCCESS
+*			ADC_E_USB_ERROR
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_NOT_ENOUGH_MEMORY	sensorHealth is too small, count is the required number
+*			ADC_E_ADC_TIMEOUT
+*			ADC_E_COMMAND_NOT_EXECUTED
+*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+* @remarks	Replaces AdcGetFirstDiagnosticData and AdcGetNextDiagnosticData,
+*			nothing is kept in the library between two calls. With count 0
+*			it returns the number of records in count.
+******************************************************************************
+*/
+short AdcGetDiagnosticSnapshot(const short handle, const char *name, AdcSensorHealth *sensorHealth, short *count)
+{
+	short   retCode;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x, name: %s", __FUNCTION__, handle, name ? name : "");
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->GetDiagnosticSnapshot(name, sensorHealth, count));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcStartDiagnosticSampler - function to read the diagnostic data periodically
+*
+* @param    handle:in			adc handle
+* @param    interval:in			sample interval in ms, min. 100
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+* @remarks	A thread of the handle reads all diagnostic values like
+*			AdcGetDiagnosticSnapshot every interval and keeps the latest
+*			snapshot of up to DIA_MAX_SENSOR_HEALTH records, see
+*			AdcGetDiagnosticSample. The first sample is read immediately, a
+*			second call changes the interval. The sampler is stopped by
+*			AdcStopDiagnosticSampler and AdcClose.
+******************************************************************************
+*/
+short AdcStartDiagnosticSampler(const short handle, const unsigned long interval)
+{
+	short   retCode;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x, interval: %lu", __FUNCTION__, handle, interval);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->StartDiagnosticSampler(interval));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcStopDiagnosticSampler - function to stop the diagnostic sampler
+*
+* @param    handle:in			adc handle
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+* @remarks	a sample in work is finished first, the latest snapshot is kept
+******************************************************************************
+*/
+short AdcStopDiagnosticSampler(const short handle)
+{
+	short   retCode;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->StopDiagnosticSampler());
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcGetDiagnosticSample - function to get the latest snapshot of the diagnostic sampler
+*
+* @param    handle:in			adc handle
+* @param    sensorHealth:out	sensor health data, sorted by diaParam
+* @param    count:in/out		in: number of records of sensorHealth, out: number of records
+* @param    age:out				ms since the snapshot was read, may be NULL
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER	sampler not started
+*			ADC_E_NOT_ENOUGH_MEMORY	sensorHealth is too small, count is the required number
+*			retCode of the latest sample
+* @remarks	No request is sent to the adc. Waits for the first sample after
+*			AdcStartDiagnosticSampler. If the latest sample failed, its retCode
+*			is returned together with the records of the last successful sample.
+******************************************************************************
+*/
+short AdcGetDiagnosticSample(const short handle, AdcSensorHealth *sensorHealth, short *count, unsigned long *age)
+{
+	short   retCode;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->GetDiagnosticSample(sensorHealth, count, age));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
 /**
 ******************************************************************************
 * AdcSetFirmwarePath - function to set the path to the adc firmware files
@@ -3311,11 +3516,11 @@ BIZLARS_API short AdcConfigureDiagnosticData(const short handle, const AdcSensor
 short AdcSetFirmwarePath(const short handle, const char *path)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3347,11 +3552,11 @@ short AdcSetFirmwarePath(const short handle, const char *path)
 BIZLARS_API short AdcUpdate(const short handle, const short force)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3363,6 +3568,121 @@ BIZLARS_API short AdcUpdate(const short handle, const short force)
 }
 
 
+/**
+******************************************************************************
+* AdcUpdateEx - function to update the adc with progress
+*
+* @param    handle:in		adc handle
+* @param    force:in		0: check parameter if update is possible
+*							1: no check, always execute update
+* @param    window:in		max. firmware blocks sent without response, 0: one block at a time
+* @param    callback:in		progress callback, may be NULL
+* @param    ctx:in			context passed to the callback
+*
+* @return	ADC_SUCCESS
+*			ADC_E_USB_ERROR
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_ADC_TIMEOUT
+*			ADC_E_COMMAND_NOT_EXECUTED
+*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+* @remarks
+******************************************************************************
+*/
+BIZLARS_API short AdcUpdateEx(const short handle, const short force, const short window, AdcUpdateProgressCallback callback, void *ctx)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x window: %d", __FUNCTION__, handle, window);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	if ((window < 0) || (window > AdcFirmware::FRM_MAX_WINDOW))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_PARAMETER);
+		return ADC_E_INVALID_PARAMETER;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->Update(force, window, callback, ctx));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcUpdateMany - function to update several adc at the same time
+*
+* @param    handles:in		adc handles
+* @param    count:in		number of handles
+* @param    force:in		0: check parameter if update is possible
+*							1: no check, always execute update
+* @param    callback:in		progress callback, may be NULL
+* @param    ctx:in			context passed to the callback
+* @param    retCodes:out	return code of every adc
+*
+* @return	ADC_SUCCESS
+*			ADC_E_INVALID_PARAMETER
+*			return code of the first adc that failed
+* @remarks	see Lars::UpdateMany
+******************************************************************************
+*/
+BIZLARS_API short AdcUpdateMany(const short *handles, const short count, const short force, AdcUpdateProgressCallback callback, void *ctx, short *retCodes)
+{
+	short   retCode = ADC_SUCCESS;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart count: %d", __FUNCTION__, count);
+
+	if ((handles == NULL) || (retCodes == NULL) || (count <= 0))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_PARAMETER);
+		return ADC_E_INVALID_PARAMETER;
+	}
+
+	vector<LarsRef>	refs(count);
+	vector<Lars *>	lars(count, NULL);
+	vector<short>	errorCodes(count, LarsErr::E_SUCCESS);
+
+	// the references keep the adc open until all updates are done
+	for (short idx = 0; idx < count; idx++)
+	{
+		if ((refs[idx] = AdcCheckHandle(g_larsTable, handles[idx])) == NULL)
+		{
+			errorCodes[idx] = LarsErr::E_INVALID_HANDLE;
+			continue;
+		}
+
+		if (find(handles, handles + idx, handles[idx]) != handles + idx)
+		{
+			refs[idx] = LarsRef();
+			errorCodes[idx] = LarsErr::E_INVALID_PARAMETER;
+			continue;
+		}
+
+		lars[idx] = refs[idx];
+	}
+
+	Lars::UpdateMany(lars.data(), count, force, callback, ctx, errorCodes.data());
+
+	for (short idx = 0; idx < count; idx++)
+	{
+		retCodes[idx] = ConvertLarsE2bizlarsE(errorCodes[idx]);
+		g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\thdl: 0x%x retCode: %d", __FUNCTION__, handles[idx], retCodes[idx]);
+
+		if ((retCode == ADC_SUCCESS) && (retCodes[idx] != ADC_SUCCESS))
+			retCode = retCodes[idx];
+	}
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
 /**
 ******************************************************************************
 * AdcGetFirmwareFileVersion - function get version of the firmware file
@@ -3381,12 +3701,12 @@ BIZLARS_API short AdcUpdate(const short handle, const short force)
 BIZLARS_API short AdcGetFirmwareFileVersion(const short handle, char *versionStr, unsigned long *size)
 {
 	short           retCode = LarsErr::E_SUCCESS;
-	Lars            *lars;
+	LarsRef         lars;
 	stringstream    versionStream;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3425,11 +3745,11 @@ BIZLARS_API short AdcGetFirmwareFileVersion(const short handle, char *versionStr
 short AdcCalibration(const short handle, const AdcCalibCmd cmd, AdcState *adcState, long *step, long *calibDigit)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3463,11 +3783,11 @@ short AdcCalibration(const short handle, const AdcCalibCmd cmd, AdcState *adcSta
 short AdcParameters(const short handle, const AdcParamMode mode)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3523,11 +3843,11 @@ BIZLARS_API short AdcTiltAngleConfirmed(const short handle, const AdcTiltAngleCo
 {
 	short   retCode = LarsErr::E_SUCCESS;
 	AdcScaleValues scaleValues;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3562,11 +3882,11 @@ BIZLARS_API short AdcTiltAngleConfirmed(const short handle, const AdcTiltAngleCo
 short AdcGetInternalDataEx(const short handle, AdcInternalDataEx *internalDataEx, bool sendRequestCmd)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3598,13 +3918,13 @@ short AdcGetInternalDataEx(const short handle, AdcInternalDataEx *internalDataEx
 short AdcGetInternalData(const short handle, AdcInternalData *internalData)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 	AdcInternalDataEx *internalDataEx;
 	short	idx = 0;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3667,11 +3987,11 @@ short AdcGetInternalData(const short handle, AdcInternalData *internalData)
 short AdcSetScaleModel(const short handle, const char *model)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3699,11 +4019,11 @@ short AdcSetScaleModel(const short handle, const char *model)
 short AdcGetScaleModel(const short handle, char *model, unsigned long size)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3731,11 +4051,11 @@ short AdcGetScaleModel(const short handle, char *model, unsigned long size)
 short AdcGetPortNr(const short handle, char *portNr, unsigned long *size)
 {
 	short   retCode = LarsErr::E_SUCCESS;
-	Lars    *lars;
+	LarsRef lars;
 
 	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-	if ((lars = AdcCheckHandle(g_larsList, handle)) == NULL)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
 		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
 		return ADC_E_INVALID_HANDLE;
@@ -3748,118 +4068,506 @@ short AdcGetPortNr(const short handle, char *portNr, unsigned long *size)
 
 /**
 ******************************************************************************
-* internal functions
-******************************************************************************
-*/
-
-
-/**
-******************************************************************************
-* CheckIfAdcIsAlreadyOpen - function checks if adc is already open
+* AdcStartWeightStream - function to subscribe to the continuous weight stream
 *
-* @param    larsList:in		list of all already open adc
-* @param    lars:in			current adc
+* @param    handle:in				adc handle
+* @param    interval:in				poll interval in ms
+* @param    callback:in				called with adc state, weight and tare of every read
+* @param    ctx:in					context passed to the callback
 *
-* @return	false		adc is not already open
-*			true		adc is already open
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
 * @remarks
 ******************************************************************************
 */
-bool CheckIfAdcIsAlreadyOpen(list <Lars *> &larsList, Lars *lars)
+short AdcStartWeightStream(const short handle, const unsigned long interval, AdcWeightStreamCallback callback, void *ctx)
 {
-	Lars *tmpLars;
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
 
-	g_larsMutex.lock();
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  interval: %lu", __FUNCTION__, handle, interval);
 
-    LarsList::const_iterator    it;
-	for (it = larsList.begin(); it != larsList.end(); ++it)
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
 	{
-		tmpLars = *it;
-        if (*(tmpLars->GetAdcName()) == *(lars->GetAdcName()))
-        {
-            g_larsMutex.unlock();
-            return true;
-        }
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
 	}
 
-	g_larsMutex.unlock();
-
-	return false;
+	retCode = ConvertLarsE2bizlarsE(lars->StartWeightStream(interval, callback, ctx));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
 }
 
 
 /**
 ******************************************************************************
-* CreateLogicalDeviceHandle - function to create the logical device handle
+* AdcStopWeightStream - function to unsubscribe from the weight stream
 *
-* @param    larsList:in		list of all already open adc
-* @param    lars:in			current adc
+* @param    handle:in				adc handle
+* @param    callback:in				callback of AdcStartWeightStream
+* @param    ctx:in					context of AdcStartWeightStream
 *
-* @return
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
 * @remarks
 ******************************************************************************
 */
-short CreateLogicalDeviceHandle(LarsList &larsList)
+short AdcStopWeightStream(const short handle, AdcWeightStreamCallback callback, void *ctx)
 {
-    Lars                            *tmpLars;
-    LarsList::const_iterator        it;
-    short                           random;
-    bool                            alreadyCreated = true;
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
 
-    /* initialize random seed: */
-    srand((unsigned int)time(NULL));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
 
-    while (alreadyCreated)
-    {
-        alreadyCreated = false;
-
-        // generate a random from 1 - 65000
-        random = rand() % 65000 + 1;
-
-        g_larsMutex.lock();
-        for (it = larsList.begin(); it != larsList.end(); ++it)
-        {
-            tmpLars = *it;
-            if (tmpLars->GetHandle() == random)
-            {
-                alreadyCreated = true;
-                continue;
-            }
-        }
-        g_larsMutex.unlock();
-    }
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
 
-    return random;
+	retCode = ConvertLarsE2bizlarsE(lars->StopWeightStream(callback, ctx));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
 }
 
 
 /**
 ******************************************************************************
-* AdcCheckHandle - function check adv handle
+* AdcSetReactorMode - function to serve the weight streams of all adc by one thread
 *
-* @param    handle:in		logical adc handle
+* @param    mode:in					1: weight streams started afterwards use the reactor
+*									0: every adc has its own stream thread
+*
+* @return   ADC_SUCCESS
+*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+* @remarks	see AdcReactor
+******************************************************************************
+*/
+short AdcSetReactorMode(const short mode)
+{
+	short   retCode;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart mode: %d", __FUNCTION__, mode);
+
+#ifdef __GNUC__
+	g_adcReactor.SetEnabled(mode != 0);
+	retCode = ADC_SUCCESS;
+#else
+	retCode = ADC_E_FUNCTION_NOT_IMPLEMENTED;
+#endif
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcPublishShared - function to publish the weight to shared memory for other processes
+*
+* @param    handle:in				adc handle
+* @param    name:in					segment name, NULL: stop publishing
+* @param    interval:in				poll interval in ms, 0: publish only the results of AdcReadWeight
 *
-* @return   lars object from list
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_FILE_NOT_FOUND
+*			ADC_E_FUNCTION_NOT_IMPLEMENTED
 * @remarks
 ******************************************************************************
 */
-Lars *AdcCheckHandle(LarsList &larsList, const short handle)
+short AdcPublishShared(const short handle, const char *name, const unsigned long interval)
 {
-    Lars                            *lars = NULL;
-    LarsList::const_iterator        it;
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
 
-    g_larsMutex.lock();
-    for (it = larsList.begin(); it != larsList.end(); ++it)
-    {
-        lars = *it;
-        if (lars->GetHandle() == handle)
-        {
-            g_larsMutex.unlock();
-            return lars;
-        }
-    }
-    g_larsMutex.unlock();
-    return NULL;
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  name: %s  interval: %lu", __FUNCTION__, handle, name ? name : "", interval);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->PublishShared(name, interval));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcAttachShared - function to attach to the weight published by another process
+*
+* @param    name:in					name of AdcPublishShared
+* @param    sharedHandle:out		handle for AdcReadShared
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_NOT_ENOUGH_MEMORY
+*			ADC_E_FILE_NOT_FOUND
+*			ADC_E_FILE_CORRUPT
+*			ADC_E_FUNCTION_NOT_IMPLEMENTED
+* @remarks
+******************************************************************************
+*/
+short AdcAttachShared(const char *name, short *sharedHandle)
+{
+	short   retCode = LarsErr::E_NOT_ENOUGH_MEMORY;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart name: %s", __FUNCTION__, name ? name : "");
+
+	if (!name || !sharedHandle)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_PARAMETER);
+		return ADC_E_INVALID_PARAMETER;
+	}
+
+	g_sharedMutex.lock();
+	for (short idx = 0; idx < MAX_SHARED_READERS; idx++)
+	{
+		if (!g_sharedList[idx].IsOpen())
+		{
+			if ((retCode = g_sharedList[idx].Attach(name)) == LarsErr::E_SUCCESS)
+				*sharedHandle = idx + 1;
+			break;
+		}
+	}
+	g_sharedMutex.unlock();
+
+	retCode = ConvertLarsE2bizlarsE(retCode);
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcReadShared - function to read the latest published weight
+*
+* @param    sharedHandle:in			handle of AdcAttachShared
+* @param    adcState:out			adc state
+* @param    weight:out				weight value
+* @param    tare:out				tare value
+* @param    sellPrice:out			sell price value
+* @param    age:out					age of the values in ms
+*
+* @return   return code of the read weight of the publisher
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_NO_DEVICE
+* @remarks	no trace, this function is meant to be called at high rate.
+*			g_sharedMutex is held while reading, so AdcDetachShared can't
+*			unmap the segment under the reader.
+******************************************************************************
+*/
+short AdcReadShared(const short sharedHandle, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcPrice *sellPrice, unsigned long *age)
+{
+	short   retCode;
+	short   errorCode;
+
+	if ((sharedHandle < 1) || (sharedHandle > MAX_SHARED_READERS))
+		return ADC_E_INVALID_HANDLE;
+
+	g_sharedMutex.lock();
+	if ((retCode = g_sharedList[sharedHandle - 1].Read(&errorCode, adcState, weight, tare, sellPrice, age)) == LarsErr::E_SUCCESS)
+		retCode = errorCode;
+	g_sharedMutex.unlock();
+
+	return ConvertLarsE2bizlarsE(retCode);
+}
+
+
+/**
+******************************************************************************
+* AdcDetachShared - function to detach from a published weight
+*
+* @param    sharedHandle:in			handle of AdcAttachShared
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+* @remarks
+******************************************************************************
+*/
+short AdcDetachShared(const short sharedHandle)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, sharedHandle);
+
+	g_sharedMutex.lock();
+	if ((sharedHandle >= 1) && (sharedHandle <= MAX_SHARED_READERS) && g_sharedList[sharedHandle - 1].IsOpen())
+		g_sharedList[sharedHandle - 1].Close();
+	else
+		retCode = LarsErr::E_INVALID_HANDLE;
+	g_sharedMutex.unlock();
+
+	retCode = ConvertLarsE2bizlarsE(retCode);
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+/**
+******************************************************************************
+* AdcDumpFlightRecorder - function to write the last telegrams to a file
+*
+* @param    handle:in				adc handle
+* @param    fileName:in				path of the dump file
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_FILE_NOT_FOUND
+* @remarks
+******************************************************************************
+*/
+short AdcDumpFlightRecorder(const short handle, const char *fileName)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  file: %s", __FUNCTION__, handle, fileName ? fileName : "");
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->DumpFlightRecorder(fileName));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcSetFlightRecorderAutoDump - function to dump the last telegrams on protocol errors
+*
+* @param    handle:in				adc handle
+* @param    fileName:in				path of the dump file, NULL: no automatic dump
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+* @remarks
+******************************************************************************
+*/
+short AdcSetFlightRecorderAutoDump(const short handle, const char *fileName)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  file: %s", __FUNCTION__, handle, fileName ? fileName : "");
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->SetFlightRecorderAutoDump(fileName));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcGetStatistics - function to get the counters and latencies of the rbs commands
+*
+* @param    handle:in				adc handle
+* @param    statistics:out			array of *count entries
+* @param    count:in/out			in: size of the array, out: number of commands
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_NOT_ENOUGH_MEMORY
+* @remarks
+******************************************************************************
+*/
+short AdcGetStatistics(const short handle, AdcCommandStatistics *statistics, short *count)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  count: %d", __FUNCTION__, handle, count ? *count : 0);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->GetStatistics(statistics, count));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d  count: %d", __FUNCTION__, retCode, count ? *count : 0);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcResetStatistics - function to set the counters and latencies to zero
+*
+* @param    handle:in				adc handle
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+* @remarks
+******************************************************************************
+*/
+short AdcResetStatistics(const short handle)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x", __FUNCTION__, handle);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->ResetStatistics());
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcWriteStatistics - function to write the statistics in the Prometheus text format
+*
+* @param    handle:in				adc handle
+* @param    fileName:in				path of the file
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+*			ADC_E_FILE_NOT_FOUND
+* @remarks
+******************************************************************************
+*/
+short AdcWriteStatistics(const short handle, const char *fileName)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  file: %s", __FUNCTION__, handle, fileName ? fileName : "");
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->WriteStatistics(fileName));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcSetRegisterCache - function to switch the cache of the scale values
+*
+* @param    handle:in				adc handle
+* @param    mode:in					1: cache on, 0: every getter reads from the adc
+*
+* @return   ADC_SUCCESS
+*			ADC_E_INVALID_HANDLE
+*			ADC_E_INVALID_PARAMETER
+* @remarks
+******************************************************************************
+*/
+short AdcSetRegisterCache(const short handle, const short mode)
+{
+	short   retCode = LarsErr::E_SUCCESS;
+	LarsRef lars;
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart hdl: 0x%x  mode: %d", __FUNCTION__, handle, mode);
+
+	if ((lars = AdcCheckHandle(g_larsTable, handle)) == NULL)
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_HANDLE);
+		return ADC_E_INVALID_HANDLE;
+	}
+
+	if ((mode != 0) && (mode != 1))
+	{
+		g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tend retCode: %d", __FUNCTION__, ADC_E_INVALID_PARAMETER);
+		return ADC_E_INVALID_PARAMETER;
+	}
+
+	retCode = ConvertLarsE2bizlarsE(lars->SetRegisterCache(mode == 1));
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, retCode);
+	return retCode;
+}
+
+
+/**
+******************************************************************************
+* AdcSetProfilePath - function to set the directory of the device profiles
+*
+* @param    path:in					directory, NULL or "": no device profiles
+*
+* @return   ADC_SUCCESS
+* @remarks	see AdcProfile
+******************************************************************************
+*/
+short AdcSetProfilePath(const char *path)
+{
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tstart path: %s", __FUNCTION__, path ? path : "");
+
+	g_adcProfile.SetPath(path);
+
+	g_adcTrace.Trace(AdcTrace::TRC_ACTION, "%s\tend retCode: %d", __FUNCTION__, ADC_SUCCESS);
+	return ADC_SUCCESS;
+}
+
+/**
+******************************************************************************
+* internal functions
+******************************************************************************
+*/
+
+
+/**
+******************************************************************************
+* CheckIfAdcIsAlreadyOpen - function checks if adc is already open
+*
+* @param    larsTable:in	table of all already open adc
+* @param    lars:in			current adc
+*
+* @return	false		adc is not already open
+*			true		adc is already open
+* @remarks
+******************************************************************************
+*/
+bool CheckIfAdcIsAlreadyOpen(LarsTable &larsTable, Lars *lars)
+{
+	return larsTable.IsOpen(*(lars->GetAdcName()));
+}
+
+
+/**
+******************************************************************************
+* AdcCheckHandle - function check adv handle
+*
+* @param    larsTable:in	table of all open adc
+* @param    handle:in		logical adc handle
+*
+* @return   reference to the lars object, NULL: invalid handle
+* @remarks	the lars object is not deleted by AdcClose as long as the
+*			reference exists
+******************************************************************************
+*/
+LarsRef AdcCheckHandle(LarsTable &larsTable, const short handle)
+{
+	return larsTable.Acquire(handle);
 }
 
 /**
@@ -1,16 +1,9 @@
-#ifdef  _MSC_VER
-#include <Windows.h>
-#endif
-#ifdef __GNUC__
-#include <dirent.h>
-#endif
-
 #include "helpers.h"
 #include "larsErr.h"
 #include "adctrace.h"
-#include "crypto.h"
 #include "adcrbs.h"
 #include "adctilt.h"
+#include "adccountryindex.h"
 #include "countrysettings.h"
 
 const string CountrySettings::TCS_LIMIT_FLOAT = "tclimitcs|FLOAT";
@@ -70,10 +63,9 @@ short CountrySettings::SetCountry(const string& country)
 
 short CountrySettings::SetCountry(const string& country, const string& path)
 {
-    string fileContent;
+    shared_ptr<const AdcFileCache::Content> fileContent;
     string ctyFileName;
     string saveCountryISO;
-    Crypto cryptVar;
     short  errorCode;
 
     if (path.empty())
@@ -81,8 +73,8 @@ short CountrySettings::SetCountry(const string& country, const string& path)
     else
 		ctyFileName = path + "/" + m_fileName + country + ".txt";
 
-    // read and decrypt country settings file
-    errorCode = cryptVar.ReadEncryptedFile(ctyFileName, fileContent);
+    // read and decrypt country settings file, other adc with the same country share it
+    errorCode = g_adcFileCache.Read(ctyFileName, fileContent);
     if (errorCode != LarsErr::E_SUCCESS)
     {
 		// check if country is already set
@@ -95,7 +87,7 @@ short CountrySettings::SetCountry(const string& country, const string& path)
 	m_loadCapacityMap.clear();
 
     // parse country settings file
-    Parse(fileContent, country);
+    Parse(*fileContent, country);
 
     return errorCode;
 }
@@ -117,60 +109,40 @@ void CountrySettings::SetSettings(const map<string, string> &cySettingsMap)
 }
 
 
-bool CountrySettings::Parse(string &fileContent, const string &country)
+bool CountrySettings::Parse(const AdcFileCache::Content &content, const string &country)
 {
     short   state = UNSUPPORTED;
-    string  oneRow, key, value;
-    size_t  endPos = 0;
-    size_t  pos1 = 0;
-	size_t	offset;
+    string  key, value;
 	size_t	posSeparator = 0;
 	string  areaCountrySettings = "[country settings " + country + "]";
 	string	areaRegParams = "[registration parameters]";
 	string  areaLoadCapacity = "[load capacities]";
 	
-    // remove all CR from string
-    RemoveCR(fileContent);
-
-	while (!fileContent.empty())
+	for (AdcFileCache::Content::const_iterator oneRow = content.begin(); oneRow != content.end(); ++oneRow)
     {
-        endPos = fileContent.find('\n');
-		if (endPos == string::npos)
-		{
-			// no \n in string
-			endPos = fileContent.size();
-			offset = 0;
-		}
-		else
-		{
-			offset = 1;
-		}
-        oneRow = fileContent.substr(0, endPos);
-
-        if (!oneRow.empty())
+        if (oneRow->keyValue || !oneRow->key.empty())
         {
-			if (oneRow == areaCountrySettings)
+			if (!oneRow->keyValue && (oneRow->key == areaCountrySettings))
 				state = COUNTRY_SETTING;
-			else if (oneRow == areaRegParams)
+			else if (!oneRow->keyValue && (oneRow->key == areaRegParams))
 				state = REGISTRATION_PARAMETER;
-            else if (oneRow == areaLoadCapacity)
+            else if (!oneRow->keyValue && (oneRow->key == areaLoadCapacity))
                 state = SUPPORTED_LOADCELL;
             else
             {
                 switch (state)
                 {
                 case COUNTRY_SETTING:
-                    pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
+					if (oneRow->keyValue)
 					{
-						key = oneRow.substr(0, pos1);
-						value = oneRow.substr(pos1 + 1);
+						key = oneRow->key;
+						value = oneRow->value;
 
 						// patch tclimitcs key
 						if (key == TCS_LIMIT_FLOAT)
 						{
 							posSeparator = key.find('|');
-							if (posSeparator != string::npos) key.replace(posSeparator + 1, pos1 - posSeparator - 1, "INT");
+							if (posSeparator != string::npos) key.replace(posSeparator + 1, oneRow->key.size() - posSeparator - 1, "INT");
 
 							if (m_tilt)
 							{
@@ -186,24 +158,21 @@ bool CountrySettings::Parse(string &fileContent, const string &country)
                     break;
 
 				case REGISTRATION_PARAMETER:
-					pos1 = oneRow.find('=');
-					if (pos1 != string::npos)
-						m_regParamMap[oneRow.substr(0, pos1)] = oneRow.substr(pos1 + 1);
+					if (oneRow->keyValue)
+						m_regParamMap[oneRow->key] = oneRow->value;
 					else
 						g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror parsing country settings for %s -> wrong format", __FUNCTION__, country.c_str());
 					break;
 
                 case SUPPORTED_LOADCELL:
-                    pos1 = oneRow.find('=');
-                    if (pos1 != string::npos)
-                        m_loadCapacityMap[oneRow.substr(0, pos1)] = oneRow.substr(pos1 + 1);
+                    if (oneRow->keyValue)
+                        m_loadCapacityMap[oneRow->key] = oneRow->value;
                     else
 						g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror parsing country settings for %s -> wrong format", __FUNCTION__, country.c_str());
                     break;
                 }
             }
         }
-        fileContent = fileContent.substr(endPos + offset);			// add offset because of \n
     }
 
     return true;
@@ -212,6 +181,7 @@ bool CountrySettings::Parse(string &fileContent, const string &country)
 
 void CountrySettings::GetSupportedCountries(supportedCountries& countries)
 {
+	ReadSupportedCountries();
 	countries = m_supportedCountries;
 }
 
@@ -224,85 +194,8 @@ void CountrySettings::ReadSupportedCountries()
 
 void CountrySettings::ReadSupportedCountries(const string& path)
 {
-    string countryISO;
-    size_t pos1, pos2;
-
-#ifdef _MSC_VER
-    WIN32_FIND_DATAA fileData;
-    HANDLE hFind;
-    string filePattern;
-
-	m_supportedCountries.clear();
-
-    if (path.empty())
-    {
-        filePattern = "./countrysettings_*.txt";
-    }
-    else
-    {
-        filePattern = path + "/countrysettings_*.txt";
-    }
-
-    if (!((hFind = FindFirstFileA(filePattern.c_str(), &fileData)) == INVALID_HANDLE_VALUE))
-    {
-        do
-        {
-            // check for file
-            if (!(fileData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-            {
-                countryISO = fileData.cFileName;
-                pos1 = countryISO.find_last_of('_');
-                pos2 = countryISO.find_last_of('.');
-                if ((pos1 != string::npos) && (pos2 != string::npos))
-                {
-                    countryISO = countryISO.substr(pos1 + 1, pos2 - pos1 - 1);
-                    m_supportedCountries.push_back(countryISO);
-                }
-            }
-        } while (FindNextFileA(hFind, &fileData));
-    }
-
-    FindClose(hFind);
-#endif
-
-#ifdef __GNUC__
-    DIR 			*dp;
-    struct dirent 	*dirp;
-    string 			dir;
-    string			filePattern = "countrysettings_";
-
-	m_supportedCountries.clear();
-
-    if (path.empty())
-    {
-        dir = "./";
-    }
-    else
-    {
-        dir = path;
-    }
-
-    //if ((dp = opendir(filePattern.c_str())) != NULL)
-    if ((dp = opendir(dir.c_str())) != NULL)
-    {
-        while ((dirp = readdir(dp)) != NULL)
-        {
-			countryISO = dirp->d_name;
-			if (countryISO.find(filePattern) != string::npos)
-			{
-				pos1 = countryISO.find_last_of('_');
-				pos2 = countryISO.find_last_of('.');
-				if ((pos1 != string::npos) && (pos2 != string::npos))
-				{
-					countryISO = countryISO.substr(pos1 + 1, pos2 - pos1 - 1);
-					m_supportedCountries.push_back(countryISO);
-				}
-			}
-        }
-    }
-
-    closedir(dp);
-#endif
+	// served from the index, the directory is read only if it has changed
+	g_adcCountryIndex.GetCountries(path, m_supportedCountries);
 }
 
 
@@ -318,18 +211,6 @@ const map<string, string> *CountrySettings::GetRegistrationParameters()
 }
 
 
-void CountrySettings::RemoveCR(string &str)
-{
-    size_t  pos = 0;
-    // first remove all \n
-    do
-    {
-        pos = str.find('\r', pos);
-        if (pos != string::npos) str.erase(pos, 1);
-    } while (pos != string::npos);
-}
-
-
 string CountrySettings::MaxTemplateString()
 {
 	string value;
@@ -29,6 +29,12 @@ using CryptoPP::StringSink;
 using CryptoPP::StringSource;
 using CryptoPP::StreamTransformationFilter;
 
+#include <hmac.h>
+using CryptoPP::HMAC;
+
+#include <sha.h>
+using CryptoPP::SHA256;
+
 #include "larsErr.h"
 #include "adctrace.h"
 #include "crypto.h"
@@ -260,21 +266,101 @@ int Crypto::DecryptAES_GCM(string cipherText, string& plainText)
 }
 
 
-short Crypto::ReadEncryptedFile(const string& fileName, string& decryptedText)
+/**
+******************************************************************************
+* DecryptAES_GCM - decrypt in chunks without a copy of the whole plain text
+*
+* @param    cipherText:in   encrypted data followed by the tag
+* @param    consumer:in     called with every decrypted chunk
+*
+* @return   E_SUCCESS
+*           E_DATA_INTEGRITY    tag does not match
+*           E_ABORTED           consumer returned false
+*           E_INVALID_PARAMETER
+* @remarks  the tag is verified after the last chunk, so the consumer gets
+*           unauthenticated data and must not act on it before the return
+******************************************************************************
+*/
+int Crypto::DecryptAES_GCM(const string& cipherText, const DecryptConsumer& consumer)
 {
-    string cipherText;
+    int     ret = E_SUCCESS;
+    byte    plainText[DECRYPT_CHUNK_SIZE];
+    size_t  dataSize;
+    size_t  size;
+
+    if (cipherText.length() < (size_t)TAG_SIZE)
+        return E_INVALID_PARAMETER;
+
+    dataSize = cipherText.length() - TAG_SIZE;
 
     try
     {
-        // read encoded file
-        CryptoPP::FileSource(fileName.c_str(), true, new CryptoPP::HexDecoder(new CryptoPP::StringSink(cipherText)));
+        GCM< AES >::Decryption aesDecryption;
+        aesDecryption.SetKeyWithIV((byte *)key.c_str(), CryptoPP::AES::DEFAULT_KEYLENGTH, (byte *)iv.c_str(), CryptoPP::AES::DEFAULT_KEYLENGTH);
 
-        // Decrypt
-        if (DecryptAES_GCM(cipherText, decryptedText) != Crypto::E_SUCCESS)
+        // authenticated data before the encrypted data, like the channel "AAD" of the filter
+        aesDecryption.Update((const byte*)authenticationStr.data(), authenticationStr.size());
+
+        for (size_t pos = 0; pos < dataSize; pos += size)
         {
-            g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tdecryption error, file %s corrupted", __FUNCTION__, fileName.c_str());
-            return LarsErr::E_FILE_CORRUPT;
+            size = (dataSize - pos < DECRYPT_CHUNK_SIZE) ? dataSize - pos : DECRYPT_CHUNK_SIZE;
+            aesDecryption.ProcessData(plainText, (const byte*)cipherText.data() + pos, size);
+
+            if (!consumer((const char *)plainText, size))
+                return E_ABORTED;
         }
+
+        if (!aesDecryption.TruncatedVerify((const byte*)cipherText.data() + dataSize, TAG_SIZE))
+            ret = E_DATA_INTEGRITY;
+    }
+    catch (CryptoPP::Exception&)
+    {
+        ret = E_INVALID_PARAMETER;
+    }
+
+    return ret;
+}
+
+
+short Crypto::ReadEncryptedFile(const string& fileName, string& decryptedText)
+{
+    string  cipherText;
+    short   errorCode;
+
+    if ((errorCode = ReadCipherFile(fileName, cipherText)) != LarsErr::E_SUCCESS)
+        return errorCode;
+
+    // Decrypt
+    if (DecryptAES_GCM(cipherText, decryptedText) != Crypto::E_SUCCESS)
+    {
+        g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\tdecryption error, file %s corrupted", __FUNCTION__, fileName.c_str());
+        return LarsErr::E_FILE_CORRUPT;
+    }
+
+    return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* ReadCipherFile - read an encrypted file without decrypting it
+*
+* @param    fileName:in     hex encoded file
+* @param    cipherText:out  encrypted data followed by the tag
+*
+* @return   LarsErr::E_SUCCESS
+*           LarsErr::E_FILE_NOT_FOUND
+* @remarks  see DecryptAES_GCM
+******************************************************************************
+*/
+short Crypto::ReadCipherFile(const string& fileName, string& cipherText)
+{
+    cipherText.clear();
+
+    try
+    {
+        // read encoded file
+        CryptoPP::FileSource(fileName.c_str(), true, new CryptoPP::HexDecoder(new CryptoPP::StringSink(cipherText)));
     }
     catch (CryptoPP::Exception &e)
     {
@@ -284,3 +370,59 @@ short Crypto::ReadEncryptedFile(const string& fileName, string& decryptedText)
 
     return LarsErr::E_SUCCESS;
 }
+
+
+/**
+******************************************************************************
+* CreateMAC - create a message authentication code of data written by the library
+*
+* @param    data:in         data to authenticate
+* @param    mac:out         hex encoded HMAC-SHA256
+*
+* @return   void
+* @remarks  the key is derived from the private key and the authentication
+*           string, so it differs from the key of the encrypted files
+******************************************************************************
+*/
+void Crypto::CreateMAC(const string& data, string& mac)
+{
+    string  macKey = authenticationStr + key;
+    HMAC< SHA256 > hmac((const byte *)macKey.data(), macKey.size());
+
+    mac.clear();
+    StringSource(data, true, new CryptoPP::HashFilter(hmac, new HexEncoder(new StringSink(mac))));
+}
+
+
+/**
+******************************************************************************
+* VerifyMAC - check the message authentication code of CreateMAC
+*
+* @param    data:in         authenticated data
+* @param    mac:in          hex encoded HMAC-SHA256
+*
+* @return   true: data is unchanged
+* @remarks  the digests are compared in constant time
+******************************************************************************
+*/
+bool Crypto::VerifyMAC(const string& data, const string& mac)
+{
+    string  macKey = authenticationStr + key;
+    string  digest;
+    HMAC< SHA256 > hmac((const byte *)macKey.data(), macKey.size());
+
+    try
+    {
+        StringSource(mac, true, new HexDecoder(new StringSink(digest)));
+    }
+    catch (CryptoPP::Exception&)
+    {
+        return false;
+    }
+
+    if (digest.size() != hmac.DigestSize())
+        return false;
+
+    hmac.Update((const byte *)data.data(), data.size());
+    return hmac.Verify((const byte *)digest.data());
+}
@@ -11,6 +11,10 @@
 */
 #include <sstream>
 #include <thread>         // std::this_thread::sleep_for
+#include <atomic>
+#include <memory>
+#include <fstream>
+#include <time.h>
 #include "version.h"
 #ifdef  __GNUC__
 #include <string.h>
@@ -23,11 +27,14 @@
 #include "lars.h"
 #include "adcusb.h"
 #include "adcserial.h"
+#include "adcsimulator.h"
 #include "adcrbs.h"
 #include "authentication.h"
 #include "helpers.h"
 #include "adcfirmware.h"
 #include "adcssp.h"
+#include "adccountryindex.h"
+#include "adcprofile.h"
 
 
 // defines for authentication
@@ -117,10 +124,17 @@ void Lars::Init()
 	if (m_port.empty() || m_port == "usb")
 		m_interface = new AdcUsb();
 
-	if (m_port.substr(0, 3) == "COM")
+	// COMn or a tty device, e.g. /dev/ttyS1 or /dev/ttyUSB0
+	if ((m_port.substr(0, 3) == "COM") || (m_port.substr(0, 5) == "/dev/"))
 		m_interface = new AdcSerial(m_port);
 
+	// simulated adc, e.g. AdcSimulator:latency=2000,jitter=500
+	if (AdcSimulator::IsSimulatorPort(m_port))
+		m_interface = new AdcSimulator(m_port);
+
     m_protocol = new AdcRbs(m_interface);
+	m_weightStream = new AdcWeightStream(this);
+	m_diagnosticSampler = new AdcDiagnosticSampler(this);
 
 	InitCapabilities();
 
@@ -159,6 +173,8 @@ Lars::Lars(const Lars &obj)                             // copy constructor
 	*m_interface = *obj.m_interface;
 	*m_protocol = *obj.m_protocol;
 	m_protocol->SetInterface(m_interface);
+	m_weightStream = new AdcWeightStream(this);
+	m_diagnosticSampler = new AdcDiagnosticSampler(this);
 
 	m_adcCap = obj.m_adcCap;
 
@@ -182,6 +198,18 @@ Lars::Lars(const Lars &obj)                             // copy constructor
 */
 Lars::~Lars()
 {
+	// stop the weight stream before the interface is closed
+	if (m_weightStream)
+	{
+		delete m_weightStream;
+		m_weightStream = NULL;
+	}
+	if (m_diagnosticSampler)
+	{
+		delete m_diagnosticSampler;
+		m_diagnosticSampler = NULL;
+	}
+
 	m_interface->Close();
 
 	if (m_tilt)
@@ -284,6 +312,13 @@ short Lars::Open(const bool performSwReset)
 */
 bool Lars::Close()
 {
+	m_weightStream->Stop();
+	m_diagnosticSampler->Stop();
+
+	m_mutex.lock();
+	m_shared.Close();
+	m_mutex.unlock();
+
 	// connection to adc is closing, call store parameter to ensure that the adc parameters are storing persistent before shutdown
 	Parameters(ADC_SAVE_SENSOR_HEALTH_DATA);
 
@@ -305,6 +340,10 @@ short Lars::SetAdcVariables()
 {
 	short errorCode;
 
+	// send the startup requests pipelined, the getters take the prefetched responses.
+	// On errors the getters send their requests again, so the error code is not checked
+	m_protocol->PrefetchIdentification();
+
 	// get protocol version to set adc type
 	map<string, string> versionMap;
 	if ((errorCode = m_protocol->GetVersion(versionMap)) != LarsErr::E_SUCCESS)
@@ -321,63 +360,105 @@ short Lars::SetAdcVariables()
 		return errorCode;
 	}
 
+	m_protocol->SetProfile("");
+
 	if (m_opMode == ADC_APPLICATION)
 	{
-		// read country specific settings
-		map<string, string> countrySettings;
-		if ((errorCode = m_protocol->GetCountrySettings(countrySettings)) != LarsErr::E_SUCCESS)
-		{
-			return errorCode;
-		}
-		else
-		{
-			m_cySetting.SetSettings(countrySettings);
-		}
+		AdcProfile::Responses	profile;
+		string	profileFile = g_adcProfile.GetFileName(versionMap);
+		bool	profileLoaded;
 
-		// read load capacity settings
-		if ((errorCode = ReadLcSettings()) != LarsErr::E_SUCCESS)
-		{
-			return errorCode;
-		}
+		// warm start: the same adc with the same firmware has the capabilities and the eeprom size
+		// in the device profile, the other settings may be changed by other processes and are read
+		profileLoaded = (g_adcProfile.Load(profileFile, versionMap, profile) == LarsErr::E_SUCCESS);
+		m_protocol->PrefetchSettings(!profileLoaded, (profileLoaded || profileFile.empty()) ? NULL : &profile);
+		if (profileLoaded)
+			m_protocol->PrefetchProfile(profile);
 
-		// read capabilities from ADC
-		InitCapabilities();
-		if ((errorCode = m_protocol->GetCapabilities(m_adcCap)) != LarsErr::E_SUCCESS)
+		if ((errorCode = ReadSettings()) != LarsErr::E_SUCCESS)
 		{
+			// the adc doesn't accept the settings of the profile
+			if (profileLoaded)
+				g_adcProfile.Remove(profileFile);
 			return errorCode;
 		}
 
-		// get eeprom size
-		if ((errorCode = m_protocol->GetEepromSize(&m_eepromSize)) != LarsErr::E_SUCCESS)
-		{
-			return errorCode;
-		}
+		if (!profileLoaded && !profile.empty())
+			g_adcProfile.Save(profileFile, versionMap, profile);
+		m_protocol->SetProfile(profileFile);
+	}
+	return errorCode;
+}
 
 
-		// check if authentication is necessary and do it
-		if ((errorCode = CheckDoAuthentication(true)) != LarsErr::E_SUCCESS)
-		{
-			return errorCode;
-		}
+/**
+******************************************************************************
+* ReadSettings - read the settings of the application mode from adc
+*
+* @param
+*
+* @return   errorCode
+* @remarks	takes the prefetched responses of SetAdcVariables
+******************************************************************************
+*/
+short Lars::ReadSettings()
+{
+	short errorCode;
 
-		// get tilt sensor resolution
-		AdcScaleValues scaleValues;
-		scaleValues.type = AdcValueType::ADC_TILT_COMP;
-		if (m_protocol->GetTiltCompensation(&scaleValues.ScaleValue.tiltCompensation) == LarsErr::E_SUCCESS)
-		{
-			if (m_tilt) delete m_tilt;
-			m_tilt = new AdcTilt(&scaleValues.ScaleValue.tiltCompensation);
-			m_cySetting.SetTilt(m_tilt);
-			m_ssp.SetTilt(m_tilt);
-		}
+	// read country specific settings
+	map<string, string> countrySettings;
+	if ((errorCode = m_protocol->GetCountrySettings(countrySettings)) != LarsErr::E_SUCCESS)
+	{
+		return errorCode;
+	}
+	else
+	{
+		m_cySetting.SetSettings(countrySettings);
+	}
 
-		// read scale model
-		// don't check error code, because older firmware version does not support the api
-		m_protocol->GetScaleModel(m_scaleModel);
+	// read load capacity settings
+	if ((errorCode = ReadLcSettings()) != LarsErr::E_SUCCESS)
+	{
+		return errorCode;
+	}
 
-		// read ssp files
-		LoadSspParam();
+	// read capabilities from ADC
+	InitCapabilities();
+	if ((errorCode = m_protocol->GetCapabilities(m_adcCap)) != LarsErr::E_SUCCESS)
+	{
+		return errorCode;
+	}
+
+	// get eeprom size
+	if ((errorCode = m_protocol->GetEepromSize(&m_eepromSize)) != LarsErr::E_SUCCESS)
+	{
+		return errorCode;
 	}
+
+
+	// check if authentication is necessary and do it
+	if ((errorCode = CheckDoAuthentication(true)) != LarsErr::E_SUCCESS)
+	{
+		return errorCode;
+	}
+
+	// get tilt sensor resolution
+	AdcScaleValues scaleValues;
+	scaleValues.type = AdcValueType::ADC_TILT_COMP;
+	if (m_protocol->GetTiltCompensation(&scaleValues.ScaleValue.tiltCompensation) == LarsErr::E_SUCCESS)
+	{
+		if (m_tilt) delete m_tilt;
+		m_tilt = new AdcTilt(&scaleValues.ScaleValue.tiltCompensation);
+		m_cySetting.SetTilt(m_tilt);
+		m_ssp.SetTilt(m_tilt);
+	}
+
+	// read scale model
+	// don't check error code, because older firmware version does not support the api
+	m_protocol->GetScaleModel(m_scaleModel);
+
+	// read ssp files
+	LoadSspParam();
 	return errorCode;
 }
 
@@ -1310,57 +1391,83 @@ short Lars::ReadWeight(const short registrationRequest, AdcState *adcState, AdcW
 	if (adcState)
 	{
 		errorCode = m_protocol->ReadWeight(registrationRequest, adcState, weight, tare, basePrice, sellPrice);
+		errorCode = CompleteReadWeight(errorCode, adcState, weight, tare, basePrice, sellPrice);
+	}
+	else
+	{
+		errorCode = LarsErr::E_INVALID_PARAMETER;
+	}
 
-		if ((errorCode == LarsErr::E_SUCCESS) &&
-			(adcState->bit.calibMode == 0) &&
-			!m_applAuthenticationDone)
-		{
-			adcState->state &= LCS_AUTHENTICATION_MASK;
-			adcState->bit.needAuthentication = 1;
-			adcState->bit.needLogbook = 1;
+    m_mutex.unlock();
 
-			if (weight)
-			{
-				weight->value = 0;
-				weight->weightUnit = (AdcWeightUnit)m_lc.GetWeightUnit();
-				weight->decimalPlaces = m_lc.GetDecimalPlaces();
-			}
+    return errorCode;
+}
 
-			if (tare)
-			{
-				tare->type = AdcTareType::ADC_TARE_WEIGHED;
-				tare->frozen = 0;
-				tare->value.value = 0;
-				tare->value.weightUnit = (AdcWeightUnit)m_lc.GetWeightUnit();
-				tare->value.decimalPlaces = m_lc.GetDecimalPlaces();
-			}
 
-			if (basePrice)
-			{
-				basePrice->price.value = 0;
-				basePrice->price.decimalPlaces = 0;
-				basePrice->price.currency[0] = '\0';
-				basePrice->weightUnit = (AdcWeightUnit)m_lc.GetWeightUnit();
-			}
+/**
+******************************************************************************
+* CompleteReadWeight - hide the weight without authentication and publish it
+*
+* @param    errorCode:in            result of the read weight request
+* @param    adcState:in/out         state of the adc
+* @param    weight:in/out           current weight
+* @param    tare:in/out             current tare
+* @param    basePrice:in/out        current base price
+* @param    sellPrice:in/out        current sell price
+*
+* @return   errorCode
+* @remarks	m_mutex must be locked, used by ReadWeight and ContinueReadWeight
+******************************************************************************
+*/
+short Lars::CompleteReadWeight(short errorCode, AdcState *adcState, AdcWeight *weight, AdcTare *tare, AdcBasePrice *basePrice, AdcPrice *sellPrice)
+{
+	if ((errorCode == LarsErr::E_SUCCESS) &&
+		(adcState->bit.calibMode == 0) &&
+		!m_applAuthenticationDone)
+	{
+		adcState->state &= LCS_AUTHENTICATION_MASK;
+		adcState->bit.needAuthentication = 1;
+		adcState->bit.needLogbook = 1;
 
-			if (sellPrice)
-			{
-				sellPrice->value = 0;
-				sellPrice->decimalPlaces = 0;
-				sellPrice->currency[0] = '\0';
-			}
+		if (weight)
+		{
+			weight->value = 0;
+			weight->weightUnit = (AdcWeightUnit)m_lc.GetWeightUnit();
+			weight->decimalPlaces = m_lc.GetDecimalPlaces();
+		}
 
-			errorCode = LarsErr::E_AUTHENTICATION;
+		if (tare)
+		{
+			tare->type = AdcTareType::ADC_TARE_WEIGHED;
+			tare->frozen = 0;
+			tare->value.value = 0;
+			tare->value.weightUnit = (AdcWeightUnit)m_lc.GetWeightUnit();
+			tare->value.decimalPlaces = m_lc.GetDecimalPlaces();
 		}
-	}
-	else
-	{
-		errorCode = LarsErr::E_INVALID_PARAMETER;
+
+		if (basePrice)
+		{
+			basePrice->price.value = 0;
+			basePrice->price.decimalPlaces = 0;
+			basePrice->price.currency[0] = '\0';
+			basePrice->weightUnit = (AdcWeightUnit)m_lc.GetWeightUnit();
+		}
+
+		if (sellPrice)
+		{
+			sellPrice->value = 0;
+			sellPrice->decimalPlaces = 0;
+			sellPrice->currency[0] = '\0';
+		}
+
+		errorCode = LarsErr::E_AUTHENTICATION;
 	}
 
-    m_mutex.unlock();
+	// publish what the application gets for readers in other processes
+	if (m_shared.IsOpen())
+		m_shared.Publish(errorCode, adcState, weight, tare, sellPrice);
 
-    return errorCode;
+	return errorCode;
 }
 
 
@@ -1390,6 +1497,89 @@ short Lars::GetLogger(const short index, char *entry, unsigned long *size)
 }
 
 
+/**
+******************************************************************************
+* GetLoggerRange - read several log book entries
+*
+* @param    first:in				index of the first entry, 0: latest entry
+* @param    count:in				max. number of entries
+* @param    arena:in				buffer for the entries, NULL: buffer of LOGGER_ARENA_SIZE
+* @param    arenaSize:in			size of arena in byte
+* @param    callback:in				gets every entry, may be NULL
+* @param    ctx:in					context passed to the callback
+* @param    exportFile:in			binary export of the entries, NULL: no export
+*
+* @return   errorCode
+* @remarks	the callback is called in the context of the caller with m_mutex
+*			locked. See LoggerFileHeader for the format of the export.
+******************************************************************************
+*/
+short Lars::GetLoggerRange(const short first, const short count, char *arena, unsigned long arenaSize, AdcLoggerCallback callback, void *ctx, const char *exportFile)
+{
+	short				errorCode;
+	vector<char>		buffer;
+	ofstream			file;
+	LoggerFileHeader	header;
+	LoggerRecord		record;
+
+	if ((first < 0) || (count <= 0) || (arena && !arenaSize))
+		return LarsErr::E_INVALID_PARAMETER;
+
+	if (!arena)
+	{
+		buffer.resize(LOGGER_ARENA_SIZE);
+		arena = &buffer[0];
+		arenaSize = LOGGER_ARENA_SIZE;
+	}
+
+	memset(&header, 0, sizeof(header));
+	header.magic = LOGGER_MAGIC;
+	header.version = LOGGER_VERSION;
+	header.exportTime = (long long)time(NULL);
+
+	if (exportFile && exportFile[0])
+	{
+		file.open(exportFile, ios::binary | ios::trunc);
+		if (!file.is_open())
+			return LarsErr::E_FILE_NOT_FOUND;
+
+		// the entry count is written at the end
+		file.write((const char *)&header, sizeof(header));
+	}
+
+	m_mutex.lock();
+
+	errorCode = m_protocol->GetLoggerRange(first, count, arena, arenaSize, [&](const short index, const char *entry, const unsigned long size)
+	{
+		if (file.is_open())
+		{
+			memset(&record, 0, sizeof(record));
+			record.index = index;
+			record.size = (unsigned int)size;
+			file.write((const char *)&record, sizeof(record));
+			file.write(entry, size);
+			header.entryCount++;
+		}
+		if (callback)
+			callback(GetHandle(), index, entry, size, ctx);
+	});
+
+	m_mutex.unlock();
+
+	if (file.is_open())
+	{
+		file.seekp(0);
+		file.write((const char *)&header, sizeof(header));
+		file.close();
+
+		if (file.fail() && (errorCode == LarsErr::E_SUCCESS))
+			errorCode = LarsErr::E_FILE_NOT_FOUND;
+	}
+
+	return errorCode;
+}
+
+
 /**
 ******************************************************************************
 * GetRandomAuthentication - function to request the random value from adc
@@ -1730,6 +1920,100 @@ short Lars::ConfigureDiagnosticData(const AdcSensorHealth *sensorHealth)
 }
 
 
+/**
+******************************************************************************
+* GetDiagnosticSnapshot - function to get all diagnostic data with one request
+*
+* @param    name:in				if name == EmptyString the function give all diagnostic values
+* @param    sensorHealth:out	diagnostic values, sorted by name
+* @param    count:in/out		in: size of sensorHealth, out: number of records
+*
+* @return   errorCode
+* @remarks	E_NOT_ENOUGH_MEMORY: sensorHealth is too small, count is the
+*			required size
+******************************************************************************
+*/
+short Lars::GetDiagnosticSnapshot(const char *name, AdcSensorHealth *sensorHealth, short *count)
+{
+	short							errorCode;
+	short							idx = 0;
+	map<string, AdcSensorHealth>	mapSensorHealth;
+
+	if (!count || ((*count > 0) && !sensorHealth))
+		return LarsErr::E_INVALID_PARAMETER;
+
+	m_mutex.lock();
+	errorCode = m_protocol->GetDiagnosticData(name, mapSensorHealth);
+	m_mutex.unlock();
+
+	if (errorCode != LarsErr::E_SUCCESS)
+		return errorCode;
+
+	if (mapSensorHealth.size() > (size_t)*count)
+	{
+		*count = (short)mapSensorHealth.size();
+		return LarsErr::E_NOT_ENOUGH_MEMORY;
+	}
+
+	for (map<string, AdcSensorHealth>::const_iterator it = mapSensorHealth.begin(); it != mapSensorHealth.end(); ++it)
+		sensorHealth[idx++] = (*it).second;
+	*count = idx;
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* StartDiagnosticSampler - read the diagnostic data periodically
+*
+* @param    interval:in		sample interval in ms
+*
+* @return   errorCode
+* @remarks	the sampler thread reads with GetDiagnosticSnapshot, so it is
+*			serialized with all other requests by m_mutex
+******************************************************************************
+*/
+short Lars::StartDiagnosticSampler(const unsigned long interval)
+{
+	return m_diagnosticSampler->Start(interval);
+}
+
+
+/**
+******************************************************************************
+* StopDiagnosticSampler - stop the diagnostic sampler
+*
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short Lars::StopDiagnosticSampler()
+{
+	m_diagnosticSampler->Stop();
+
+	return LarsErr::E_SUCCESS;
+}
+
+
+/**
+******************************************************************************
+* GetDiagnosticSample - latest snapshot of the diagnostic sampler
+*
+* @param    sensorHealth:out	diagnostic values, sorted by name
+* @param    count:in/out		in: size of sensorHealth, out: number of records
+* @param    age:out				ms since the snapshot was read, may be NULL
+*
+* @return   errorCode of the latest sample
+* @remarks	no request is sent to the adc
+******************************************************************************
+*/
+short Lars::GetDiagnosticSample(AdcSensorHealth *sensorHealth, short *count, unsigned long *age)
+{
+	return m_diagnosticSampler->GetSample(sensorHealth, count, age);
+}
+
+
 /**
 ******************************************************************************
 * CreateNewSensorHealthID - function to create a new sensor health id
@@ -1749,7 +2033,7 @@ long Lars::CreateNewSensorHealthID()
 	else
 	{
 		// get id from last entry
-		map<long, map<string, AdcSensorHealth>>::iterator it = m_sensorHealth.end();
+		map<long, map<string, AdcSensorHealth>>::reverse_iterator it = m_sensorHealth.rbegin();
 
 		sensorID = (*it).first;
 
@@ -1759,7 +2043,7 @@ long Lars::CreateNewSensorHealthID()
 			sensorID = 1;
 
 		// check if ID is free
-		if (m_sensorHealth.find(sensorID) == m_sensorHealth.end())
+		if (m_sensorHealth.find(sensorID) != m_sensorHealth.end())
 			sensorID = INVALID_SENSOR_ID;
 	}
 
@@ -1997,7 +2281,6 @@ short Lars::GetCompatibleLoadCapacities(char *loadCapacities, unsigned long *siz
 short Lars::GetCompatibleLoadCapacities(const char *country, char *loadCapacities, unsigned long *size)
 {
 	short                       errorCode = LarsErr::E_SUCCESS;
-	CountrySettings				cySettings;
 	CountrySettings::loadCapacity   loadCapacityMap;
 	stringstream                outStream;
 	bool						bFirstRun;
@@ -2020,13 +2303,12 @@ short Lars::GetCompatibleLoadCapacities(const char *country, char *loadCapacitie
 	}
 	else
 	{
-		if ((errorCode = cySettings.SetCountry(country, m_cySetting.GetPath())) != LarsErr::E_SUCCESS)
+		// served from the country index, the file is decrypted only when it has changed
+		if ((errorCode = g_adcCountryIndex.GetLoadCapacities(m_cySetting.GetPath(), country, loadCapacityMap)) != LarsErr::E_SUCCESS)
 		{
 			m_mutex.unlock();
 			return errorCode;
 		}
-
-		cySettings.GetCompatibleLoadCapacities(loadCapacityMap);
 	}
 
 	// convert to user format
@@ -2182,96 +2464,167 @@ void Lars::SetFirmwarePath(const char *path)
 ******************************************************************************
 * Update - function to update the adc
 *
-* @param    directory:in	directory of the firmware files
 * @param    force:in		0: check parameter if update is possible
 *							1: no check, always execute update
+* @param    window:in		max. firmware blocks without response, 0: one block at a time
+* @param    callback:in		progress callback, may be NULL
+* @param    ctx:in			context passed to the callback
 *
 * @return   errorCode
-* @remarks
+* @remarks	the firmware file is authenticated by Open, the blocks are
+*			decrypted while they are downloaded
 ******************************************************************************
 */
-short Lars::Update(const short force)
+short Lars::Update(const short force, const short window, AdcUpdateProgressCallback callback, void *ctx)
 {
 	short		errorCode = LarsErr::E_SUCCESS;
 	AdcFirmware firmware;
-	AdcFrmData	frmData;
-	unsigned long pos;
-	bool		sendData;
 	
 	m_mutex.lock();
 
-	errorCode = firmware.LoadFile(m_firmwarePath, m_adcType);
-	if ((errorCode == LarsErr::E_FILE_NOT_FOUND) && ((m_adcType == "ADC505") || (m_adcType == "ADW505")))
-	{
-		// file not found, try again with the compatible adctype
-		string tmpAdcType;
-		if (m_adcType == "ADC505") tmpAdcType = "ADW505";
-		else tmpAdcType = "ADC505";
-
-		errorCode = firmware.LoadFile(m_firmwarePath, tmpAdcType);
-	}
+	errorCode = OpenFirmware(firmware, false);
 
 	if (errorCode == LarsErr::E_SUCCESS)
 	{
-		// send start download command
-		string usbStackVersion = firmware.GetUsbStackVersion();
-		string welmecStructureVersion = firmware.GetWelmecStructureVersion();
-		errorCode = m_protocol->FirmwareUpdate(ADC_FRMUPDATE_START, NULL, &usbStackVersion, &welmecStructureVersion, force);
+		errorCode = DownloadFirmware(firmware, force, window, callback, ctx);
+	}
 
-		if (errorCode == LarsErr::E_SUCCESS)
-		{
-			// write new firmware
-			pos = 0;
-			while (firmware.GetData(pos, &frmData))
-			{
-				// send only data package != 0xFF
-				sendData = false;
-				for (short idx = 0; idx < frmData.len; idx++)
-				{
-					if (frmData.data[idx] != 0xFF)
-					{
-						sendData = true;
-						break;
-					}
-				}
-				if (sendData == true)
-				{
-					if ((errorCode = m_protocol->FirmwareUpdate(ADC_FRMUPDATE_WRITE_DATA, &frmData)) != LarsErr::E_SUCCESS)
-					{
-						if ((m_bootLoaderVersion < 1.05) && ((frmData.startAdr + frmData.len - 1) >= 0xFFFF9F00) && ((frmData.startAdr + frmData.len - 1) <= 0xFFFF9FFF))
-						{
-							// bugfix for bootloader < 1.05
-							// only check errorCode for data not written to flash block [0xFFFF9F00 - 0xFFFF9FFF], ignore errorCode for data written to flash block [0xFFFF9F00 - 0xFFFF9FFF] 
-							errorCode = LarsErr::E_SUCCESS;
-						}
-						else
-						{
-							break;
-						}
-					}
-				}
-				pos += frmData.len;
-			}
-		}
+	m_mutex.unlock();
 
-		if (errorCode == LarsErr::E_SUCCESS)
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* UpdateMany - update several adc at the same time
+*
+* @param    lars:in			adc in bootloader mode, NULL entries are skipped
+* @param    count:in		number of adc
+* @param    force:in		0: check parameter if update is possible
+*							1: no check, always execute update
+* @param    callback:in		progress callback, may be NULL
+* @param    ctx:in			context passed to the callback
+* @param    errorCodes:out	errorCode of every adc, unchanged for NULL entries
+*
+* @return   void
+* @remarks	every firmware file is decrypted once to an image, all adc with
+*			the same file download this image. The downloads run on up to
+*			UPDATE_MAX_WORKERS threads, the callback is called by these
+*			threads. An error of one adc does not stop the others.
+******************************************************************************
+*/
+void Lars::UpdateMany(Lars *const *lars, const short count, const short force, AdcUpdateProgressCallback callback, void *ctx, short *errorCodes)
+{
+	map<string, pair<short, shared_ptr<const AdcFirmware>>>	firmwares;
+	vector<shared_ptr<const AdcFirmware>>	deviceFirmware(count);
+	vector<thread>		workers;
+	atomic<short>		next(0);
+	string				firmwareFile;
+
+	// load every firmware file once
+	for (short idx = 0; idx < count; idx++)
+	{
+		if (!lars[idx])
+			continue;
+
+		lars[idx]->m_mutex.lock();
+		firmwareFile = lars[idx]->m_firmwarePath + "/" + lars[idx]->m_adcType;
+		auto it = firmwares.find(firmwareFile);
+		if (it == firmwares.end())
 		{
-			// send end download command
-			errorCode = m_protocol->FirmwareUpdate(ADC_FRMUPDATE_END, NULL);
+			shared_ptr<AdcFirmware> firmware = make_shared<AdcFirmware>();
+			short errorCode = lars[idx]->OpenFirmware(*firmware, true);
+
+			it = firmwares.insert(make_pair(firmwareFile, make_pair(errorCode, (errorCode == LarsErr::E_SUCCESS) ? firmware : nullptr))).first;
 		}
-		else
+		lars[idx]->m_mutex.unlock();
+
+		errorCodes[idx] = it->second.first;
+		deviceFirmware[idx] = it->second.second;
+	}
+
+	// the workers take the next adc until all are done
+	for (short idx = 0; (idx < count) && (idx < UPDATE_MAX_WORKERS); idx++)
+	{
+		workers.push_back(thread([&]()
 		{
-			// error occured, send cancel download command
-			m_protocol->FirmwareUpdate(ADC_FRMUPDATE_CANCEL, NULL);
-		}
+			short device;
+
+			while ((device = next.fetch_add(1)) < count)
+			{
+				if (!lars[device] || !deviceFirmware[device])
+					continue;
+
+				lars[device]->m_mutex.lock();
+				errorCodes[device] = lars[device]->DownloadFirmware(*deviceFirmware[device], force, 0, callback, ctx);
+				lars[device]->m_mutex.unlock();
+			}
+		}));
 	}
 
-	m_mutex.unlock();
+	for (size_t idx = 0; idx < workers.size(); idx++)
+		workers[idx].join();
+}
+
+
+/**
+******************************************************************************
+* OpenFirmware - open the firmware file of the adc type
+*
+* @param    firmware:out	firmware
+* @param    loadImage:in	true: decrypt to an image that can be shared
+*							false: keep the encrypted file, see AdcFirmware::Open
+*
+* @return   errorCode
+* @remarks	ADC505 and ADW505 use the file of the other type if their own file
+*			is not found. m_mutex must be locked.
+******************************************************************************
+*/
+short Lars::OpenFirmware(AdcFirmware &firmware, const bool loadImage)
+{
+	short		errorCode;
+
+	errorCode = loadImage ? firmware.LoadFile(m_firmwarePath, m_adcType) : firmware.Open(m_firmwarePath, m_adcType);
+	if ((errorCode == LarsErr::E_FILE_NOT_FOUND) && ((m_adcType == "ADC505") || (m_adcType == "ADW505")))
+	{
+		// file not found, try again with the compatible adctype
+		string tmpAdcType;
+		if (m_adcType == "ADC505") tmpAdcType = "ADW505";
+		else tmpAdcType = "ADC505";
+
+		errorCode = loadImage ? firmware.LoadFile(m_firmwarePath, tmpAdcType) : firmware.Open(m_firmwarePath, tmpAdcType);
+	}
 
 	return errorCode;
 }
 
 
+/**
+******************************************************************************
+* DownloadFirmware - download an opened firmware to the adc
+*
+* @param    firmware:in		firmware, may be used by other adc at the same time
+* @param    force:in		0: check parameter if update is possible
+*							1: no check, always execute update
+* @param    window:in		max. firmware blocks without response, 0: one block at a time
+* @param    callback:in		progress callback, may be NULL
+* @param    ctx:in			context passed to the callback
+*
+* @return   errorCode
+* @remarks	m_mutex must be locked
+******************************************************************************
+*/
+short Lars::DownloadFirmware(const AdcFirmware &firmware, const short force, const short window, AdcUpdateProgressCallback callback, void *ctx)
+{
+	return firmware.Download(m_protocol, force, window, m_bootLoaderVersion, [&](unsigned long written, unsigned long total)
+	{
+		if (callback)
+			callback(GetHandle(), written, total, ctx);
+	});
+}
+
+
 /**
 ******************************************************************************
 * GetFirmwareFileVersion - get the version of the firmware file
@@ -2854,3 +3207,266 @@ short Lars::GetPortNr(char *portNr, unsigned long *size)
 
 	return errorCode;
 }
+
+
+/**
+******************************************************************************
+* StartWeightStream - subscribe to the continuous weight stream
+*
+* @param    interval:in		poll interval in ms
+* @param    callback:in		called with adc state, weight and tare of every read
+* @param    ctx:in			context passed to the callback
+*
+* @return   errorCode
+* @remarks	the stream thread reads with ReadWeight, so it is serialized with
+*			all other requests by m_mutex
+******************************************************************************
+*/
+short Lars::StartWeightStream(const unsigned long interval, AdcWeightStreamCallback callback, void *ctx)
+{
+	return m_weightStream->Subscribe(interval, callback, ctx);
+}
+
+
+/**
+******************************************************************************
+* StopWeightStream - unsubscribe from the weight stream
+*
+* @param    callback:in		callback of StartWeightStream
+* @param    ctx:in			context of StartWeightStream
+*
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short Lars::StopWeightStream(AdcWeightStreamCallback callback, void *ctx)
+{
+	return m_weightStream->Unsubscribe(callback, ctx);
+}
+
+
+/**
+******************************************************************************
+* StartReadWeight - send the read weight request without waiting
+*
+* @param    busy:out		true: another request is running, nothing is sent
+*
+* @return   errorCode
+* @remarks	on success the request is marked in m_mutex until ContinueReadWeight
+*			is done or CancelReadWeight is called, blocking calls wait for it.
+*			m_mutex itself is not held between the reactor cycles, see AdcReactor
+******************************************************************************
+*/
+short Lars::StartReadWeight(bool *busy)
+{
+	short errorCode;
+
+	*busy = !m_mutex.TryBeginAsync();
+	if (*busy)
+		return LarsErr::E_SUCCESS;
+
+	if ((errorCode = m_protocol->StartReadWeight(0)) != LarsErr::E_SUCCESS)
+		m_mutex.EndAsync();
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* ContinueReadWeight - receive the response of StartReadWeight as far as possible
+*
+* @param    done:out		true: request is finished, the mark in m_mutex is removed
+* @param    deadline:out	latest time of the next call if not done
+* @param    adcState:out	state of the adc
+* @param    weight:out		current weight
+* @param    tare:out		current tare
+*
+* @return   errorCode of ReadWeight if done
+* @remarks	never waits, call it when GetPollFd is readable
+******************************************************************************
+*/
+short Lars::ContinueReadWeight(bool *done, chrono::steady_clock::time_point *deadline, AdcState *adcState, AdcWeight *weight, AdcTare *tare)
+{
+	short errorCode;
+
+	errorCode = m_protocol->ContinueRequest(done, deadline);
+	if (!*done)
+		return errorCode;
+
+	errorCode = m_protocol->DecodeReadWeight(errorCode, adcState, weight, tare, NULL, NULL);
+	errorCode = CompleteReadWeight(errorCode, adcState, weight, tare, NULL, NULL);
+
+	m_mutex.EndAsync();
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* CancelReadWeight - give up the request of StartReadWeight
+*
+* @return   void
+* @remarks	removes the mark in m_mutex. Called by the reactor thread, that
+*			started the request, see AdcWeightStream::OnRemove
+******************************************************************************
+*/
+void Lars::CancelReadWeight()
+{
+	m_protocol->CancelRequest();
+
+	m_mutex.EndAsync();
+}
+
+
+/**
+******************************************************************************
+* GetPollFd - file descriptor that is readable when the adc has sent data
+*
+* @return   file descriptor, -1: the interface can't be polled
+* @remarks
+******************************************************************************
+*/
+int Lars::GetPollFd()
+{
+	return m_interface ? m_interface->GetPollFd() : -1;
+}
+
+
+/**
+******************************************************************************
+* SharedPollCallback - subscriber of the weight stream for the shared memory
+*
+* @remarks	the snapshot is written by ReadWeight, this subscription only
+*			keeps the device polled
+******************************************************************************
+*/
+static void SharedPollCallback(const short handle, const short retCode, const AdcState *adcState, const AdcWeight *weight, const AdcTare *tare, void *ctx)
+{
+}
+
+
+/**
+******************************************************************************
+* PublishShared - publish the weight to a shared memory segment
+*
+* @param    name:in			segment name, NULL: stop publishing
+* @param    interval:in		poll interval in ms, 0: publish only the reads of the application
+*
+* @return   errorCode
+* @remarks	every ReadWeight updates the snapshot, see AdcShared
+******************************************************************************
+*/
+short Lars::PublishShared(const char *name, const unsigned long interval)
+{
+	short errorCode = LarsErr::E_SUCCESS;
+
+	// stop polling for a previous segment, outside m_mutex because it waits for running callbacks
+	m_weightStream->Unsubscribe(SharedPollCallback, this);
+
+	m_mutex.lock();
+	if (name)
+		errorCode = m_shared.Create(name);
+	else
+		m_shared.Close();
+	m_mutex.unlock();
+
+	if ((errorCode == LarsErr::E_SUCCESS) && name && interval)
+		errorCode = m_weightStream->Subscribe(interval, SharedPollCallback, this);
+
+	return errorCode;
+}
+
+
+/**
+******************************************************************************
+* DumpFlightRecorder - write the last telegrams to a binary file
+*
+* @param    fileName:in		path of the dump file
+*
+* @return   errorCode
+* @remarks	without m_mutex, so a hanging request can be analyzed
+******************************************************************************
+*/
+short Lars::DumpFlightRecorder(const char *fileName)
+{
+	return m_protocol->DumpFlightRecorder(fileName);
+}
+
+
+/**
+******************************************************************************
+* SetFlightRecorderAutoDump - dump the last telegrams on protocol errors
+*
+* @param    fileName:in		path of the dump file, NULL: no automatic dump
+*
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short Lars::SetFlightRecorderAutoDump(const char *fileName)
+{
+	return m_protocol->SetFlightRecorderAutoDump(fileName);
+}
+
+
+/**
+******************************************************************************
+* GetStatistics - counters and latencies of the rbs commands
+*
+* @param    statistics:out	array of *count entries
+* @param    count:in/out	in: size of the array, out: number of commands
+*
+* @return   errorCode
+* @remarks	without m_mutex, the counters are lock free
+******************************************************************************
+*/
+short Lars::GetStatistics(AdcCommandStatistics *statistics, short *count)
+{
+	return m_protocol->GetStatistics(statistics, count);
+}
+
+
+short Lars::ResetStatistics()
+{
+	return m_protocol->ResetStatistics();
+}
+
+
+/**
+******************************************************************************
+* WriteStatistics - write the statistics in the Prometheus text format
+*
+* @param    fileName:in		path of the file
+*
+* @return   errorCode
+* @remarks	the port of the adc is the port label of the metrics
+******************************************************************************
+*/
+short Lars::WriteStatistics(const char *fileName)
+{
+	return m_protocol->WriteStatistics(fileName, m_adcName);
+}
+
+
+/**
+******************************************************************************
+* SetRegisterCache - switch the cache of the scale values
+*
+* @param    enable:in		false: every getter reads the scale values from the adc
+*
+* @return   errorCode
+* @remarks
+******************************************************************************
+*/
+short Lars::SetRegisterCache(const bool enable)
+{
+	short	errorCode;
+
+	m_mutex.lock();
+	errorCode = m_protocol->SetRegisterCache(enable);
+	m_mutex.unlock();
+
+	return errorCode;
+}
@@ -0,0 +1,232 @@
+/**
+******************************************************************************
+* File       : larstable.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : larstable class: handle table of all open adc
+******************************************************************************
+*/
+#include <thread>
+#include <chrono>
+#include "larsErr.h"
+#include "lars.h"
+#include "larstable.h"
+
+
+LarsTable::LarsTable()
+{
+	for (short idx = 0; idx < MAX_HANDLES; idx++)
+	{
+		m_slots[idx].lars = NULL;
+		m_slots[idx].generation = 0;
+		m_slots[idx].refCount = 0;
+	}
+}
+
+LarsTable::~LarsTable()
+{
+}
+
+
+/**
+******************************************************************************
+* Insert - add an open adc to the table
+*
+* @param    lars:in			adc
+* @param    handle:out		logical handle for the application
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_NOT_ENOUGH_MEMORY	MAX_HANDLES adc are open
+* @remarks	the generation of the slot is part of the handle, so a handle of a
+*			closed adc does not match the next adc in the same slot. The adc
+*			gets its handle before it can be found by Acquire.
+******************************************************************************
+*/
+short LarsTable::Insert(Lars *lars, short *handle)
+{
+	unsigned short	generation;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	for (short idx = 0; idx < MAX_HANDLES; idx++)
+	{
+		Slot &slot = m_slots[idx];
+
+		// slot of a closing adc is still occupied
+		if ((slot.generation.load() & 1) || slot.lars.load())
+			continue;
+
+		generation = slot.generation.load() + 1;
+		*handle = (short)(((generation & GENERATION_MASK) << SLOT_BITS) | idx);
+		lars->SetHandle(*handle);
+
+		slot.lars.store(lars);
+		slot.generation.fetch_add(1);
+		return LarsErr::E_SUCCESS;
+	}
+
+	return LarsErr::E_NOT_ENOUGH_MEMORY;
+}
+
+
+/**
+******************************************************************************
+* Remove - remove an adc from the table
+*
+* @param    handle:in		logical handle
+*
+* @return   adc, NULL: invalid handle
+* @remarks	the handle is invalid immediately, then the function waits until
+*			all running calls have released the adc. The caller owns the adc.
+******************************************************************************
+*/
+Lars *LarsTable::Remove(const short handle)
+{
+	Lars	*lars;
+
+	if (handle <= 0)
+		return NULL;
+
+	Slot &slot = m_slots[handle & SLOT_MASK];
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		if (!(slot.generation.load() & 1) ||
+			((slot.generation.load() & GENERATION_MASK) != (handle >> SLOT_BITS)))
+		{
+			return NULL;
+		}
+
+		// no new references from now on
+		slot.generation.fetch_add(1);
+		lars = slot.lars.load();
+	}
+
+	while (slot.refCount.load() != 0)
+		this_thread::sleep_for(chrono::milliseconds(1));
+
+	slot.lars.store(NULL);
+
+	return lars;
+}
+
+
+/**
+******************************************************************************
+* Acquire - get a reference to an open adc
+*
+* @param    handle:in		logical handle
+*
+* @return   reference, NULL: invalid handle
+* @remarks	lock free, the adc can't be deleted while the reference exists
+******************************************************************************
+*/
+LarsRef LarsTable::Acquire(const short handle)
+{
+	unsigned short	generation;
+	Lars			*lars;
+
+	if (handle <= 0)
+		return LarsRef();
+
+	Slot &slot = m_slots[handle & SLOT_MASK];
+
+	// take the reference before the check, Remove invalidates first and then waits
+	slot.refCount.fetch_add(1);
+
+	generation = slot.generation.load();
+	lars = slot.lars.load();
+	if (!(generation & 1) || ((generation & GENERATION_MASK) != (handle >> SLOT_BITS)) || !lars)
+	{
+		slot.refCount.fetch_sub(1);
+		return LarsRef();
+	}
+
+	return LarsRef(this, handle, lars);
+}
+
+
+void LarsTable::Release(const short handle)
+{
+	m_slots[handle & SLOT_MASK].refCount.fetch_sub(1);
+}
+
+
+/**
+******************************************************************************
+* IsOpen - check if an adc is already in the table
+*
+* @param    adcName:in		adc identification
+*
+* @return   true: adc is already open
+* @remarks
+******************************************************************************
+*/
+bool LarsTable::IsOpen(const string &adcName)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	for (short idx = 0; idx < MAX_HANDLES; idx++)
+	{
+		Lars *lars = m_slots[idx].lars.load();
+
+		if ((m_slots[idx].generation.load() & 1) && lars && (*(lars->GetAdcName()) == adcName))
+			return true;
+	}
+
+	return false;
+}
+
+
+LarsRef::LarsRef()
+{
+	m_table = NULL;
+	m_handle = 0;
+	m_lars = NULL;
+}
+
+LarsRef::LarsRef(LarsTable *table, const short handle, Lars *lars)
+{
+	m_table = table;
+	m_handle = handle;
+	m_lars = lars;
+}
+
+LarsRef::LarsRef(LarsRef &&ref)
+{
+	m_table = ref.m_table;
+	m_handle = ref.m_handle;
+	m_lars = ref.m_lars;
+	ref.m_lars = NULL;
+}
+
+LarsRef::~LarsRef()
+{
+	Release();
+}
+
+LarsRef &LarsRef::operator=(LarsRef &&ref)
+{
+	if (this != &ref)
+	{
+		Release();
+		m_table = ref.m_table;
+		m_handle = ref.m_handle;
+		m_lars = ref.m_lars;
+		ref.m_lars = NULL;
+	}
+	return *this;
+}
+
+void LarsRef::Release()
+{
+	if (m_lars)
+	{
+		m_table->Release(m_handle);
+		m_lars = NULL;
+	}
+}
@@ -6,7 +6,6 @@
 #include "helpers.h"
 #include "larsErr.h"
 #include "adctrace.h"
-#include "crypto.h"
 #include "loadcapacity.h"
 #include "adcrbs.h"
 
@@ -53,8 +52,7 @@ LoadCapacity::~LoadCapacity()
 short LoadCapacity::Set(const string &loadCapacity, const string &fileName, const string &path, const map<string, string> *regParamMap)
 {
     short   errorCode;
-    Crypto  cryptVar;
-    string  fileContent;
+    shared_ptr<const AdcFileCache::Content> fileContent;
 
 	if (path.empty())
 		m_fileName = fileName;
@@ -62,8 +60,8 @@ short LoadCapacity::Set(const string &loadCapacity, const string &fileName, cons
 		m_fileName = path + "/" + fileName;
 
 
-    // read and decrypt country settings file
-	errorCode = cryptVar.ReadEncryptedFile(m_fileName, fileContent);
+    // read and decrypt load capacity file, other adc with the same load capacity share it
+	errorCode = g_adcFileCache.Read(m_fileName, fileContent);
     if (errorCode != LarsErr::E_SUCCESS)
     {
 		if (loadCapacity == GetLoadCapacity()) errorCode = LarsErr::E_SUCCESS;
@@ -71,7 +69,7 @@ short LoadCapacity::Set(const string &loadCapacity, const string &fileName, cons
     }
 
     // parse load capacity file
-	Parse(fileContent, loadCapacity, regParamMap);
+	Parse(*fileContent, loadCapacity, regParamMap);
 
 	// create the calibration strings
 	BuildCalStrings();
@@ -94,50 +92,19 @@ void LoadCapacity::SetSettings(const map<string, string> &lcSettingsMap)
 }
 
 
-bool LoadCapacity::Parse(string &fileContent, const string &loadCapacity, const map<string, string> *regParamMap)
+bool LoadCapacity::Parse(const AdcFileCache::Content &content, const string &loadCapacity, const map<string, string> *regParamMap)
 {
-    string  oneRow;
-    size_t  endPos = 0;
-    size_t  pos1 = 0;
-	size_t	offset;
-
 	m_lcSettings.clear();
 
-    // remove all CR from string
-    RemoveCR(fileContent);
-
-    // always skip first line
-    endPos = fileContent.find('\n');
-	if (endPos == string::npos)
-	{
-		endPos = fileContent.size();
-	}
-    oneRow = fileContent.substr(0, endPos);
-    fileContent = fileContent.substr(endPos + 1);
-
-    // parse rest of file
-    while (!fileContent.empty())
+    // always skip first line, parse rest of file
+    for (AdcFileCache::Content::const_iterator oneRow = content.begin() + (content.empty() ? 0 : 1); oneRow != content.end(); ++oneRow)
     {
-        endPos = fileContent.find('\n');
-		if (endPos == string::npos)
-		{
-			// no \n in string
-			endPos = fileContent.size();
-			offset = 0;
-		}
-		else
-		{
-			offset = 1;
-		}
-        oneRow = fileContent.substr(0, endPos);
-
-        if (!oneRow.empty())
+        if (oneRow->keyValue || !oneRow->key.empty())
         {
-            pos1 = oneRow.find('=');
-			if (pos1 != string::npos)
+			if (oneRow->keyValue)
 			{
-				m_lcSettings[oneRow.substr(0, pos1)] = oneRow.substr(pos1 + 1);
-				if (oneRow.substr(0, pos1) == "teilSchritt[0]|INT")
+				m_lcSettings[oneRow->key] = oneRow->value;
+				if (oneRow->key == "teilSchritt[0]|INT")
 				{
 					// if we had read e call SetRegistrationParameters to set the parameters
 					SetRegistrationParameters(regParamMap);
@@ -146,26 +113,12 @@ bool LoadCapacity::Parse(string &fileContent, const string &loadCapacity, const
             else
 				g_adcTrace.Trace(AdcTrace::TRC_ERROR_WARNING, "%s\terror parsing load capacity settings for %s -> wrong format", __FUNCTION__, loadCapacity.c_str());
         }
-        fileContent = fileContent.substr(endPos + offset);		// add offset because of \n
     }
 
     return true;
 }
 
 
-void LoadCapacity::RemoveCR(string &str)
-{
-    size_t  pos = 0;
-    // first remove all \n
-    do
-    {
-        pos = str.find('\r', pos);
-        if (pos != string::npos) str.erase(pos, 1);
-    } while (pos != string::npos);
-
-}
-
-
 string LoadCapacity::MaxString()
 {
 	return m_maxStr;
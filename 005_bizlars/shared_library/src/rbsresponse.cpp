@@ -0,0 +1,483 @@
+/**
+******************************************************************************
+* File       : rbsresponse.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : rbsresponse class: parse rbs telegrams in place without copies
+******************************************************************************
+*/
+#include <string.h>
+#include <limits.h>
+#include "lars.h"
+#include "larsErr.h"
+#include "rbsresponse.h"
+
+
+static const RbsField emptyField = { "", 0 };
+
+
+/**
+******************************************************************************
+* Equals - compare the field with a string
+*
+* @param    str:in			string to compare
+*
+* @return   true: field and string are equal
+* @remarks
+******************************************************************************
+*/
+bool RbsField::Equals(const string &str) const
+{
+	return (str.size() == size) && !memcmp(str.data(), data, size);
+}
+
+
+/**
+******************************************************************************
+* Position - get one element of a structured value
+*
+* @param    pos:in			position, the elements are separated by ESC
+*
+* @return   element, empty if the value has less elements
+* @remarks	same elements as ParseStructure stores in pos0..posN
+******************************************************************************
+*/
+RbsField RbsField::Position(short pos) const
+{
+	const char	*begin = data;
+	const char	*end = data + size;
+	const char	*next;
+	RbsField	field = emptyField;
+
+	while (pos-- > 0)
+	{
+		if ((next = (const char *)memchr(begin, Lars::ESC, end - begin)) == NULL)
+			return field;
+		begin = next + 1;
+	}
+
+	if ((next = (const char *)memchr(begin, Lars::ESC, end - begin)) == NULL)
+		next = end;
+
+	field.data = begin;
+	field.size = next - begin;
+	return field;
+}
+
+
+/**
+******************************************************************************
+* GetLongLong - decode a decimal number
+*
+* @param    value:out		number
+*
+* @return   false: field does not start with a number or number out of range
+* @remarks	leading white space and trailing characters are ignored like
+*			stream extraction does
+******************************************************************************
+*/
+bool RbsField::GetLongLong(long long *value) const
+{
+	unsigned long		idx = 0;
+	bool				negative = false;
+	unsigned long long	number;
+
+	while ((idx < size) && ((data[idx] == ' ') || (data[idx] == '\t')))
+		idx++;
+
+	if ((idx < size) && ((data[idx] == '-') || (data[idx] == '+')))
+		negative = (data[idx++] == '-');
+
+	RbsField digits = { data + idx, size - idx };
+	if (!digits.GetULongLong(&number))
+		return false;
+
+	if (negative)
+	{
+		if (number > (unsigned long long)LLONG_MAX + 1)
+			return false;
+		*value = (long long)(0 - number);
+	}
+	else
+	{
+		if (number > (unsigned long long)LLONG_MAX)
+			return false;
+		*value = (long long)number;
+	}
+
+	return true;
+}
+
+
+bool RbsField::GetULongLong(unsigned long long *value) const
+{
+	unsigned long		idx = 0;
+	unsigned long long	number = 0;
+	unsigned long		digits = 0;
+
+	while ((idx < size) && ((data[idx] == ' ') || (data[idx] == '\t')))
+		idx++;
+
+	if ((idx < size) && (data[idx] == '+'))
+		idx++;
+
+	// decimal coding, see AdcRbs::m_base
+	for (; (idx < size) && (data[idx] >= '0') && (data[idx] <= '9'); idx++, digits++)
+	{
+		unsigned long long digit = data[idx] - '0';
+
+		if (number > (ULLONG_MAX - digit) / 10)
+			return false;
+		number = number * 10 + digit;
+	}
+
+	if (!digits)
+		return false;
+
+	*value = number;
+	return true;
+}
+
+
+bool RbsField::GetShort(short *value) const
+{
+	long long number;
+
+	if (!GetLongLong(&number) || (number < SHRT_MIN) || (number > SHRT_MAX))
+		return false;
+
+	*value = (short)number;
+	return true;
+}
+
+
+bool RbsField::GetUShort(unsigned short *value) const
+{
+	unsigned long long number;
+
+	if (!GetULongLong(&number) || (number > USHRT_MAX))
+		return false;
+
+	*value = (unsigned short)number;
+	return true;
+}
+
+
+/**
+******************************************************************************
+* GetString - copy the field to a zero terminated string
+*
+* @param    str:out			destination
+* @param    strSize:in		size of str incl. zero termination
+*
+* @return   false: field does not fit, str is not changed
+* @remarks
+******************************************************************************
+*/
+bool RbsField::GetString(char *str, unsigned long strSize) const
+{
+	if (size + 1 > strSize)
+		return false;
+
+	memcpy(str, data, size);
+	str[size] = '\0';
+	return true;
+}
+
+
+RbsResponse::RbsResponse()
+{
+	Clear();
+}
+
+RbsResponse::~RbsResponse()
+{
+}
+
+
+/**
+******************************************************************************
+* Clear - forget the last parsed telegram
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void RbsResponse::Clear()
+{
+	m_telegram = emptyField.data;
+	m_size = 0;
+	m_headerCount = 0;
+	m_cmd = emptyField;
+	m_crc16 = emptyField;
+	m_fieldCount = 0;
+}
+
+
+/**
+******************************************************************************
+* Parse - split a full telegram into header, command, key value pairs and crc
+*
+* @param    telegram:in		telegram starting with SOH and ending with ETB
+* @param    size:in			size of the telegram
+*
+* @return   LarsErr::E_SUCCESS
+*			LarsErr::E_INVALID_PARAMETER	telegram is malformed
+*			LarsErr::E_NOT_ENOUGH_MEMORY	telegram has more than MAX_FIELDS keys
+* @remarks	no data is copied, all fields point into telegram, so the buffer
+*			must not change as long as the fields are used
+******************************************************************************
+*/
+short RbsResponse::Parse(const char *telegram, unsigned long size)
+{
+	enum { PARSE_HEADER, PARSE_COMMAND, PARSE_KEY, PARSE_VALUE, PARSE_CHECKSUM };
+
+	short			state = PARSE_HEADER;
+	unsigned long	begin = 1;
+	unsigned long	keyBegin = 0;
+	unsigned long	keyEnd = 0;
+	char			ch;
+
+	Clear();
+
+	if (!size || (telegram[0] != Lars::SOH))
+		return LarsErr::E_INVALID_PARAMETER;
+
+	for (unsigned long idx = 1; idx < size; idx++)
+	{
+		ch = telegram[idx];
+
+		switch (state)
+		{
+		case PARSE_HEADER:
+			// length, order ID and flags, separated by ESC, terminated by GS
+			if ((ch == Lars::ESC) || (ch == Lars::GS))
+			{
+				if (m_headerCount < MAX_HEADER_FIELDS)
+				{
+					m_header[m_headerCount].data = &telegram[begin];
+					m_header[m_headerCount].size = idx - begin;
+				}
+				m_headerCount++;
+				begin = idx + 1;
+
+				if (ch == Lars::GS) state = PARSE_COMMAND;
+			}
+			break;
+
+		case PARSE_COMMAND:
+			if ((ch == Lars::STX) || (ch == Lars::ETB) || (ch == Lars::GS))
+			{
+				if (idx == begin)
+				{
+					Clear();
+					return LarsErr::E_INVALID_PARAMETER;
+				}
+				m_cmd.data = &telegram[begin];
+				m_cmd.size = idx - begin;
+				begin = idx + 1;
+
+				if (ch == Lars::STX)
+				{
+					keyBegin = begin;
+					state = PARSE_KEY;
+				}
+				else if (ch == Lars::GS)
+				{
+					state = PARSE_CHECKSUM;
+				}
+				else
+				{
+					m_telegram = telegram;
+					m_size = idx + 1;
+					return LarsErr::E_SUCCESS;
+				}
+			}
+			break;
+
+		case PARSE_KEY:
+		case PARSE_VALUE:
+			if ((ch == Lars::FS) && (state == PARSE_KEY))
+			{
+				if (idx == keyBegin)
+				{
+					Clear();
+					return LarsErr::E_INVALID_PARAMETER;
+				}
+				keyEnd = idx;
+				begin = idx + 1;
+				state = PARSE_VALUE;
+			}
+			else if ((ch == Lars::GS) || (ch == Lars::ETX))
+			{
+				if (state == PARSE_KEY)
+				{
+					// key without value
+					keyEnd = idx;
+					begin = idx;
+				}
+
+				if (keyEnd > keyBegin)
+				{
+					if (m_fieldCount >= MAX_FIELDS)
+					{
+						Clear();
+						return LarsErr::E_NOT_ENOUGH_MEMORY;
+					}
+					m_key[m_fieldCount].data = &telegram[keyBegin];
+					m_key[m_fieldCount].size = keyEnd - keyBegin;
+					m_value[m_fieldCount].data = &telegram[begin];
+					m_value[m_fieldCount].size = idx - begin;
+					m_fieldCount++;
+				}
+
+				keyBegin = idx + 1;
+				begin = idx + 1;
+				state = (ch == Lars::GS) ? PARSE_KEY : PARSE_CHECKSUM;
+			}
+			break;
+
+		case PARSE_CHECKSUM:
+			if (ch == Lars::ETB)
+			{
+				if (idx > begin)
+				{
+					m_crc16.data = &telegram[begin];
+					m_crc16.size = idx - begin;
+				}
+				m_telegram = telegram;
+				m_size = idx + 1;
+				return LarsErr::E_SUCCESS;
+			}
+			break;
+		}
+	}
+
+	// ETB expected
+	Clear();
+	return LarsErr::E_INVALID_PARAMETER;
+}
+
+
+/**
+******************************************************************************
+* Find - search a key
+*
+* @param    key:in			key of the reference data
+*
+* @return   value of the key, NULL: key not found
+* @remarks	if a key is sent twice, the last value is used
+******************************************************************************
+*/
+const RbsField *RbsResponse::Find(const string &key) const
+{
+	for (short idx = m_fieldCount - 1; idx >= 0; idx--)
+	{
+		if (m_key[idx].Equals(key))
+			return &m_value[idx];
+	}
+
+	return NULL;
+}
+
+
+short RbsResponse::GetFieldCount() const
+{
+	return m_fieldCount;
+}
+
+
+const RbsField &RbsResponse::GetKey(short idx) const
+{
+	return m_key[idx];
+}
+
+
+const RbsField &RbsResponse::GetValue(short idx) const
+{
+	return m_value[idx];
+}
+
+
+/**
+******************************************************************************
+* GetHeader - get a header field
+*
+* @param    idx:in			IDX_LENGTH, IDX_ORDERID, 2.. flags
+*
+* @return   header field, NULL: not in telegram
+* @remarks
+******************************************************************************
+*/
+const RbsField *RbsResponse::GetHeader(short idx) const
+{
+	if ((idx < 0) || (idx >= m_headerCount) || (idx >= MAX_HEADER_FIELDS))
+		return NULL;
+
+	return &m_header[idx];
+}
+
+
+const RbsField &RbsResponse::GetCmd() const
+{
+	return m_cmd;
+}
+
+
+/**
+******************************************************************************
+* GetCrc16 - get the checksum of the telegram
+*
+* @return   checksum, NULL: telegram without checksum
+* @remarks
+******************************************************************************
+*/
+const RbsField *RbsResponse::GetCrc16() const
+{
+	return m_crc16.size ? &m_crc16 : NULL;
+}
+
+
+/**
+******************************************************************************
+* GetCrcRange - get the part of the telegram protected by the checksum
+*
+* @param    data:out		first ESC of the telegram
+* @param    size:out		size up to the last ETX, without user data up to the last GS
+*
+* @return   false: range not found
+* @remarks
+******************************************************************************
+*/
+bool RbsResponse::GetCrcRange(const char **data, unsigned long *size) const
+{
+	const char		*start;
+	unsigned long	end;
+
+	if ((start = (const char *)memchr(m_telegram, Lars::ESC, m_size)) == NULL)
+		return false;
+
+	// check if telegram contains user data
+	for (end = m_size; end > 0; end--)
+	{
+		if (m_telegram[end - 1] == Lars::ETX) break;
+	}
+	if (!end)
+	{
+		// no user data, get pos from last GS
+		for (end = m_size; end > 0; end--)
+		{
+			if (m_telegram[end - 1] == Lars::GS) break;
+		}
+	}
+
+	if (!end || (&m_telegram[end] <= start))
+		return false;
+
+	*data = start;
+	*size = &m_telegram[end] - start;
+	return true;
+}
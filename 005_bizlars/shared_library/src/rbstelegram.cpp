@@ -0,0 +1,226 @@
+/**
+******************************************************************************
+* File       : rbstelegram.cpp
+* Project    : BizLars
+* Date       : 17.10.2026
+* Author     : Thomas Buck, Sensor Technology
+* Copyright  : Bizerba GmbH & Co. KG
+*
+* Content    : rbstelegram class: build rbs telegrams in a preallocated buffer
+******************************************************************************
+*/
+#include <string.h>
+#include "lars.h"
+#include "rbstelegram.h"
+
+
+RbsTelegram::RbsTelegram() : m_crc16(RBS_CRC_START, RBS_CRC_POLY, RBS_CRC_MASK)
+{
+	m_start = MAX_LENGTH_DIGITS;
+	m_end = MAX_LENGTH_DIGITS;
+	m_refData = false;
+	m_overflow = false;
+	m_crc = m_crc16.InitCrc();
+	m_buffer[m_end] = '\0';
+}
+
+RbsTelegram::~RbsTelegram()
+{
+}
+
+
+/**
+******************************************************************************
+* Begin - start a new telegram, the previous content is discarded
+*
+* @param    orderID:in		order ID of the telegram
+* @param    flag:in			telegram flags, 0: no flags
+* @param    cmd:in			rbs command
+*
+* @return   void
+* @remarks  the telegram body starts behind the space reserved for SOH and length
+******************************************************************************
+*/
+void RbsTelegram::Begin(short orderID, unsigned long flag, const string &cmd)
+{
+	m_start = MAX_LENGTH_DIGITS;
+	m_end = MAX_LENGTH_DIGITS;
+	m_refData = false;
+	m_overflow = false;
+	m_crc = m_crc16.InitCrc();
+
+	Append(Lars::ESC);
+	AppendNumber(orderID);
+
+	if (flag)
+	{
+		Append(Lars::ESC);
+		AppendNumber(flag);
+	}
+
+	Append(Lars::GS);
+	Append(cmd.c_str(), cmd.size());
+}
+
+
+/**
+******************************************************************************
+* AddReferenceData - append a key value pair
+*
+* @param    key:in			key of the reference data
+* @param    value:in		value, empty: only the key is sent
+*
+* @return   void
+* @remarks
+******************************************************************************
+*/
+void RbsTelegram::AddReferenceData(const string &key, const string &value)
+{
+	if (!m_refData)
+	{
+		Append(Lars::STX);
+		m_refData = true;
+	}
+	else
+	{
+		Append(Lars::GS);
+	}
+
+	Append(key.c_str(), key.size());
+	if (!value.empty())
+	{
+		Append(Lars::FS);
+		Append(value.c_str(), value.size());
+	}
+}
+
+
+/**
+******************************************************************************
+* End - finish the telegram with crc and ETB and put SOH and length in front
+*
+* @param    crc16:in		true: append the crc16 checksum
+*
+* @return   false: telegram does not fit into the buffer
+*			true:  ok
+* @remarks
+******************************************************************************
+*/
+bool RbsTelegram::End(bool crc16)
+{
+	unsigned long	bodySize;
+
+	if (m_refData)
+	{
+		Append(Lars::ETX);
+	}
+	else if (crc16)
+	{
+		Append(Lars::GS);
+	}
+
+	if (crc16) AppendNumber(m_crc16.FinalCrc(m_crc), false);
+
+	Append(Lars::ETB);
+
+	// decimal length of the telegram body, written backwards in front of the body
+	bodySize = m_end - MAX_LENGTH_DIGITS;
+	m_start = MAX_LENGTH_DIGITS;
+	do
+	{
+		m_buffer[--m_start] = '0' + (char)(bodySize % 10);
+		bodySize /= 10;
+	} while (bodySize);
+	m_buffer[--m_start] = Lars::SOH;
+	m_buffer[m_end] = '\0';
+
+	return !m_overflow;
+}
+
+
+/**
+******************************************************************************
+* GetData - get the telegram
+*
+* @return   pointer to the zero terminated telegram
+* @remarks
+******************************************************************************
+*/
+const char *RbsTelegram::GetData() const
+{
+	return &m_buffer[m_start];
+}
+
+
+/**
+******************************************************************************
+* GetSize - get the telegram size
+*
+* @return   size of the telegram without zero termination
+* @remarks
+******************************************************************************
+*/
+unsigned long RbsTelegram::GetSize() const
+{
+	return m_end - m_start;
+}
+
+
+/**
+******************************************************************************
+* Overflow - check if the telegram was truncated
+*
+* @return   true: telegram larger than TELEGRAM_SIZE
+* @remarks
+******************************************************************************
+*/
+bool RbsTelegram::Overflow() const
+{
+	return m_overflow;
+}
+
+
+void RbsTelegram::Append(char value)
+{
+	Append(&value, 1);
+}
+
+
+void RbsTelegram::Append(const char *value, unsigned long size)
+{
+	if (size > MAX_LENGTH_DIGITS + TELEGRAM_SIZE - m_end)
+	{
+		m_overflow = true;
+		size = MAX_LENGTH_DIGITS + TELEGRAM_SIZE - m_end;
+	}
+
+	memcpy(&m_buffer[m_end], value, size);
+	m_crc16.UpdateCrc(&m_crc, (const unsigned char *)value, size);
+	m_end += size;
+}
+
+
+void RbsTelegram::AppendNumber(unsigned long value, bool crc16)
+{
+	char			number[20];
+	unsigned long	idx = sizeof(number);
+
+	// decimal coding, see AdcRbs::m_base
+	do
+	{
+		number[--idx] = '0' + (char)(value % 10);
+		value /= 10;
+	} while (value);
+
+	if (crc16)
+	{
+		Append(&number[idx], sizeof(number) - idx);
+	}
+	else
+	{
+		// checksum itself is not part of the crc
+		unsigned short crc = m_crc;
+		Append(&number[idx], sizeof(number) - idx);
+		m_crc = crc;
+	}
+}